@@ -262,6 +262,18 @@ typedef struct ArrangerSelectionsAction
   /** The velocities changed to when ramping. */
   uint8_t *            vel_after;
 
+  /**
+   * Whether \ref ArrangerSelectionsAction.sel and
+   * \ref ArrangerSelectionsAction.sel_after are
+   * shallow clones (without the children of the
+   * objects).
+   *
+   * Set for actions that only need to find the
+   * objects in the project and change their
+   * positions or properties.
+   */
+  bool                 shallow;
+
   /**
    * The arranger object, if the action can only
    * affect a single object rather than selections,
@@ -658,6 +670,14 @@ char *
 arranger_selections_action_stringize (
   ArrangerSelectionsAction * self);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+arranger_selections_action_get_mem_usage (
+  ArrangerSelectionsAction * self);
+
 void
 arranger_selections_action_free (
   ArrangerSelectionsAction * self);
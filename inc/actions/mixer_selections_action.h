@@ -225,6 +225,14 @@ char *
 mixer_selections_action_stringize (
   MixerSelectionsAction * self);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+mixer_selections_action_get_mem_usage (
+  MixerSelectionsAction * self);
+
 void
 mixer_selections_action_free (
   MixerSelectionsAction * self);
@@ -59,14 +59,41 @@ typedef struct RangeAction
 
   /** Selections before the action, starting from
    * objects intersecting with the start position and
-   * ending in infinity. */
+   * ending in infinity.
+   *
+   * Objects that are only moved by the action are
+   * in \ref RangeAction.sel_moved instead. */
   TimelineSelections * sel_before;
 
+  /**
+   * Shallow clones of the objects that are only
+   * moved by the action.
+   *
+   * These are moved in place in the project
+   * instead of being removed and re-added, so
+   * their children don't need to be stored.
+   */
+  TimelineSelections * sel_moved;
+
   /** Selections after the action. */
   TimelineSelections * sel_after;
 
-  /** A copy of the transport at the start of the
-   * action. */
+  /** Transport marker positions at the start of
+   * the action, restored on undo. */
+  Position       playhead_pos_before;
+  Position       cue_pos_before;
+  Position       loop_start_pos_before;
+  Position       loop_end_pos_before;
+
+  /**
+   * Copy of the transport stored by actions
+   * saved before only the marker positions were
+   * kept.
+   *
+   * Only used when loading such actions and
+   * converted to the positions above in
+   * range_action_init_loaded().
+   */
   Transport *    transport;
 
   /** Whether this is the first run. */
@@ -95,9 +122,24 @@ static const cyaml_schema_field_t
   YAML_FIELD_MAPPING_PTR (
     RangeAction, sel_after,
     timeline_selections_fields_schema),
+  YAML_FIELD_MAPPING_PTR_OPTIONAL (
+    RangeAction, sel_moved,
+    timeline_selections_fields_schema),
   YAML_FIELD_INT (
     RangeAction, first_run),
-  YAML_FIELD_MAPPING_PTR (
+  YAML_FIELD_MAPPING_EMBEDDED_OPTIONAL (
+    RangeAction, playhead_pos_before,
+    position_fields_schema),
+  YAML_FIELD_MAPPING_EMBEDDED_OPTIONAL (
+    RangeAction, cue_pos_before,
+    position_fields_schema),
+  YAML_FIELD_MAPPING_EMBEDDED_OPTIONAL (
+    RangeAction, loop_start_pos_before,
+    position_fields_schema),
+  YAML_FIELD_MAPPING_EMBEDDED_OPTIONAL (
+    RangeAction, loop_end_pos_before,
+    position_fields_schema),
+  YAML_FIELD_MAPPING_PTR_OPTIONAL (
     RangeAction, transport,
     transport_fields_schema),
 
@@ -147,6 +189,14 @@ char *
 range_action_stringize (
   RangeAction * self);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+range_action_get_mem_usage (
+  RangeAction * self);
+
 void
 range_action_free (
   RangeAction * self);
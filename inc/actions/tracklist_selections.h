@@ -477,6 +477,14 @@ char *
 tracklist_selections_action_stringize (
   TracklistSelectionsAction * self);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+tracklist_selections_action_get_mem_usage (
+  TracklistSelectionsAction * self);
+
 void
 tracklist_selections_action_free (
   TracklistSelectionsAction * self);
@@ -56,6 +56,18 @@ typedef struct UndoStack
   /** Actual stack used at runtime. */
   Stack *       stack;
 
+  /**
+   * Approximate memory used by the actions in the
+   * stack, in bytes.
+   */
+  size_t        mem_usage;
+
+  /**
+   * Maximum memory to use for the actions in the
+   * stack, in bytes, or 0 for unlimited.
+   */
+  size_t        max_mem_usage;
+
   /* the following are for serialization
    * purposes only */
 
@@ -171,6 +183,10 @@ undo_stack_free (
 #define undo_stack_peek_last(x) \
   (stack_peek_last ((x)->stack))
 
+#define undo_stack_is_over_mem_limit(x) \
+  ((x)->max_mem_usage > 0 && \
+   (x)->mem_usage > (x)->max_mem_usage)
+
 void
 undo_stack_push (
   UndoStack *      self,
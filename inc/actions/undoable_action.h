@@ -92,6 +92,13 @@ typedef struct UndoableAction
    * Used during deserialization.
    */
   int                 stack_idx;
+
+  /**
+   * Approximate memory usage of the action in
+   * bytes, calculated when pushed to an
+   * UndoStack.
+   */
+  size_t              mem_usage;
 } UndoableAction;
 
 static const cyaml_schema_field_t
@@ -139,6 +146,14 @@ int
 undoable_action_undo (
   UndoableAction * self);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+undoable_action_get_mem_usage (
+  UndoableAction * self);
+
 void
 undoable_action_free (
   UndoableAction * self);
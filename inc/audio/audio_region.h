@@ -126,6 +126,20 @@ audio_region_replace_frames (
   size_t    num_frames,
   bool      duplicate_clip);
 
+/**
+ * Hints the clip streamer about the frames that
+ * will be played from the given global frame on,
+ * if the region's clip is streamed.
+ *
+ * The read-ahead window wraps around the transport
+ * loop and the region loop.
+ */
+REALTIME
+void
+audio_region_prefetch (
+  ZRegion * self,
+  long      g_start_frames);
+
 /**
  * Fills audio data from the region.
  *
@@ -159,6 +159,20 @@ typedef struct AutomationTrack
   CustomButtonWidget * bot_left_buttons[8];
   int                  num_bot_left_buttons;
 
+  /**
+   * Region the automation was last read from by
+   * automation_track_get_normalized_val_at_frames().
+   *
+   * Only used to speed up the next search, it is
+   * never dereferenced unless it is found in
+   * \ref AutomationTrack.regions.
+   */
+  ZRegion *            read_region;
+
+  /** Index of the automation point last read in
+   * \ref AutomationTrack.read_region. */
+  int                  read_ap_idx;
+
   /** The widget. */
   //AutomationTrackWidget * widget;
 } AutomationTrack;
@@ -425,6 +439,28 @@ automation_track_get_val_at_pos (
   Position *        pos,
   bool              normalized);
 
+/**
+ * Gets the normalized value of the automation at
+ * the given global frames.
+ *
+ * The automation point found is remembered, so
+ * that reading consecutive positions (like in the
+ * engine's process cycle) does not need to search
+ * the automation points from scratch.
+ *
+ * @param[out] val The normalized value, if
+ *   automation exists at the given position.
+ *
+ * @return Whether there is automation at the given
+ *   position.
+ */
+REALTIME
+bool
+automation_track_get_normalized_val_at_frames (
+  AutomationTrack * self,
+  long              g_frames,
+  float *           val);
+
 /**
  * Returns the y pixels from the value based on the
  * allocation of the automation track.
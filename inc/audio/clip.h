@@ -31,6 +31,9 @@
 #include "utils/types.h"
 #include "utils/yaml.h"
 
+typedef struct ClipStream ClipStream;
+typedef struct ClipPeaks ClipPeaks;
+
 /**
  * @addtogroup audio
  *
@@ -48,17 +51,27 @@ typedef struct AudioClip
   /** Name of the clip. */
   char *        name;
 
-  /** The audio frames, interleaved. */
-  sample_t *    frames;
-
   /** Number of frames per channel. */
   long          num_frames;
 
   /**
-   * Per-channel frames for convenience.
+   * Per-channel (planar) audio frames.
+   *
+   * This is the only layout kept in memory.
+   * Interleaved frames are generated on demand
+   * with audio_clip_get_interleaved_frames().
    */
   sample_t *    ch_frames[16];
 
+  /**
+   * Allocated number of frames per channel in
+   * @ref AudioClip.ch_frames.
+   *
+   * May be larger than
+   * @ref AudioClip.num_frames while recording.
+   */
+  size_t        ch_frames_size;
+
   /** Number of channels. */
   channels_t    channels;
 
@@ -93,6 +106,44 @@ typedef struct AudioClip
    * @see AudioClip.frames_written.
    */
   gint64        last_write;
+
+  /**
+   * Stream to read from if the clip is streamed
+   * from its file in the pool instead of being
+   * fully loaded in memory, otherwise NULL.
+   *
+   * When this is set, @ref AudioClip.ch_frames
+   * are NULL.
+   */
+  ClipStream *  stream;
+
+  /**
+   * Mapped pool cache file that
+   * @ref AudioClip.ch_frames point into, if the
+   * clip was loaded from the pool cache,
+   * otherwise NULL.
+   *
+   * @see pool_cache_load_clip().
+   */
+  GMappedFile * mapped_file;
+
+  /**
+   * Waveform peaks used when drawing, or NULL if
+   * not generated yet.
+   *
+   * Must only be accessed through
+   * clip_peaks_acquire() and friends.
+   */
+  ClipPeaks *   peaks;
+
+  /** Thread generating the peaks, if any. */
+  GThread *     peaks_thread;
+
+  /**
+   * Whether the frames changed since the peaks
+   * were generated.
+   */
+  volatile gint peaks_dirty;
 } AudioClip;
 
 static const cyaml_schema_field_t
@@ -125,6 +176,49 @@ void
 audio_clip_init_loaded (
   AudioClip * self);
 
+/**
+ * Loads the whole clip in memory if it is being
+ * streamed.
+ *
+ * To be called before any operation that needs
+ * direct access to @ref AudioClip.ch_frames.
+ */
+void
+audio_clip_ensure_loaded (
+  AudioClip * self);
+
+/**
+ * Copies the frames of the given channel into
+ * @p buf, whether the clip is streamed or not.
+ *
+ * Not realtime safe.
+ */
+void
+audio_clip_read_frames (
+  AudioClip * self,
+  channels_t  channel,
+  long        start_frame,
+  size_t      nframes,
+  float *     buf);
+
+/**
+ * Gets the minimum and maximum sample values
+ * across all channels in the given frame range.
+ *
+ * The range is clamped to the clip's bounds and
+ * the results are not larger than 0 (min) and
+ * not smaller than 0 (max).
+ *
+ * Not realtime safe.
+ */
+void
+audio_clip_get_min_max (
+  AudioClip * self,
+  long        start_frame,
+  long        end_frame,
+  float *     min,
+  float *     max);
+
 /**
  * Creates an audio clip from a file.
  *
@@ -165,17 +259,58 @@ audio_clip_new_recording (
   const char *     name);
 
 /**
- * Updates the channel caches.
+ * Makes sure the channel caches can hold
+ * @ref AudioClip.num_frames frames.
  *
- * See @ref AudioClip.ch_frames.
+ * The caches grow geometrically, so repeated calls
+ * while appending (eg, when recording) only
+ * reallocate occasionally. Existing frames are
+ * kept and newly allocated frames are zeroed.
  *
- * @param start_from Frames to start from (per
- *   channel. The previous frames will be kept.
+ * See @ref AudioClip.ch_frames.
  */
 void
 audio_clip_update_channel_caches (
+  AudioClip * self);
+
+/**
+ * Frees the frames of the clip, whether they are
+ * streamed, mapped from the pool cache or
+ * allocated.
+ */
+void
+audio_clip_free_frames (
+  AudioClip * self);
+
+/**
+ * Copies the given frame range to @p buf,
+ * interleaved.
+ *
+ * Streamed clips are read from the stream, in
+ * which case this is not realtime safe.
+ *
+ * @param buf Buffer with space for
+ *   @p nframes * channels samples.
+ */
+void
+audio_clip_get_interleaved_frames (
   AudioClip * self,
-  size_t      start_from);
+  long        start_frame,
+  size_t      nframes,
+  float *     buf);
+
+/**
+ * Replaces the given frame range with the
+ * interleaved frames in @p arr.
+ *
+ * The range must be inside the clip.
+ */
+void
+audio_clip_set_interleaved_frames (
+  AudioClip *   self,
+  const float * arr,
+  long          start_frame,
+  size_t        nframes);
 
 /**
  * Writes the given audio clip data to a file.
@@ -191,6 +326,29 @@ audio_clip_write_to_file (
   const char * filepath,
   bool         parts);
 
+/**
+ * Generates the waveform peaks of the clip and
+ * saves them next to its file in the pool.
+ *
+ * Peaks previously saved for the pool file are
+ * used if they are still valid.
+ *
+ * @param async Whether to generate the peaks in a
+ *   separate thread.
+ */
+void
+audio_clip_generate_peaks (
+  AudioClip * self,
+  bool        async);
+
+/**
+ * Waits for the peaks to finish generating, if
+ * they are being generated.
+ */
+void
+audio_clip_wait_for_peaks (
+  AudioClip * self);
+
 /**
  * Writes the clip to the pool as a wav file.
  *
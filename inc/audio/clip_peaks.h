@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/**
+ * \file
+ *
+ * Multi-resolution waveform peaks of audio clips.
+ */
+
+#ifndef __AUDIO_CLIP_PEAKS_H__
+#define __AUDIO_CLIP_PEAKS_H__
+
+#include <stdbool.h>
+
+#include <gtk/gtk.h>
+
+typedef struct AudioClip AudioClip;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Number of frames each peak of the first level
+ * covers. */
+#define CLIP_PEAKS_BASE_FRAMES 256
+
+/** Number of peaks of a level each peak of the
+ * next level covers. */
+#define CLIP_PEAKS_LEVEL_FACTOR 4
+
+/** Max number of levels. */
+#define CLIP_PEAKS_MAX_LEVELS 12
+
+/** Peaks file format version. */
+#define CLIP_PEAKS_VERSION 1
+
+/** Extension appended to the pool file's path to
+ * get the path of its peaks file. */
+#define CLIP_PEAKS_FILE_EXT ".peaks"
+
+/**
+ * Peak of a range of frames across all channels.
+ */
+typedef struct ClipPeak
+{
+  float min;
+  float max;
+  float rms;
+} ClipPeak;
+
+/**
+ * Peak pyramid of an audio clip.
+ *
+ * Each level has a peak for every
+ * @ref CLIP_PEAKS_BASE_FRAMES *
+ * @ref CLIP_PEAKS_LEVEL_FACTOR ^ level frames, so
+ * drawing a range of frames at any zoom level
+ * only needs to look at a few peaks.
+ */
+typedef struct ClipPeaks
+{
+  ClipPeak * levels[CLIP_PEAKS_MAX_LEVELS];
+  size_t     num_peaks[CLIP_PEAKS_MAX_LEVELS];
+  size_t     peaks_size[CLIP_PEAKS_MAX_LEVELS];
+  int        num_levels;
+
+  /** Number of frames covered. */
+  long       num_frames;
+} ClipPeaks;
+
+/**
+ * Header of a peaks file.
+ *
+ * Peaks files only contain the first level. The
+ * pool file's size and modification time are
+ * stored so that peaks of files that changed are
+ * not used.
+ */
+typedef struct ClipPeaksHeader
+{
+  char    magic[8];
+  guint32 version;
+  guint32 channels;
+  gint64  num_frames;
+  gint64  pool_file_size;
+  gint64  pool_file_mtime;
+} ClipPeaksHeader;
+
+/**
+ * Creates empty peaks.
+ */
+ClipPeaks *
+clip_peaks_new (void);
+
+/**
+ * Creates the peaks of all the frames of the
+ * given clip.
+ *
+ * Not realtime safe.
+ */
+ClipPeaks *
+clip_peaks_new_from_clip (
+  AudioClip * clip);
+
+/**
+ * Recalculates the peaks of the given frame range
+ * of the clip, growing the peaks to the clip's
+ * current number of frames if needed.
+ *
+ * Used to update the peaks incrementally (eg,
+ * while recording).
+ */
+void
+clip_peaks_update (
+  ClipPeaks * self,
+  AudioClip * clip,
+  long        start_frame,
+  long        end_frame);
+
+/**
+ * Loads the peaks saved for the given pool file.
+ *
+ * @return The peaks, or NULL if there are no
+ *   valid peaks for the file's current contents.
+ */
+ClipPeaks *
+clip_peaks_load (
+  AudioClip *  clip,
+  const char * pool_path);
+
+/**
+ * Saves the peaks next to the given pool file.
+ *
+ * The peaks must not be shared with other
+ * threads. Use clip_peaks_save_clip() for the
+ * peaks of a clip.
+ */
+void
+clip_peaks_save (
+  ClipPeaks *  self,
+  AudioClip *  clip,
+  const char * pool_path);
+
+/**
+ * Saves the current peaks of the clip next to the
+ * given pool file.
+ *
+ * The peaks lock is only held while copying the
+ * peaks, not during the file I/O.
+ *
+ * @return Whether the clip had peaks to save.
+ */
+bool
+clip_peaks_save_clip (
+  AudioClip *  clip,
+  const char * pool_path);
+
+/**
+ * Returns the path of the peaks file of the given
+ * pool file.
+ */
+char *
+clip_peaks_get_path (
+  const char * pool_path);
+
+/**
+ * Returns the level to use when each pixel
+ * covers the given number of frames, or -1 if the
+ * frames should be read directly.
+ */
+int
+clip_peaks_get_level (
+  ClipPeaks * self,
+  double      frames_per_px);
+
+/**
+ * Gets the minimum and maximum sample values and
+ * the RMS in the given frame range using the
+ * peaks of the given level.
+ *
+ * The results are the same as
+ * audio_clip_get_min_max(), except that the
+ * range is extended to the bounds of the peaks.
+ *
+ * @param rms RMS to fill in, or NULL.
+ */
+void
+clip_peaks_get_min_max (
+  ClipPeaks * self,
+  int         level,
+  long        start_frame,
+  long        end_frame,
+  float *     min,
+  float *     max,
+  float *     rms);
+
+/**
+ * Returns the peaks of the clip with the peaks
+ * lock held, or NULL if the clip has no peaks
+ * yet.
+ *
+ * The lock must be released with
+ * clip_peaks_release() when done.
+ */
+ClipPeaks *
+clip_peaks_acquire (
+  AudioClip * clip);
+
+/**
+ * Releases the lock taken by clip_peaks_acquire().
+ */
+void
+clip_peaks_release (void);
+
+/**
+ * Replaces the peaks of the clip and frees the
+ * previous ones.
+ */
+void
+clip_peaks_set (
+  AudioClip * clip,
+  ClipPeaks * peaks);
+
+/**
+ * Updates the peaks of the clip after the given
+ * frame range was recorded, creating them if
+ * needed.
+ */
+void
+clip_peaks_update_clip (
+  AudioClip * clip,
+  long        start_frame,
+  long        end_frame);
+
+void
+clip_peaks_free (
+  ClipPeaks * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Disk streaming for large audio clips.
+ */
+
+#ifndef __AUDIO_CLIP_STREAM_H__
+#define __AUDIO_CLIP_STREAM_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <gtk/gtk.h>
+#include <sndfile.h>
+
+#include "zix/sem.h"
+
+typedef struct ClipStreamer ClipStreamer;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Number of frames (per channel) in each block
+ * of a streamed clip.
+ */
+#define CLIP_STREAM_BLOCK_FRAMES 16384
+
+/**
+ * Number of frames to read ahead of the playhead.
+ */
+#define CLIP_STREAM_READ_AHEAD_FRAMES \
+  (4 * CLIP_STREAM_BLOCK_FRAMES)
+
+/**
+ * Default memory budget in MiB for streamed
+ * blocks.
+ */
+#define CLIP_STREAM_DEFAULT_CACHE_SIZE 512
+
+/**
+ * A clip that is streamed from its file in the
+ * pool instead of being fully loaded in memory.
+ *
+ * The file is split into blocks of
+ * @ref CLIP_STREAM_BLOCK_FRAMES frames that are
+ * loaded by the read-ahead thread of the
+ * ClipStreamer and evicted when the memory
+ * budget is exceeded.
+ *
+ * The realtime thread only ever reads block
+ * pointers atomically and never blocks.
+ */
+typedef struct ClipStream
+{
+  /** Path to the file being streamed. */
+  char *          path;
+
+  /** Open file handle. */
+  SNDFILE *       file;
+
+  /** Number of channels. */
+  channels_t      channels;
+
+  /** Number of frames per channel. */
+  long            num_frames;
+
+  /** Number of blocks. */
+  size_t          num_blocks;
+
+  /**
+   * Planar block data, or NULL if the block is
+   * not loaded.
+   *
+   * Each block holds @ref CLIP_STREAM_BLOCK_FRAMES
+   * frames for each channel, one channel after
+   * the other.
+   *
+   * Accessed atomically.
+   */
+  float **        blocks;
+
+  /**
+   * Engine cycle each block was last used or
+   * hinted in.
+   */
+  volatile gint * last_used;
+
+  /** Whether each block was requested. */
+  volatile gint * requested;
+
+  /** Whether any block was requested. */
+  volatile gint   has_requests;
+
+  /** Streamer this stream is registered with. */
+  ClipStreamer *  streamer;
+} ClipStream;
+
+/**
+ * Manages the read-ahead thread and memory budget
+ * for all streamed clips.
+ */
+typedef struct ClipStreamer
+{
+  /** Registered streams. */
+  GPtrArray *     streams;
+
+  /**
+   * Number of registered streams.
+   *
+   * Read by the engine to skip looking for
+   * streamed clips when there are none.
+   */
+  volatile gint   num_streams;
+
+  /**
+   * Lock for the streams, the retired blocks and
+   * the file handles.
+   *
+   * Never taken by the realtime thread.
+   */
+  GMutex          lock;
+
+  /**
+   * Blocks that were evicted but may still be
+   * read by the engine in the current cycle.
+   */
+  GQueue *        retired;
+
+  /** Memory budget in bytes. */
+  size_t          max_bytes;
+
+  /**
+   * Minimum clip size in bytes for the clip to
+   * be streamed, or -1 to never stream.
+   */
+  gint64          min_clip_bytes;
+
+  /** Bytes used by loaded blocks. */
+  size_t          used_bytes;
+
+  /** Whether the budget warning was shown. */
+  bool            warned_over_budget;
+
+  /** Scratch buffer for interleaved reads. */
+  float *         read_buf;
+
+  /**
+   * Read-ahead thread, started when the first
+   * stream is registered.
+   */
+  GThread *       thread;
+
+  /**
+   * Posted when blocks are requested, to wake up
+   * the read-ahead thread.
+   */
+  ZixSem          requests_sem;
+
+  /** Whether the read-ahead thread should run. */
+  volatile gint   run;
+} ClipStreamer;
+
+/**
+ * Creates a new streamer and starts its read-ahead
+ * thread.
+ */
+ClipStreamer *
+clip_streamer_new (void);
+
+/**
+ * Returns whether a clip with the given size
+ * should be streamed instead of being fully
+ * loaded.
+ */
+bool
+clip_streamer_should_stream (
+  ClipStreamer * self,
+  channels_t     channels,
+  long           num_frames);
+
+/**
+ * Stops the read-ahead thread and frees the
+ * streamer.
+ *
+ * All streams must be freed before calling this.
+ */
+void
+clip_streamer_free (
+  ClipStreamer * self);
+
+/**
+ * Opens the given file for streaming.
+ *
+ * @return The stream, or NULL if the file does not
+ *   match the engine's sample rate, is too small
+ *   to be streamed or could not be opened.
+ */
+ClipStream *
+clip_stream_new (
+  ClipStreamer * streamer,
+  const char *   path);
+
+/**
+ * Copies @p nframes frames of the given channel
+ * starting at @p start_frame into @p buf.
+ *
+ * Blocks that are not loaded yet are filled with
+ * silence and requested from the read-ahead
+ * thread. When exporting, missing blocks are
+ * loaded synchronously instead.
+ *
+ * @return Whether all frames were available.
+ */
+REALTIME
+bool
+clip_stream_read (
+  ClipStream * self,
+  channels_t   channel,
+  long         start_frame,
+  size_t       nframes,
+  float *      buf);
+
+/**
+ * Hints the read-ahead thread that the given
+ * frames will be read soon.
+ */
+REALTIME
+void
+clip_stream_prefetch (
+  ClipStream * self,
+  long         start_frame,
+  size_t       nframes);
+
+/**
+ * Non-realtime version of clip_stream_read()
+ * that loads any missing blocks before reading.
+ */
+void
+clip_stream_read_blocking (
+  ClipStream * self,
+  channels_t   channel,
+  long         start_frame,
+  size_t       nframes,
+  float *      buf);
+
+/**
+ * Unregisters the stream from its streamer and
+ * frees it once the engine is no longer reading
+ * from it.
+ */
+void
+clip_stream_free (
+  ClipStream * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -320,7 +320,9 @@ typedef struct AudioEngine
   /**
    * Cycle count to know which cycle we are in.
    *
-   * Useful for debugging.
+   * Useful for debugging and for knowing when data
+   * that was removed is no longer used by the
+   * engine (see ClipStreamer).
    */
   volatile long     cycle;
 
@@ -143,6 +143,28 @@ typedef struct Fader
   /** Track position, if channel fader. */
   int              track_pos;
 
+  /**
+   * Amplitude and balance gains applied at the
+   * end of the last processed block (runtime).
+   *
+   * The gains are ramped from these values to
+   * the new ones to avoid zipper noise when the
+   * fader or balance are moved.
+   */
+  float            last_amp;
+  float            last_calc_l;
+  float            last_calc_r;
+
+  /** Whether the above are set. */
+  bool             last_gains_set;
+
+  /**
+   * Cached fader_get_implied_soloed() (runtime).
+   *
+   * @see tracklist_update_solo_state().
+   */
+  bool             implied_soloed;
+
   int              magic;
 
   bool             is_project;
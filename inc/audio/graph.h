@@ -79,6 +79,47 @@ typedef struct ModulatorMacroProcessor
 
 #define MAX_GRAPH_THREADS 128
 
+/**
+ * Default maximum estimated cost of a graph for
+ * it to be run serially in topological order
+ * instead of being spread across the graph
+ * threads.
+ *
+ * Can be overridden with the
+ * ZRYTHM_GRAPH_SERIAL_MAX_COST environment
+ * variable.
+ */
+#define GRAPH_DEFAULT_SERIAL_MAX_COST 32
+
+/** Estimated cost of a plugin node. */
+#define GRAPH_PLUGIN_NODE_COST 16
+
+/** Estimated cost of other processing (non-port)
+ * nodes. */
+#define GRAPH_PROCESSOR_NODE_COST 1
+
+/**
+ * Strategy used to hand ready nodes to the graph
+ * threads.
+ */
+typedef enum GraphScheduler
+{
+  /** All ready nodes are pushed into a single
+   * MPMC queue shared by all threads. */
+  GRAPH_SCHEDULER_MPMC_QUEUE,
+
+  /**
+   * Each thread keeps its own deque of ready
+   * nodes and steals from other threads when it
+   * runs out of work.
+   *
+   * A thread that finishes a node runs the first
+   * successor that became ready inline and
+   * publishes the rest in its own deque.
+   */
+  GRAPH_SCHEDULER_WORK_STEALING,
+} GraphScheduler;
+
 /**
  * Graph.
  */
@@ -96,6 +137,10 @@ typedef struct Graph
   GraphNode **  graph_nodes;
   int           n_graph_nodes;
 
+  /** Index of \ref Graph.graph_nodes by node type
+   * and object pointer. */
+  GHashTable *  graph_nodes_map;
+
   /** Nodes without incoming edges.
    * These run concurrently at the start of each
    * cycle to kick off processing */
@@ -123,9 +168,44 @@ typedef struct Graph
    * processed. */
   MPMCQueue *     trigger_queue;
 
-  /** Number of entries in trigger queue. */
+  /** Number of entries in trigger queue (or in
+   * all thread deques when work-stealing). */
   volatile guint  trigger_queue_size;
 
+  /** Scheduler used, decided when the graph is
+   * created. */
+  GraphScheduler  scheduler;
+
+  /** Whether the scheduler was chosen
+   * explicitly, in which case the graph is never
+   * run serially unless the choice is serial. */
+  bool            scheduler_explicit;
+
+  /** Whether to always run the graph serially
+   * (decided when the graph is created). */
+  bool            force_serial;
+
+  /** Maximum estimated cost of the graph for it
+   * to be run serially automatically. */
+  int             serial_max_cost;
+
+  /**
+   * Whether to run the graph serially in
+   * \ref Graph.topo_order from the engine's
+   * process thread, without going through the
+   * graph threads.
+   *
+   * Decided in graph_rechain() based on the
+   * scheduler, the estimated cost of the nodes
+   * and the number of cores.
+   */
+  bool            process_serially;
+
+  /** The nodes in topological order, calculated
+   * in graph_rechain(). */
+  GraphNode **    topo_order;
+  size_t          n_topo_order;
+
   /** flag to exit, terminate all process-threads */
   volatile gint     terminate;
 
@@ -137,6 +217,11 @@ typedef struct Graph
    */
   GraphNode **         setup_graph_nodes;
   size_t               num_setup_graph_nodes;
+
+  /** Index of \ref Graph.setup_graph_nodes by
+   * node type and object pointer, filled in as
+   * the nodes are created. */
+  GHashTable *         setup_graph_nodes_map;
   GraphNode **         setup_init_trigger_list;
   size_t               num_setup_init_triggers;
 
@@ -240,7 +325,21 @@ graph_get_max_route_playback_latency (
  */
 void
 graph_on_reached_terminal_node (
-  Graph *  self);
+  Graph *       self,
+  GraphThread * thread);
+
+/**
+ * Makes the given node available for processing
+ * using the graph's scheduler.
+ *
+ * @param thread The thread that made the node
+ *   ready.
+ */
+void
+graph_schedule_node (
+  Graph *       self,
+  GraphThread * thread,
+  GraphNode *   node);
 
 void
 graph_update_latencies (
@@ -262,6 +361,35 @@ graph_setup (
   const int drop_unnecessary_ports,
   const int rechain);
 
+/**
+ * Sets up the next graph while the current one
+ * keeps running.
+ *
+ * Plugins in the running graph are not queried,
+ * so this can be called without holding the
+ * router's graph access. graph_apply_setup() must
+ * be called afterwards while holding the graph
+ * access.
+ */
+void
+graph_setup_next (
+  Graph * self);
+
+/**
+ * Compares the graph set up with
+ * graph_setup_next() with the running graph,
+ * recalculates latencies only for the nodes
+ * affected by the changes and swaps it in.
+ *
+ * Must be called while holding the router's graph
+ * access.
+ *
+ * @return Whether the running graph was replaced.
+ */
+bool
+graph_apply_setup (
+  Graph * self);
+
 /**
  * Adds a new connection for the given
  * src and dest ports and validates the graph.
@@ -278,6 +406,59 @@ graph_validate_with_connection (
   const Port * src,
   const Port * dest);
 
+/**
+ * Processes all the nodes one after another in
+ * topological order on the calling thread.
+ *
+ * Used instead of the graph threads when
+ * \ref Graph.process_serially is set.
+ */
+void
+graph_process_serially (
+  Graph * self);
+
+/**
+ * Returns the chain of nodes that bounded the
+ * last processing cycle.
+ *
+ * Starting from the terminal node that finished
+ * last, the parent that finished last is followed
+ * until a node without parents is reached.
+ *
+ * Must be called from the GTK thread.
+ *
+ * @param[out] path Newly allocated array with the
+ *   nodes, starting from the initial node. Must be
+ *   free'd.
+ *
+ * @return The number of nodes in the path.
+ */
+size_t
+graph_get_critical_path (
+  Graph *       self,
+  GraphNode *** path);
+
+/**
+ * Fills in @p load with the sum of the processing
+ * times of the track processor, plugins, pre-fader
+ * and fader of the given track.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+graph_get_track_dsp_load (
+  Graph *            self,
+  Track *            track,
+  GraphNodeDspLoad * load);
+
+/**
+ * Resets the processing time statistics of all
+ * the nodes.
+ */
+void
+graph_reset_dsp_load (
+  Graph * self);
+
 /**
  * Starts as many threads as there are cores.
  *
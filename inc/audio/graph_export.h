@@ -58,6 +58,19 @@ graph_export_as (
   GraphExportType type,
   const char *    path);
 
+/**
+ * Writes the processing time statistics of each
+ * node and the critical path of the last cycle as
+ * text at the given path.
+ *
+ * The graph must be the running graph and this
+ * must be called from the GTK thread.
+ */
+void
+graph_export_dsp_load (
+  Graph *      graph,
+  const char * path);
+
 /**
  * @}
  */
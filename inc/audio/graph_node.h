@@ -52,6 +52,7 @@
 
 typedef struct GraphNode GraphNode;
 typedef struct Graph Graph;
+typedef struct GraphThread GraphThread;
 typedef struct PassthroughProcessor
   PassthroughProcessor;
 typedef struct Port Port;
@@ -105,6 +106,51 @@ typedef enum GraphNodeType
   ROUTE_NODE_TYPE_MODULATOR_MACRO_PROCESOR,
 } GraphNodeType;
 
+/**
+ * Weight of the last cycle in
+ * \ref GraphNodeDspLoad.avg, as a power of 2
+ * (1/8).
+ */
+#define GRAPH_NODE_DSP_LOAD_AVG_SHIFT 3
+
+/**
+ * Processing time statistics of a node.
+ *
+ * Only written by the thread processing the node
+ * and read from other threads without locking.
+ *
+ * Times are in nanoseconds.
+ */
+typedef struct GraphNodeDspLoad
+{
+  /** Time taken in the last cycle. */
+  volatile gint last;
+
+  /** Min time taken since the last reset. */
+  volatile gint min;
+
+  /** Max time taken since the last reset. */
+  volatile gint max;
+
+  /** Exponential moving average of the time
+   * taken. */
+  volatile gint avg;
+
+  /** Time the node finished processing in the
+   * last cycle, relative to the start of the
+   * cycle. */
+  volatile gint end;
+
+  /** Number of cycles measured since the last
+   * reset. */
+  volatile gint num_cycles;
+
+  /** \ref GraphNodeDspLoad.avg in 1/256ths of a
+   * nanosecond, used by the processing thread
+   * only. */
+  gint64        avg_fixed;
+} GraphNodeDspLoad;
+
 /**
  * A node in the processing graph.
  */
@@ -165,6 +211,9 @@ typedef struct GraphNode
   /** The route's playback latency so far. */
   nframes_t     route_playback_latency;
 
+  /** Processing time statistics. */
+  GraphNodeDspLoad dsp_load;
+
   GraphNodeType type;
 } GraphNode;
 
@@ -186,13 +235,50 @@ graph_node_print (
   GraphNode * node);
 
 /**
- * Processes the GraphNode.
+ * Processes the GraphNode without notifying
+ * downstream nodes.
+ *
+ * Used directly when the graph is run in
+ * topological order.
  */
 void
-graph_node_process (
+graph_node_run (
   GraphNode * node,
   nframes_t   nframes);
 
+/**
+ * Processes the GraphNode.
+ *
+ * @param thread The graph thread processing the
+ *   node.
+ */
+void
+graph_node_process (
+  GraphNode *   node,
+  nframes_t     nframes,
+  GraphThread * thread);
+
+/**
+ * Copies the processing time statistics of the
+ * node into @p load.
+ *
+ * Can be called from any thread.
+ */
+void
+graph_node_get_dsp_load (
+  GraphNode *        self,
+  GraphNodeDspLoad * load);
+
+/**
+ * Resets the processing time statistics of the
+ * node.
+ *
+ * Can be called from any thread.
+ */
+void
+graph_node_reset_dsp_load (
+  GraphNode * self);
+
 /**
  * Returns the latency of only the given port,
  * without adding the previous/next latencies.
@@ -221,10 +307,14 @@ graph_node_set_route_playback_latency (
 /**
  * Called by an upstream node when it has completed
  * processing.
+ *
+ * @param thread The graph thread that processed
+ *   the upstream node.
  */
 void
 graph_node_trigger (
-  GraphNode * self);
+  GraphNode *   self,
+  GraphThread * thread);
 
 //void
 //graph_node_add_feeds (
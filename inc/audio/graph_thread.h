@@ -62,6 +62,8 @@
 #endif
 
 typedef struct Graph Graph;
+typedef struct GraphNode GraphNode;
+typedef struct WsDeque WsDeque;
 
 /**
  * @addtogroup audio
@@ -87,6 +89,15 @@ typedef struct GraphThread
   /** Pointer back to the graph. */
   Graph *           graph;
 
+  /** Nodes made ready by this thread, used by
+   * the work-stealing scheduler. */
+  WsDeque *         deque;
+
+  /** Ready node to run next on this thread
+   * without going through the deque, used by
+   * the work-stealing scheduler. */
+  GraphNode *       inline_node;
+
 #ifdef HAVE_LSP_DSP
   /** LSP DSP context. */
   lsp_dsp_context_t lsp_ctx;
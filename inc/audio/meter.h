@@ -59,10 +59,15 @@ typedef enum MeterAlgorithm
 
 /**
  * A Meter used by a single GUI element.
+ *
+ * The DSP runs in the engine after the port is
+ * processed, and the results are published in a
+ * small snapshot that the GUI reads.
  */
 typedef struct Meter
 {
-  /** Port associated with this meter. */
+  /** Port associated with this meter, or NULL if
+   * the port was freed. */
   Port *          port;
 
   /** True peak processor. */
@@ -85,6 +90,25 @@ typedef struct Meter
    */
   MeterAlgorithm  algorithm;
 
+  /**
+   * Sequence number of the snapshot below.
+   *
+   * Odd while the engine is writing the snapshot
+   * and 0 if nothing was published yet.
+   */
+  volatile gint   snapshot_seq;
+
+  /** Last amplitude published by the engine. */
+  float           snapshot_amp;
+
+  /** Last max amplitude published by the
+   * engine. */
+  float           snapshot_max_amp;
+
+  /** Set by the GUI after reading the snapshot so
+   * that the engine starts a new max. */
+  volatile gint   snapshot_read;
+
   /** Previous max, used when holding the max
    * value. */
   float           prev_max;
@@ -101,10 +125,31 @@ typedef struct Meter
 
 } Meter;
 
+/**
+ * Creates a meter for the given port and
+ * registers it with the port so that it gets
+ * processed by the engine.
+ *
+ * Must be called from the GTK thread.
+ */
 Meter *
 meter_new_for_port (
   Port * port);
 
+/**
+ * Runs the meter DSP on the given range of the
+ * port buffer and publishes a new snapshot.
+ *
+ * To be called by the engine after the port is
+ * processed.
+ */
+REALTIME
+void
+meter_process (
+  Meter *   self,
+  nframes_t local_offset,
+  nframes_t nframes);
+
 /**
  * Get the current meter value.
  *
@@ -118,6 +163,12 @@ meter_get_value (
   float *          val,
   float *          max);
 
+/**
+ * Unregisters the meter from its port and frees
+ * it once the engine no longer uses it.
+ *
+ * Must be called from the GTK thread.
+ */
 void
 meter_free (
   Meter * self);
@@ -51,6 +51,12 @@ typedef struct ChordDescriptor ChordDescriptor;
 /** Max events to hold in queues. */
 #define MAX_MIDI_EVENTS 2560
 
+/**
+ * Max sources to pass to midi_events_merge() at
+ * a time.
+ */
+#define MIDI_EVENTS_MAX_MERGE_SOURCES 16
+
 /**
  * Type of MIDI event.
  *
@@ -237,6 +243,37 @@ midi_events_append_w_filter (
   const nframes_t nframes,
   bool            queued);
 
+/**
+ * Merges the events of the given sources into
+ * @p dest, keeping the events sorted by time and
+ * skipping duplicates.
+ *
+ * The events of each source and the existing
+ * events of @p dest must already be sorted, in
+ * which case the result is sorted too and this
+ * only takes linear time in the number of
+ * events.
+ *
+ * @param srcs Sources to merge the main events of.
+ * @param channels Allowed channels (array of 16
+ *   booleans) for each source, or NULL to allow
+ *   all channels. The array itself may be NULL.
+ * @param num_srcs Number of sources, up to
+ *   @ref MIDI_EVENTS_MAX_MERGE_SOURCES.
+ * @param local_offset The start frame offset from 0
+ *   in this cycle.
+ * @param nframes Number of frames to process.
+ */
+REALTIME
+void
+midi_events_merge (
+  MidiEvents *    dest,
+  MidiEvents **   srcs,
+  int **          channels,
+  const int       num_srcs,
+  const nframes_t local_offset,
+  const nframes_t nframes);
+
 /**
  * Adds a note on event to the given MidiEvents.
  *
@@ -375,9 +412,13 @@ midi_events_clear (
 /**
  * Clears duplicates.
  *
+ * The events must be sorted by time (see
+ * midi_events_sort()).
+ *
  * @param queued Clear duplicates from queued events
  * instead.
  */
+REALTIME
 void
 midi_events_clear_duplicates (
   MidiEvents * midi_events,
@@ -422,6 +463,8 @@ midi_events_copy_to_jack (
 
 /**
  * Sorts the MidiEvents by time.
+ *
+ * Does nothing if they are already sorted.
  */
 void
 midi_events_sort (
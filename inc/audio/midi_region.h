@@ -177,6 +177,30 @@ midi_region_fill_midi_events (
   bool         note_off_at_end,
   MidiEvents * midi_events);
 
+/**
+ * Rebuilds the time-sorted note index of the
+ * given MIDI or chord region.
+ *
+ * Must not be called while the engine is
+ * processing the region.
+ *
+ * @see ZRegion.notes_by_start.
+ */
+void
+midi_region_update_note_index (
+  ZRegion * self);
+
+/**
+ * Marks the note index of the given MIDI or chord
+ * region as outdated.
+ *
+ * To be called when notes are added, removed or
+ * moved.
+ */
+void
+midi_region_invalidate_note_index (
+  ZRegion * self);
+
 /**
  * Prints the MidiNotes in the Region.
  *
@@ -30,6 +30,7 @@
 #include "utils/yaml.h"
 
 typedef struct Track Track;
+typedef struct ClipStreamer ClipStreamer;
 
 /**
  * @addtogroup audio
@@ -59,6 +60,10 @@ typedef struct AudioPool
 
   /** Array sizes. */
   size_t         clips_size;
+
+  /** Streamer for clips too large to be loaded
+   * in memory. */
+  ClipStreamer * streamer;
 } AudioPool;
 
 static const cyaml_schema_field_t
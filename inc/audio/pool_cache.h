@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * On-disk cache of decoded pool files.
+ */
+
+#ifndef __AUDIO_POOL_CACHE_H__
+#define __AUDIO_POOL_CACHE_H__
+
+#include <stdbool.h>
+
+#include <gtk/gtk.h>
+
+typedef struct AudioClip AudioClip;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Cache file format version. */
+#define POOL_CACHE_VERSION 1
+
+/**
+ * Offset of the frames in a cache file.
+ *
+ * The header is padded to a page so that the
+ * frames are suitably aligned when mapped.
+ */
+#define POOL_CACHE_DATA_OFFSET 4096
+
+/**
+ * Name of the index file in the cache directory.
+ *
+ * The index maps each pool file name to its size,
+ * modification time and content hash, so that
+ * unchanged files do not need to be hashed again.
+ */
+#define POOL_CACHE_INDEX_FILE "index"
+
+/**
+ * Header of a cache file.
+ *
+ * Cache files are named after the hash of the
+ * pool file's contents and the sample rate and
+ * contain the decoded frames at that sample rate,
+ * one channel after the other, at
+ * @ref POOL_CACHE_DATA_OFFSET.
+ */
+typedef struct PoolCacheHeader
+{
+  char    magic[8];
+  guint32 version;
+  guint32 samplerate;
+  guint32 channels;
+  guint32 reserved;
+  gint64  num_frames;
+} PoolCacheHeader;
+
+/**
+ * Maps the cached frames of the given pool file
+ * into the clip.
+ *
+ * The clip's frames are mapped copy-on-write, so
+ * editing them never modifies the cache.
+ *
+ * @return Whether a valid cache file was found
+ *   for the file's current contents and the
+ *   engine's sample rate.
+ */
+bool
+pool_cache_load_clip (
+  AudioClip *  clip,
+  const char * path);
+
+/**
+ * Stores the decoded frames of the clip in the
+ * cache for the given pool file.
+ */
+void
+pool_cache_store_clip (
+  AudioClip *  clip,
+  const char * path);
+
+/**
+ * @}
+ */
+
+#endif
@@ -67,6 +67,7 @@ typedef struct AutomationTrack AutomationTrack;
 typedef struct TruePeakDsp TruePeakDsp;
 typedef struct ExtPort ExtPort;
 typedef struct AudioClip AudioClip;
+typedef struct Meter Meter;
 typedef enum PanAlgorithm PanAlgorithm;
 typedef enum PanLaw PanLaw;
 
@@ -89,6 +90,13 @@ typedef enum PanLaw PanLaw;
 
 #define TIME_TO_RESET_PEAK 4800000
 
+/**
+ * Automation curves are evaluated every this many
+ * frames when rendering control port buffers and
+ * linearly interpolated in between.
+ */
+#define PORT_AUTOMATION_RENDER_STEP 32
+
 /**
  * Special ID for owner_pl, owner_ch, etc. to indicate that
  * the port is not owned.
@@ -133,9 +141,36 @@ typedef struct Port
    * size changes.
    *
    * The buffer size is AUDIO_ENGINE->block_length.
+   *
+   * For automatable control inputs, this holds the
+   * value of the control at each frame of the
+   * current cycle, including automation and CV
+   * modulation (see port_process()).
    */
   float *             buf;
 
+  /**
+   * Whether \ref Port.buf is known to contain only
+   * silence (DENORMAL_PREVENTION_VAL) in the frames
+   * processed so far in this cycle (audio and CV
+   * ports only).
+   *
+   * This is set when the buffer is cleared and
+   * unset by anything that writes a signal to it,
+   * so consumers can skip silent inputs. False
+   * means "unknown".
+   */
+  bool                silent;
+
+  /**
+   * For automatable control inputs, whether the
+   * values in \ref Port.buf vary within the range
+   * processed last (automation ramps or CV
+   * modulation), so consumers can use a single
+   * value otherwise.
+   */
+  bool                buf_varies;
+
   /**
    * Contains raw MIDI data (MIDI ports only)
    */
@@ -406,6 +441,9 @@ typedef struct Port
    * audio buffer to be used in the UI instead of
    * directly accessing the buffer.
    *
+   * Only filled if \ref Port.write_ring_buffers
+   * is set.
+   *
    * This should contain blocks of block_length
    * samples and should maintain at least 10
    * cycles' worth of buffers.
@@ -429,6 +467,16 @@ typedef struct Port
    */
   ZixRing *           midi_ring;
 
+  /**
+   * NULL-terminated array of meters to be
+   * processed after this port, or NULL.
+   *
+   * Only replaced (never modified) from the GTK
+   * thread so that the engine can read it without
+   * locking.
+   */
+  Meter **            meters;
+
   /** Max amplitude during processing, if audio
    * (fabsf). */
   float               peak;
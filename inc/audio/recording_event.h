@@ -93,8 +93,14 @@ typedef struct RecordingEvent
 {
   RecordingEventType type;
 
-  /** The name of the track this event is for. */
-  char       track_name[200];
+  /**
+   * Position of the track this event is for.
+   *
+   * Used instead of the track name so that the
+   * track does not need to be looked up by name
+   * for each event.
+   */
+  int        track_pos;
 
   /** ZRegion name, if applicable. */
   char       region_name[200];
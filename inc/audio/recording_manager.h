@@ -26,9 +26,12 @@
 #ifndef __AUDIO_RECORDING_MANAGER_H__
 #define __AUDIO_RECORDING_MANAGER_H__
 
+#include <stdbool.h>
+
 #include "utils/types.h"
 
 typedef struct ObjectPool ObjectPool;
+typedef struct AudioClip AudioClip;
 typedef struct TrackProcessor TrackProcessor;
 typedef struct MPMCQueue MPMCQueue;
 
@@ -40,6 +43,32 @@ typedef struct MPMCQueue MPMCQueue;
 
 #define RECORDING_MANAGER (ZRYTHM->recording_manager)
 
+/**
+ * Number of recorded frames to write to the pool
+ * at a time while recording.
+ */
+#define RECORDING_MANAGER_FLUSH_CHUNK_FRAMES 32768
+
+/**
+ * Max time the flusher thread waits before
+ * checking for recorded frames to write, in
+ * microseconds.
+ */
+#define RECORDING_MANAGER_FLUSH_INTERVAL 500000
+
+/**
+ * An audio clip being recorded, whose frames are
+ * written to its file in the pool in the
+ * background.
+ */
+typedef struct RecordingFlushClip
+{
+  AudioClip * clip;
+
+  /** Path to the clip's file in the pool. */
+  char *      path;
+} RecordingFlushClip;
+
 typedef struct RecordingManager
 {
   /** Number of recordings currently in progress. */
@@ -68,6 +97,41 @@ typedef struct RecordingManager
    */
   RegionIdentifier   recorded_ids[8000];
   int                num_recorded_ids;
+
+  /**
+   * Audio clips being recorded.
+   *
+   * Their recorded frames are written to the pool
+   * in chunks of
+   * @ref RECORDING_MANAGER_FLUSH_CHUNK_FRAMES by
+   * @ref RecordingManager.flush_thread so that the
+   * take is on disk while recording.
+   */
+  RecordingFlushClip * flush_clips;
+  int                num_flush_clips;
+  size_t             flush_clips_size;
+
+  /**
+   * Protects @ref RecordingManager.flush_clips and
+   * the frames of the clips in it.
+   */
+  GMutex             flush_lock;
+
+  /** Used to wake up the flusher thread. */
+  GCond              flush_cond;
+
+  /** Signaled when a write is finished. */
+  GCond              flush_done_cond;
+
+  /** Whether the flusher thread is writing. */
+  bool               flushing;
+
+  /** Whether the flusher thread should exit. */
+  bool               stop_flushing;
+
+  /** Thread writing recorded frames to the
+   * pool. */
+  GThread *          flush_thread;
 } RecordingManager;
 
 /**
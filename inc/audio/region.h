@@ -137,6 +137,35 @@ typedef struct ZRegion
   MidiNote *      unended_notes[12000];
   int             num_unended_notes;
 
+  /**
+   * MIDI notes (or chord objects in chord
+   * regions) sorted by start position, used to
+   * only look at the notes inside the current
+   * cycle during playback.
+   *
+   * @see midi_region_update_note_index().
+   */
+  ArrangerObject ** notes_by_start;
+
+  /**
+   * MIDI notes sorted by end position.
+   *
+   * Unused in chord regions, where all chord
+   * objects have the same length.
+   */
+  ArrangerObject ** notes_by_end;
+  int             num_indexed_notes;
+  size_t          indexed_notes_size;
+
+  /**
+   * Whether the note index is up to date.
+   *
+   * Cleared when notes are added, removed or
+   * moved. While cleared, playback goes through
+   * all the notes instead.
+   */
+  volatile gint   note_index_valid;
+
   /* ==== MIDI REGION END ==== */
 
   /* ==== AUDIO REGION ==== */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Precomputed tempo map.
+ */
+
+#ifndef __AUDIO_TEMPO_MAP_H__
+#define __AUDIO_TEMPO_MAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "audio/curve.h"
+#include "utils/types.h"
+
+typedef struct Track Track;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * A range of the timeline where the BPM follows a
+ * single automation curve (or no automation).
+ *
+ * The segment ends where the next one starts.
+ */
+typedef struct TempoMapSegment
+{
+  /** Start position in ticks. */
+  double        start_ticks;
+
+  /** Frames from the start of the timeline to
+   * \ref TempoMapSegment.start_ticks. */
+  double        start_frames;
+
+  /** Whether there is automation in this
+   * segment. If false, the current BPM is used. */
+  bool          automated;
+
+  /** Normalized value of the automation point the
+   * curve starts from. */
+  float         normalized_val;
+
+  /** Normalized value of the automation point the
+   * curve ends at (same as
+   * \ref TempoMapSegment.normalized_val if there
+   * is no next point). */
+  float         next_normalized_val;
+
+  /** Whether there is a next automation point. */
+  bool          has_next;
+
+  /** Curve of the starting automation point. */
+  CurveOptions  curve_opts;
+
+  /** Position in the curve (0.0 to 1.0) at the
+   * start of the segment. */
+  double        start_ratio;
+
+  /** Increase of the position in the curve per
+   * tick. */
+  double        ratio_per_tick;
+} TempoMapSegment;
+
+/**
+ * Tempo automation flattened into sorted segments
+ * on the timeline, with the frames at the start of
+ * each segment precalculated.
+ *
+ * The map is immutable once created, so it can be
+ * read from any thread. It is replaced (not
+ * modified) when the tempo automation changes.
+ */
+typedef struct TempoMap
+{
+  /** Segments sorted by position. The first one
+   * starts at 0 and the last one is unbounded. */
+  TempoMapSegment * segments;
+  size_t            num_segments;
+
+  /** BPM outside automation when the map was
+   * created, used for frame calculations. */
+  bpm_t             default_bpm;
+
+  /** Real BPM value at normalized value 0. */
+  bpm_t             min_bpm;
+
+  /** Real BPM range (max - min). */
+  bpm_t             bpm_range;
+
+  /** Frames per tick multiplied by the BPM, which
+   * is constant for a given sample rate and time
+   * signature. */
+  double            frames_per_tick_bpm;
+} TempoMap;
+
+/**
+ * Creates a tempo map from the BPM automation of
+ * the given tempo track.
+ *
+ * Must not be called from a realtime thread.
+ */
+TempoMap *
+tempo_map_new (
+  Track * tempo_track);
+
+/**
+ * Returns the BPM at the given position.
+ *
+ * @param cur_bpm BPM to return if there is no
+ *   automation at the position.
+ */
+REALTIME
+bpm_t
+tempo_map_get_bpm_at_ticks (
+  const TempoMap * self,
+  double           ticks,
+  bpm_t            cur_bpm);
+
+/**
+ * Returns the frames from the start of the
+ * timeline to the given position, following the
+ * tempo changes.
+ */
+REALTIME
+double
+tempo_map_get_frames_at_ticks (
+  const TempoMap * self,
+  double           ticks);
+
+/**
+ * Returns the position in ticks that is the given
+ * number of frames from the start of the
+ * timeline, following the tempo changes.
+ */
+REALTIME
+double
+tempo_map_get_ticks_at_frames (
+  const TempoMap * self,
+  double           frames);
+
+void
+tempo_map_free (
+  TempoMap * self);
+
+/**
+ * @}
+ */
+
+#endif
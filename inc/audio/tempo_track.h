@@ -62,14 +62,55 @@ void
 tempo_track_clear (
   Track * self);
 
+/**
+ * Marks the tempo map as outdated.
+ *
+ * To be called when the BPM automation changes.
+ */
+void
+tempo_track_invalidate_tempo_map (
+  Track * self);
+
+/**
+ * Rebuilds the tempo map if it is outdated.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+tempo_track_update_tempo_map (
+  Track * self);
+
 /**
  * Returns the BPM at the given pos.
+ *
+ * This does not look up any ports or automation
+ * and is safe to call from realtime threads.
  */
 bpm_t
 tempo_track_get_bpm_at_pos (
   Track *    track,
   Position * pos);
 
+/**
+ * Returns the frames from the start of the
+ * timeline to the given position, following the
+ * tempo automation.
+ */
+double
+tempo_track_get_frames_at_ticks (
+  Track * self,
+  double  ticks);
+
+/**
+ * Returns the position in ticks that is the given
+ * number of frames from the start of the
+ * timeline, following the tempo automation.
+ */
+double
+tempo_track_get_ticks_at_frames (
+  Track * self,
+  double  frames);
+
 /**
  * Returns the current BPM.
  */
@@ -58,6 +58,7 @@ typedef struct MusicalScale MusicalScale;
 typedef struct Modulator Modulator;
 typedef struct Marker Marker;
 typedef struct PluginDescriptor PluginDescriptor;
+typedef struct TempoMap TempoMap;
 typedef enum PassthroughProcessorType
   PassthroughProcessorType;
 typedef enum FaderType FaderType;
@@ -69,6 +70,12 @@ typedef void MIDI_FILE;
  * @{
  */
 
+/**
+ * Maximum number of input frames to timestretch
+ * at once from a streamed clip.
+ */
+#define TRACK_MAX_STREAMED_STRETCH_FRAMES 8192
+
 #define TRACK_MIN_HEIGHT 24
 #define TRACK_DEF_HEIGHT 48
 
@@ -325,6 +332,14 @@ typedef struct Track
   /** Real-time time stretcher. */
   Stretcher *          rt_stretcher;
 
+  /**
+   * Scratch buffers for the streamed frames to be
+   * stretched, one per channel, each with
+   * @ref TRACK_MAX_STREAMED_STRETCH_FRAMES
+   * frames.
+   */
+  float *              rt_stretch_bufs[2];
+
   /* ==== AUDIO TRACK END ==== */
 
   /* ==== CHORD TRACK ==== */
@@ -365,6 +380,19 @@ typedef struct Track
   /** Automatable time sig control. */
   Port *              time_sig_port;
 
+  /**
+   * Precomputed BPM automation (runtime only).
+   *
+   * Replaced atomically when outdated.
+   *
+   * @see tempo_track_update_tempo_map().
+   */
+  TempoMap *          tempo_map;
+
+  /** Whether \ref Track.tempo_map needs to be
+   * rebuilt. */
+  volatile gint       tempo_map_outdated;
+
   /* ==== TEMPO TRACK END ==== */
 
   /* ==== MODULATOR TRACK ==== */
@@ -76,6 +76,38 @@ typedef struct TrackLane
   int                 num_regions;
   size_t              regions_size;
 
+  /**
+   * Regions sorted by start position, used to
+   * only look at the regions inside the current
+   * cycle during playback.
+   *
+   * @see track_lane_update_region_index().
+   */
+  ZRegion **          regions_by_start;
+
+  /**
+   * Index of the region that ends last in
+   * @ref TrackLane.regions_by_start up to and
+   * including each index.
+   *
+   * Indices are stored instead of positions so
+   * that the index stays valid when the frames
+   * of all positions are recalculated (eg, on
+   * tempo change).
+   */
+  int *               max_end_indices;
+  int                 num_indexed_regions;
+  size_t              indexed_regions_size;
+
+  /**
+   * Whether the region index is up to date.
+   *
+   * Cleared when regions are added, removed or
+   * moved. While cleared, playback goes through
+   * all the regions instead.
+   */
+  volatile gint       region_index_valid;
+
   /** Position of owner Track in the Tracklist. */
   int                 track_pos;
 
@@ -167,6 +199,51 @@ track_lane_remove_region (
   TrackLane * self,
   ZRegion *   region);
 
+/**
+ * Rebuilds the time-sorted region index.
+ *
+ * Must not be called while the engine is
+ * processing the lane.
+ *
+ * @see TrackLane.regions_by_start.
+ */
+void
+track_lane_update_region_index (
+  TrackLane * self);
+
+/**
+ * Marks the region index as outdated.
+ *
+ * To be called when regions are added, removed
+ * or moved.
+ */
+void
+track_lane_invalidate_region_index (
+  TrackLane * self);
+
+/**
+ * Gets the range of regions in
+ * @ref TrackLane.regions_by_start that may be hit
+ * by the given global frame range (inclusive).
+ *
+ * The regions in the range still need to be
+ * checked with region_is_hit_by_range().
+ *
+ * @param[out] first First index.
+ * @param[out] last Index after the last region.
+ *
+ * @return False if the index is outdated, in which
+ *   case all regions must be checked.
+ */
+REALTIME
+bool
+track_lane_get_indexed_regions_in_range (
+  TrackLane * self,
+  long        g_start_frames,
+  long        g_end_frames,
+  int *       first,
+  int *       last);
+
 /**
  * Unselects all arranger objects.
  */
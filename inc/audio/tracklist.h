@@ -114,6 +114,14 @@ typedef struct Tracklist
   /** When this is true, some tracks may temporarily
    * be moved beyond num_tracks. */
   bool                swapping_tracks;
+
+  /**
+   * Cached result of tracklist_has_soloed(), used
+   * by the engine.
+   *
+   * @see tracklist_update_solo_state().
+   */
+  bool                has_soloed_tracks;
 } Tracklist;
 
 static const cyaml_schema_field_t
@@ -141,6 +149,18 @@ void
 tracklist_init_loaded (
   Tracklist * self);
 
+/**
+ * Rebuilds the outdated region indices of all
+ * lanes, note indices of all MIDI and chord
+ * regions and the tempo map.
+ *
+ * Must not be called while the engine is
+ * processing.
+ */
+void
+tracklist_update_playback_indices (
+  Tracklist * self);
+
 /**
  * Finds visible tracks and puts them in given array.
  */
@@ -384,6 +404,17 @@ int
 tracklist_has_soloed (
   const Tracklist * self);
 
+/**
+ * Updates the cached solo state of the tracklist
+ * and of each channel fader.
+ *
+ * To be called when a track is soloed/unsoloed or
+ * when the routing changes.
+ */
+void
+tracklist_update_solo_state (
+  Tracklist * self);
+
 /**
  * @param visible 1 for visible, 0 for invisible.
  */
@@ -150,6 +150,16 @@ typedef enum ArrangerObjectCloneFlag
   /** Create a link copy that references the
    * parent (only used for regions). */
   ARRANGER_OBJECT_CLONE_COPY_LINK,
+
+  /**
+   * Create a copy without the children of the
+   * object (eg, the MidiNote's of a MIDI region).
+   *
+   * Used by undoable actions that only need to
+   * find the object in the project and change the
+   * object itself, like moving or resizing.
+   */
+  ARRANGER_OBJECT_CLONE_COPY_SHALLOW,
 } ArrangerObjectCloneFlag;
 
 /**
@@ -882,6 +892,17 @@ ArrangerObject *
 arranger_object_find (
   ArrangerObject * obj);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the object and its children, in bytes.
+ *
+ * Used for keeping track of the memory used by
+ * the undo history.
+ */
+size_t
+arranger_object_get_mem_usage (
+  ArrangerObject * self);
+
 /**
  * Clone the ArrangerObject.
  *
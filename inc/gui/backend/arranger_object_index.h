@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Time index of arranger objects for hit
+ * testing.
+ */
+
+#ifndef __GUI_BACKEND_ARRANGER_OBJECT_INDEX_H__
+#define __GUI_BACKEND_ARRANGER_OBJECT_INDEX_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct ArrangerObject ArrangerObject;
+
+/**
+ * @addtogroup gui_backend
+ *
+ * @{
+ */
+
+/**
+ * An object in the index along with its extent.
+ */
+typedef struct ArrangerObjectIndexEntry
+{
+  ArrangerObject * obj;
+
+  /** Start of the object in ticks. */
+  double           start_ticks;
+
+  /** End of the object in ticks. */
+  double           end_ticks;
+
+  /** Order the object was added in. */
+  int              order;
+} ArrangerObjectIndexEntry;
+
+/**
+ * Index of arranger objects sorted by their start
+ * position, used to find the objects in a range
+ * of ticks without going through all of them.
+ *
+ * Positions in ticks do not change with the zoom
+ * level or the tempo, so the index only needs to
+ * be rebuilt when objects are added, moved or
+ * removed.
+ *
+ * @see arranger_object_index_invalidate_all().
+ */
+typedef struct ArrangerObjectIndex
+{
+  /** Entries sorted by start position. */
+  ArrangerObjectIndexEntry * entries;
+  int                        num_entries;
+  size_t                     entries_size;
+
+  /**
+   * Largest end position of the entries up to
+   * and including each index.
+   *
+   * Used to stop looking back for objects that
+   * overlap a range.
+   */
+  double *                   max_end_ticks;
+
+  /** Buffer for query results. */
+  ArrangerObjectIndexEntry ** results;
+
+  /** Objects returned by the last query. */
+  ArrangerObject **          result_objs;
+
+  /**
+   * Owner of the indexed objects (eg, the region
+   * for editor objects), or NULL.
+   */
+  void *                     owner;
+
+  /**
+   * Value of the global change counter when the
+   * index was built, or -1 if the index was never
+   * built.
+   */
+  int                        generation;
+} ArrangerObjectIndex;
+
+/**
+ * Creates a new empty index.
+ */
+ArrangerObjectIndex *
+arranger_object_index_new (void);
+
+/**
+ * Marks all indices as outdated.
+ *
+ * To be called when arranger objects are added,
+ * moved or removed, or when tracks are added,
+ * moved or removed.
+ */
+void
+arranger_object_index_invalidate_all (void);
+
+/**
+ * Returns whether the index is up to date and
+ * was built for the given owner.
+ */
+bool
+arranger_object_index_is_valid (
+  ArrangerObjectIndex * self,
+  void *                owner);
+
+/**
+ * Removes all the objects from the index to start
+ * building it again.
+ */
+void
+arranger_object_index_clear (
+  ArrangerObjectIndex * self,
+  void *                owner);
+
+/**
+ * Adds an object to the index.
+ *
+ * Objects are returned by queries in the order
+ * they were added.
+ */
+void
+arranger_object_index_add (
+  ArrangerObjectIndex * self,
+  ArrangerObject *      obj,
+  double                start_ticks,
+  double                end_ticks);
+
+/**
+ * Sorts the added objects and marks the index as
+ * up to date.
+ */
+void
+arranger_object_index_finish (
+  ArrangerObjectIndex * self);
+
+/**
+ * Returns the objects that overlap the given
+ * range, in the order they were added.
+ *
+ * The returned array is owned by the index and
+ * is valid until the next call.
+ *
+ * @param[out] num_objs Number of objects returned.
+ */
+ArrangerObject **
+arranger_object_index_query (
+  ArrangerObjectIndex * self,
+  double                start_ticks,
+  double                end_ticks,
+  int *                 num_objs);
+
+void
+arranger_object_index_free (
+  ArrangerObjectIndex * self);
+
+/**
+ * @}
+ */
+
+#endif
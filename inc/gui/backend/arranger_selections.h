@@ -172,6 +172,16 @@ ArrangerSelections *
 arranger_selections_clone (
   ArrangerSelections * self);
 
+/**
+ * Clones the struct without the children of the
+ * objects.
+ *
+ * @see ARRANGER_OBJECT_CLONE_COPY_SHALLOW.
+ */
+ArrangerSelections *
+arranger_selections_clone_shallow (
+  ArrangerSelections * self);
+
 /**
  * Returns if there are any selections.
  */
@@ -239,6 +249,14 @@ arranger_selections_paste_to_pos (
   Position *           pos,
   bool                 undoable);
 
+/**
+ * Returns the approximate amount of memory used
+ * by the selections and their objects, in bytes.
+ */
+size_t
+arranger_selections_get_mem_usage (
+  ArrangerSelections * self);
+
 /**
  * Returns all objects in the selections in a
  * newly allocated array that should be free'd.
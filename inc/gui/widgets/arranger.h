@@ -52,6 +52,8 @@ typedef struct _GtkEventControllerMotion
   GtkEventControllerMotion;
 typedef struct ArrangerObject ArrangerObject;
 typedef struct ArrangerSelections ArrangerSelections;
+typedef struct ArrangerObjectIndex
+  ArrangerObjectIndex;
 typedef struct EditorSettings EditorSettings;
 typedef enum ArrangerObjectType ArrangerObjectType;
 
@@ -356,6 +358,14 @@ typedef struct _ArrangerWidget
    */
   PangoLayout *  ap_layout;
 
+  /**
+   * Index of the objects in the arranger, used
+   * for hit testing.
+   *
+   * Rebuilt on demand after objects change.
+   */
+  ArrangerObjectIndex * object_index;
+
 } ArrangerWidget;
 
 /**
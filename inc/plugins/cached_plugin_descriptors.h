@@ -51,6 +51,18 @@ typedef struct CachedPluginDescriptors
    * when scanning */
   PluginDescriptor *  blacklisted[90000];
   int                 num_blacklisted;
+
+  /**
+   * Valid descriptors by path, or by URI for LV2
+   * plugins.
+   *
+   * Each value is a GPtrArray of the descriptors
+   * found in the file/bundle.
+   */
+  GHashTable *        index;
+
+  /** Blacklisted descriptors by path. */
+  GHashTable *        blacklisted_index;
 } CachedPluginDescriptors;
 
 static const cyaml_schema_field_t
@@ -113,10 +125,25 @@ cached_plugin_descriptors_find (
   bool                      check_valid,
   bool                      check_blacklisted);
 
+/**
+ * Returns the cached descriptor of the LV2 plugin
+ * with the given URI, if its bundle was not
+ * modified since it was cached.
+ *
+ * @param mtime The current modification time of
+ *   the plugin's bundle.
+ */
+const PluginDescriptor *
+cached_plugin_descriptors_get_lv2 (
+  CachedPluginDescriptors * self,
+  const char *              uri,
+  int64_t                   mtime);
+
 /**
  * Returns the PluginDescriptor's corresponding to
  * the .so/.dll file at the given path, if it
- * exists and the MD5 hash matches.
+ * exists and was not modified since it was
+ * cached.
  *
  * @note The returned array must be free'd but not
  *   the descriptors.
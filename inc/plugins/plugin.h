@@ -176,6 +176,15 @@ typedef struct Plugin
    */
   char *            state_dir;
 
+  /**
+   * Size of the last saved state in bytes.
+   *
+   * Cached when the state is saved so that
+   * memory usage accounting doesn't need to
+   * touch the filesystem.
+   */
+  size_t            state_size;
+
   /** Whether the plugin is currently being
    * deleted. */
   bool              deleting;
@@ -787,6 +796,29 @@ int
 plugin_cleanup (
   Plugin * self);
 
+/**
+ * Updates \ref Plugin.state_size from the files
+ * in the given state directory.
+ *
+ * To be called after saving the state.
+ */
+void
+plugin_update_state_size (
+  Plugin *     self,
+  const char * abs_state_dir);
+
+/**
+ * Returns the approximate amount of memory used
+ * by the plugin, its ports and its saved state,
+ * in bytes.
+ *
+ * Used for keeping track of the memory used by
+ * the undo history.
+ */
+size_t
+plugin_get_mem_usage (
+  Plugin * self);
+
 /**
  * Frees given plugin, breaks all its port connections, and frees its ports
  * and other internal pointers
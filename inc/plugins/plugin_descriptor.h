@@ -254,6 +254,12 @@ typedef struct PluginDescriptor
    * used when caching PluginDescriptor's, obtained
    * using g_file_hash(). */
   unsigned int     ghash;
+
+  /** Last modification time of the plugin's
+   * bundle (or file for non-LV2 plugins) at the
+   * time it was scanned, used to detect changed
+   * plugins when caching PluginDescriptor's. */
+  int64_t          mtime;
 } PluginDescriptor;
 
 static const cyaml_schema_field_t
@@ -321,6 +327,9 @@ plugin_descriptor_fields_schema[] =
   CYAML_FIELD_UINT (
     "ghash", CYAML_FLAG_DEFAULT,
     PluginDescriptor, ghash),
+  CYAML_FIELD_INT (
+    "mtime", CYAML_FLAG_OPTIONAL,
+    PluginDescriptor, mtime),
 
   CYAML_FIELD_END
 };
@@ -75,6 +75,7 @@ typedef struct TracklistSelections
 #define PROJECT_EXPORTS_DIR     "exports"
 #define PROJECT_STEMS_DIR       "stems"
 #define PROJECT_POOL_DIR        "pool"
+#define PROJECT_POOL_CACHE_DIR  "pool_cache"
 
 typedef enum ProjectPath
 {
@@ -101,6 +102,9 @@ typedef enum ProjectPath
   PROJECT_PATH_EXPORTS_STEMS,
 
   PROJECT_PATH_POOL,
+
+  /** Decoded pool files, see pool_cache.h. */
+  PROJECT_PATH_POOL_CACHE,
 } ProjectPath;
 
 /**
@@ -151,6 +155,27 @@ typedef enum ProjectCompressionFlag
 #define PROJECT_DECOMPRESS_DATA \
   PROJECT_COMPRESS_DATA
 
+/**
+ * Format to save project files in.
+ *
+ * Project files in either format can always be
+ * loaded.
+ */
+typedef enum ProjectFileFormat
+{
+  /** Binary format, see utils/binary.h. */
+  PROJECT_FILE_FORMAT_BINARY,
+
+  /** zstd-compressed YAML. */
+  PROJECT_FILE_FORMAT_YAML,
+} ProjectFileFormat;
+
+static const char * project_file_format_str[] =
+{
+  __("Binary"),
+  __("YAML"),
+};
+
 /**
  * Contains all of the info that will be serialized
  * into a project file.
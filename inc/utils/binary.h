@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Binary serialization driven by the cyaml
+ * schemas.
+ */
+
+#ifndef __UTILS_BINARY_H__
+#define __UTILS_BINARY_H__
+
+#include <stdbool.h>
+
+#include "utils/yaml.h"
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/** Magic bytes at the start of binary files. */
+#define BINARY_MAGIC "ZBIN"
+
+/**
+ * Binary format version.
+ *
+ * Only needs to be bumped when the encoding
+ * itself changes. Changes in the schemas are
+ * handled by the field keys stored in the file.
+ */
+#define BINARY_FORMAT_VERSION 1
+
+/**
+ * Size of the chunks that are compressed and
+ * written to/read from disk at a time.
+ */
+#define BINARY_CHUNK_SIZE (128 * 1024)
+
+/**
+ * Value tags.
+ *
+ * Each value in a binary file is prefixed with its
+ * tag, so that values of unknown fields can be
+ * skipped when loading.
+ */
+typedef enum BinaryTag
+{
+  BINARY_TAG_NULL,
+  BINARY_TAG_INT,
+  BINARY_TAG_UINT,
+  BINARY_TAG_BOOL,
+  BINARY_TAG_FLOAT,
+  BINARY_TAG_DOUBLE,
+  BINARY_TAG_STRING,
+  BINARY_TAG_ENUM,
+  BINARY_TAG_MAPPING,
+  BINARY_TAG_SEQUENCE,
+} BinaryTag;
+
+/**
+ * Serializes the given data using its cyaml
+ * schema and writes it to a zstd-compressed file
+ * in chunks of @ref BINARY_CHUNK_SIZE.
+ *
+ * Mappings are written with their field keys, so
+ * files stay loadable when fields are added or
+ * removed. Keys and enum strings are only written
+ * in full the first time they appear and are
+ * referenced by index afterwards.
+ *
+ * @param data Pointer to the data, as would be
+ *   passed to cyaml_save_data().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+binary_save_to_file (
+  const char *                 filepath,
+  const cyaml_schema_value_t * schema,
+  const void *                 data);
+
+/**
+ * Loads data saved with binary_save_to_file().
+ *
+ * Fields that are not in the schema are skipped
+ * and fields that are not in the file are left
+ * zeroed. Memory is allocated the same way as
+ * cyaml_load_data() so the result can be freed
+ * with cyaml_free().
+ *
+ * @param[out] data Pointer to store the loaded
+ *   data in.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+binary_load_from_file (
+  const char *                 filepath,
+  const cyaml_schema_value_t * schema,
+  void **                      data);
+
+/**
+ * Returns whether the given file was saved with
+ * binary_save_to_file().
+ */
+bool
+binary_file_is_binary (
+  const char * filepath);
+
+/**
+ * @}
+ */
+
+#endif
@@ -32,6 +32,17 @@ dsp_fill (
   float   val,
   size_t  size);
 
+/**
+ * Fill the buffer with a linear ramp from @p start
+ * (inclusive) to @p end (exclusive).
+ */
+void
+dsp_fill_ramp (
+  float * buf,
+  float   start,
+  float   end,
+  size_t  size);
+
 /**
  * Clamp the buffer to min/max.
  */
@@ -117,6 +128,47 @@ dsp_mix_add2 (
   float         k2,
   size_t        size);
 
+/**
+ * Calculate
+ * dest[i] = dest[i] + src[i] * k1[i] * k2.
+ */
+void
+dsp_mix_add_mul (
+  float *       dest,
+  const float * src,
+  const float * k1,
+  float         k2,
+  size_t        size);
+
+/**
+ * Calculate
+ * dest[i] = dest[i] + src[i] * k[i], where k
+ * ramps linearly from @p k_start (inclusive) to
+ * @p k_end (exclusive).
+ */
+void
+dsp_mix_add_ramp (
+  float *       dest,
+  const float * src,
+  float         k_start,
+  float         k_end,
+  size_t        size);
+
+/**
+ * Calculate
+ * dest[i] = dest[i] + src[i] * k1[i] * k2[i],
+ * where k2 ramps linearly from @p k2_start
+ * (inclusive) to @p k2_end (exclusive).
+ */
+void
+dsp_mix_add_mul_ramp (
+  float *       dest,
+  const float * src,
+  const float * k1,
+  float         k2_start,
+  float         k2_end,
+  size_t        size);
+
 /**
  * Makes the two signals mono.
  *
@@ -27,6 +27,7 @@
 #include "zrythm-config.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /**
@@ -90,6 +91,15 @@ char *
 io_file_get_last_modified_datetime (
   const char * filename);
 
+/**
+ * Returns the last modification time of the given
+ * file or directory in seconds since the epoch,
+ * or -1 if it could not be obtained.
+ */
+int64_t
+io_file_get_last_modified_time (
+  const char * filename);
+
 /**
  * Removes the given file.
  */
@@ -27,6 +27,7 @@
 typedef struct _LogViewerWidget LogViewerWidget;
 typedef struct MPMCQueue MPMCQueue;
 typedef struct ObjectPool ObjectPool;
+typedef struct RtTrace RtTrace;
 
 /**
  * @addtogroup utils
@@ -57,6 +58,10 @@ typedef struct Log
   /** Object pool for the queue. */
   ObjectPool *    obj_pool;
 
+  /** Rings for messages logged from realtime
+   * threads. */
+  RtTrace *       rt_trace;
+
   bool            initialized;
 
   /**
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Realtime-safe logging.
+ *
+ * Messages logged from realtime threads are
+ * stored as their format and raw arguments in
+ * fixed-size records in a lock-free ring owned by
+ * the calling thread. The rings are drained from a
+ * non-realtime thread, where the messages are
+ * formatted and passed to the log writer.
+ */
+
+#ifndef __UTILS_RT_TRACE_H__
+#define __UTILS_RT_TRACE_H__
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <glib.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/** Maximum number of threads that can trace at
+ * the same time. */
+#define RT_TRACE_MAX_THREADS 32
+
+/**
+ * Number of records in each ring.
+ *
+ * Must be a power of 2.
+ */
+#define RT_TRACE_RING_SIZE 256
+
+/** Maximum formatted message length, including
+ * the terminating null byte. */
+#define RT_TRACE_MSG_SIZE 240
+
+/** Maximum number of arguments in a record,
+ * including `*` width and precision
+ * arguments. */
+#define RT_TRACE_MAX_ARGS 8
+
+/** Size of the buffer for copies of string
+ * arguments in a record. */
+#define RT_TRACE_STR_SIZE 128
+
+/**
+ * Logs a debug message from a realtime thread.
+ */
+#define rt_debug(...) \
+  rt_trace_log (G_LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+/**
+ * Logs a message from a realtime thread.
+ */
+#define rt_message(...) \
+  rt_trace_log (G_LOG_LEVEL_MESSAGE, __VA_ARGS__)
+
+/**
+ * Logs a warning from a realtime thread.
+ */
+#define rt_warning(...) \
+  rt_trace_log (G_LOG_LEVEL_WARNING, __VA_ARGS__)
+
+/**
+ * A raw format argument.
+ *
+ * The member used depends on the conversion
+ * specification it belongs to.
+ */
+typedef union RtTraceArg
+{
+  int            i;
+  long           l;
+  long long      ll;
+  size_t         z;
+  intmax_t       j;
+  ptrdiff_t      t;
+  double         d;
+  long double    ld;
+  const void *   p;
+
+  /** Offset of the copy of a string argument in
+   * @ref RtTraceRecord.strs, or -1 if NULL. */
+  int            str_offset;
+} RtTraceArg;
+
+/**
+ * A single log record.
+ */
+typedef struct RtTraceRecord
+{
+  /** Monotonic time the record was created. */
+  gint64         time;
+
+  GLogLevelFlags log_level;
+
+  /** The printf-style format, which must be a
+   * string literal. */
+  const char *   format;
+
+  /** Arguments, in the order they appear in the
+   * format. */
+  RtTraceArg     args[RT_TRACE_MAX_ARGS];
+  int            num_args;
+
+  /** Whether some arguments could not be
+   * stored. */
+  bool           truncated;
+
+  /** Copies of the string arguments, since the
+   * original strings may be gone when the record
+   * is formatted. */
+  char           strs[RT_TRACE_STR_SIZE];
+} RtTraceRecord;
+
+/**
+ * Single-producer single-consumer ring of
+ * records owned by one thread at a time.
+ */
+typedef struct RtTraceRing
+{
+  RtTraceRecord  records[RT_TRACE_RING_SIZE];
+
+  /** Number of records written, only modified by
+   * the owner thread. */
+  volatile gint  write_idx;
+
+  /** Number of records drained, only modified by
+   * the draining thread. */
+  volatile gint  read_idx;
+
+  /** Number of records dropped because the ring
+   * was full. */
+  volatile gint  num_dropped;
+
+  /** Whether a thread owns the ring. Released
+   * when the thread exits. */
+  volatile gint  claimed;
+} RtTraceRing;
+
+/**
+ * Trace rings for all threads.
+ */
+typedef struct RtTrace
+{
+  /** Rings, allocated in advance so that
+   * claiming a ring never allocates. */
+  RtTraceRing *  rings;
+
+  /** Number of records dropped because all rings
+   * were claimed. */
+  volatile gint  num_dropped;
+
+  /**
+   * Unique number of this instance.
+   *
+   * Used by threads to know if the ring they
+   * claimed belongs to this instance.
+   */
+  gint           generation;
+
+  /** Lock for draining (non-realtime side only). */
+  GMutex         drain_lock;
+} RtTrace;
+
+/**
+ * Creates the trace rings.
+ */
+RtTrace *
+rt_trace_new (void);
+
+/**
+ * Stores a message into the ring of the calling
+ * thread.
+ *
+ * This never allocates or blocks. If the ring is
+ * full, the message is dropped and counted.
+ *
+ * @param format A printf-style format string
+ *   literal.
+ */
+void
+rt_trace_log (
+  GLogLevelFlags log_level,
+  const char *   format,
+  ...) G_GNUC_PRINTF (2, 3);
+
+/**
+ * Stores the format and the raw arguments in the
+ * record without formatting them.
+ *
+ * This never allocates or blocks. The `%n`
+ * conversion is not supported.
+ */
+void
+rt_trace_record_set_args (
+  RtTraceRecord * self,
+  const char *    format,
+  va_list         args);
+
+/**
+ * Formats the message of the record into @p buf.
+ */
+void
+rt_trace_record_format (
+  const RtTraceRecord * self,
+  char *                buf,
+  size_t                size);
+
+/**
+ * Writes all pending records to the log.
+ *
+ * Must not be called from a realtime thread.
+ *
+ * @return The number of records written.
+ */
+int
+rt_trace_drain (
+  RtTrace * self);
+
+/**
+ * Drains and frees the trace rings.
+ */
+void
+rt_trace_free (
+  RtTrace * self);
+
+/**
+ * @}
+ */
+
+#endif
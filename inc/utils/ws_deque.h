@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Single-owner work-stealing deque.
+ */
+
+#ifndef __UTILS_WS_DEQUE_H__
+#define __UTILS_WS_DEQUE_H__
+
+#include <stddef.h>
+
+#include <glib.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/**
+ * Lock-free work-stealing deque (Chase-Lev).
+ *
+ * The owner thread pushes and pops at the bottom
+ * end while any other thread may steal from the
+ * top end.
+ *
+ * The buffer is not grown during operation, so it
+ * must be reserved with ws_deque_reserve() to the
+ * maximum number of elements that can be queued at
+ * the same time, while no other thread is using
+ * the deque.
+ *
+ * Indices are unsigned and allowed to wrap around;
+ * all comparisons are done on their signed
+ * difference.
+ */
+typedef struct WsDeque
+{
+  void **        buffer;
+  size_t         buffer_mask;
+
+  /** Index to steal from (modified by thieves and
+   * by the owner when popping the last
+   * element). */
+  volatile guint top;
+
+  /** Index to push to (only modified by the
+   * owner). */
+  volatile guint bottom;
+
+} WsDeque;
+
+WsDeque *
+ws_deque_new (void);
+
+/**
+ * Makes sure the deque can hold at least
+ * \ref buffer_size elements.
+ *
+ * @note Not thread-safe, must only be called
+ *   while no thread is using the deque.
+ */
+void
+ws_deque_reserve (
+  WsDeque * self,
+  size_t    buffer_size);
+
+void
+ws_deque_clear (
+  WsDeque * self);
+
+/**
+ * Returns the approximate number of elements in
+ * the deque.
+ */
+int
+ws_deque_size (
+  WsDeque * self);
+
+/**
+ * Pushes an element at the bottom.
+ *
+ * Must only be called by the owner thread.
+ *
+ * @return 1 if pushed, 0 if the deque is full.
+ */
+int
+ws_deque_push_bottom (
+  WsDeque *    self,
+  void * const data);
+
+/**
+ * Pops the most recently pushed element.
+ *
+ * Must only be called by the owner thread.
+ *
+ * @return 1 if an element was popped, 0 if empty.
+ */
+int
+ws_deque_pop_bottom (
+  WsDeque * self,
+  void **   data);
+
+/**
+ * Steals the oldest element.
+ *
+ * Can be called from any thread.
+ *
+ * @return 1 if an element was stolen, 0 if the
+ *   deque was empty or another thread won the
+ *   race for the element.
+ */
+int
+ws_deque_steal (
+  WsDeque * self,
+  void **   data);
+
+void
+ws_deque_free (
+  WsDeque * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -45,6 +45,17 @@
     #member, CYAML_FLAG_DEFAULT, owner, member, \
     schema)
 
+/**
+ * Optional mapping embedded inside the struct.
+ *
+ * The member is left zeroed if missing.
+ */
+#define YAML_FIELD_MAPPING_EMBEDDED_OPTIONAL( \
+  owner,member,schema) \
+  CYAML_FIELD_MAPPING ( \
+    #member, CYAML_FLAG_OPTIONAL, owner, \
+    member, schema)
+
 /**
  * Mapping pointer to a struct.
  */
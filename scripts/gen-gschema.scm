@@ -312,6 +312,9 @@ Args:
          (print-enum
            "pan-algorithm"
            '("linear" "sqrt" "sine"))
+         (print-enum
+           "project-file-format"
+           '("binary" "yaml"))
          (print-enum
            "curve-algorithm"
            '("exponent" "superellipse" "vital"))
@@ -715,6 +718,16 @@ Args:
                      "midi-controllers" "as"
                      "[]" "MIDI controllers"
                      "A list of controllers to enable.")
+                   (make-schema-key-with-range
+                     "clip-streaming-threshold" "i" "-1"
+                     "65536" "256"
+                     "Clip streaming threshold"
+                     "Audio clips larger than this size (in MiB) are streamed from disk instead of being fully loaded in memory. Set to -1 to disable streaming.")
+                   (make-schema-key-with-range
+                     "clip-streaming-cache-size" "i" "16"
+                     "65536" "512"
+                     "Clip streaming cache size"
+                     "Maximum memory (in MiB) to use for caching streamed audio clips.")
                  )) ;; general/engine
                (make-schema
                  "paths"
@@ -829,6 +842,11 @@ Args:
                      "380000" "128"
                      "Undo stack length"
                      "Maximum undo history stack length. Set to -1 for unlimited.")
+                   (make-schema-key-with-range
+                     "undo-stack-memory-limit" "i" "-1"
+                     "65536" "1024"
+                     "Undo history memory limit"
+                     "Maximum memory (in MiB) to use for the undo history. The oldest actions are discarded when this is exceeded. Set to -1 for unlimited.")
                  )) ;; editing/undo
              ))) ;; editing
 
@@ -847,6 +865,12 @@ Args:
                      "0" "120" "1"
                      "Autosave interval"
                      "Interval to auto-save projects, in minutes. Auto-saving will be disabled if this is set to 0.")
+                   (make-schema-key-with-enum
+                     "file-format"
+                     "project-file-format"
+                     "binary"
+                     "Project file format"
+                     "Format to save project files in. Binary files are faster to save and load, YAML files are human-readable. Projects in either format can be opened.")
                  )) ;; projects/general
              ))) ;; projects
 
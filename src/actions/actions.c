@@ -865,6 +865,7 @@ activate_export_graph (
       GTK_WINDOW (MAIN_WINDOW), flags,
       _("Image (PNG)"), 1,
       _("Dot graph"), 2,
+      _("DSP load report"), 3,
       NULL);
   content_area =
     gtk_dialog_get_content_area (
@@ -908,6 +909,10 @@ activate_export_graph (
         filename = "graph.dot";
         export_type = GRAPH_EXPORT_DOT;
         break;
+      /* DSP load of the running graph */
+      case 3:
+        filename = "dsp_load.txt";
+        break;
       default:
         gtk_widget_destroy (dialog);
         return;
@@ -917,8 +922,15 @@ activate_export_graph (
   char * path =
     g_build_filename (
       exports_dir, filename, NULL);
-  graph_export_as (
-    graph, export_type, path);
+  if (result == 3)
+    {
+      graph_export_dsp_load (ROUTER->graph, path);
+    }
+  else
+    {
+      graph_export_as (
+        graph, export_type, path);
+    }
   g_free (exports_dir);
   g_free (path);
 
@@ -125,7 +125,11 @@ set_selections (
   ArrangerSelections * sel = _sel;
   if (clone)
     {
-      sel = arranger_selections_clone (_sel);
+      if (self->shallow)
+        sel =
+          arranger_selections_clone_shallow (_sel);
+      else
+        sel = arranger_selections_clone (_sel);
     }
 
   if (ZRYTHM_TESTING)
@@ -259,13 +263,19 @@ set_single_object (
 }
 #endif
 
+/**
+ * @param shallow Whether to store shallow clones
+ *   of the selections.
+ */
 static ArrangerSelectionsAction *
 _create_action (
-  ArrangerSelections * sel)
+  ArrangerSelections * sel,
+  bool                 shallow)
 {
   ArrangerSelectionsAction * self =
     object_new (ArrangerSelectionsAction);
 
+  self->shallow = shallow;
   set_selections (self, sel, true, false);
   self->first_run = true;
 
@@ -333,7 +343,7 @@ arranger_selections_action_new_move_or_duplicate (
     arranger_selections_has_any (sel), NULL);
 
   ArrangerSelectionsAction * self =
-    _create_action (sel);
+    _create_action (sel, move);
   UndoableAction * ua = (UndoableAction *) self;
   if (move)
     {
@@ -380,7 +390,7 @@ arranger_selections_action_new_link (
     sel_before && sel_after, NULL);
 
   ArrangerSelectionsAction * self =
-    _create_action (sel_before);
+    _create_action (sel_before, false);
   self->type = AS_ACTION_LINK;
 
   set_selections (
@@ -421,7 +431,7 @@ arranger_selections_action_new_create_or_delete (
     }
 
   ArrangerSelectionsAction * self =
-    _create_action (sel);
+    _create_action (sel, false);
   if (create)
     {
       self->type = AS_ACTION_CREATE;
@@ -442,7 +452,7 @@ arranger_selections_action_new_record (
   const bool           already_recorded)
 {
   ArrangerSelectionsAction * self =
-    _create_action (sel_before);
+    _create_action (sel_before, false);
   self->type = AS_ACTION_RECORD;
 
   set_selections (self, sel_after, 1, 1);
@@ -471,15 +481,17 @@ arranger_selections_action_new_edit (
   ArrangerSelectionsActionEditType type,
   bool                             already_edited)
 {
+  /* editor functions may change anything */
+  bool shallow =
+    type !=
+      ARRANGER_SELECTIONS_ACTION_EDIT_EDITOR_FUNCTION;
+
   ArrangerSelectionsAction * self =
-    _create_action (sel_before);
+    _create_action (sel_before, shallow);
   self->type = AS_ACTION_EDIT;
 
   self->edit_type = type;
 
-  set_selections (
-    self, sel_before, F_CLONE, F_NOT_IS_AFTER);
-
   if (sel_after)
     {
       set_selections (
@@ -662,7 +674,7 @@ arranger_selections_action_new_split (
   const Position *     pos)
 {
   ArrangerSelectionsAction * self =
-    _create_action (sel);
+    _create_action (sel, false);
   self->type = AS_ACTION_SPLIT;
 
   ArrangerObject ** objs =
@@ -685,7 +697,7 @@ arranger_selections_action_new_merge (
   ArrangerSelections * sel)
 {
   ArrangerSelectionsAction * self =
-    _create_action (sel);
+    _create_action (sel, false);
   self->type = AS_ACTION_MERGE;
 
   UndoableAction * ua = (UndoableAction *) self;
@@ -706,7 +718,7 @@ arranger_selections_action_new_resize (
   const double                       ticks)
 {
   ArrangerSelectionsAction * self =
-    _create_action (sel);
+    _create_action (sel, true);
   self->type = AS_ACTION_RESIZE;
 
   self->resize_type = type;
@@ -728,7 +740,7 @@ arranger_selections_action_new_quantize (
   QuantizeOptions *    opts)
 {
   ArrangerSelectionsAction * self =
-    _create_action (sel);
+    _create_action (sel, true);
   self->type = AS_ACTION_QUANTIZE;
 
   set_selections (self, sel, 1, 1);
@@ -1787,6 +1799,7 @@ do_or_undo_edit (
           AudioClip * src_clip =
             audio_pool_get_clip (
               AUDIO_POOL, src_audio_sel->pool_id);
+          audio_clip_ensure_loaded (src_clip);
 
           /* adjust the positions */
           Position start, end;
@@ -1805,10 +1818,16 @@ do_or_undo_edit (
               src_clip->num_frames, -1);
 
           /* replace the frames in the region */
+          float * frames =
+            malloc (
+              MAX (num_frames, 1) *
+              src_clip->channels * sizeof (float));
+          audio_clip_get_interleaved_frames (
+            src_clip, 0, num_frames, frames);
           audio_region_replace_frames (
-            r, src_clip->frames,
-            (size_t) start.frames,
+            r, frames, (size_t) start.frames,
             num_frames, F_NO_DUPLICATE_CLIP);
+          free (frames);
         }
       else /* not audio function */
         {
@@ -2531,12 +2550,70 @@ arranger_selections_action_stringize (
   g_return_val_if_reached (g_strdup (""));
 }
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+arranger_selections_action_get_mem_usage (
+  ArrangerSelectionsAction * self)
+{
+  size_t mem_usage =
+    sizeof (ArrangerSelectionsAction);
+  if (self->sel)
+    {
+      mem_usage +=
+        arranger_selections_get_mem_usage (
+          self->sel);
+    }
+  if (self->sel_after)
+    {
+      mem_usage +=
+        arranger_selections_get_mem_usage (
+          self->sel_after);
+    }
+  for (int i = 0; i < self->num_split_objs; i++)
+    {
+      if (self->r1[i])
+        {
+          mem_usage +=
+            arranger_object_get_mem_usage (
+              self->r1[i]);
+        }
+      if (self->r2[i])
+        {
+          mem_usage +=
+            arranger_object_get_mem_usage (
+              self->r2[i]);
+        }
+    }
+  if (self->region_before)
+    {
+      mem_usage +=
+        arranger_object_get_mem_usage (
+          (ArrangerObject *) self->region_before);
+    }
+  if (self->region_after)
+    {
+      mem_usage +=
+        arranger_object_get_mem_usage (
+          (ArrangerObject *) self->region_after);
+    }
+
+  return mem_usage;
+}
+
 void
 arranger_selections_action_free (
   ArrangerSelectionsAction * self)
 {
   object_free_w_func_and_null (
     arranger_selections_free_full, self->sel);
+  object_free_w_func_and_null (
+    arranger_selections_free_full,
+    self->sel_after);
+  object_free_w_func_and_null (
+    quantize_options_free, self->opts);
 
   object_zero_and_free (self);
 }
@@ -22,9 +22,11 @@
 #include "audio/modulator_track.h"
 #include "audio/router.h"
 #include "audio/track.h"
+#include "gui/backend/arranger_object.h"
 #include "gui/backend/mixer_selections.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
+#include "plugins/plugin.h"
 #include "project.h"
 #include "settings/settings.h"
 #include "utils/flags.h"
@@ -1089,6 +1091,76 @@ mixer_selections_action_stringize (
   return NULL;
 }
 
+static size_t
+get_ms_mem_usage (
+  MixerSelections * ms)
+{
+  size_t mem_usage = sizeof (MixerSelections);
+  for (int i = 0; i < ms->num_slots; i++)
+    {
+      if (ms->plugins[i])
+        {
+          mem_usage +=
+            plugin_get_mem_usage (ms->plugins[i]);
+        }
+    }
+
+  return mem_usage;
+}
+
+static size_t
+get_ats_mem_usage (
+  AutomationTrack ** ats,
+  int                num_ats)
+{
+  size_t mem_usage = 0;
+  for (int i = 0; i < num_ats; i++)
+    {
+      AutomationTrack * at = ats[i];
+      if (!at)
+        continue;
+
+      mem_usage += sizeof (AutomationTrack);
+      for (int j = 0; j < at->num_regions; j++)
+        {
+          mem_usage +=
+            arranger_object_get_mem_usage (
+              (ArrangerObject *) at->regions[j]);
+        }
+    }
+
+  return mem_usage;
+}
+
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+mixer_selections_action_get_mem_usage (
+  MixerSelectionsAction * self)
+{
+  size_t mem_usage =
+    sizeof (MixerSelectionsAction);
+  if (self->ms_before)
+    {
+      mem_usage +=
+        get_ms_mem_usage (self->ms_before);
+    }
+  if (self->deleted_ms)
+    {
+      mem_usage +=
+        get_ms_mem_usage (self->deleted_ms);
+    }
+  mem_usage +=
+    get_ats_mem_usage (self->ats, self->num_ats);
+  mem_usage +=
+    get_ats_mem_usage (
+      self->deleted_ats, self->num_deleted_ats);
+
+  return mem_usage;
+}
+
 void
 mixer_selections_action_free (
   MixerSelectionsAction * self)
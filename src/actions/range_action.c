@@ -47,6 +47,119 @@ range_action_init_loaded (
         (ArrangerSelections *) self->sel_after,
         F_NOT_PROJECT);
     }
+  if (self->sel_moved)
+    {
+      arranger_selections_init_loaded (
+        (ArrangerSelections *) self->sel_moved,
+        F_NOT_PROJECT);
+    }
+
+  /* convert the transport copy of older
+   * actions */
+  if (self->transport)
+    {
+      position_set_to_pos (
+        &self->playhead_pos_before,
+        &self->transport->playhead_pos);
+      position_set_to_pos (
+        &self->cue_pos_before,
+        &self->transport->cue_pos);
+      position_set_to_pos (
+        &self->loop_start_pos_before,
+        &self->transport->loop_start_pos);
+      position_set_to_pos (
+        &self->loop_end_pos_before,
+        &self->transport->loop_end_pos);
+      object_zero_and_free (self->transport);
+    }
+}
+
+/**
+ * Returns whether the given project object is
+ * only moved by the action (ie, it doesn't need
+ * to be split).
+ */
+static bool
+object_only_moves (
+  RangeAction *    self,
+  ArrangerObject * obj)
+{
+  /* object starts before the range and ends after
+   * the range start */
+  if (arranger_object_is_hit (
+        obj, &self->start_pos, NULL) &&
+      position_is_before (
+        &obj->pos, &self->start_pos))
+    {
+      return false;
+    }
+
+  /* object starts before the range end and ends
+   * after the range end */
+  if (self->type == RANGE_ACTION_REMOVE &&
+      arranger_object_is_hit (
+        obj, &self->end_pos, NULL) &&
+      position_is_after (
+        &obj->end_pos, &self->end_pos))
+    {
+      return false;
+    }
+
+  return true;
+}
+
+/**
+ * Returns a newly allocated array with the project
+ * objects corresponding to the given clones.
+ *
+ * Must be called before any other objects are
+ * removed from or added to the project, while the
+ * identifiers of the clones are still valid.
+ */
+static ArrangerObject **
+find_project_objects (
+  ArrangerObject ** objs,
+  int               num_objs)
+{
+  ArrangerObject ** prj_objs =
+    calloc (
+      (size_t) MAX (num_objs, 1),
+      sizeof (ArrangerObject *));
+  for (int i = 0; i < num_objs; i++)
+    {
+      objs[i]->flags |=
+        ARRANGER_OBJECT_FLAG_NON_PROJECT;
+      prj_objs[i] = arranger_object_find (objs[i]);
+      g_warn_if_fail (prj_objs[i]);
+    }
+
+  return prj_objs;
+}
+
+/**
+ * Moves the given project objects and their
+ * clones by the given amount of ticks.
+ */
+static void
+move_objects (
+  ArrangerObject ** objs,
+  ArrangerObject ** prj_objs,
+  int               num_objs,
+  double            ticks)
+{
+  for (int i = 0; i < num_objs; i++)
+    {
+      if (!prj_objs[i])
+        continue;
+
+      arranger_object_move (prj_objs[i], ticks);
+      arranger_object_move (objs[i], ticks);
+
+      /* remember the identifier so we can find the
+       * object next time */
+      arranger_object_copy_identifier (
+        objs[i], prj_objs[i]);
+    }
 }
 
 /**
@@ -73,12 +186,51 @@ range_action_new (
   /* create selections for overlapping objects */
   Position inf;
   position_set_to_bar (&inf, 160000);
-  self->sel_before =
+  TimelineSelections * sel =
     timeline_selections_new_for_range (
-      start_pos, &inf, F_CLONE);
+      start_pos, &inf, F_NO_CLONE);
+  self->sel_before = timeline_selections_new ();
   self->sel_after = timeline_selections_new ();
+  self->sel_moved = timeline_selections_new ();
 
-  self->transport = transport_clone (TRANSPORT);
+  /* objects that only need to be moved don't need
+   * full copies */
+  int num_objs;
+  ArrangerObject ** objs =
+    arranger_selections_get_all_objects (
+      (ArrangerSelections *) sel, &num_objs);
+  for (int i = 0; i < num_objs; i++)
+    {
+      ArrangerObject * obj = objs[i];
+      bool only_moves =
+        object_only_moves (self, obj);
+      ArrangerObject * clone =
+        arranger_object_clone (
+          obj,
+          only_moves ?
+            ARRANGER_OBJECT_CLONE_COPY_SHALLOW :
+            ARRANGER_OBJECT_CLONE_COPY_MAIN);
+      arranger_selections_add_object (
+        only_moves ?
+          (ArrangerSelections *) self->sel_moved :
+          (ArrangerSelections *) self->sel_before,
+        clone);
+    }
+  free (objs);
+  arranger_selections_free (
+    (ArrangerSelections *) sel);
+
+  position_set_to_pos (
+    &self->playhead_pos_before,
+    &TRANSPORT->playhead_pos);
+  position_set_to_pos (
+    &self->cue_pos_before, &TRANSPORT->cue_pos);
+  position_set_to_pos (
+    &self->loop_start_pos_before,
+    &TRANSPORT->loop_start_pos);
+  position_set_to_pos (
+    &self->loop_end_pos_before,
+    &TRANSPORT->loop_end_pos);
 
   return ua;
 }
@@ -97,7 +249,7 @@ range_action_new (
       position_set_to_pos ( \
         &TRANSPORT->x, \
         _do ? \
-          &self->start_pos : &self->transport->x); \
+          &self->start_pos : &self->x##_before); \
     } \
   else if (position_is_after_or_equal ( \
              &TRANSPORT->x, \
@@ -149,6 +301,22 @@ range_action_do (
     position_to_ticks (&self->end_pos) -
     position_to_ticks (&self->start_pos);
 
+  /* find the objects to move before anything is
+   * removed from the project */
+  int num_moved_objs = 0;
+  ArrangerObject ** moved_objs = NULL;
+  ArrangerObject ** prj_moved_objs = NULL;
+  if (self->sel_moved)
+    {
+      moved_objs =
+        arranger_selections_get_all_objects (
+          (ArrangerSelections *) self->sel_moved,
+          &num_moved_objs);
+      prj_moved_objs =
+        find_project_objects (
+          moved_objs, num_moved_objs);
+    }
+
   /* temporary place to store project objects, so
    * we can get their final identifiers at the end */
   ArrangerObject * prj_objs[num_before_objs * 2];
@@ -513,6 +681,14 @@ range_action_do (
         after_objs_for_prj[i], prj_objs[i]);
     }
 
+  /* move the objects after the range */
+  move_objects (
+    moved_objs, prj_moved_objs, num_moved_objs,
+    self->type == RANGE_ACTION_INSERT_SILENCE ?
+      range_size_ticks : - range_size_ticks);
+  free (moved_objs);
+  free (prj_moved_objs);
+
   EVENTS_PUSH (
     ET_ARRANGER_SELECTIONS_ACTION_FINISHED, NULL);
   EVENTS_PUSH (
@@ -545,6 +721,22 @@ range_action_undo (
     position_to_ticks (&self->end_pos) -
     position_to_ticks (&self->start_pos);
 
+  /* find the objects to move before anything is
+   * removed from the project */
+  int num_moved_objs = 0;
+  ArrangerObject ** moved_objs = NULL;
+  ArrangerObject ** prj_moved_objs = NULL;
+  if (self->sel_moved)
+    {
+      moved_objs =
+        arranger_selections_get_all_objects (
+          (ArrangerSelections *) self->sel_moved,
+          &num_moved_objs);
+      prj_moved_objs =
+        find_project_objects (
+          moved_objs, num_moved_objs);
+    }
+
   /* remove all matching project objects from
    * sel_after */
   for (int i = num_objs_after - 1; i >= 0; i--)
@@ -593,6 +785,14 @@ range_action_undo (
   free (objs_before);
   free (objs_after);
 
+  /* move the objects after the range back */
+  move_objects (
+    moved_objs, prj_moved_objs, num_moved_objs,
+    self->type == RANGE_ACTION_INSERT_SILENCE ?
+      - range_size_ticks : range_size_ticks);
+  free (moved_objs);
+  free (prj_moved_objs);
+
   EVENTS_PUSH (
     ET_ARRANGER_SELECTIONS_ACTION_FINISHED, NULL);
   EVENTS_PUSH (
@@ -619,6 +819,36 @@ range_action_stringize (
   g_return_val_if_reached (NULL);
 }
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+range_action_get_mem_usage (
+  RangeAction * self)
+{
+  size_t mem_usage = sizeof (RangeAction);
+  if (self->sel_before)
+    {
+      mem_usage +=
+        arranger_selections_get_mem_usage (
+          (ArrangerSelections *) self->sel_before);
+    }
+  if (self->sel_after)
+    {
+      mem_usage +=
+        arranger_selections_get_mem_usage (
+          (ArrangerSelections *) self->sel_after);
+    }
+  if (self->sel_moved)
+    {
+      mem_usage +=
+        arranger_selections_get_mem_usage (
+          (ArrangerSelections *) self->sel_moved);
+    }
+  return mem_usage;
+}
+
 void
 range_action_free (
   RangeAction * self)
@@ -635,6 +865,13 @@ range_action_free (
         (ArrangerSelections *) self->sel_after);
       self->sel_after = NULL;
     }
+  if (self->sel_moved)
+    {
+      arranger_selections_free_full (
+        (ArrangerSelections *) self->sel_moved);
+      self->sel_moved = NULL;
+    }
+  object_zero_and_free (self->transport);
 
   object_zero_and_free (self);
 }
@@ -19,6 +19,7 @@
 
 #include "actions/tracklist_selections.h"
 #include "audio/audio_region.h"
+#include "audio/channel.h"
 #include "audio/group_target_track.h"
 #include "audio/midi_file.h"
 #include "audio/router.h"
@@ -26,6 +27,7 @@
 #include "audio/track.h"
 #include "audio/tracklist.h"
 #include "gui/backend/event.h"
+#include "gui/backend/arranger_object.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/main_window.h"
 #include "plugins/plugin.h"
@@ -1210,6 +1212,114 @@ tracklist_selections_action_stringize (
   g_return_val_if_reached (g_strdup (""));
 }
 
+static size_t
+get_track_mem_usage (
+  Track * track)
+{
+  size_t mem_usage = sizeof (Track);
+  Channel * ch = track->channel;
+  if (ch)
+    {
+      mem_usage += sizeof (Channel);
+      for (int i = 0; i < STRIP_SIZE; i++)
+        {
+          if (ch->inserts[i])
+            {
+              mem_usage +=
+                plugin_get_mem_usage (
+                  ch->inserts[i]);
+            }
+          if (ch->midi_fx[i])
+            {
+              mem_usage +=
+                plugin_get_mem_usage (
+                  ch->midi_fx[i]);
+            }
+        }
+      if (ch->instrument)
+        {
+          mem_usage +=
+            plugin_get_mem_usage (ch->instrument);
+        }
+    }
+  for (int i = 0; i < track->num_modulators; i++)
+    {
+      mem_usage +=
+        plugin_get_mem_usage (
+          track->modulators[i]);
+    }
+
+  for (int i = 0; i < track->num_lanes; i++)
+    {
+      TrackLane * lane = track->lanes[i];
+      for (int j = 0; j < lane->num_regions; j++)
+        {
+          mem_usage +=
+            arranger_object_get_mem_usage (
+              (ArrangerObject *) lane->regions[j]);
+        }
+    }
+  for (int i = 0; i < track->num_chord_regions;
+       i++)
+    {
+      mem_usage +=
+        arranger_object_get_mem_usage (
+          (ArrangerObject *)
+          track->chord_regions[i]);
+    }
+  AutomationTracklist * atl =
+    &track->automation_tracklist;
+  for (int i = 0; i < atl->num_ats; i++)
+    {
+      AutomationTrack * at = atl->ats[i];
+      for (int j = 0; j < at->num_regions; j++)
+        {
+          mem_usage +=
+            arranger_object_get_mem_usage (
+              (ArrangerObject *) at->regions[j]);
+        }
+    }
+
+  return mem_usage;
+}
+
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+tracklist_selections_action_get_mem_usage (
+  TracklistSelectionsAction * self)
+{
+  size_t mem_usage =
+    sizeof (TracklistSelectionsAction);
+  if (self->tls_before)
+    {
+      for (int i = 0;
+           i < self->tls_before->num_tracks; i++)
+        {
+          mem_usage +=
+            get_track_mem_usage (
+              self->tls_before->tracks[i]);
+        }
+    }
+  if (self->tls_after)
+    {
+      for (int i = 0;
+           i < self->tls_after->num_tracks; i++)
+        {
+          mem_usage +=
+            get_track_mem_usage (
+              self->tls_after->tracks[i]);
+        }
+    }
+  mem_usage +=
+    (size_t) self->src_sends_size *
+    sizeof (ChannelSend);
+
+  return mem_usage;
+}
+
 void
 tracklist_selections_action_free (
   TracklistSelectionsAction * self)
@@ -62,6 +62,24 @@ undo_manager_new (void)
   return self;
 }
 
+/**
+ * Deletes the oldest actions in the given stack
+ * until it is within its memory limit, keeping
+ * at least the most recent action.
+ */
+static void
+free_oldest_over_mem_limit (
+  UndoStack * stack)
+{
+  while (undo_stack_is_over_mem_limit (stack) &&
+         undo_stack_size (stack) > 1)
+    {
+      UndoableAction * action_to_delete =
+        undo_stack_pop_last (stack);
+      undoable_action_free (action_to_delete);
+    }
+}
+
 /**
  * Undo last action.
  */
@@ -99,6 +117,7 @@ undo_manager_undo (UndoManager * self)
 
   /* push action to the redo stack */
   undo_stack_push (self->redo_stack, action);
+  free_oldest_over_mem_limit (self->redo_stack);
 
   if (ZRYTHM_HAVE_UI)
     {
@@ -145,6 +164,7 @@ undo_manager_redo (UndoManager * self)
 
   /* push action to the undo stack */
   undo_stack_push (self->undo_stack, action);
+  free_oldest_over_mem_limit (self->undo_stack);
 
   if (ZRYTHM_HAVE_UI)
     {
@@ -192,6 +212,8 @@ undo_manager_perform (
 
   undo_stack_clear (self->redo_stack, true);
 
+  free_oldest_over_mem_limit (self->undo_stack);
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
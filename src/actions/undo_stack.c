@@ -25,6 +25,24 @@
 #include "zrythm.h"
 #include "zrythm_app.h"
 
+/**
+ * Returns the memory limit from the settings, in
+ * bytes.
+ */
+static size_t
+get_max_mem_usage (void)
+{
+  if (ZRYTHM_TESTING)
+    return 0;
+
+  int limit =
+    g_settings_get_int (
+      S_P_EDITING_UNDO,
+      "undo-stack-memory-limit");
+  return
+    limit < 0 ? 0 : (size_t) limit * 1024 * 1024;
+}
+
 void
 undo_stack_init_loaded (
   UndoStack * self)
@@ -36,6 +54,8 @@ undo_stack_init_loaded (
   self->stack =
     stack_new (undo_stack_length);
   self->stack->top = -1;
+  self->mem_usage = 0;
+  self->max_mem_usage = get_max_mem_usage ();
 
 #define DO_SIMPLE(cc,sc) \
   /* if there are still actions of this type */ \
@@ -49,6 +69,9 @@ undo_stack_init_loaded (
       if (self->stack->top + 1 == ua->stack_idx) \
         { \
           STACK_PUSH (self->stack, ua); \
+          ua->mem_usage = \
+            undoable_action_get_mem_usage (ua); \
+          self->mem_usage += ua->mem_usage; \
           sc##_actions_idx++; \
         } \
     }
@@ -107,6 +130,7 @@ undo_stack_new (void)
   self->stack =
     stack_new (undo_stack_length);
   self->stack->top = -1;
+  self->max_mem_usage = get_max_mem_usage ();
 
   return self;
 }
@@ -145,6 +169,10 @@ undo_stack_push (
 
   action->stack_idx = self->stack->top;
 
+  action->mem_usage =
+    undoable_action_get_mem_usage (action);
+  self->mem_usage += action->mem_usage;
+
   /* CAPS, CamelCase, snake_case */
 #define APPEND_ELEMENT(caps,cc,sc) \
   case UA_##caps: \
@@ -261,6 +289,11 @@ undo_stack_pop (
   int removed = remove_action (self, action);
   g_warn_if_fail (removed);
 
+  g_warn_if_fail (
+    self->mem_usage >= action->mem_usage);
+  self->mem_usage -=
+    MIN (self->mem_usage, action->mem_usage);
+
   /* return it */
   return action;
 }
@@ -284,6 +317,11 @@ undo_stack_pop_last (
   bool removed = remove_action (self, action);
   g_warn_if_fail (removed);
 
+  g_warn_if_fail (
+    self->mem_usage >= action->mem_usage);
+  self->mem_usage -=
+    MIN (self->mem_usage, action->mem_usage);
+
   /* return it */
   return action;
 }
@@ -24,6 +24,7 @@
 #include "actions/tracklist_selections.h"
 #include "actions/transport_action.h"
 #include "actions/undoable_action.h"
+#include "audio/tracklist.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm_app.h"
@@ -199,6 +200,12 @@ undoable_action_do (UndoableAction * self)
   g_debug ("lock released");
 #endif
 
+  /* rebuild the playback indices of the edited
+   * lanes and regions while the engine is
+   * paused */
+  tracklist_update_playback_indices (TRACKLIST);
+  tracklist_update_solo_state (TRACKLIST);
+
   /* restart engine */
   resume_engine (&state);
 
@@ -270,12 +277,68 @@ undoable_action_undo (UndoableAction * self)
 
   /*zix_sem_post (&AUDIO_ENGINE->port_operation_lock);*/
 
+  /* rebuild the playback indices of the edited
+   * lanes and regions while the engine is
+   * paused */
+  tracklist_update_playback_indices (TRACKLIST);
+  tracklist_update_solo_state (TRACKLIST);
+
   /* restart engine */
   resume_engine (&state);
 
   return ret;
 }
 
+/**
+ * Returns the approximate amount of memory used
+ * by the action, in bytes.
+ */
+size_t
+undoable_action_get_mem_usage (
+  UndoableAction * self)
+{
+/* uppercase, camel case, snake case */
+#define GET_MEM_USAGE(uc,sc,cc) \
+  case UA_##uc: \
+    return \
+      sc##_action_get_mem_usage ( \
+        (cc##Action *) self);
+
+/* actions that only store primitives */
+#define SIZEOF_ACTION(uc,cc) \
+  case UA_##uc: \
+    return sizeof (cc##Action);
+
+  switch (self->type)
+    {
+    GET_MEM_USAGE (
+      TRACKLIST_SELECTIONS,
+      tracklist_selections,
+      TracklistSelections);
+    GET_MEM_USAGE (
+      ARRANGER_SELECTIONS, arranger_selections,
+      ArrangerSelections);
+    GET_MEM_USAGE (RANGE, range, Range);
+    SIZEOF_ACTION (CHANNEL_SEND, ChannelSend);
+    GET_MEM_USAGE (
+      MIXER_SELECTIONS, mixer_selections,
+      MixerSelections);
+    SIZEOF_ACTION (MIDI_MAPPING, MidiMapping);
+    SIZEOF_ACTION (
+      PORT_CONNECTION, PortConnection);
+    SIZEOF_ACTION (PORT, Port);
+    SIZEOF_ACTION (TRANSPORT, Transport);
+    default:
+      break;
+    }
+
+#undef GET_MEM_USAGE
+#undef SIZEOF_ACTION
+
+  g_return_val_if_reached (
+    sizeof (UndoableAction));
+}
+
 void
 undoable_action_free (UndoableAction * self)
 {
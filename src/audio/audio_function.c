@@ -62,6 +62,7 @@ audio_function_apply (
   g_return_val_if_fail (tr, -1);
   AudioClip * orig_clip =  audio_region_get_clip (r);
   g_return_val_if_fail (orig_clip, -1);
+  audio_clip_ensure_loaded (orig_clip);
 
   Position init_pos;
   position_init (&init_pos);
@@ -96,10 +97,9 @@ audio_function_apply (
   /* interleaved frames */
   size_t channels = orig_clip->channels;
   float frames[num_frames * channels];
-  dsp_copy (
-    &frames[0],
-    &orig_clip->frames[start.frames * (long) channels],
-    num_frames * channels);
+  audio_clip_get_interleaved_frames (
+    orig_clip, start.frames, num_frames,
+    &frames[0]);
 
   switch (type)
     {
@@ -125,10 +125,9 @@ audio_function_apply (
           for (size_t j = 0; j < channels; j++)
             {
               frames[i * channels + j] =
-                orig_clip->frames[
-                  ((size_t) start.frames +
-                   ((num_frames - i) - 1)) *
-                    channels + j];
+                orig_clip->ch_frames[j][
+                  (size_t) start.frames +
+                    ((num_frames - i) - 1)];
             }
         }
       break;
@@ -20,11 +20,13 @@
 #include "audio/channel.h"
 #include "audio/audio_region.h"
 #include "audio/clip.h"
+#include "audio/clip_stream.h"
 #include "audio/fade.h"
 #include "audio/pool.h"
 #include "audio/stretcher.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
+#include "audio/transport.h"
 #include "gui/widgets/main_window.h"
 #include "gui/widgets/region.h"
 #include "project.h"
@@ -33,6 +35,7 @@
 #include "utils/flags.h"
 #include "utils/io.h"
 #include "utils/math.h"
+#include "utils/rt_trace.h"
 #include "zrythm_app.h"
 
 /**
@@ -110,7 +113,8 @@ audio_region_new (
     {
       self->pool_id = pool_id;
       clip = AUDIO_POOL->clips[pool_id];
-      g_warn_if_fail (clip && clip->frames);
+      g_warn_if_fail (
+        clip && (clip->ch_frames[0] || clip->stream));
     }
 
   /* set end pos to sample end */
@@ -215,7 +219,8 @@ audio_region_get_clip (
     AUDIO_POOL->clips[self->pool_id];
 
   g_return_val_if_fail (
-    clip && clip->frames && clip->num_frames > 0,
+    clip && (clip->ch_frames[0] || clip->stream) &&
+    clip->num_frames > 0,
     NULL);
 
   return clip;
@@ -252,6 +257,7 @@ audio_region_replace_frames (
   bool      duplicate_clip)
 {
   AudioClip * clip = audio_region_get_clip (self);
+  audio_clip_ensure_loaded (clip);
 
   if (duplicate_clip)
     {
@@ -270,9 +276,8 @@ audio_region_replace_frames (
       self->pool_id = clip->pool_id;
     }
 
-  dsp_copy (
-    &clip->frames[start_frame * clip->channels],
-    frames, num_frames * clip->channels);
+  audio_clip_set_interleaved_frames (
+    clip, frames, (long) start_frame, num_frames);
 
   audio_clip_write_to_pool (clip, false);
 }
@@ -296,7 +301,7 @@ timestretch_buf (
   size_t in_frames_to_process =
     (size_t)
     (frames_to_process * timestretch_ratio);
-  g_message (
+  rt_debug (
     "%s: in frame offset %zd, out frame offset %u, "
     "in frames to process %zu, "
     "out frames to process %zd",
@@ -306,13 +311,45 @@ timestretch_buf (
     (long)
     (in_frame_offset + in_frames_to_process) <=
       clip->num_frames);
+
+  float * in_l;
+  float * in_r;
+  float * streamed_l = self->rt_stretch_bufs[0];
+  float * streamed_r = self->rt_stretch_bufs[1];
+  ClipStream * stream =
+    g_atomic_pointer_get (&clip->stream);
+  if (stream)
+    {
+      g_return_if_fail (
+        streamed_l &&
+        in_frames_to_process <=
+          TRACK_MAX_STREAMED_STRETCH_FRAMES);
+      clip_stream_read (
+        stream, 0, (long) in_frame_offset,
+        in_frames_to_process, streamed_l);
+      if (clip->channels > 1)
+        {
+          clip_stream_read (
+            stream, 1, (long) in_frame_offset,
+            in_frames_to_process, streamed_r);
+        }
+      in_l = streamed_l;
+      in_r =
+        clip->channels == 1 ?
+          streamed_l : streamed_r;
+    }
+  else
+    {
+      in_l = &clip->ch_frames[0][in_frame_offset];
+      in_r =
+        clip->channels == 1 ?
+          &clip->ch_frames[0][in_frame_offset] :
+          &clip->ch_frames[1][in_frame_offset];
+    }
+
   ssize_t retrieved =
     stretcher_stretch (
-      self->rt_stretcher,
-      &clip->ch_frames[0][in_frame_offset],
-      clip->channels == 1 ?
-        &clip->ch_frames[0][in_frame_offset] :
-        &clip->ch_frames[1][in_frame_offset],
+      self->rt_stretcher, in_l, in_r,
       in_frames_to_process,
       &lbuf_after_ts[out_frame_offset],
       &rbuf_after_ts[out_frame_offset],
@@ -320,6 +357,162 @@ timestretch_buf (
   g_warn_if_fail (retrieved == frames_to_process);
 }
 
+/**
+ * Fills the timestretched audio data from the
+ * region frame by frame.
+ */
+static void
+fill_timestretched (
+  Track *       track,
+  ZRegion *     r,
+  AudioClip *   clip,
+  long          g_start_frames,
+  nframes_t     local_start_frame,
+  nframes_t     nframes,
+  double        timestretch_ratio,
+  StereoPorts * stereo_ports)
+{
+  /* the stretcher writes at offsets in the port
+   * buffers and leaves gaps it has no material
+   * for */
+  float * lbuf_after_ts = stereo_ports->l->buf;
+  float * rbuf_after_ts = stereo_ports->r->buf;
+  dsp_fill (
+    &lbuf_after_ts[local_start_frame], 0, nframes);
+  dsp_fill (
+    &rbuf_after_ts[local_start_frame], 0, nframes);
+
+  size_t buff_index_start =
+    (size_t) clip->num_frames + 16;
+  size_t buff_size = 0;
+  unsigned int prev_offset = local_start_frame;
+  for (nframes_t j = 0; j < nframes; j++)
+    {
+      long current_local_frame =
+        local_start_frame + j;
+      long r_local_pos =
+        region_timeline_frames_to_local (
+          r, g_start_frames + j, F_NORMALIZE);
+
+      ssize_t buff_index =
+        (ssize_t) r_local_pos;
+
+#define STRETCH \
+timestretch_buf ( \
+track, r, clip, buff_index_start, \
+timestretch_ratio, \
+lbuf_after_ts, rbuf_after_ts, \
+prev_offset, \
+(current_local_frame - prev_offset) + 1)
+
+      /* if we are starting at a new
+       * point in the audio clip */
+      buff_index =
+        (ssize_t)
+        (buff_index * timestretch_ratio);
+      if (buff_index <
+            (ssize_t) buff_index_start)
+        {
+          rt_debug (
+            "buff index (%zd) < "
+            "buff index start (%zd)",
+            buff_index,
+            buff_index_start);
+          /* set the start point (
+           * used when
+           * timestretching) */
+          buff_index_start =
+            (size_t) buff_index;
+
+          /* timestretch the material
+           * up to this point */
+          if (buff_size > 0)
+            {
+              rt_debug (
+                "buff size (%zd) > 0",
+                buff_size);
+              STRETCH;
+              prev_offset = current_local_frame;
+            }
+          buff_size = 0;
+        }
+      /* else if last sample */
+      else if (j == (nframes - 1))
+        {
+          STRETCH;
+          prev_offset = current_local_frame;
+        }
+      else
+        {
+          buff_size++;
+        }
+
+#undef STRETCH
+    }
+}
+
+/**
+ * Applies the region's fade in/out to the given
+ * buffers.
+ *
+ * Only the frames inside the fade ranges are
+ * touched.
+ *
+ * @param lbuf Left buffer, starting at
+ *   \ref g_start_frames.
+ * @param rbuf Right buffer, starting at
+ *   \ref g_start_frames.
+ */
+static void
+apply_fades (
+  ZRegion *   r,
+  long        g_start_frames,
+  nframes_t   nframes,
+  float *     lbuf,
+  float *     rbuf)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+
+  /* frames since the region start */
+  long start_frame =
+    g_start_frames - r_obj->pos.frames;
+  long end_frame = start_frame + (long) nframes;
+  long fade_in_frames = r_obj->fade_in_pos.frames;
+  long fade_out_start = r_obj->fade_out_pos.frames;
+  long fade_out_frames =
+    (r_obj->end_pos.frames - r_obj->pos.frames) -
+    fade_out_start;
+
+  /* fade in */
+  for (long i = MAX (start_frame, 0);
+       i < MIN (end_frame, fade_in_frames); i++)
+    {
+      float fade_in =
+        (float)
+        fade_get_y_normalized (
+          (double) i / (double) fade_in_frames,
+          &r_obj->fade_in_opts, 1);
+      lbuf[i - start_frame] *= fade_in;
+      rbuf[i - start_frame] *= fade_in;
+    }
+
+  /* fade out */
+  if (fade_out_frames <= 0)
+    return;
+  for (long i = MAX (start_frame, fade_out_start);
+       i < end_frame; i++)
+    {
+      float fade_out =
+        (float)
+        fade_get_y_normalized (
+          (double) (i - fade_out_start) /
+          (double) fade_out_frames,
+          &r_obj->fade_out_opts, 0);
+      lbuf[i - start_frame] *= fade_out;
+      rbuf[i - start_frame] *= fade_out;
+    }
+}
+
 /**
  * Fills audio data from the region.
  *
@@ -365,143 +558,192 @@ audio_region_fill_stereo_ports (
       needs_rt_timestretch = true;
       timestretch_ratio =
         (double) cur_bpm / (double) clip->bpm;
-      g_message (
+      rt_debug (
         "timestretching: "
         "(cur bpm %f clip bpm %f) %f",
         (double) cur_bpm, (double) clip->bpm,
         timestretch_ratio);
     }
 
-  /* buffers after timestretch */
-  float lbuf_after_ts[nframes];
-  float rbuf_after_ts[nframes];
-  dsp_fill (lbuf_after_ts, 0, nframes);
-  dsp_fill (rbuf_after_ts, 0, nframes);
+  float * lbuf =
+    &stereo_ports->l->buf[local_start_frame];
+  float * rbuf =
+    &stereo_ports->r->buf[local_start_frame];
+  stereo_ports->l->silent = false;
+  stereo_ports->r->silent = false;
 
-  size_t buff_index_start =
-    (size_t) clip->num_frames + 16;
-  size_t buff_size = 0;
-  unsigned int prev_offset = local_start_frame;
-  for (nframes_t j = 0; j < nframes; j++)
+  if (needs_rt_timestretch)
     {
-      long current_local_frame =
-        local_start_frame + j;
-      long r_local_pos =
-        region_timeline_frames_to_local (
-          r, g_start_frames + j, F_NORMALIZE);
-
-      ssize_t buff_index =
-        (ssize_t) r_local_pos;
-
-#define STRETCH \
-timestretch_buf ( \
-track, r, clip, buff_index_start, \
-timestretch_ratio, \
-lbuf_after_ts, rbuf_after_ts, \
-prev_offset, \
-(current_local_frame - prev_offset) + 1)
-
-      /* if we are starting at a new
-       * point in the audio clip */
-      if (needs_rt_timestretch)
+      fill_timestretched (
+        track, r, clip, g_start_frames,
+        local_start_frame, nframes,
+        timestretch_ratio, stereo_ports);
+    }
+  else
+    {
+      ClipStream * stream =
+        g_atomic_pointer_get (&clip->stream);
+
+      /* copy contiguous runs of the clip, split at
+       * the region's loop end and the clip
+       * boundaries */
+      nframes_t j = 0;
+      while (j < nframes)
         {
-          buff_index =
-            (ssize_t)
-            (buff_index * timestretch_ratio);
-          if (buff_index <
-                (ssize_t) buff_index_start)
+          long r_local_pos =
+            region_timeline_frames_to_local (
+              r, g_start_frames + j, F_NORMALIZE);
+          long run =
+            MIN (
+              (long) (nframes - j),
+              r_obj->loop_end_pos.frames -
+                r_local_pos);
+          g_return_if_fail (run > 0);
+
+          if (r_local_pos < 0 ||
+              r_local_pos >= clip->num_frames)
             {
-              g_message (
-                "buff index (%zd) < "
-                "buff index start (%zd)",
-                buff_index,
-                buff_index_start);
-              /* set the start point (
-               * used when
-               * timestretching) */
-              buff_index_start =
-                (size_t) buff_index;
-
-              /* timestretch the material
-               * up to this point */
-              if (buff_size > 0)
+              /* outside the clip */
+              if (r_local_pos < 0)
                 {
-                  g_message (
-                    "buff size (%zd) > 0",
-                    buff_size);
-                  STRETCH;
-                  prev_offset = current_local_frame;
+                  run = MIN (run, - r_local_pos);
                 }
-              buff_size = 0;
+              dsp_fill (&lbuf[j], 0.f, (size_t) run);
+              dsp_fill (&rbuf[j], 0.f, (size_t) run);
             }
-          /* else if last sample */
-          else if (j == (nframes - 1))
+          else if (stream)
             {
-              STRETCH;
-              prev_offset = current_local_frame;
+              run =
+                MIN (
+                  run,
+                  clip->num_frames - r_local_pos);
+              clip_stream_read (
+                stream, 0, r_local_pos,
+                (size_t) run, &lbuf[j]);
+              if (clip->channels == 1)
+                {
+                  dsp_copy (
+                    &rbuf[j], &lbuf[j],
+                    (size_t) run);
+                }
+              else
+                {
+                  clip_stream_read (
+                    stream, 1, r_local_pos,
+                    (size_t) run, &rbuf[j]);
+                }
             }
           else
             {
-              buff_size++;
+              run =
+                MIN (
+                  run,
+                  clip->num_frames - r_local_pos);
+              dsp_copy (
+                &lbuf[j],
+                &clip->ch_frames[0][r_local_pos],
+                (size_t) run);
+              dsp_copy (
+                &rbuf[j],
+                clip->channels == 1 ?
+                  &clip->ch_frames[0][r_local_pos] :
+                  &clip->ch_frames[1][r_local_pos],
+                (size_t) run);
             }
-        }
-      /* else if no need for timestretch */
-      else if (!needs_rt_timestretch)
-        {
-          lbuf_after_ts[j] =
-            clip->ch_frames[0][buff_index];
-          rbuf_after_ts[j] =
-            clip->channels == 1 ?
-            clip->ch_frames[0][buff_index] :
-            clip->ch_frames[1][buff_index];
+
+          j += (nframes_t) run;
         }
     }
 
-  /* apply fades */
-  for (nframes_t j = 0; j < nframes; j++)
-    {
-      long current_local_frame =
-        local_start_frame + j;
-
-      float fade_in = 1.f;
-      float fade_out = 1.f;
+  apply_fades (
+    r, g_start_frames, nframes, lbuf, rbuf);
+}
 
-      /* if inside fade in */
-      if (current_local_frame >= 0 &&
-          current_local_frame <
-            r_obj->fade_in_pos.frames)
-        {
-          fade_in =
-            (float)
-            fade_get_y_normalized (
-              (double) current_local_frame /
-              (double)
-              r_obj->fade_in_pos.frames,
-              &r_obj->fade_in_opts, 1);
-        }
-      /* else if inside fade out */
-      else if (current_local_frame >=
-                 r_obj->fade_out_pos.frames)
-        {
-          fade_out =
-            (float)
-            fade_get_y_normalized (
-              (double)
-              (current_local_frame -
-                  r_obj->fade_out_pos.frames) /
-              (double)
-              (r_obj->end_pos.frames -
-                (r_obj->fade_out_pos.frames +
-                 r_obj->pos.frames)),
-              &r_obj->fade_out_opts, 0);
-        }
+/**
+ * Hints the clip streamer about the given global
+ * frame range of the region, wrapping around the
+ * region's loop end.
+ */
+static void
+prefetch_range (
+  ZRegion *    self,
+  ClipStream * stream,
+  long         g_start_frames,
+  long         g_end_frames)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) self;
+
+  g_start_frames =
+    MAX (g_start_frames, r_obj->pos.frames);
+  g_end_frames =
+    MIN (g_end_frames, r_obj->end_pos.frames);
+  if (g_start_frames >= g_end_frames)
+    return;
+
+  long local_start =
+    region_timeline_frames_to_local (
+      self, g_start_frames, F_NORMALIZE);
+  long len = g_end_frames - g_start_frames;
+  long till_loop_end =
+    r_obj->loop_end_pos.frames - local_start;
+  if (till_loop_end > 0 && len > till_loop_end)
+    {
+      clip_stream_prefetch (
+        stream, local_start, (size_t) till_loop_end);
+      clip_stream_prefetch (
+        stream, r_obj->loop_start_pos.frames,
+        (size_t) (len - till_loop_end));
+    }
+  else
+    {
+      clip_stream_prefetch (
+        stream, local_start, (size_t) len);
+    }
+}
 
-      stereo_ports->l->buf[current_local_frame] =
-          lbuf_after_ts[j] *
-          fade_in * fade_out;
-      stereo_ports->r->buf[current_local_frame] =
-          rbuf_after_ts[j] *
-          fade_in * fade_out;
+/**
+ * Hints the clip streamer about the frames that
+ * will be played from the given global frame on,
+ * if the region's clip is streamed.
+ *
+ * The read-ahead window wraps around the transport
+ * loop and the region loop.
+ */
+REALTIME
+void
+audio_region_prefetch (
+  ZRegion * self,
+  long      g_start_frames)
+{
+  AudioClip * clip =
+    AUDIO_POOL->clips[self->pool_id];
+  ClipStream * stream =
+    g_atomic_pointer_get (&clip->stream);
+  if (!stream)
+    return;
+
+  long g_end_frames =
+    g_start_frames + CLIP_STREAM_READ_AHEAD_FRAMES;
+  long loop_start_frames =
+    TRANSPORT->loop_start_pos.frames;
+  long loop_end_frames =
+    TRANSPORT->loop_end_pos.frames;
+  if (TRANSPORT_IS_LOOPING &&
+      g_start_frames < loop_end_frames &&
+      g_end_frames > loop_end_frames)
+    {
+      prefetch_range (
+        self, stream, g_start_frames,
+        loop_end_frames);
+      prefetch_range (
+        self, stream, loop_start_frames,
+        loop_start_frames +
+          (g_end_frames - loop_end_frames));
+    }
+  else
+    {
+      prefetch_range (
+        self, stream, g_start_frames, g_end_frames);
     }
 }
 
@@ -49,6 +49,14 @@ audio_track_init (
     stretcher_new_rubberband (
       AUDIO_ENGINE->sample_rate, 2, 1.0,
       1.0, true);
+
+  for (int i = 0; i < 2; i++)
+    {
+      self->rt_stretch_bufs[i] =
+        calloc (
+          TRACK_MAX_STREAMED_STRETCH_FRAMES,
+          sizeof (float));
+    }
 }
 
 void
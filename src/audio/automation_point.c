@@ -30,6 +30,7 @@
 #include "audio/instrument_track.h"
 #include "audio/port.h"
 #include "audio/position.h"
+#include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -202,6 +203,13 @@ automation_point_set_fvalue (
   g_message ("setting to %f", (double) real_val);
   self->fvalue = real_val;
 
+  if (port->id.flags & PORT_FLAG_BPM &&
+      P_TEMPO_TRACK)
+    {
+      tempo_track_invalidate_tempo_map (
+        P_TEMPO_TRACK);
+    }
+
   ZRegion * region =
     arranger_object_get_region (
       (ArrangerObject *) self);
@@ -266,6 +274,15 @@ automation_point_set_curviness (
     return;
 
   self->curve_opts.curviness = curviness;
+
+  ArrangerObject * obj = (ArrangerObject *) self;
+  if (PROJECT && TRACKLIST && P_TEMPO_TRACK &&
+      obj->region_id.track_pos ==
+        P_TEMPO_TRACK->pos)
+    {
+      tempo_track_invalidate_tempo_map (
+        P_TEMPO_TRACK);
+    }
 }
 
 /**
@@ -23,6 +23,8 @@
 #include "audio/automation_region.h"
 #include "audio/position.h"
 #include "audio/region.h"
+#include "audio/tempo_track.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/automation_selections.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -107,6 +109,22 @@ automation_region_print_automation (
     }
 }
 
+/**
+ * Marks the tempo map as outdated if this is a
+ * region in the tempo track.
+ */
+static void
+invalidate_tempo_map (
+  ZRegion * self)
+{
+  if (PROJECT && TRACKLIST && P_TEMPO_TRACK &&
+      self->id.track_pos == P_TEMPO_TRACK->pos)
+    {
+      tempo_track_invalidate_tempo_map (
+        P_TEMPO_TRACK);
+    }
+}
+
 /**
  * Forces sort of the automation points.
  */
@@ -114,6 +132,8 @@ void
 automation_region_force_sort (
   ZRegion * self)
 {
+  invalidate_tempo_map (self);
+
   /* sort by position */
   qsort (self->aps,
          (size_t) self->num_aps,
@@ -149,6 +169,7 @@ automation_region_add_ap (
 
   /* re-sort */
   automation_region_force_sort (self);
+  arranger_object_index_invalidate_all ();
 
   if (pub_events)
     {
@@ -281,6 +302,8 @@ automation_region_remove_ap (
 
   array_delete (
     self->aps, self->num_aps, ap);
+  arranger_object_index_invalidate_all ();
+  invalidate_tempo_map (self);
 
   if (free)
     {
@@ -24,7 +24,9 @@
 #include "audio/automation_region.h"
 #include "audio/control_port.h"
 #include "audio/instrument_track.h"
+#include "audio/tempo_track.h"
 #include "audio/track.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/center_dock.h"
@@ -141,6 +143,22 @@ automation_track_add_region (
     self, region, self->num_regions);
 }
 
+/**
+ * Marks the tempo map as outdated if this is the
+ * BPM automation track.
+ */
+static void
+invalidate_tempo_map (
+  AutomationTrack * self)
+{
+  if (self->port_id.flags & PORT_FLAG_BPM &&
+      PROJECT && TRACKLIST && P_TEMPO_TRACK)
+    {
+      tempo_track_invalidate_tempo_map (
+        P_TEMPO_TRACK);
+    }
+}
+
 /**
  * Inserts an automation ZRegion to the
  * AutomationTrack at the given index.
@@ -174,6 +192,8 @@ automation_track_insert_region (
   region_set_automation_track (region, self);
   region->id.idx = idx;
   region_update_identifier (region);
+  arranger_object_index_invalidate_all ();
+  invalidate_tempo_map (self);
 }
 
 AutomationTracklist *
@@ -490,6 +510,8 @@ automation_track_remove_region (
 
   array_delete (
     self->regions, self->num_regions, region);
+  arranger_object_index_invalidate_all ();
+  invalidate_tempo_map (self);
 
   for (int i = region->id.idx;
        i < self->num_regions; i++)
@@ -567,6 +589,142 @@ automation_track_set_index (
     }
 }
 
+/**
+ * Returns the normalized value between @p ap and
+ * @p next_ap at the given region-local frames.
+ *
+ * @param next_ap The automation point after @p ap,
+ *   or NULL if @p ap is the last one.
+ */
+static float
+get_normalized_val_in_curve (
+  AutomationPoint * ap,
+  AutomationPoint * next_ap,
+  long              local_frames)
+{
+  if (!next_ap)
+    {
+      return ap->normalized_val;
+    }
+
+  ArrangerObject * ap_obj =
+    (ArrangerObject *) ap;
+  ArrangerObject * next_ap_obj =
+    (ArrangerObject *) next_ap;
+
+  int prev_ap_lower =
+    ap->normalized_val <= next_ap->normalized_val;
+  float cur_next_diff =
+    (float)
+    fabsf (
+      ap->normalized_val - next_ap->normalized_val);
+
+  /* ratio of how far in we are in the curve */
+  long ap_frames =
+    position_to_frames (&ap_obj->pos);
+  long next_ap_frames =
+    position_to_frames (&next_ap_obj->pos);
+  double ratio =
+    next_ap_frames == ap_frames ?
+      1.0 :
+      (double) (local_frames - ap_frames) /
+      (double) (next_ap_frames - ap_frames);
+  g_return_val_if_fail (ratio >= 0, 0.f);
+
+  float result =
+    (float)
+    automation_point_get_normalized_value_in_curve (
+      ap, ratio);
+  result = result * cur_next_diff;
+  if (prev_ap_lower)
+    result +=
+      ap->normalized_val;
+  else
+    result +=
+      next_ap->normalized_val;
+
+  return result;
+}
+
+/**
+ * Gets the normalized value of the automation at
+ * the given global frames.
+ *
+ * The automation point found is remembered, so
+ * that reading consecutive positions (like in the
+ * engine's process cycle) does not need to search
+ * the automation points from scratch.
+ *
+ * @param[out] val The normalized value, if
+ *   automation exists at the given position.
+ *
+ * @return Whether there is automation at the given
+ *   position.
+ */
+bool
+automation_track_get_normalized_val_at_frames (
+  AutomationTrack * self,
+  long              g_frames,
+  float *           val)
+{
+  Position pos;
+  position_from_frames (&pos, g_frames);
+  ZRegion * r =
+    automation_track_get_region_before_pos (
+      self, &pos);
+  if (!r ||
+      r->num_aps == 0 ||
+      arranger_object_get_muted (
+        (ArrangerObject *) r))
+    {
+      return false;
+    }
+
+  long local_frames =
+    region_timeline_frames_to_local (
+      r, g_frames, true);
+
+  /* start from the last automation point read if
+   * in the same region */
+  int idx =
+    r == self->read_region ?
+      CLAMP (self->read_ap_idx, 0, r->num_aps - 1) :
+      r->num_aps - 1;
+
+  /* find the last automation point before or at
+   * the position */
+  while (idx > 0 &&
+         r->aps[idx]->base.pos.frames >
+           local_frames)
+    {
+      idx--;
+    }
+  while (idx < r->num_aps - 1 &&
+         r->aps[idx + 1]->base.pos.frames <=
+           local_frames)
+    {
+      idx++;
+    }
+
+  self->read_region = r;
+  self->read_ap_idx = idx;
+
+  AutomationPoint * ap = r->aps[idx];
+  if (ap->base.pos.frames > local_frames)
+    {
+      return false;
+    }
+
+  *val =
+    get_normalized_val_in_curve (
+      ap,
+      idx < r->num_aps - 1 ?
+        r->aps[idx + 1] : NULL,
+      local_frames);
+
+  return true;
+}
+
 /**
  * Returns the actual parameter value at the given
  * position.
@@ -612,50 +770,16 @@ automation_track_get_val_at_pos (
   AutomationPoint * next_ap =
     automation_region_get_next_ap (
       region, ap, false, false);
-  ArrangerObject * next_ap_obj =
-    (ArrangerObject *) next_ap;
 
   /* return value at last ap */
-  if (!next_ap)
+  if (!next_ap && !normalized)
     {
-      if (normalized)
-        {
-          return ap->normalized_val;
-        }
-      else
-        {
-          return ap->fvalue;
-        }
+      return ap->fvalue;
     }
 
-  int prev_ap_lower =
-    ap->normalized_val <= next_ap->normalized_val;
-  float cur_next_diff =
-    (float)
-    fabsf (
-      ap->normalized_val - next_ap->normalized_val);
-
-  /* ratio of how far in we are in the curve */
-  long ap_frames =
-    position_to_frames (&ap_obj->pos);
-  long next_ap_frames =
-    position_to_frames (&next_ap_obj->pos);
-  double ratio =
-    (double) (localp - ap_frames) /
-    (double) (next_ap_frames - ap_frames);
-  g_return_val_if_fail (ratio >= 0, 0.f);
-
   float result =
-    (float)
-    automation_point_get_normalized_value_in_curve (
-      ap, ratio);
-  result = result * cur_next_diff;
-  if (prev_ap_lower)
-    result +=
-      ap->normalized_val;
-  else
-    result +=
-      next_ap->normalized_val;
+    get_normalized_val_in_curve (
+      ap, next_ap, localp);
 
   if (normalized)
     {
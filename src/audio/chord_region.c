@@ -20,6 +20,7 @@
 #include "audio/chord_region.h"
 #include "audio/chord_object.h"
 #include "audio/chord_track.h"
+#include "audio/midi_region.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "project.h"
@@ -81,6 +82,7 @@ chord_region_add_chord_object (
 
   chord_object_set_region_and_index (
     chord, self, self->num_chord_objects - 1);
+  midi_region_invalidate_note_index (self);
 
   if (fire_events)
     {
@@ -117,6 +119,7 @@ chord_region_remove_chord_object (
   array_delete (
     self->chord_objects, self->num_chord_objects,
     chord);
+  midi_region_invalidate_note_index (self);
 
   if (free)
     {
@@ -151,4 +154,5 @@ chord_region_free_members (
     }
 
   free (self->chord_objects);
+  g_free (self->notes_by_start);
 }
@@ -20,8 +20,12 @@
 #include <stdlib.h>
 
 #include "audio/clip.h"
+#include "audio/clip_peaks.h"
+#include "audio/clip_stream.h"
 #include "audio/encoder.h"
 #include "audio/engine.h"
+#include "audio/pool.h"
+#include "audio/pool_cache.h"
 #include "audio/tempo_track.h"
 #include "project.h"
 #include "utils/audio.h"
@@ -35,35 +39,201 @@
 
 #include <gtk/gtk.h>
 
+typedef struct PeaksThreadData
+{
+  AudioClip * clip;
+  char *      pool_path;
+} PeaksThreadData;
+
 /**
- * Updates the channel caches.
+ * Makes sure the channel caches can hold
+ * @ref AudioClip.num_frames frames.
  *
- * See @ref AudioClip.ch_frames.
+ * The caches grow geometrically, so repeated calls
+ * while appending (eg, when recording) only
+ * reallocate occasionally. Existing frames are
+ * kept and newly allocated frames are zeroed.
  *
- * @param start_from Frames to start from (per
- *   channel. The previous frames will be kept.
+ * See @ref AudioClip.ch_frames.
  */
 void
 audio_clip_update_channel_caches (
+  AudioClip * self)
+{
+  g_return_if_fail (
+    self->channels > 0 && self->num_frames >= 0);
+
+  size_t num_frames = (size_t) self->num_frames;
+  if (num_frames <= self->ch_frames_size &&
+      self->ch_frames[0])
+    return;
+
+  audio_clip_wait_for_peaks (self);
+
+  size_t new_size =
+    MAX (self->ch_frames_size * 2, num_frames);
+  new_size = MAX (new_size, 1);
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      if (self->mapped_file)
+        {
+          /* copy the frames out of the pool cache
+           * mapping */
+          float * frames =
+            malloc (sizeof (float) * new_size);
+          dsp_copy (
+            frames, self->ch_frames[i],
+            self->ch_frames_size);
+          self->ch_frames[i] = frames;
+        }
+      else
+        {
+          self->ch_frames[i] =
+            realloc (
+              self->ch_frames[i],
+              sizeof (float) * new_size);
+        }
+      dsp_fill (
+        &self->ch_frames[i][self->ch_frames_size],
+        0.f, new_size - self->ch_frames_size);
+    }
+  if (self->mapped_file)
+    {
+      g_mapped_file_unref (self->mapped_file);
+      self->mapped_file = NULL;
+    }
+  self->ch_frames_size = new_size;
+}
+
+/**
+ * Frees the frames of the clip, whether they are
+ * streamed, mapped from the pool cache or
+ * allocated.
+ */
+void
+audio_clip_free_frames (
+  AudioClip * self)
+{
+  audio_clip_wait_for_peaks (self);
+
+  if (self->stream)
+    {
+      ClipStream * stream = self->stream;
+      g_atomic_pointer_set (&self->stream, NULL);
+      clip_stream_free (stream);
+    }
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      if (self->mapped_file)
+        {
+          self->ch_frames[i] = NULL;
+        }
+      else
+        {
+          object_zero_and_free (self->ch_frames[i]);
+        }
+    }
+  if (self->mapped_file)
+    {
+      g_mapped_file_unref (self->mapped_file);
+      self->mapped_file = NULL;
+    }
+  self->ch_frames_size = 0;
+}
+
+/**
+ * Copies the given frame range to @p buf,
+ * interleaved.
+ *
+ * Streamed clips are read from the stream, in
+ * which case this is not realtime safe.
+ *
+ * @param buf Buffer with space for
+ *   @p nframes * channels samples.
+ */
+void
+audio_clip_get_interleaved_frames (
   AudioClip * self,
-  size_t      start_from)
+  long        start_frame,
+  size_t      nframes,
+  float *     buf)
+{
+  g_return_if_fail (
+    start_frame >= 0 &&
+    start_frame + (long) nframes <=
+      self->num_frames);
+
+  if (self->stream)
+    {
+      /* read each channel in blocks and
+       * interleave them */
+      float * tmp =
+        malloc (
+          CLIP_STREAM_BLOCK_FRAMES * sizeof (float));
+      for (size_t offset = 0; offset < nframes;
+           offset += CLIP_STREAM_BLOCK_FRAMES)
+        {
+          size_t len =
+            MIN (
+              nframes - offset,
+              CLIP_STREAM_BLOCK_FRAMES);
+          for (channels_t i = 0;
+               i < self->channels; i++)
+            {
+              audio_clip_read_frames (
+                self, i,
+                start_frame + (long) offset, len,
+                tmp);
+              for (size_t j = 0; j < len; j++)
+                {
+                  buf[(offset + j) * self->channels +
+                      i] = tmp[j];
+                }
+            }
+        }
+      free (tmp);
+      return;
+    }
+
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      const float * src =
+        &self->ch_frames[i][start_frame];
+      for (size_t j = 0; j < nframes; j++)
+        {
+          buf[j * self->channels + i] = src[j];
+        }
+    }
+}
+
+/**
+ * Replaces the given frame range with the
+ * interleaved frames in @p arr.
+ *
+ * The range must be inside the clip.
+ */
+void
+audio_clip_set_interleaved_frames (
+  AudioClip *   self,
+  const float * arr,
+  long          start_frame,
+  size_t        nframes)
 {
   g_return_if_fail (
-    self->channels > 0 && self->num_frames > 0);
+    !self->stream && start_frame >= 0 &&
+    start_frame + (long) nframes <=
+      self->num_frames);
+
+  audio_clip_wait_for_peaks (self);
+  g_atomic_int_set (&self->peaks_dirty, 1);
 
-  /* copy the frames to the channel caches */
   for (unsigned int i = 0; i < self->channels; i++)
     {
-      self->ch_frames[i] =
-        realloc (
-          self->ch_frames[i],
-          sizeof (float) *
-            (size_t) self->num_frames);
-      for (size_t j = start_from;
-           j < (size_t) self->num_frames; j++)
+      float * dest =
+        &self->ch_frames[i][start_frame];
+      for (size_t j = 0; j < nframes; j++)
         {
-          self->ch_frames[i][j] =
-            self->frames[j * self->channels + i];
+          dest[j] = arr[j * self->channels + i];
         }
     }
 }
@@ -83,26 +253,19 @@ audio_clip_init_from_file (
     enc, self->samplerate, F_SHOW_PROGRESS);
 
 
-  size_t arr_size =
-    (size_t) enc->num_out_frames *
-    (size_t) enc->nfo.channels;
-  self->frames =
-    realloc (
-      self->frames, arr_size * sizeof (float));
   self->num_frames = enc->num_out_frames;
-  dsp_copy (
-    self->frames, enc->out_frames, arr_size);
+  self->channels = enc->nfo.channels;
+  audio_clip_update_channel_caches (self);
+  audio_clip_set_interleaved_frames (
+    self, enc->out_frames, 0,
+    (size_t) enc->num_out_frames);
   if (self->name)
     {
       g_free (self->name);
     }
   self->name = g_path_get_basename (full_path);
-  self->channels = enc->nfo.channels;
   self->bpm =
     tempo_track_get_current_bpm (P_TEMPO_TRACK);
-  /*g_message (*/
-    /*"\n\n num frames %ld \n\n", self->num_frames);*/
-  audio_clip_update_channel_caches (self, 0);
 
   audio_encoder_free (enc);
 }
@@ -129,8 +292,164 @@ audio_clip_init_loaded (
     g_strdup_printf ("%s.wav", tmp);
 
   bpm_t bpm = self->bpm;
-  audio_clip_init_from_file (self, filepath);
+
+  /* stream large clips from the pool instead of
+   * loading them in memory */
+  ClipStream * stream =
+    AUDIO_POOL->streamer ?
+      clip_stream_new (
+        AUDIO_POOL->streamer, filepath) : NULL;
+  if (stream)
+    {
+      g_free (self->name);
+      self->name = g_path_get_basename (filepath);
+      self->samplerate =
+        (int) AUDIO_ENGINE->sample_rate;
+      self->channels = stream->channels;
+      self->num_frames = stream->num_frames;
+      g_atomic_pointer_set (&self->stream, stream);
+    }
+  /* otherwise map the decoded frames from the
+   * pool cache, or decode the file and cache the
+   * result for next time */
+  else if (!pool_cache_load_clip (self, filepath))
+    {
+      audio_clip_init_from_file (self, filepath);
+      if (self->num_frames > 0)
+        {
+          pool_cache_store_clip (self, filepath);
+        }
+    }
+  self->bpm = bpm;
+
+  /* the frames are the pool file's frames, so
+   * any saved peaks are still valid. this is
+   * already called in a worker thread so generate
+   * the peaks synchronously */
+  g_atomic_int_set (&self->peaks_dirty, 0);
+  audio_clip_generate_peaks (self, false);
+
+  g_free (pool_dir);
+  g_free (noext);
+  g_free (tmp);
+  g_free (filepath);
+}
+
+/**
+ * Loads the whole clip in memory if it is being
+ * streamed.
+ *
+ * To be called before any operation that needs
+ * direct access to @ref AudioClip.ch_frames.
+ */
+void
+audio_clip_ensure_loaded (
+  AudioClip * self)
+{
+  ClipStream * stream = self->stream;
+  if (!stream)
+    return;
+
+  audio_clip_wait_for_peaks (self);
+
+  g_message (
+    "loading streamed clip %s in memory",
+    self->name);
+
+  bpm_t bpm = self->bpm;
+  char * name = g_strdup (self->name);
+  audio_clip_init_from_file (self, stream->path);
   self->bpm = bpm;
+  g_free (self->name);
+  self->name = name;
+
+  g_atomic_pointer_set (&self->stream, NULL);
+  clip_stream_free (stream);
+
+  /* the frames were decoded from the same file */
+  g_atomic_int_set (&self->peaks_dirty, 0);
+}
+
+/**
+ * Copies the frames of the given channel into
+ * @p buf, whether the clip is streamed or not.
+ *
+ * Not realtime safe.
+ */
+void
+audio_clip_read_frames (
+  AudioClip * self,
+  channels_t  channel,
+  long        start_frame,
+  size_t      nframes,
+  float *     buf)
+{
+  g_return_if_fail (
+    channel < self->channels && start_frame >= 0 &&
+    start_frame + (long) nframes <=
+      self->num_frames);
+
+  if (self->stream)
+    {
+      clip_stream_read_blocking (
+        self->stream, channel, start_frame,
+        nframes, buf);
+    }
+  else
+    {
+      dsp_copy (
+        buf, &self->ch_frames[channel][start_frame],
+        nframes);
+    }
+}
+
+/**
+ * Gets the minimum and maximum sample values
+ * across all channels in the given frame range.
+ *
+ * The range is clamped to the clip's bounds and
+ * the results are not larger than 0 (min) and
+ * not smaller than 0 (max).
+ *
+ * Not realtime safe.
+ */
+void
+audio_clip_get_min_max (
+  AudioClip * self,
+  long        start_frame,
+  long        end_frame,
+  float *     min,
+  float *     max)
+{
+  *min = 0.f;
+  *max = 0.f;
+
+  start_frame = MAX (start_frame, 0);
+  end_frame = MIN (end_frame, self->num_frames);
+
+  float buf[4096];
+  for (channels_t i = 0; i < self->channels; i++)
+    {
+      for (long j = start_frame; j < end_frame;
+           j += 4096)
+        {
+          size_t len =
+            (size_t) MIN (end_frame - j, 4096);
+          float * frames;
+          if (self->stream)
+            {
+              clip_stream_read_blocking (
+                self->stream, i, j, len, buf);
+              frames = buf;
+            }
+          else
+            {
+              frames = &self->ch_frames[i][j];
+            }
+          *min = MIN (*min, dsp_min (frames, len));
+          *max = MAX (*max, dsp_max (frames, len));
+        }
+    }
 }
 
 /**
@@ -170,22 +489,17 @@ audio_clip_new_from_float_array (
   AudioClip * self =
     calloc (1, sizeof (AudioClip));
 
-  self->frames =
-    calloc (
-      (size_t) (nframes * (long) channels),
-      sizeof (sample_t));
   self->num_frames = nframes;
   self->channels = channels;
   self->samplerate = (int) AUDIO_ENGINE->sample_rate;
   g_return_val_if_fail (self->samplerate > 0, NULL);
   self->name = g_strdup (name);
   self->pool_id = -1;
-  dsp_copy (
-    self->frames, arr,
-    (size_t) nframes * (size_t) channels);
+  audio_clip_update_channel_caches (self);
+  audio_clip_set_interleaved_frames (
+    self, arr, 0, (size_t) nframes);
   self->bpm =
     tempo_track_get_current_bpm (P_TEMPO_TRACK);
-  audio_clip_update_channel_caches (self, 0);
 
   return self;
 }
@@ -210,10 +524,6 @@ audio_clip_new_recording (
     calloc (1, sizeof (AudioClip));
 
   self->channels = channels;
-  self->frames =
-    calloc (
-      (size_t) (nframes * (long) self->channels),
-      sizeof (sample_t));
   self->num_frames = nframes;
   self->name = g_strdup (name);
   self->pool_id = -1;
@@ -221,14 +531,118 @@ audio_clip_new_recording (
     tempo_track_get_current_bpm (P_TEMPO_TRACK);
   self->samplerate = (int) AUDIO_ENGINE->sample_rate;
   g_return_val_if_fail (self->samplerate > 0, NULL);
-  dsp_fill (
-    self->frames, DENORMAL_PREVENTION_VAL,
-    (size_t) nframes * (size_t) channels);
-  audio_clip_update_channel_caches (self, 0);
+  audio_clip_update_channel_caches (self);
+  for (unsigned int i = 0; i < channels; i++)
+    {
+      dsp_fill (
+        self->ch_frames[i], DENORMAL_PREVENTION_VAL,
+        (size_t) nframes);
+    }
 
   return self;
 }
 
+/**
+ * Generates the peaks and saves them next to the
+ * given pool file.
+ */
+static void
+generate_peaks (
+  AudioClip *  self,
+  const char * pool_path)
+{
+  ClipPeaks * peaks = NULL;
+  if (g_atomic_int_get (&self->peaks_dirty))
+    {
+      g_atomic_int_set (&self->peaks_dirty, 0);
+      peaks = clip_peaks_new_from_clip (self);
+    }
+  else if (clip_peaks_save_clip (self, pool_path))
+    {
+      /* the peaks are up to date (eg, they were
+       * updated while recording) but the file
+       * changed, so only save them again */
+      return;
+    }
+  else
+    {
+      peaks = clip_peaks_load (self, pool_path);
+      if (peaks)
+        {
+          clip_peaks_set (self, peaks);
+          return;
+        }
+      peaks = clip_peaks_new_from_clip (self);
+    }
+
+  clip_peaks_save (peaks, self, pool_path);
+  clip_peaks_set (self, peaks);
+}
+
+static void *
+generate_peaks_thread (
+  void * data)
+{
+  PeaksThreadData * thread_data =
+    (PeaksThreadData *) data;
+  generate_peaks (
+    thread_data->clip, thread_data->pool_path);
+  g_free (thread_data->pool_path);
+  free (thread_data);
+
+  return NULL;
+}
+
+/**
+ * Generates the waveform peaks of the clip and
+ * saves them next to its file in the pool.
+ *
+ * Peaks previously saved for the pool file are
+ * used if they are still valid.
+ *
+ * @param async Whether to generate the peaks in a
+ *   separate thread.
+ */
+void
+audio_clip_generate_peaks (
+  AudioClip * self,
+  bool        async)
+{
+  audio_clip_wait_for_peaks (self);
+
+  char * pool_path =
+    audio_clip_get_path_in_pool (self);
+  if (!async)
+    {
+      generate_peaks (self, pool_path);
+      g_free (pool_path);
+      return;
+    }
+
+  PeaksThreadData * data =
+    object_new (PeaksThreadData);
+  data->clip = self;
+  data->pool_path = pool_path;
+  self->peaks_thread =
+    g_thread_new (
+      "clip_peaks", generate_peaks_thread, data);
+}
+
+/**
+ * Waits for the peaks to finish generating, if
+ * they are being generated.
+ */
+void
+audio_clip_wait_for_peaks (
+  AudioClip * self)
+{
+  if (self->peaks_thread)
+    {
+      g_thread_join (self->peaks_thread);
+      self->peaks_thread = NULL;
+    }
+}
+
 char *
 audio_clip_get_path_in_pool_from_name (
   const char * name)
@@ -289,6 +703,13 @@ audio_clip_write_to_pool (
   audio_clip_write_to_file (
     self, new_path, parts);
   g_free (new_path);
+
+  /* parts are written while recording, where the
+   * peaks are updated as the frames come in */
+  if (!parts)
+    {
+      audio_clip_generate_peaks (self, true);
+    }
 }
 
 /**
@@ -306,18 +727,24 @@ audio_clip_write_to_file (
   bool         parts)
 {
   g_return_val_if_fail (self->samplerate > 0, -1);
-  size_t before_frames =
-    (size_t) self->frames_written;
+
+  /* interleave the frames to write */
+  long start_frame =
+    parts ? self->frames_written : 0;
+  size_t nframes =
+    (size_t) (self->num_frames - start_frame);
+  float * frames =
+    malloc (
+      MAX (nframes, 1) * self->channels *
+      sizeof (float));
+  audio_clip_get_interleaved_frames (
+    self, start_frame, nframes, frames);
   int ret =
     audio_write_raw_file (
-      self->frames, parts ? self->frames_written : 0,
-      parts ?
-        (self->num_frames - self->frames_written) :
-        self->num_frames,
+      frames, start_frame, (long) nframes,
       (uint32_t) self->samplerate,
       self->channels, filepath);
-  audio_clip_update_channel_caches (
-    self, before_frames);
+  free (frames);
 
   if (parts && ret == 0)
     {
@@ -353,10 +780,20 @@ void
 audio_clip_remove_and_free (
   AudioClip * self)
 {
+  /* close the file before removing it */
+  audio_clip_free_frames (self);
+
   char * path =
     audio_clip_get_path_in_pool (self);
   g_debug ("removing clip at %s", path);
   io_remove (path);
+  char * peaks_path = clip_peaks_get_path (path);
+  if (file_exists (peaks_path))
+    {
+      io_remove (peaks_path);
+    }
+  g_free (peaks_path);
+  g_free (path);
 
   audio_clip_free (self);
 }
@@ -368,10 +805,10 @@ void
 audio_clip_free (
   AudioClip * self)
 {
-  object_zero_and_free (self->frames);
-  for (unsigned int i = 0; i < self->channels; i++)
+  audio_clip_free_frames (self);
+  if (self->peaks)
     {
-      object_zero_and_free (self->ch_frames[i]);
+      clip_peaks_free (self->peaks);
     }
   g_free_and_null (self->name);
 
@@ -0,0 +1,710 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/clip.h"
+#include "audio/clip_peaks.h"
+#include "utils/dsp.h"
+#include "utils/objects.h"
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#define CLIP_PEAKS_MAGIC "ZPEAKS1"
+
+/** Number of first-level peaks to calculate at a
+ * time. */
+#define PEAKS_PER_BLOCK 64
+
+/**
+ * Protects the peaks of all clips.
+ *
+ * Peaks are only read while drawing and written
+ * while recording or when replaced, so a single
+ * lock is enough.
+ */
+static GMutex peaks_lock;
+
+/**
+ * Returns the number of frames each peak of the
+ * given level covers.
+ */
+static inline long
+get_level_frames (
+  int level)
+{
+  long frames = CLIP_PEAKS_BASE_FRAMES;
+  for (int i = 0; i < level; i++)
+    frames *= CLIP_PEAKS_LEVEL_FACTOR;
+  return frames;
+}
+
+/**
+ * Creates empty peaks.
+ */
+ClipPeaks *
+clip_peaks_new (void)
+{
+  ClipPeaks * self = object_new (ClipPeaks);
+
+  return self;
+}
+
+/**
+ * Grows the levels to cover the given number of
+ * frames.
+ *
+ * @return The number of levels before growing.
+ */
+static int
+ensure_size (
+  ClipPeaks * self,
+  long        num_frames)
+{
+  int prev_num_levels = self->num_levels;
+  if (num_frames <= self->num_frames)
+    return prev_num_levels;
+
+  self->num_frames = num_frames;
+  size_t num_peaks =
+    (size_t)
+    ((num_frames + CLIP_PEAKS_BASE_FRAMES - 1) /
+       CLIP_PEAKS_BASE_FRAMES);
+  int level = 0;
+  while (level < CLIP_PEAKS_MAX_LEVELS)
+    {
+      if (num_peaks > self->peaks_size[level])
+        {
+          size_t new_size =
+            MAX (
+              num_peaks,
+              self->peaks_size[level] * 2);
+          self->levels[level] =
+            g_realloc_n (
+              self->levels[level], new_size,
+              sizeof (ClipPeak));
+          memset (
+            &self->levels[level][
+              self->peaks_size[level]],
+            0,
+            (new_size - self->peaks_size[level]) *
+              sizeof (ClipPeak));
+          self->peaks_size[level] = new_size;
+        }
+      self->num_peaks[level] = num_peaks;
+      level++;
+
+      if (num_peaks <= 1)
+        break;
+      num_peaks =
+        (num_peaks + CLIP_PEAKS_LEVEL_FACTOR - 1) /
+          CLIP_PEAKS_LEVEL_FACTOR;
+    }
+  self->num_levels = level;
+
+  return prev_num_levels;
+}
+
+/**
+ * Calculates the first-level peaks from @p first
+ * to @p last (inclusive) from the clip's frames.
+ */
+static void
+calc_first_level (
+  ClipPeaks * self,
+  AudioClip * clip,
+  size_t      first,
+  size_t      last)
+{
+  float * buf =
+    malloc (
+      PEAKS_PER_BLOCK * CLIP_PEAKS_BASE_FRAMES *
+        sizeof (float));
+  float mins[PEAKS_PER_BLOCK];
+  float maxes[PEAKS_PER_BLOCK];
+  double sums[PEAKS_PER_BLOCK];
+
+  for (size_t block_start = first;
+       block_start <= last;
+       block_start += PEAKS_PER_BLOCK)
+    {
+      size_t num_peaks =
+        MIN (PEAKS_PER_BLOCK, last + 1 - block_start);
+      long start_frame =
+        (long) block_start * CLIP_PEAKS_BASE_FRAMES;
+      long end_frame =
+        MIN (
+          start_frame +
+            (long) num_peaks * CLIP_PEAKS_BASE_FRAMES,
+          clip->num_frames);
+      for (size_t i = 0; i < num_peaks; i++)
+        {
+          mins[i] = 0.f;
+          maxes[i] = 0.f;
+          sums[i] = 0.0;
+        }
+
+      for (channels_t ch = 0; ch < clip->channels;
+           ch++)
+        {
+          audio_clip_read_frames (
+            clip, ch, start_frame,
+            (size_t) (end_frame - start_frame), buf);
+          for (size_t i = 0; i < num_peaks; i++)
+            {
+              long offset =
+                (long) i * CLIP_PEAKS_BASE_FRAMES;
+              size_t len =
+                (size_t)
+                MIN (
+                  CLIP_PEAKS_BASE_FRAMES,
+                  end_frame - start_frame - offset);
+              float * frames = &buf[offset];
+              mins[i] =
+                MIN (mins[i], dsp_min (frames, len));
+              maxes[i] =
+                MAX (maxes[i], dsp_max (frames, len));
+              for (size_t j = 0; j < len; j++)
+                {
+                  sums[i] +=
+                    (double) frames[j] *
+                    (double) frames[j];
+                }
+            }
+        }
+
+      for (size_t i = 0; i < num_peaks; i++)
+        {
+          long offset =
+            (long) i * CLIP_PEAKS_BASE_FRAMES;
+          long len =
+            MIN (
+              CLIP_PEAKS_BASE_FRAMES,
+              end_frame - start_frame - offset);
+          ClipPeak * peak =
+            &self->levels[0][block_start + i];
+          peak->min = mins[i];
+          peak->max = maxes[i];
+          peak->rms =
+            (float)
+            sqrt (
+              sums[i] /
+              (double) (len * clip->channels));
+        }
+    }
+
+  free (buf);
+}
+
+/**
+ * Calculates the peaks of the given level from
+ * @p first to @p last (inclusive) from the
+ * previous level.
+ */
+static void
+calc_level (
+  ClipPeaks * self,
+  int         level,
+  size_t      first,
+  size_t      last)
+{
+  ClipPeak * children = self->levels[level - 1];
+  size_t num_children = self->num_peaks[level - 1];
+  long child_frames = get_level_frames (level - 1);
+  for (size_t i = first; i <= last; i++)
+    {
+      size_t child_start =
+        i * CLIP_PEAKS_LEVEL_FACTOR;
+      size_t child_end =
+        MIN (
+          child_start + CLIP_PEAKS_LEVEL_FACTOR,
+          num_children);
+      ClipPeak * peak = &self->levels[level][i];
+      peak->min = 0.f;
+      peak->max = 0.f;
+      double sum = 0.0;
+      long frames = 0;
+      for (size_t j = child_start; j < child_end; j++)
+        {
+          ClipPeak * child = &children[j];
+          long len =
+            MIN (
+              child_frames,
+              self->num_frames -
+                (long) j * child_frames);
+          peak->min = MIN (peak->min, child->min);
+          peak->max = MAX (peak->max, child->max);
+          sum +=
+            (double) child->rms *
+            (double) child->rms * (double) len;
+          frames += len;
+        }
+      peak->rms =
+        frames > 0 ?
+          (float) sqrt (sum / (double) frames) : 0.f;
+    }
+}
+
+/**
+ * Recalculates the peaks of the given frame range
+ * of the clip, growing the peaks to the clip's
+ * current number of frames if needed.
+ *
+ * Used to update the peaks incrementally (eg,
+ * while recording).
+ */
+void
+clip_peaks_update (
+  ClipPeaks * self,
+  AudioClip * clip,
+  long        start_frame,
+  long        end_frame)
+{
+  int prev_num_levels =
+    ensure_size (self, clip->num_frames);
+
+  start_frame = MAX (start_frame, 0);
+  end_frame = MIN (end_frame, clip->num_frames);
+  if (end_frame > start_frame)
+    {
+      size_t first =
+        (size_t)
+        (start_frame / CLIP_PEAKS_BASE_FRAMES);
+      size_t last =
+        (size_t)
+        ((end_frame - 1) / CLIP_PEAKS_BASE_FRAMES);
+      calc_first_level (self, clip, first, last);
+      for (int level = 1;
+           level < prev_num_levels; level++)
+        {
+          first /= CLIP_PEAKS_LEVEL_FACTOR;
+          last /= CLIP_PEAKS_LEVEL_FACTOR;
+          calc_level (self, level, first, last);
+        }
+    }
+
+  /* levels that were just added */
+  for (int level = MAX (prev_num_levels, 1);
+       level < self->num_levels; level++)
+    {
+      calc_level (
+        self, level, 0,
+        self->num_peaks[level] - 1);
+    }
+}
+
+/**
+ * Creates the peaks of all the frames of the
+ * given clip.
+ *
+ * Not realtime safe.
+ */
+ClipPeaks *
+clip_peaks_new_from_clip (
+  AudioClip * clip)
+{
+  ClipPeaks * self = clip_peaks_new ();
+  ensure_size (self, clip->num_frames);
+  if (self->num_levels == 0)
+    return self;
+
+  calc_first_level (
+    self, clip, 0, self->num_peaks[0] - 1);
+  for (int level = 1; level < self->num_levels;
+       level++)
+    {
+      calc_level (
+        self, level, 0,
+        self->num_peaks[level] - 1);
+    }
+
+  return self;
+}
+
+/**
+ * Returns the path of the peaks file of the given
+ * pool file.
+ */
+char *
+clip_peaks_get_path (
+  const char * pool_path)
+{
+  return
+    g_strdup_printf (
+      "%s%s", pool_path, CLIP_PEAKS_FILE_EXT);
+}
+
+/**
+ * Loads the peaks saved for the given pool file.
+ *
+ * @return The peaks, or NULL if there are no
+ *   valid peaks for the file's current contents.
+ */
+ClipPeaks *
+clip_peaks_load (
+  AudioClip *  clip,
+  const char * pool_path)
+{
+  GStatBuf st;
+  if (g_stat (pool_path, &st) != 0)
+    return NULL;
+
+  char * path = clip_peaks_get_path (pool_path);
+  char * contents = NULL;
+  gsize length = 0;
+  bool loaded =
+    g_file_get_contents (
+      path, &contents, &length, NULL);
+  g_free (path);
+  if (!loaded)
+    return NULL;
+
+  const ClipPeaksHeader * header =
+    (const ClipPeaksHeader *) contents;
+  size_t num_peaks =
+    (size_t)
+    ((clip->num_frames +
+        CLIP_PEAKS_BASE_FRAMES - 1) /
+      CLIP_PEAKS_BASE_FRAMES);
+  if (length < sizeof (ClipPeaksHeader) ||
+      memcmp (
+        header->magic, CLIP_PEAKS_MAGIC,
+        sizeof (header->magic)) != 0 ||
+      header->version != CLIP_PEAKS_VERSION ||
+      header->channels != clip->channels ||
+      header->num_frames != clip->num_frames ||
+      header->pool_file_size !=
+        (gint64) st.st_size ||
+      header->pool_file_mtime !=
+        (gint64) st.st_mtime ||
+      length !=
+        sizeof (ClipPeaksHeader) +
+          num_peaks * sizeof (ClipPeak))
+    {
+      g_free (contents);
+      return NULL;
+    }
+
+  ClipPeaks * self = clip_peaks_new ();
+  ensure_size (self, clip->num_frames);
+  if (num_peaks > 0)
+    {
+      memcpy (
+        self->levels[0],
+        &contents[sizeof (ClipPeaksHeader)],
+        num_peaks * sizeof (ClipPeak));
+    }
+  g_free (contents);
+
+  /* the other levels are quick to calculate */
+  for (int level = 1; level < self->num_levels;
+       level++)
+    {
+      calc_level (
+        self, level, 0,
+        self->num_peaks[level] - 1);
+    }
+
+  return self;
+}
+
+/**
+ * Serializes the base level of the peaks into a
+ * newly allocated buffer to be written to the
+ * peaks file.
+ *
+ * Does no I/O, so it can be called with the peaks
+ * lock held.
+ *
+ * @param st The stat of the pool file.
+ */
+static char *
+serialize (
+  ClipPeaks *      self,
+  AudioClip *      clip,
+  const GStatBuf * st,
+  size_t *         length)
+{
+  size_t num_peaks =
+    self->num_levels > 0 ? self->num_peaks[0] : 0;
+  *length =
+    sizeof (ClipPeaksHeader) +
+      num_peaks * sizeof (ClipPeak);
+  char * contents = g_malloc0 (*length);
+  ClipPeaksHeader * header =
+    (ClipPeaksHeader *) contents;
+  memcpy (
+    header->magic, CLIP_PEAKS_MAGIC,
+    sizeof (header->magic));
+  header->version = CLIP_PEAKS_VERSION;
+  header->channels = clip->channels;
+  header->num_frames = self->num_frames;
+  header->pool_file_size = (gint64) st->st_size;
+  header->pool_file_mtime = (gint64) st->st_mtime;
+  if (num_peaks > 0)
+    {
+      memcpy (
+        &contents[sizeof (ClipPeaksHeader)],
+        self->levels[0],
+        num_peaks * sizeof (ClipPeak));
+    }
+
+  return contents;
+}
+
+static void
+write_contents (
+  const char * pool_path,
+  const char * contents,
+  size_t       length)
+{
+  char * path = clip_peaks_get_path (pool_path);
+  GError * err = NULL;
+  if (!g_file_set_contents (
+         path, contents, (gssize) length, &err))
+    {
+      g_warning (
+        "failed to save peaks to %s: %s",
+        path, err->message);
+      g_error_free (err);
+    }
+  g_free (path);
+}
+
+/**
+ * Saves the peaks next to the given pool file.
+ *
+ * The peaks must not be shared with other
+ * threads. Use clip_peaks_save_clip() for the
+ * peaks of a clip.
+ */
+void
+clip_peaks_save (
+  ClipPeaks *  self,
+  AudioClip *  clip,
+  const char * pool_path)
+{
+  GStatBuf st;
+  if (g_stat (pool_path, &st) != 0)
+    return;
+
+  size_t length;
+  char * contents =
+    serialize (self, clip, &st, &length);
+  write_contents (pool_path, contents, length);
+  g_free (contents);
+}
+
+/**
+ * Saves the current peaks of the clip next to the
+ * given pool file.
+ *
+ * The peaks lock is only held while copying the
+ * peaks, not during the file I/O.
+ *
+ * @return Whether the clip had peaks to save.
+ */
+bool
+clip_peaks_save_clip (
+  AudioClip *  clip,
+  const char * pool_path)
+{
+  GStatBuf st;
+  if (g_stat (pool_path, &st) != 0)
+    return g_atomic_pointer_get (&clip->peaks) != NULL;
+
+  ClipPeaks * peaks = clip_peaks_acquire (clip);
+  if (!peaks)
+    return false;
+
+  size_t length;
+  char * contents =
+    serialize (peaks, clip, &st, &length);
+  clip_peaks_release ();
+
+  write_contents (pool_path, contents, length);
+  g_free (contents);
+
+  return true;
+}
+
+/**
+ * Returns the level to use when each pixel
+ * covers the given number of frames, or -1 if the
+ * frames should be read directly.
+ */
+int
+clip_peaks_get_level (
+  ClipPeaks * self,
+  double      frames_per_px)
+{
+  int level = -1;
+  for (int i = 0; i < self->num_levels; i++)
+    {
+      if ((double) get_level_frames (i) >
+            frames_per_px)
+        break;
+      level = i;
+    }
+
+  return level;
+}
+
+/**
+ * Gets the minimum and maximum sample values and
+ * the RMS in the given frame range using the
+ * peaks of the given level.
+ *
+ * The results are the same as
+ * audio_clip_get_min_max(), except that the
+ * range is extended to the bounds of the peaks.
+ *
+ * @param rms RMS to fill in, or NULL.
+ */
+void
+clip_peaks_get_min_max (
+  ClipPeaks * self,
+  int         level,
+  long        start_frame,
+  long        end_frame,
+  float *     min,
+  float *     max,
+  float *     rms)
+{
+  *min = 0.f;
+  *max = 0.f;
+  if (rms)
+    *rms = 0.f;
+
+  g_return_if_fail (
+    level >= 0 && level < self->num_levels);
+
+  start_frame = MAX (start_frame, 0);
+  end_frame = MIN (end_frame, self->num_frames);
+  if (end_frame <= start_frame)
+    return;
+
+  long level_frames = get_level_frames (level);
+  size_t first = (size_t) (start_frame / level_frames);
+  size_t last =
+    (size_t) ((end_frame - 1) / level_frames);
+  ClipPeak * peaks = self->levels[level];
+  double sum = 0.0;
+  for (size_t i = first; i <= last; i++)
+    {
+      *min = MIN (*min, peaks[i].min);
+      *max = MAX (*max, peaks[i].max);
+      sum +=
+        (double) peaks[i].rms *
+        (double) peaks[i].rms;
+    }
+  if (rms)
+    {
+      *rms =
+        (float)
+        sqrt (sum / (double) (last + 1 - first));
+    }
+}
+
+/**
+ * Returns the peaks of the clip with the peaks
+ * lock held, or NULL if the clip has no peaks
+ * yet.
+ *
+ * The lock must be released with
+ * clip_peaks_release() when done.
+ */
+ClipPeaks *
+clip_peaks_acquire (
+  AudioClip * clip)
+{
+  g_mutex_lock (&peaks_lock);
+  if (!clip->peaks)
+    {
+      g_mutex_unlock (&peaks_lock);
+      return NULL;
+    }
+
+  return clip->peaks;
+}
+
+/**
+ * Releases the lock taken by clip_peaks_acquire().
+ */
+void
+clip_peaks_release (void)
+{
+  g_mutex_unlock (&peaks_lock);
+}
+
+/**
+ * Replaces the peaks of the clip and frees the
+ * previous ones.
+ */
+void
+clip_peaks_set (
+  AudioClip * clip,
+  ClipPeaks * peaks)
+{
+  g_mutex_lock (&peaks_lock);
+  ClipPeaks * prev_peaks = clip->peaks;
+  clip->peaks = peaks;
+  g_mutex_unlock (&peaks_lock);
+
+  if (prev_peaks)
+    {
+      clip_peaks_free (prev_peaks);
+    }
+}
+
+/**
+ * Updates the peaks of the clip after the given
+ * frame range was recorded, creating them if
+ * needed.
+ */
+void
+clip_peaks_update_clip (
+  AudioClip * clip,
+  long        start_frame,
+  long        end_frame)
+{
+  g_mutex_lock (&peaks_lock);
+  if (!clip->peaks)
+    {
+      clip->peaks = clip_peaks_new ();
+    }
+  clip_peaks_update (
+    clip->peaks, clip, start_frame, end_frame);
+  g_mutex_unlock (&peaks_lock);
+}
+
+void
+clip_peaks_free (
+  ClipPeaks * self)
+{
+  for (int i = 0; i < CLIP_PEAKS_MAX_LEVELS; i++)
+    {
+      g_free (self->levels[i]);
+    }
+
+  object_zero_and_free (self);
+}
@@ -0,0 +1,715 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/clip_stream.h"
+#include "audio/engine.h"
+#include "project.h"
+#include "settings/settings.h"
+#include "utils/dsp.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include <gtk/gtk.h>
+
+/** Maximum number of channels of a streamed clip. */
+#define MAX_CHANNELS 16
+
+/**
+ * An evicted block waiting for the engine to
+ * finish the cycle it was last visible in.
+ */
+typedef struct RetiredBlock
+{
+  float * data;
+  long    cycle;
+} RetiredBlock;
+
+static inline size_t
+get_block_bytes (
+  ClipStream * self)
+{
+  return
+    sizeof (float) * self->channels *
+    CLIP_STREAM_BLOCK_FRAMES;
+}
+
+static inline gint
+get_current_cycle (void)
+{
+  return
+    AUDIO_ENGINE ? (gint) AUDIO_ENGINE->cycle : 0;
+}
+
+/**
+ * Returns whether the engine can no longer be
+ * reading data that was made unreachable during
+ * the given cycle.
+ */
+static bool
+engine_done_with_cycle (
+  long cycle)
+{
+  return
+    !AUDIO_ENGINE ||
+    !g_atomic_int_get (
+      &AUDIO_ENGINE->cycle_running) ||
+    AUDIO_ENGINE->cycle > cycle + 1;
+}
+
+/**
+ * Frees the retired blocks that the engine is
+ * done with.
+ *
+ * Must be called with the lock held.
+ */
+static void
+free_retired (
+  ClipStreamer * self)
+{
+  RetiredBlock * retired;
+  while ((retired =
+            g_queue_peek_head (self->retired)) &&
+         engine_done_with_cycle (retired->cycle))
+    {
+      g_queue_pop_head (self->retired);
+      free (retired->data);
+      free (retired);
+    }
+}
+
+/**
+ * Makes the given block unreachable and queues its
+ * data for freeing.
+ *
+ * Must be called with the lock held.
+ */
+static void
+evict_block (
+  ClipStreamer * self,
+  ClipStream *   stream,
+  size_t         block)
+{
+  float * data =
+    g_atomic_pointer_get (&stream->blocks[block]);
+  if (!data)
+    return;
+
+  g_atomic_pointer_set (
+    &stream->blocks[block], NULL);
+
+  RetiredBlock * retired =
+    object_new (RetiredBlock);
+  retired->data = data;
+  retired->cycle =
+    AUDIO_ENGINE ? AUDIO_ENGINE->cycle : 0;
+  g_queue_push_tail (self->retired, retired);
+
+  self->used_bytes -= get_block_bytes (stream);
+}
+
+/**
+ * Evicts the least recently used blocks until
+ * there is room for @p bytes more.
+ *
+ * Must be called with the lock held.
+ */
+static void
+make_room (
+  ClipStreamer * self,
+  size_t         bytes)
+{
+  gint cur_cycle = get_current_cycle ();
+  while (self->used_bytes + bytes > self->max_bytes)
+    {
+      ClipStream * lru_stream = NULL;
+      size_t lru_block = 0;
+      gint lru_age = G_MININT;
+      for (size_t i = 0; i < self->streams->len;
+           i++)
+        {
+          ClipStream * stream =
+            g_ptr_array_index (self->streams, i);
+          for (size_t j = 0; j < stream->num_blocks;
+               j++)
+            {
+              if (!g_atomic_pointer_get (
+                     &stream->blocks[j]) ||
+                  g_atomic_int_get (
+                    &stream->requested[j]))
+                continue;
+
+              gint age =
+                cur_cycle -
+                g_atomic_int_get (
+                  &stream->last_used[j]);
+              if (age > lru_age)
+                {
+                  lru_age = age;
+                  lru_stream = stream;
+                  lru_block = j;
+                }
+            }
+        }
+
+      if (!lru_stream)
+        {
+          if (!self->warned_over_budget)
+            {
+              g_message (
+                "clip streaming cache is over "
+                "budget (%zu MiB in use)",
+                self->used_bytes / (1024 * 1024));
+              self->warned_over_budget = true;
+            }
+          return;
+        }
+
+      evict_block (self, lru_stream, lru_block);
+    }
+}
+
+/**
+ * Reads the given block from the file.
+ *
+ * Must be called with the lock held.
+ *
+ * @return The block data, or NULL on failure.
+ */
+static float *
+load_block (
+  ClipStreamer * self,
+  ClipStream *   stream,
+  size_t         block)
+{
+  float * data =
+    g_atomic_pointer_get (&stream->blocks[block]);
+  if (data)
+    return data;
+
+  size_t bytes = get_block_bytes (stream);
+  make_room (self, bytes);
+
+  sf_count_t start_frame =
+    (sf_count_t) block * CLIP_STREAM_BLOCK_FRAMES;
+  if (sf_seek (
+        stream->file, start_frame, SEEK_SET) < 0)
+    {
+      g_warning (
+        "failed to seek to %ld in %s",
+        (long) start_frame, stream->path);
+      return NULL;
+    }
+  sf_count_t read =
+    sf_readf_float (
+      stream->file, self->read_buf,
+      CLIP_STREAM_BLOCK_FRAMES);
+  if (read < 0)
+    read = 0;
+
+  /* deinterleave */
+  data = calloc (1, bytes);
+  for (channels_t i = 0; i < stream->channels; i++)
+    {
+      float * ch_data =
+        &data[i * CLIP_STREAM_BLOCK_FRAMES];
+      for (sf_count_t j = 0; j < read; j++)
+        {
+          ch_data[j] =
+            self->read_buf[
+              j * stream->channels + i];
+        }
+    }
+
+  g_atomic_int_set (
+    &stream->last_used[block],
+    get_current_cycle ());
+  g_atomic_pointer_set (
+    &stream->blocks[block], data);
+  self->used_bytes += bytes;
+
+  return data;
+}
+
+/**
+ * Loads the requested blocks of the given stream.
+ *
+ * Must be called with the lock held.
+ */
+static void
+load_requested_blocks (
+  ClipStreamer * self,
+  ClipStream *   stream)
+{
+  if (!g_atomic_int_compare_and_exchange (
+         &stream->has_requests, 1, 0))
+    return;
+
+  for (size_t i = 0; i < stream->num_blocks; i++)
+    {
+      if (!g_atomic_int_get (&stream->requested[i]))
+        continue;
+
+      load_block (self, stream, i);
+      g_atomic_int_set (&stream->requested[i], 0);
+    }
+}
+
+/**
+ * Flags the stream as having requested blocks and
+ * wakes up the read-ahead thread if it was not
+ * flagged already.
+ */
+REALTIME
+static inline void
+request_blocks (
+  ClipStream * self)
+{
+  if (g_atomic_int_compare_and_exchange (
+        &self->has_requests, 0, 1))
+    {
+      zix_sem_post (
+        &self->streamer->requests_sem);
+    }
+}
+
+static gpointer
+read_ahead_thread (
+  gpointer data)
+{
+  ClipStreamer * self = (ClipStreamer *) data;
+
+  while (g_atomic_int_get (&self->run))
+    {
+      /* sleep until blocks are requested. evicted
+       * blocks are freed on the next wakeup */
+      zix_sem_wait (&self->requests_sem);
+      if (!g_atomic_int_get (&self->run))
+        break;
+
+      g_mutex_lock (&self->lock);
+      free_retired (self);
+      for (size_t i = 0; i < self->streams->len;
+           i++)
+        {
+          load_requested_blocks (
+            self,
+            g_ptr_array_index (self->streams, i));
+        }
+      g_mutex_unlock (&self->lock);
+    }
+
+  return NULL;
+}
+
+/**
+ * Creates a new streamer.
+ *
+ * The read-ahead thread is started when the first
+ * stream is registered.
+ */
+ClipStreamer *
+clip_streamer_new (void)
+{
+  ClipStreamer * self = object_new (ClipStreamer);
+
+  int cache_size =
+    ZRYTHM_TESTING ?
+      CLIP_STREAM_DEFAULT_CACHE_SIZE :
+      g_settings_get_int (
+        S_P_GENERAL_ENGINE,
+        "clip-streaming-cache-size");
+  int threshold =
+    ZRYTHM_TESTING ? -1 :
+      g_settings_get_int (
+        S_P_GENERAL_ENGINE,
+        "clip-streaming-threshold");
+  self->max_bytes =
+    (size_t) cache_size * 1024 * 1024;
+  self->min_clip_bytes =
+    threshold < 0 ?
+      -1 : (gint64) threshold * 1024 * 1024;
+
+  self->streams = g_ptr_array_new ();
+  self->retired = g_queue_new ();
+  g_mutex_init (&self->lock);
+  self->read_buf =
+    calloc (
+      MAX_CHANNELS * CLIP_STREAM_BLOCK_FRAMES,
+      sizeof (float));
+
+  zix_sem_init (&self->requests_sem, 0);
+  g_atomic_int_set (&self->run, 1);
+
+  return self;
+}
+
+/**
+ * Returns whether a clip with the given size
+ * should be streamed instead of being fully
+ * loaded.
+ */
+bool
+clip_streamer_should_stream (
+  ClipStreamer * self,
+  channels_t     channels,
+  long           num_frames)
+{
+  if (self->min_clip_bytes < 0 ||
+      channels == 0 || channels > MAX_CHANNELS)
+    return false;
+
+  gint64 bytes =
+    (gint64) sizeof (float) * channels * num_frames;
+  return bytes >= self->min_clip_bytes;
+}
+
+/**
+ * Opens the given file for streaming.
+ *
+ * @return The stream, or NULL if the file does not
+ *   match the engine's sample rate, is too small
+ *   to be streamed or could not be opened.
+ */
+ClipStream *
+clip_stream_new (
+  ClipStreamer * streamer,
+  const char *   path)
+{
+  SF_INFO info;
+  memset (&info, 0, sizeof (SF_INFO));
+  SNDFILE * file = sf_open (path, SFM_READ, &info);
+  if (!file)
+    {
+      return NULL;
+    }
+  if (info.samplerate !=
+        (int) AUDIO_ENGINE->sample_rate ||
+      !clip_streamer_should_stream (
+        streamer, (channels_t) info.channels,
+        (long) info.frames))
+    {
+      sf_close (file);
+      return NULL;
+    }
+
+  ClipStream * self = object_new (ClipStream);
+  self->path = g_strdup (path);
+  self->file = file;
+  self->channels = (channels_t) info.channels;
+  self->num_frames = (long) info.frames;
+  self->num_blocks =
+    ((size_t) info.frames +
+       CLIP_STREAM_BLOCK_FRAMES - 1) /
+    CLIP_STREAM_BLOCK_FRAMES;
+  self->blocks =
+    calloc (self->num_blocks, sizeof (float *));
+  self->last_used =
+    calloc (self->num_blocks, sizeof (gint));
+  self->requested =
+    calloc (self->num_blocks, sizeof (gint));
+  self->streamer = streamer;
+
+  g_message (
+    "streaming %s (%ld frames, %zu blocks)",
+    path, self->num_frames, self->num_blocks);
+
+  g_mutex_lock (&streamer->lock);
+  g_ptr_array_add (streamer->streams, self);
+  g_atomic_int_inc (&streamer->num_streams);
+  if (!streamer->thread)
+    {
+      streamer->thread =
+        g_thread_new (
+          "clip_streamer", read_ahead_thread,
+          streamer);
+    }
+  g_mutex_unlock (&streamer->lock);
+
+  return self;
+}
+
+/**
+ * Copies @p nframes frames of the given channel
+ * starting at @p start_frame into @p buf.
+ *
+ * Blocks that are not loaded yet are filled with
+ * silence and requested from the read-ahead
+ * thread. When exporting, missing blocks are
+ * loaded synchronously instead.
+ *
+ * @return Whether all frames were available.
+ */
+REALTIME
+bool
+clip_stream_read (
+  ClipStream * self,
+  channels_t   channel,
+  long         start_frame,
+  size_t       nframes,
+  float *      buf)
+{
+  g_return_val_if_fail (
+    channel < self->channels && start_frame >= 0 &&
+    start_frame + (long) nframes <=
+      self->num_frames, false);
+
+  gint cur_cycle = get_current_cycle ();
+  bool complete = true;
+  size_t i = 0;
+  while (i < nframes)
+    {
+      long frame = start_frame + (long) i;
+      size_t block =
+        (size_t) frame / CLIP_STREAM_BLOCK_FRAMES;
+      size_t offset =
+        (size_t) frame % CLIP_STREAM_BLOCK_FRAMES;
+      size_t len =
+        MIN (
+          nframes - i,
+          CLIP_STREAM_BLOCK_FRAMES - offset);
+
+      float * data =
+        g_atomic_pointer_get (&self->blocks[block]);
+      if (!data &&
+          g_atomic_int_get (&AUDIO_ENGINE->exporting))
+        {
+          /* not realtime, read the block now */
+          g_mutex_lock (&self->streamer->lock);
+          load_block (self->streamer, self, block);
+          g_mutex_unlock (&self->streamer->lock);
+          data =
+            g_atomic_pointer_get (
+              &self->blocks[block]);
+        }
+
+      if (data)
+        {
+          dsp_copy (
+            &buf[i],
+            &data[
+              channel * CLIP_STREAM_BLOCK_FRAMES +
+              offset],
+            len);
+          g_atomic_int_set (
+            &self->last_used[block], cur_cycle);
+        }
+      else
+        {
+          dsp_fill (&buf[i], 0.f, len);
+          g_atomic_int_set (
+            &self->requested[block], 1);
+          request_blocks (self);
+          complete = false;
+        }
+
+      i += len;
+    }
+
+  return complete;
+}
+
+/**
+ * Hints the read-ahead thread that the given
+ * frames will be read soon.
+ */
+REALTIME
+void
+clip_stream_prefetch (
+  ClipStream * self,
+  long         start_frame,
+  size_t       nframes)
+{
+  if (start_frame >= self->num_frames ||
+      start_frame + (long) nframes <= 0)
+    return;
+
+  long end_frame =
+    MIN (
+      start_frame + (long) nframes,
+      self->num_frames);
+  start_frame = MAX (start_frame, 0);
+
+  gint cur_cycle = get_current_cycle ();
+  bool requested = false;
+  for (size_t block =
+         (size_t) start_frame /
+           CLIP_STREAM_BLOCK_FRAMES;
+       block <=
+         (size_t) (end_frame - 1) /
+           CLIP_STREAM_BLOCK_FRAMES;
+       block++)
+    {
+      if (g_atomic_pointer_get (
+            &self->blocks[block]))
+        {
+          /* keep it from being evicted */
+          g_atomic_int_set (
+            &self->last_used[block], cur_cycle);
+        }
+      else if (!g_atomic_int_get (
+                  &self->requested[block]))
+        {
+          g_atomic_int_set (
+            &self->requested[block], 1);
+          requested = true;
+        }
+    }
+
+  if (requested)
+    {
+      request_blocks (self);
+    }
+}
+
+/**
+ * Non-realtime version of clip_stream_read()
+ * that loads any missing blocks before reading.
+ */
+void
+clip_stream_read_blocking (
+  ClipStream * self,
+  channels_t   channel,
+  long         start_frame,
+  size_t       nframes,
+  float *      buf)
+{
+  g_return_if_fail (
+    channel < self->channels && start_frame >= 0 &&
+    start_frame + (long) nframes <=
+      self->num_frames);
+
+  g_mutex_lock (&self->streamer->lock);
+  size_t i = 0;
+  while (i < nframes)
+    {
+      long frame = start_frame + (long) i;
+      size_t block =
+        (size_t) frame / CLIP_STREAM_BLOCK_FRAMES;
+      size_t offset =
+        (size_t) frame % CLIP_STREAM_BLOCK_FRAMES;
+      size_t len =
+        MIN (
+          nframes - i,
+          CLIP_STREAM_BLOCK_FRAMES - offset);
+
+      float * data =
+        load_block (self->streamer, self, block);
+      if (data)
+        {
+          dsp_copy (
+            &buf[i],
+            &data[
+              channel * CLIP_STREAM_BLOCK_FRAMES +
+              offset],
+            len);
+        }
+      else
+        {
+          dsp_fill (&buf[i], 0.f, len);
+        }
+
+      i += len;
+    }
+  g_mutex_unlock (&self->streamer->lock);
+}
+
+/**
+ * Unregisters the stream from its streamer and
+ * frees it once the engine is no longer reading
+ * from it.
+ */
+void
+clip_stream_free (
+  ClipStream * self)
+{
+  ClipStreamer * streamer = self->streamer;
+
+  g_mutex_lock (&streamer->lock);
+  if (g_ptr_array_remove (streamer->streams, self))
+    {
+      g_atomic_int_add (&streamer->num_streams, -1);
+    }
+  g_mutex_unlock (&streamer->lock);
+
+  /* wait for the engine to stop using the
+   * stream */
+  long cycle = AUDIO_ENGINE ? AUDIO_ENGINE->cycle : 0;
+  while (!engine_done_with_cycle (cycle))
+    {
+      g_usleep (1000);
+    }
+
+  g_mutex_lock (&streamer->lock);
+  for (size_t i = 0; i < self->num_blocks; i++)
+    {
+      if (self->blocks[i])
+        {
+          streamer->used_bytes -=
+            get_block_bytes (self);
+          free (self->blocks[i]);
+        }
+    }
+  g_mutex_unlock (&streamer->lock);
+
+  sf_close (self->file);
+  g_free_and_null (self->path);
+  object_zero_and_free (self->blocks);
+  free ((void *) self->last_used);
+  free ((void *) self->requested);
+
+  object_zero_and_free (self);
+}
+
+/**
+ * Stops the read-ahead thread and frees the
+ * streamer.
+ *
+ * All streams must be freed before calling this.
+ */
+void
+clip_streamer_free (
+  ClipStreamer * self)
+{
+  g_atomic_int_set (&self->run, 0);
+  if (self->thread)
+    {
+      zix_sem_post (&self->requests_sem);
+      g_thread_join (self->thread);
+    }
+
+  g_warn_if_fail (self->streams->len == 0);
+  g_ptr_array_unref (self->streams);
+
+  RetiredBlock * retired;
+  while ((retired =
+            g_queue_pop_head (self->retired)))
+    {
+      free (retired->data);
+      free (retired);
+    }
+  g_queue_free (self->retired);
+  g_mutex_clear (&self->lock);
+  zix_sem_destroy (&self->requests_sem);
+  object_zero_and_free (self->read_buf);
+
+  object_zero_and_free (self);
+}
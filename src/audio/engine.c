@@ -80,6 +80,7 @@
 #include "project.h"
 #include "settings/settings.h"
 #include "utils/objects.h"
+#include "utils/rt_trace.h"
 #include "utils/string.h"
 #include "utils/ui.h"
 #include "zrythm.h"
@@ -897,7 +898,7 @@ engine_process_prepare (
   if (self->transport->play_state ==
         PLAYSTATE_PAUSE_REQUESTED)
     {
-      g_message ("pause requested handled");
+      rt_message ("pause requested handled");
       self->transport->play_state = PLAYSTATE_PAUSED;
       /*zix_sem_post (&TRANSPORT->paused);*/
 #ifdef HAVE_JACK
@@ -915,7 +916,7 @@ engine_process_prepare (
       self->remaining_latency_preroll =
         router_get_max_route_playback_latency (
           self->router);
-      g_message (
+      rt_message (
         "starting playback, remaining latency "
         "preroll: %u",
         self->remaining_latency_preroll);
@@ -949,7 +950,7 @@ engine_process_prepare (
 
   if (!lock_acquired && !self->exporting)
     {
-      g_message (
+      rt_message (
         "port operation lock is busy, skipping "
         "cycle...");
       self->skip_cycle = 1;
@@ -1209,7 +1210,7 @@ engine_process (
     }
 #endif
 
-  /*self->cycle++;*/
+  self->cycle++;
 
   g_atomic_int_set (&self->cycle_running, 0);
 
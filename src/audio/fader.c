@@ -415,6 +415,7 @@ fader_set_soloed (
   else
     {
       self->solo = solo;
+      tracklist_update_solo_state (TRACKLIST);
 
       if (fire_events)
         {
@@ -750,15 +751,24 @@ fader_process (
       /* if prefader */
       if (self->passthrough)
         {
-          /* copy the input to output */
-          dsp_copy (
-            &self->stereo_out->l->buf[start_frame],
-            &self->stereo_in->l->buf[start_frame],
-            nframes);
-          dsp_copy (
-            &self->stereo_out->r->buf[start_frame],
-            &self->stereo_in->r->buf[start_frame],
-            nframes);
+          /* copy the input to output (the output
+           * is already silent if the input is) */
+          if (!self->stereo_in->l->silent)
+            {
+              dsp_copy (
+                &self->stereo_out->l->buf[start_frame],
+                &self->stereo_in->l->buf[start_frame],
+                nframes);
+              self->stereo_out->l->silent = false;
+            }
+          if (!self->stereo_in->r->silent)
+            {
+              dsp_copy (
+                &self->stereo_out->r->buf[start_frame],
+                &self->stereo_in->r->buf[start_frame],
+                nframes);
+              self->stereo_out->r->silent = false;
+            }
 
           /* if track frozen and transport is
            * rolling */
@@ -789,7 +799,7 @@ fader_process (
             BALANCE_CONTROL_ALGORITHM_LINEAR,
             pan, &calc_l, &calc_r);
 
-          /* clear it if any of the following is
+          /* silence it if any of the following is
            * true:
            * 1. muted
            * 2. other track(s) is soloed and this
@@ -798,9 +808,9 @@ fader_process (
            *   to BOUNCE_OFF */
           if (fader_get_muted (self) ||
               (self->type == FADER_TYPE_AUDIO_CHANNEL &&
-                tracklist_has_soloed (TRACKLIST) &&
+                TRACKLIST->has_soloed_tracks &&
                 !fader_get_soloed (self) &&
-                !fader_get_implied_soloed (self) &&
+                !self->implied_soloed &&
                 track != P_MASTER_TRACK) ||
               (AUDIO_ENGINE->bounce_mode == BOUNCE_ON &&
                self->type == FADER_TYPE_AUDIO_CHANNEL &&
@@ -808,52 +818,128 @@ fader_process (
                track->type != TRACK_TYPE_MASTER &&
                !track->bounce))
             {
+              calc_l = 0.f;
+              calc_r = 0.f;
+            }
+
+          /* use the amplitude of each frame for
+           * channel faders (the amp port's buffer
+           * is filled with the automation when
+           * processed) */
+          const float * amp_buf =
+            &self->amp->buf[start_frame];
+          bool amp_varies =
+            self->type == FADER_TYPE_AUDIO_CHANNEL &&
+            self->amp->buf_varies;
+          if (self->type == FADER_TYPE_AUDIO_CHANNEL)
+            {
+              amp = amp_buf[0];
+            }
+
+          /* ramp from the gains of the previous
+           * cycle to avoid zipper noise */
+          if (!self->last_gains_set)
+            {
+              self->last_amp = amp;
+              self->last_calc_l = calc_l;
+              self->last_calc_r = calc_r;
+              self->last_gains_set = true;
+            }
+
+          float * out_l =
+            &self->stereo_out->l->buf[start_frame];
+          float * out_r =
+            &self->stereo_out->r->buf[start_frame];
+          const float * in_l =
+            &self->stereo_in->l->buf[start_frame];
+          const float * in_r =
+            &self->stereo_in->r->buf[start_frame];
+          float start_l =
+            self->last_amp * self->last_calc_l;
+          float start_r =
+            self->last_amp * self->last_calc_r;
+          float end_l = amp * calc_l;
+          float end_r = amp * calc_r;
+          bool mixed = true;
+          if (self->stereo_in->l->silent &&
+              self->stereo_in->r->silent)
+            {
+              /* nothing to add, the output is
+               * already silent */
+              mixed = false;
+            }
+          else if (amp_varies)
+            {
+              dsp_mix_add_mul_ramp (
+                out_l, in_l, amp_buf,
+                self->last_calc_l, calc_l, nframes);
+              dsp_mix_add_mul_ramp (
+                out_r, in_r, amp_buf,
+                self->last_calc_r, calc_r, nframes);
+            }
+          else if (!math_floats_equal (start_l, end_l) ||
+                   !math_floats_equal (start_r, end_r))
+            {
+              dsp_mix_add_ramp (
+                out_l, in_l, start_l, end_l, nframes);
+              dsp_mix_add_ramp (
+                out_r, in_r, start_r, end_r, nframes);
             }
-          else /* if not muted */
+          /* nothing to add if silenced */
+          else if (!math_floats_equal (end_l, 0.f) ||
+                   !math_floats_equal (end_r, 0.f))
             {
-              /* apply fader and pan */
               dsp_mix2 (
-                &self->stereo_out->l->buf[
-                  start_frame],
-                &self->stereo_in->l->buf[
-                  start_frame],
-                1.f,
-                amp * calc_l,
-                nframes);
+                out_l, in_l, 1.f, end_l, nframes);
               dsp_mix2 (
-                &self->stereo_out->r->buf[
-                  start_frame],
-                &self->stereo_in->r->buf[
-                  start_frame],
-                1.f,
-                amp * calc_r,
-                nframes);
+                out_r, in_r, 1.f, end_r, nframes);
+            }
+          else
+            {
+              mixed = false;
+            }
+          if (mixed)
+            {
+              self->stereo_out->l->silent = false;
+              self->stereo_out->r->silent = false;
+            }
 
-              /* make mono if mono compat
-               * enabled. equal amplitude is
-               * more suitable for mono
-               * compatibility checking */
-              /* for reference:
-               * equal power sum =
-               * (L+R) * 0.7079 (-3dB)
-               * equal amplitude sum =
-               * (L+R) /2 (-6.02dB) */
-              if (self->mono_compat_enabled)
-                {
-                  dsp_make_mono (
-                    &self->stereo_out->l->buf[
-                      start_frame],
-                    &self->stereo_out->r->buf[
-                      start_frame], nframes,
-                      false);
-                }
+          if (amp_varies)
+            {
+              amp = amp_buf[nframes - 1];
+            }
+          self->last_amp = amp;
+          self->last_calc_l = calc_l;
+          self->last_calc_r = calc_r;
+
+          bool out_silent =
+            self->stereo_out->l->silent &&
+            self->stereo_out->r->silent;
+
+          /* make mono if mono compat
+           * enabled. equal amplitude is
+           * more suitable for mono
+           * compatibility checking */
+          /* for reference:
+           * equal power sum =
+           * (L+R) * 0.7079 (-3dB)
+           * equal amplitude sum =
+           * (L+R) /2 (-6.02dB) */
+          if (self->mono_compat_enabled &&
+              !out_silent)
+            {
+              dsp_make_mono (
+                out_l, out_r, nframes, false);
+              self->stereo_out->l->silent = false;
+              self->stereo_out->r->silent = false;
             }
 
-          /* if not master, no more processing
-           * needed, return */
-          if (self->type ==
-                FADER_TYPE_AUDIO_CHANNEL &&
-              track->type != TRACK_TYPE_MASTER)
+          /* if not master or silent, no more
+           * processing needed, return */
+          if ((self->type ==
+                 FADER_TYPE_AUDIO_CHANNEL &&
+               track->type != TRACK_TYPE_MASTER) ||
+              out_silent)
             {
                 return;
             }
@@ -36,6 +36,7 @@
  */
 
 
+#include "audio/channel.h"
 #include "audio/control_room.h"
 #include "audio/engine.h"
 #include "audio/fader.h"
@@ -57,6 +58,70 @@
 #include "utils/object_utils.h"
 #include "utils/objects.h"
 #include "utils/stoat.h"
+#include "utils/string.h"
+#include "utils/ws_deque.h"
+
+/**
+ * Key used to index graph nodes by node type and
+ * object pointer.
+ */
+typedef struct GraphNodeKey
+{
+  GraphNodeType type;
+  const void *  ptr;
+} GraphNodeKey;
+
+static guint
+node_key_hash (
+  gconstpointer key)
+{
+  const GraphNodeKey * k =
+    (const GraphNodeKey *) key;
+  return
+    g_direct_hash (k->ptr) ^
+    ((guint) k->type * 2654435761u);
+}
+
+static gboolean
+node_key_equal (
+  gconstpointer a,
+  gconstpointer b)
+{
+  const GraphNodeKey * ka =
+    (const GraphNodeKey *) a;
+  const GraphNodeKey * kb =
+    (const GraphNodeKey *) b;
+  return ka->type == kb->type && ka->ptr == kb->ptr;
+}
+
+static GHashTable *
+node_map_new (void)
+{
+  return
+    g_hash_table_new_full (
+      node_key_hash, node_key_equal, free, NULL);
+}
+
+/**
+ * Looks up a node by type and object pointer in
+ * either the setup nodes or the live nodes.
+ */
+static GraphNode *
+find_node (
+  Graph *       self,
+  GraphNodeType type,
+  const void *  ptr,
+  bool          use_setup_nodes)
+{
+  GraphNodeKey key = { .type = type, .ptr = ptr };
+  return
+    (GraphNode *)
+    g_hash_table_lookup (
+      use_setup_nodes ?
+        self->setup_graph_nodes_map :
+        self->graph_nodes_map,
+      &key);
+}
 
 /* called from a terminal node (from the Graph
  * worked-thread) to indicate it has completed
@@ -68,7 +133,8 @@
  */
 void
 graph_on_reached_terminal_node (
-  Graph *  self)
+  Graph *       self,
+  GraphThread * thread)
 {
   g_return_if_fail (self->terminal_refcnt >= 0);
 
@@ -114,16 +180,65 @@ graph_on_reached_terminal_node (
       for (size_t i = 0;
            i < self->n_init_triggers; ++i)
         {
-          g_atomic_int_inc (
-            &self->trigger_queue_size);
-          mpmc_queue_push_back_node (
-            self->trigger_queue,
+          graph_schedule_node (
+            self, thread,
             self->init_trigger_list[i]);
         }
       /* continue in worker-thread */
     }
 }
 
+/**
+ * Makes the given node available for processing
+ * using the graph's scheduler.
+ *
+ * @param thread The thread that made the node
+ *   ready.
+ */
+void
+graph_schedule_node (
+  Graph *       self,
+  GraphThread * thread,
+  GraphNode *   node)
+{
+  if (self->scheduler ==
+        GRAPH_SCHEDULER_WORK_STEALING)
+    {
+      /* keep the first ready node on this thread
+       * to avoid a round trip through the deque,
+       * and publish the rest for other threads to
+       * steal */
+      if (!thread->inline_node)
+        {
+          thread->inline_node = node;
+        }
+      else
+        {
+          g_atomic_int_inc (
+            &self->trigger_queue_size);
+
+          /* the deques are sized to the node count
+           * when the graph is set up, but if one is
+           * full, publish the node on the shared
+           * queue so it is not lost */
+          if (G_UNLIKELY (
+                !ws_deque_push_bottom (
+                  thread->deque, node)))
+            {
+              mpmc_queue_push_back_node (
+                self->trigger_queue, node);
+            }
+        }
+    }
+  else
+    {
+      g_atomic_int_inc (
+        &self->trigger_queue_size);
+      mpmc_queue_push_back_node (
+        self->trigger_queue, node);
+    }
+}
+
 /**
  * Checks for cycles in the graph.
  */
@@ -187,6 +302,269 @@ clear_setup (
   self->num_setup_graph_nodes = 0;
   self->num_setup_init_triggers = 0;
   self->num_setup_terminal_nodes = 0;
+  g_hash_table_remove_all (
+    self->setup_graph_nodes_map);
+}
+
+/**
+ * Calculates the topological order of the running
+ * nodes and decides whether to process them
+ * serially.
+ */
+static void
+update_topo_order (
+  Graph * self)
+{
+  size_t num_nodes = (size_t) self->n_graph_nodes;
+  self->topo_order =
+    realloc (
+      self->topo_order,
+      MAX (num_nodes, 1) * sizeof (GraphNode *));
+  self->n_topo_order = 0;
+
+  /* remaining incoming edges, indexed by node ID */
+  gint * refcounts =
+    calloc (MAX (num_nodes, 1), sizeof (gint));
+  for (size_t i = 0; i < num_nodes; i++)
+    {
+      GraphNode * node = self->graph_nodes[i];
+      refcounts[node->id] = node->init_refcount;
+    }
+
+  /* the order itself is used as the queue */
+  for (size_t i = 0; i < self->n_init_triggers; i++)
+    {
+      self->topo_order[self->n_topo_order++] =
+        self->init_trigger_list[i];
+    }
+  for (size_t i = 0; i < self->n_topo_order; i++)
+    {
+      GraphNode * node = self->topo_order[i];
+      for (int j = 0; j < node->n_childnodes; j++)
+        {
+          GraphNode * child = node->childnodes[j];
+          if (--refcounts[child->id] == 0)
+            {
+              self->topo_order[
+                self->n_topo_order++] = child;
+            }
+        }
+    }
+  free (refcounts);
+
+  g_warn_if_fail (self->n_topo_order == num_nodes);
+
+  /* estimate the cost of the processing nodes
+   * (port nodes only copy or sum buffers) */
+  int cost = 0;
+  for (size_t i = 0; i < num_nodes; i++)
+    {
+      switch (self->graph_nodes[i]->type)
+        {
+        case ROUTE_NODE_TYPE_PORT:
+          break;
+        case ROUTE_NODE_TYPE_PLUGIN:
+          cost += GRAPH_PLUGIN_NODE_COST;
+          break;
+        default:
+          cost += GRAPH_PROCESSOR_NODE_COST;
+          break;
+        }
+    }
+
+  self->process_serially =
+    self->n_topo_order == num_nodes &&
+    (self->force_serial ||
+     (!self->scheduler_explicit &&
+      (audio_get_num_cores () <= 2 ||
+       cost <= self->serial_max_cost)));
+  g_message (
+    "graph with %zu nodes (estimated cost %d) "
+    "will be processed %s",
+    num_nodes, cost,
+    self->process_serially ?
+      "serially" : "in parallel");
+}
+
+/**
+ * Processes all the nodes one after another in
+ * topological order on the calling thread.
+ *
+ * Used instead of the graph threads when
+ * \ref Graph.process_serially is set.
+ */
+void
+graph_process_serially (
+  Graph * self)
+{
+  nframes_t nframes = self->router->nsamples;
+  for (size_t i = 0; i < self->n_topo_order; i++)
+    {
+      graph_node_run (self->topo_order[i], nframes);
+    }
+}
+
+/**
+ * Returns the chain of nodes that bounded the
+ * last processing cycle.
+ *
+ * Starting from the terminal node that finished
+ * last, the parent that finished last is followed
+ * until a node without parents is reached.
+ *
+ * Must be called from the GTK thread.
+ *
+ * @param[out] path Newly allocated array with the
+ *   nodes, starting from the initial node. Must be
+ *   free'd.
+ *
+ * @return The number of nodes in the path.
+ */
+size_t
+graph_get_critical_path (
+  Graph *       self,
+  GraphNode *** path)
+{
+  *path = NULL;
+
+  GraphNode * node = NULL;
+  GraphNodeDspLoad load;
+  gint latest_end = G_MININT;
+  for (int i = 0; i < self->n_terminal_nodes; i++)
+    {
+      GraphNode * terminal = self->terminal_nodes[i];
+      graph_node_get_dsp_load (terminal, &load);
+      if (load.num_cycles > 0 &&
+          load.end > latest_end)
+        {
+          node = terminal;
+          latest_end = load.end;
+        }
+    }
+  if (!node)
+    return 0;
+
+  GraphNode ** nodes =
+    calloc (
+      (size_t) self->n_graph_nodes,
+      sizeof (GraphNode *));
+  size_t num_nodes = 0;
+  while (node &&
+         num_nodes < (size_t) self->n_graph_nodes)
+    {
+      nodes[num_nodes++] = node;
+
+      GraphNode * latest_parent = NULL;
+      latest_end = G_MININT;
+      for (int i = 0; i < node->init_refcount; i++)
+        {
+          GraphNode * parent = node->parentnodes[i];
+          graph_node_get_dsp_load (parent, &load);
+          if (load.end > latest_end)
+            {
+              latest_parent = parent;
+              latest_end = load.end;
+            }
+        }
+      node = latest_parent;
+    }
+
+  /* reverse so the path starts at the initial
+   * node */
+  for (size_t i = 0; i < num_nodes / 2; i++)
+    {
+      GraphNode * tmp = nodes[i];
+      nodes[i] = nodes[num_nodes - i - 1];
+      nodes[num_nodes - i - 1] = tmp;
+    }
+
+  *path = nodes;
+  return num_nodes;
+}
+
+/**
+ * Adds the processing time statistics of the
+ * given node to @p load.
+ */
+static void
+add_node_dsp_load (
+  GraphNode *        node,
+  GraphNodeDspLoad * load)
+{
+  if (!node)
+    return;
+
+  GraphNodeDspLoad node_load;
+  graph_node_get_dsp_load (node, &node_load);
+  load->last += node_load.last;
+  load->min += node_load.min;
+  load->max += node_load.max;
+  load->avg += node_load.avg;
+  load->end = MAX (load->end, node_load.end);
+  load->num_cycles =
+    MAX (load->num_cycles, node_load.num_cycles);
+}
+
+/**
+ * Fills in @p load with the sum of the processing
+ * times of the track processor, plugins, pre-fader
+ * and fader of the given track.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+graph_get_track_dsp_load (
+  Graph *            self,
+  Track *            track,
+  GraphNodeDspLoad * load)
+{
+  object_set_to_zero (load);
+
+  add_node_dsp_load (
+    find_node (
+      self, ROUTE_NODE_TYPE_TRACK, track, false),
+    load);
+
+  Channel * ch = track->channel;
+  if (!ch)
+    return;
+
+  Plugin * plugins[60];
+  int num_plugins =
+    channel_get_plugins (ch, plugins);
+  for (int i = 0; i < num_plugins; i++)
+    {
+      add_node_dsp_load (
+        find_node (
+          self, ROUTE_NODE_TYPE_PLUGIN,
+          plugins[i], false),
+        load);
+    }
+  add_node_dsp_load (
+    find_node (
+      self, ROUTE_NODE_TYPE_PREFADER,
+      ch->prefader, false),
+    load);
+  add_node_dsp_load (
+    find_node (
+      self, ROUTE_NODE_TYPE_FADER, ch->fader,
+      false),
+    load);
+}
+
+/**
+ * Resets the processing time statistics of all
+ * the nodes.
+ */
+void
+graph_reset_dsp_load (
+  Graph * self)
+{
+  for (int i = 0; i < self->n_graph_nodes; i++)
+    {
+      graph_node_reset_dsp_load (
+        self->graph_nodes[i]);
+    }
 }
 
 static void
@@ -214,6 +592,12 @@ graph_rechain (
     &self->n_terminal_nodes,
     &self->setup_terminal_nodes,
     &self->num_setup_terminal_nodes);
+  GHashTable * tmp_map = self->graph_nodes_map;
+  self->graph_nodes_map =
+    self->setup_graph_nodes_map;
+  self->setup_graph_nodes_map = tmp_map;
+
+  update_topo_order (self);
 
   /*self->n_terminal_nodes =*/
     /*(int) self->num_setup_terminal_nodes;*/
@@ -224,6 +608,18 @@ graph_rechain (
   mpmc_queue_reserve (
     self->trigger_queue,
     (size_t) self->n_graph_nodes);
+  for (int i = 0; i < self->num_threads; i++)
+    {
+      ws_deque_reserve (
+        self->threads[i]->deque,
+        (size_t) self->n_graph_nodes);
+    }
+  if (self->main_thread)
+    {
+      ws_deque_reserve (
+        self->main_thread->deque,
+        (size_t) self->n_graph_nodes);
+    }
 
   clear_setup (self);
 }
@@ -476,20 +872,41 @@ graph_update_latencies (
     0);
 }
 
-/*
- * Adds the graph nodes and connections, then
- * rechains.
+/**
+ * Updates the latency of the given plugin, unless
+ * it is part of the running graph and \ref
+ * skip_running is true.
+ */
+static void
+update_plugin_latency (
+  Graph *    self,
+  Plugin *   pl,
+  const bool skip_running)
+{
+  /* plugins in the running graph may be getting
+   * processed at the same time */
+  if (skip_running &&
+      find_node (
+        self, ROUTE_NODE_TYPE_PLUGIN, pl, false))
+    return;
+
+  plugin_update_latency (pl);
+}
+
+/**
+ * Adds the graph nodes and connections and sets
+ * the initial and terminal nodes.
  *
  * @param drop_unnecessary_ports Drops any ports
  *   that don't connect anywhere.
- * @param rechain Whether to rechain or not. If
- *   we are just validating this should be 0.
+ * @param skip_running_plugins Don't update the
+ *   latency of plugins in the running graph.
  */
-void
-graph_setup (
-  Graph *   self,
-  const int drop_unnecessary_ports,
-  const int rechain)
+static void
+add_nodes_and_connections (
+  Graph *    self,
+  const bool drop_unnecessary_ports,
+  const bool skip_running_plugins)
 {
   GraphNode * node, * node2;
 
@@ -537,7 +954,8 @@ graph_setup (
             continue;
 
           add_plugin (self, pl);
-          plugin_update_latency (pl);
+          update_plugin_latency (
+            self, pl, skip_running_plugins);
         }
 
       /* add the modulator macro processors */
@@ -582,7 +1000,8 @@ graph_setup (
             continue;
 
           add_plugin (self, pl);
-          plugin_update_latency (pl);
+          update_plugin_latency (
+            self, pl, skip_running_plugins);
         }
     }
 
@@ -1008,6 +1427,28 @@ graph_setup (
         }
     }
 
+  /* free ports */
+  free (ports);
+}
+
+/*
+ * Adds the graph nodes and connections, then
+ * rechains.
+ *
+ * @param drop_unnecessary_ports Drops any ports
+ *   that don't connect anywhere.
+ * @param rechain Whether to rechain or not. If
+ *   we are just validating this should be 0.
+ */
+void
+graph_setup (
+  Graph *   self,
+  const int drop_unnecessary_ports,
+  const int rechain)
+{
+  add_nodes_and_connections (
+    self, drop_unnecessary_ports, false);
+
   /* ========================
    * calculate latencies of each port and each
    * processor
@@ -1015,25 +1456,223 @@ graph_setup (
 
   graph_update_latencies (self, true);
 
-  /* ========================
-   * set up caches to tracks, channels, plugins,
-   * automation tracks, etc.
-   *
-   * this is because indices can be changed by the
-   * GUI thread while the graph is running
-   * TODO or maybe not needed since there is a lock
-   * now
-   * ======================== */
-
   /*graph_print (self);*/
 
-  /* free ports */
-  free (ports);
-
   if (rechain)
     graph_rechain (self);
 }
 
+/**
+ * Sets up the next graph while the current one
+ * keeps running.
+ *
+ * Plugins in the running graph are not queried,
+ * so this can be called without holding the
+ * router's graph access. graph_apply_setup() must
+ * be called afterwards while holding the graph
+ * access.
+ */
+void
+graph_setup_next (
+  Graph * self)
+{
+  add_nodes_and_connections (self, true, true);
+}
+
+/**
+ * Returns whether the setup node has the same
+ * outgoing edges as the given node in the running
+ * graph.
+ */
+static bool
+node_edges_match (
+  Graph *     self,
+  GraphNode * node,
+  GraphNode * live_node)
+{
+  if (node->n_childnodes != live_node->n_childnodes)
+    return false;
+
+  for (int i = 0; i < node->n_childnodes; i++)
+    {
+      GraphNode * child = node->childnodes[i];
+      GraphNode * live_child =
+        find_node (
+          self, child->type,
+          graph_node_get_pointer (child), false);
+      if (!live_child ||
+          !array_contains (
+            live_node->childnodes,
+            live_node->n_childnodes, live_child))
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/**
+ * Recalculates the route playback latency of
+ * affected nodes from their downstream nodes.
+ *
+ * The route playback latency of unaffected nodes
+ * is already set.
+ */
+static nframes_t
+calc_route_playback_latency (
+  GraphNode * node,
+  bool *      affected,
+  bool *      done)
+{
+  if (!affected[node->id] || done[node->id])
+    return node->route_playback_latency;
+
+  nframes_t latency = node->playback_latency;
+  for (int i = 0; i < node->n_childnodes; i++)
+    {
+      latency =
+        MAX (
+          latency,
+          calc_route_playback_latency (
+            node->childnodes[i], affected, done));
+    }
+  node->route_playback_latency = latency;
+  done[node->id] = true;
+
+  return latency;
+}
+
+/**
+ * Compares the graph set up with
+ * graph_setup_next() with the running graph,
+ * recalculates latencies only for the nodes
+ * affected by the changes and swaps it in.
+ *
+ * Must be called while holding the router's graph
+ * access.
+ *
+ * @return Whether the running graph was replaced.
+ */
+bool
+graph_apply_setup (
+  Graph * self)
+{
+  size_t num_nodes = self->num_setup_graph_nodes;
+  bool changed =
+    num_nodes != (size_t) self->n_graph_nodes;
+
+  /* indexed by node ID */
+  bool * affected =
+    calloc (MAX (num_nodes, 1), sizeof (bool));
+  bool * done =
+    calloc (MAX (num_nodes, 1), sizeof (bool));
+  GraphNode ** stack =
+    calloc (MAX (num_nodes, 1), sizeof (GraphNode *));
+  size_t stack_size = 0;
+
+  for (size_t i = 0; i < num_nodes; i++)
+    {
+      GraphNode * node = self->setup_graph_nodes[i];
+      GraphNode * live_node =
+        find_node (
+          self, node->type,
+          graph_node_get_pointer (node), false);
+
+      /* it is safe to query plugins in the running
+       * graph now */
+      if (live_node &&
+          node->type == ROUTE_NODE_TYPE_PLUGIN)
+        {
+          plugin_update_latency (node->pl);
+        }
+
+      node->playback_latency =
+        graph_node_get_single_playback_latency (
+          node);
+      node->route_playback_latency = 0;
+
+      /* keep the statistics of the node (the
+       * running graph is not processing while
+       * this is called) */
+      if (live_node)
+        {
+          node->dsp_load = live_node->dsp_load;
+        }
+
+      if (live_node &&
+          live_node->playback_latency ==
+            node->playback_latency &&
+          node_edges_match (self, node, live_node))
+        {
+          node->route_playback_latency =
+            live_node->route_playback_latency;
+        }
+      else
+        {
+          affected[node->id] = true;
+          stack[stack_size++] = node;
+          changed = true;
+        }
+    }
+
+  if (!changed)
+    {
+      g_message (
+        "graph unchanged, keeping running graph");
+      free (affected);
+      free (done);
+      free (stack);
+      clear_setup (self);
+      return false;
+    }
+
+  /* route playback latencies only depend on
+   * downstream nodes, so only the changed nodes
+   * and the nodes upstream of them need to be
+   * recalculated */
+  while (stack_size > 0)
+    {
+      GraphNode * node = stack[--stack_size];
+      for (int i = 0; i < node->init_refcount; i++)
+        {
+          GraphNode * parent = node->parentnodes[i];
+          if (!affected[parent->id])
+            {
+              affected[parent->id] = true;
+              stack[stack_size++] = parent;
+            }
+        }
+    }
+
+  size_t num_affected = 0;
+  for (size_t i = 0; i < num_nodes; i++)
+    {
+      GraphNode * node = self->setup_graph_nodes[i];
+      if (affected[node->id])
+        {
+          calc_route_playback_latency (
+            node, affected, done);
+          num_affected++;
+        }
+    }
+
+  g_message (
+    "recalculated latencies of %zu/%zu nodes, "
+    "max playback latency: %d",
+    num_affected, num_nodes,
+    graph_get_max_route_playback_latency (
+      self, true));
+
+  free (affected);
+  free (done);
+  free (stack);
+
+  graph_rechain (self);
+
+  return true;
+}
+
 /**
  * Adds a new connection for the given
  * src and dest ports and validates the graph.
@@ -1139,11 +1778,41 @@ graph_new (
 
   self->router = router;
   self->trigger_queue = mpmc_queue_new ();
+
+  char * scheduler =
+    env_get_string (
+      "ZRYTHM_GRAPH_SCHEDULER", "auto");
+  self->scheduler_explicit =
+    !string_is_equal (scheduler, "auto");
+  if (string_is_equal (
+        scheduler, "work-stealing"))
+    {
+      self->scheduler =
+        GRAPH_SCHEDULER_WORK_STEALING;
+    }
+  else
+    {
+      self->scheduler = GRAPH_SCHEDULER_MPMC_QUEUE;
+    }
+  self->force_serial =
+    string_is_equal (scheduler, "serial");
+  self->serial_max_cost =
+    env_get_int (
+      "ZRYTHM_GRAPH_SERIAL_MAX_COST",
+      GRAPH_DEFAULT_SERIAL_MAX_COST);
+  g_message (
+    "using %s graph scheduler",
+    self->scheduler ==
+      GRAPH_SCHEDULER_WORK_STEALING ?
+        "work-stealing" : "MPMC queue");
+  g_free (scheduler);
   self->init_trigger_list =
     object_new (GraphNode *);
   self->terminal_nodes =
     object_new (GraphNode *);
   self->graph_nodes = object_new (GraphNode *);
+  self->graph_nodes_map = node_map_new ();
+  self->setup_graph_nodes_map = node_map_new ();
 
   zix_sem_init (&self->callback_start, 0);
   zix_sem_init (&self->callback_done, 0);
@@ -1224,16 +1893,9 @@ graph_find_node_from_port (
   Graph * graph,
   const Port * port)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type == ROUTE_NODE_TYPE_PORT &&
-          node->port == port)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_PORT, port, true);
 }
 
 GraphNode *
@@ -1241,16 +1903,9 @@ graph_find_node_from_plugin (
   Graph * graph,
   Plugin * pl)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type == ROUTE_NODE_TYPE_PLUGIN &&
-          node->pl == pl)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_PLUGIN, pl, true);
 }
 
 GraphNode *
@@ -1259,23 +1914,10 @@ graph_find_node_from_track (
   Track * track,
   bool    use_setup_nodes)
 {
-  GraphNode ** nodes =
-    (use_setup_nodes ?
-       graph->setup_graph_nodes :
-       graph->graph_nodes);
-  size_t num_nodes =
-    (use_setup_nodes ?
-       graph->num_setup_graph_nodes :
-       (size_t) graph->n_graph_nodes);
-  GraphNode * node;
-  for (size_t i = 0; i < num_nodes; i++)
-    {
-      node = nodes[i];
-      if (node->type == ROUTE_NODE_TYPE_TRACK &&
-          node->track == track)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_TRACK, track,
+      use_setup_nodes);
 }
 
 GraphNode *
@@ -1283,16 +1925,9 @@ graph_find_node_from_fader (
   Graph * graph,
   Fader * fader)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type == ROUTE_NODE_TYPE_FADER &&
-          node->fader == fader)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_FADER, fader, true);
 }
 
 GraphNode *
@@ -1300,16 +1935,10 @@ graph_find_node_from_prefader (
   Graph * graph,
   Fader * prefader)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type == ROUTE_NODE_TYPE_PREFADER &&
-          node->prefader == prefader)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_PREFADER, prefader,
+      true);
 }
 
 GraphNode *
@@ -1317,18 +1946,10 @@ graph_find_node_from_sample_processor (
   Graph * graph,
   SampleProcessor * sample_processor)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type ==
-            ROUTE_NODE_TYPE_SAMPLE_PROCESSOR &&
-          node->sample_processor ==
-            sample_processor)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_SAMPLE_PROCESSOR,
+      sample_processor, true);
 }
 
 GraphNode *
@@ -1336,49 +1957,30 @@ graph_find_node_from_monitor_fader (
   Graph * graph,
   Fader * fader)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type ==
-            ROUTE_NODE_TYPE_MONITOR_FADER &&
-          node->fader == fader)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_MONITOR_FADER, fader,
+      true);
 }
 
 GraphNode *
 graph_find_initial_processor_node (
   Graph * graph)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type ==
-            ROUTE_NODE_TYPE_INITIAL_PROCESSOR)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_INITIAL_PROCESSOR,
+      NULL, true);
 }
 
 GraphNode *
 graph_find_hw_processor_node (
   Graph * graph)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type ==
-            ROUTE_NODE_TYPE_HW_PROCESSOR)
-        return node;
-    }
-  return NULL;
+  return
+    find_node (
+      graph, ROUTE_NODE_TYPE_HW_PROCESSOR,
+      HW_IN_PROCESSOR, true);
 }
 
 GraphNode *
@@ -1386,20 +1988,11 @@ graph_find_node_from_modulator_macro_processor (
   Graph * graph,
   ModulatorMacroProcessor * processor)
 {
-  GraphNode * node;
-  for (size_t i = 0;
-       i < graph->num_setup_graph_nodes; i++)
-    {
-      node = graph->setup_graph_nodes[i];
-      if (node->type ==
-            ROUTE_NODE_TYPE_MODULATOR_MACRO_PROCESOR &&
-          node->modulator_macro_processor ==
-            processor)
-        {
-          return node;
-        }
-    }
-  return NULL;
+  return
+    find_node (
+      graph,
+      ROUTE_NODE_TYPE_MODULATOR_MACRO_PROCESOR,
+      processor, true);
 }
 
 /**
@@ -1423,6 +2016,22 @@ graph_create_node (
   graph->setup_graph_nodes[
     graph->num_setup_graph_nodes++] = node;
 
+  /* index the node, keeping the first one if
+   * the same object was added twice */
+  GraphNodeKey * key = object_new (GraphNodeKey);
+  key->type = type;
+  key->ptr = graph_node_get_pointer (node);
+  if (g_hash_table_contains (
+        graph->setup_graph_nodes_map, key))
+    {
+      free (key);
+    }
+  else
+    {
+      g_hash_table_insert (
+        graph->setup_graph_nodes_map, key, node);
+    }
+
   return node;
 }
 
@@ -1440,6 +2049,16 @@ graph_free (
       object_free_w_func_and_null (
         graph_node_free, self->graph_nodes[i]);
     }
+  for (int i = 0; i < self->num_threads; i++)
+    {
+      object_free_w_func_and_null (
+        ws_deque_free, self->threads[i]->deque);
+    }
+  if (self->main_thread)
+    {
+      object_free_w_func_and_null (
+        ws_deque_free, self->main_thread->deque);
+    }
   object_zero_and_free (self->graph_nodes);
   object_zero_and_free (self->init_trigger_list);
   object_zero_and_free (self->setup_graph_nodes);
@@ -1447,6 +2066,12 @@ graph_free (
     self->setup_init_trigger_list);
   object_zero_and_free (
     self->terminal_nodes);
+  object_zero_and_free (self->topo_order);
+  object_free_w_func_and_null (
+    g_hash_table_destroy, self->graph_nodes_map);
+  object_free_w_func_and_null (
+    g_hash_table_destroy,
+    self->setup_graph_nodes_map);
 
   zix_sem_destroy (&self->callback_start);
   zix_sem_destroy (&self->callback_done);
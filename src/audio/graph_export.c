@@ -17,6 +17,9 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "audio/fader.h"
 #include "audio/graph.h"
 #include "audio/graph_node.h"
@@ -446,3 +449,110 @@ graph_export_as (
 
   g_message ("graph exported");
 }
+
+static int
+cmp_node_avg_dsp_load (
+  const void * a,
+  const void * b)
+{
+  GraphNode * node_a = *(GraphNode * const *) a;
+  GraphNode * node_b = *(GraphNode * const *) b;
+  GraphNodeDspLoad load_a, load_b;
+  graph_node_get_dsp_load (node_a, &load_a);
+  graph_node_get_dsp_load (node_b, &load_b);
+  return load_b.avg - load_a.avg;
+}
+
+/**
+ * Writes the processing time statistics of each
+ * node and the critical path of the last cycle as
+ * text at the given path.
+ *
+ * The graph must be the running graph and this
+ * must be called from the GTK thread.
+ */
+void
+graph_export_dsp_load (
+  Graph *      graph,
+  const char * export_path)
+{
+  g_message (
+    "exporting DSP load to %s...", export_path);
+
+  GString * str = g_string_new (NULL);
+  g_string_append_printf (
+    str,
+    "%-60s %8s %8s %8s %8s %8s\n",
+    "node (times in us)", "last", "min", "max",
+    "avg", "latency");
+
+  size_t num_nodes = (size_t) graph->n_graph_nodes;
+  GraphNode ** nodes =
+    calloc (MAX (num_nodes, 1), sizeof (GraphNode *));
+  memcpy (
+    nodes, graph->graph_nodes,
+    num_nodes * sizeof (GraphNode *));
+  qsort (
+    nodes, num_nodes, sizeof (GraphNode *),
+    cmp_node_avg_dsp_load);
+  GraphNodeDspLoad load;
+  for (size_t i = 0; i < num_nodes; i++)
+    {
+      GraphNode * node = nodes[i];
+      graph_node_get_dsp_load (node, &load);
+      char * name = graph_node_get_name (node);
+      g_string_append_printf (
+        str,
+        "%-60s %8.1f %8.1f %8.1f %8.1f %8u\n",
+        name, load.last / 1000.0,
+        load.min / 1000.0, load.max / 1000.0,
+        load.avg / 1000.0,
+        node->route_playback_latency);
+      g_free (name);
+    }
+  free (nodes);
+
+  GraphNode ** path;
+  size_t path_len =
+    graph_get_critical_path (graph, &path);
+  gint64 total = 0;
+  for (size_t i = 0; i < path_len; i++)
+    {
+      graph_node_get_dsp_load (path[i], &load);
+      total += load.last;
+    }
+  g_string_append_printf (
+    str,
+    "\ncritical path of the last cycle "
+    "(%zu nodes, %.1f us):\n",
+    path_len, (double) total / 1000.0);
+  for (size_t i = 0; i < path_len; i++)
+    {
+      GraphNode * node = path[i];
+      graph_node_get_dsp_load (node, &load);
+      char * name = graph_node_get_name (node);
+      g_string_append_printf (
+        str,
+        "  %-58s %8.1f us, ends at %8.1f us, "
+        "latency %u\n",
+        name, load.last / 1000.0,
+        load.end / 1000.0,
+        node->route_playback_latency);
+      g_free (name);
+    }
+  free (path);
+
+  GError * err = NULL;
+  if (!g_file_set_contents (
+         export_path, str->str, (gssize) str->len,
+         &err))
+    {
+      g_warning (
+        "failed to export DSP load: %s",
+        err->message);
+      g_error_free (err);
+    }
+  g_string_free (str, true);
+
+  g_message ("DSP load exported");
+}
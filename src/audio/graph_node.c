@@ -37,11 +37,13 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/graph.h"
 #include "audio/graph_node.h"
+#include "audio/graph_thread.h"
 #include "audio/master_track.h"
 #include "audio/midi_event.h"
 #include "audio/port.h"
@@ -54,7 +56,6 @@
 #include "plugins/plugin.h"
 #include "project.h"
 #include "utils/arrays.h"
-#include "utils/mpmc_queue.h"
 #include "utils/objects.h"
 
 #include <gtk/gtk.h>
@@ -204,7 +205,8 @@ graph_node_print (
 
 static void
 on_node_finish (
-  GraphNode * self)
+  GraphNode *   self,
+  GraphThread * thread)
 {
   int feeds = 0;
 
@@ -222,7 +224,8 @@ on_node_finish (
           /*self->childnodes[i]->*/
             /*route_playback_latency);*/
 #endif
-      graph_node_trigger (self->childnodes[i]);
+      graph_node_trigger (
+        self->childnodes[i], thread);
       feeds = 1;
     }
 
@@ -231,7 +234,8 @@ on_node_finish (
   if (!feeds)
     {
       /* notify parent graph */
-      graph_on_reached_terminal_node (self->graph);
+      graph_on_reached_terminal_node (
+        self->graph, thread);
     }
 }
 
@@ -330,11 +334,8 @@ process_node (
     }
 }
 
-/**
- * Processes the GraphNode.
- */
-void
-graph_node_process (
+static void
+run_node (
   GraphNode * node,
   nframes_t   nframes)
 {
@@ -367,7 +368,7 @@ graph_node_process (
 
       /* if no-roll, only process terminal nodes
        * to set their buffers to 0 */
-      goto node_process_finish;
+      return;
       /*if (!node->terminal)*/
         /*{*/
         /*}*/
@@ -442,17 +443,125 @@ graph_node_process (
         node, g_start_frames, local_offset, nframes);
     }
 
-node_process_finish:
-  on_node_finish (node);
+}
+
+/**
+ * Returns the monotonic time in nanoseconds.
+ *
+ * Most nodes take only a few microseconds, so
+ * the microsecond resolution of
+ * g_get_monotonic_time() is not enough.
+ */
+static inline gint64
+get_monotonic_time_ns (void)
+{
+#ifdef _WOE32
+  return g_get_monotonic_time () * 1000;
+#else
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return
+    (gint64) ts.tv_sec * 1000000000 +
+    (gint64) ts.tv_nsec;
+#endif
+}
+
+/**
+ * Records the time taken to process the node in
+ * this cycle.
+ *
+ * @param start_time Start time in nanoseconds.
+ * @param end_time End time in nanoseconds.
+ */
+static void
+update_dsp_load (
+  GraphNode * self,
+  gint64      start_time,
+  gint64      end_time)
+{
+  GraphNodeDspLoad * load = &self->dsp_load;
+  gint taken =
+    (gint) MIN (end_time - start_time, G_MAXINT);
+
+  g_atomic_int_set (&load->last, taken);
+  g_atomic_int_set (
+    &load->end,
+    (gint)
+    CLAMP (
+      end_time -
+        AUDIO_ENGINE->timestamp_start * 1000,
+      G_MININT, G_MAXINT));
+
+  /* first cycle after a reset */
+  if (g_atomic_int_get (&load->num_cycles) == 0)
+    {
+      g_atomic_int_set (&load->min, taken);
+      g_atomic_int_set (&load->max, taken);
+      load->avg_fixed = (gint64) taken * 256;
+    }
+  else
+    {
+      if (taken < load->min)
+        g_atomic_int_set (&load->min, taken);
+      if (taken > load->max)
+        g_atomic_int_set (&load->max, taken);
+      load->avg_fixed +=
+        ((gint64) taken * 256 - load->avg_fixed) /
+        (1 << GRAPH_NODE_DSP_LOAD_AVG_SHIFT);
+    }
+  g_atomic_int_set (
+    &load->avg, (gint) (load->avg_fixed / 256));
+  g_atomic_int_inc (&load->num_cycles);
+}
+
+/**
+ * Processes the GraphNode without notifying
+ * downstream nodes.
+ *
+ * Used directly when the graph is run in
+ * topological order.
+ */
+void
+graph_node_run (
+  GraphNode * node,
+  nframes_t   nframes)
+{
+  gint64 start_time = get_monotonic_time_ns ();
+
+  run_node (node, nframes);
+
+  update_dsp_load (
+    node, start_time, get_monotonic_time_ns ());
+}
+
+/**
+ * Processes the GraphNode.
+ *
+ * @param thread The graph thread processing the
+ *   node.
+ */
+void
+graph_node_process (
+  GraphNode *   node,
+  nframes_t     nframes,
+  GraphThread * thread)
+{
+  graph_node_run (node, nframes);
+
+  on_node_finish (node, thread);
 }
 
 /**
  * Called by an upstream node when it has completed
  * processing.
+ *
+ * @param thread The graph thread that processed
+ *   the upstream node.
  */
 void
 graph_node_trigger (
-  GraphNode * self)
+  GraphNode *   self,
+  GraphThread * thread)
 {
   /* check if we can run */
   if (g_atomic_int_dec_and_test (&self->refcount))
@@ -465,11 +574,8 @@ graph_node_trigger (
       /* all nodes that feed this node have
        * completed, so this node be processed
        * now. */
-      g_atomic_int_inc (
-        &self->graph->trigger_queue_size);
-      /*g_message ("triggering node, pushing back");*/
-      mpmc_queue_push_back_node (
-        self->graph->trigger_queue, self);
+      graph_schedule_node (
+        self->graph, thread, self);
     }
 }
 
@@ -518,6 +624,41 @@ add_depends (
   self->initial = false;
 }
 
+/**
+ * Copies the processing time statistics of the
+ * node into @p load.
+ *
+ * Can be called from any thread.
+ */
+void
+graph_node_get_dsp_load (
+  GraphNode *        self,
+  GraphNodeDspLoad * load)
+{
+  GraphNodeDspLoad * src = &self->dsp_load;
+  load->num_cycles =
+    g_atomic_int_get (&src->num_cycles);
+  load->last = g_atomic_int_get (&src->last);
+  load->min = g_atomic_int_get (&src->min);
+  load->max = g_atomic_int_get (&src->max);
+  load->avg = g_atomic_int_get (&src->avg);
+  load->end = g_atomic_int_get (&src->end);
+  load->avg_fixed = (gint64) load->avg * 256;
+}
+
+/**
+ * Resets the processing time statistics of the
+ * node.
+ *
+ * Can be called from any thread.
+ */
+void
+graph_node_reset_dsp_load (
+  GraphNode * self)
+{
+  g_atomic_int_set (&self->dsp_load.num_cycles, 0);
+}
+
 /**
  * Returns the latency of only the given port,
  * without adding the previous/next latencies.
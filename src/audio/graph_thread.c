@@ -45,33 +45,186 @@
 #include "project.h"
 #include "utils/mpmc_queue.h"
 #include "utils/objects.h"
+#include "utils/ws_deque.h"
 
 /* uncomment to show debug messages */
 /*#define DEBUG_THREADS 1*/
 
-static void *
-worker_thread (void * arg)
+/**
+ * Returns the thread at the given index, where
+ * the main thread is at index \ref
+ * Graph.num_threads.
+ */
+static GraphThread *
+get_thread_at (
+  Graph * graph,
+  int     idx)
+{
+  if (idx == graph->num_threads)
+    return graph->main_thread;
+  else
+    return graph->threads[idx];
+}
+
+/**
+ * Wakes up idle threads, but at most as many as
+ * there are nodes published for other threads.
+ */
+static void
+wake_up_idle_threads (
+  GraphThread * thread)
 {
-  GraphThread * thread = (GraphThread *) arg;
   Graph * graph = thread->graph;
-  GraphNode* to_run = NULL;
 
+  guint idle_cnt =
+    (guint)
+    g_atomic_int_get (&graph->idle_thread_cnt);
+  guint work_avail =
+    (guint)
+    g_atomic_int_get (&graph->trigger_queue_size);
+  guint wakeup = MIN (idle_cnt, work_avail);
+#ifdef DEBUG_THREADS
   g_message (
-    "WORKER THREAD %d created (num threads %d)",
-    thread->id, graph->num_threads);
+    "[%d]: Waking up %u idle threads (idle count %u), work available -> %u",
+    thread->id, wakeup,
+    idle_cnt, work_avail);
+#endif
 
-  /* wait for all threads to get created */
-  if (thread->id < graph->num_threads - 1)
+  for (guint i = 0; i < wakeup; ++i)
     {
-      sched_yield ();
+      zix_sem_post (&graph->trigger);
     }
+}
 
-#ifdef HAVE_LSP_DSP
-  if (ZRYTHM_USE_OPTIMIZED_DSP)
+/**
+ * Returns the next node to run on the given
+ * thread, or NULL if there is no work available.
+ *
+ * The node made ready inline by the previous node
+ * is preferred, then the newest node in the
+ * thread's own deque, then the oldest node in
+ * another thread's deque and finally a node that
+ * overflowed into the graph's shared queue.
+ */
+static GraphNode *
+find_work (
+  GraphThread * thread)
+{
+  Graph * graph = thread->graph;
+  GraphNode * node = thread->inline_node;
+
+  if (node)
     {
-      lsp_dsp_start (&thread->lsp_ctx);
+      thread->inline_node = NULL;
+      return node;
     }
+
+  if (ws_deque_pop_bottom (
+        thread->deque, (void **) &node))
+    {
+      g_atomic_int_dec_and_test (
+        &graph->trigger_queue_size);
+      return node;
+    }
+
+  /* steal, starting from the next thread so that
+   * thieves spread over the victims */
+  int num_threads = graph->num_threads + 1;
+  int own_idx =
+    thread->id == -1 ?
+      graph->num_threads : thread->id;
+  for (int i = 1; i < num_threads; i++)
+    {
+      GraphThread * victim =
+        get_thread_at (
+          graph, (own_idx + i) % num_threads);
+      if (!victim || !victim->deque)
+        continue;
+
+      if (ws_deque_steal (
+            victim->deque, (void **) &node))
+        {
+          g_atomic_int_dec_and_test (
+            &graph->trigger_queue_size);
+#ifdef DEBUG_THREADS
+          g_message (
+            "[%d]: stole node from thread %d",
+            thread->id, victim->id);
+#endif
+          return node;
+        }
+    }
+
+  if (mpmc_queue_dequeue_node (
+        graph->trigger_queue, &node))
+    {
+      g_atomic_int_dec_and_test (
+        &graph->trigger_queue_size);
+      return node;
+    }
+
+  return NULL;
+}
+
+/**
+ * Processing loop using a work-stealing deque per
+ * thread.
+ */
+static void
+run_work_stealing (
+  GraphThread * thread)
+{
+  Graph * graph = thread->graph;
+
+  for (;;)
+    {
+      if (g_atomic_int_get (&graph->terminate))
+        {
+          return;
+        }
+
+      GraphNode * to_run = find_work (thread);
+      if (to_run)
+        {
+          /* the previous node may have published
+           * more work than this thread can take */
+          wake_up_idle_threads (thread);
+
+#ifdef DEBUG_THREADS
+          g_message (
+            "[%d]: running node", thread->id);
 #endif
+          graph_node_process (
+            to_run, graph->router->nsamples,
+            thread);
+          continue;
+        }
+
+      /* wait for work, fall asleep */
+      g_atomic_int_inc (&graph->idle_thread_cnt);
+
+      zix_sem_wait (&graph->trigger);
+
+      if (g_atomic_int_get (&graph->terminate))
+        {
+          return;
+        }
+
+      g_atomic_int_dec_and_test (
+        &graph->idle_thread_cnt);
+    }
+}
+
+/**
+ * Processing loop using the graph's global MPMC
+ * trigger queue.
+ */
+static void
+run_mpmc_queue (
+  GraphThread * thread)
+{
+  Graph * graph = thread->graph;
+  GraphNode* to_run = NULL;
 
   for (;;)
     {
@@ -79,17 +232,7 @@ worker_thread (void * arg)
 
       if (g_atomic_int_get (&graph->terminate))
         {
-          if (thread->id == -1)
-            {
-              g_message ("terminating main thread");
-            }
-          else
-            {
-              g_message (
-                "[%d]: terminating thread",
-                thread->id);
-            }
-          goto terminate_thread;
+          return;
         }
 
       if (mpmc_queue_dequeue_node (
@@ -163,7 +306,7 @@ worker_thread (void * arg)
 
           if (g_atomic_int_get (&graph->terminate))
             {
-              goto terminate_thread;
+              return;
             }
 
           g_atomic_int_dec_and_test (
@@ -191,11 +334,53 @@ worker_thread (void * arg)
       g_message ("[%d]: running node", thread->id);
 #endif
       graph_node_process (
-        to_run, graph->router->nsamples);
+        to_run, graph->router->nsamples, thread);
 
     }
+}
 
-terminate_thread:
+static void *
+worker_thread (void * arg)
+{
+  GraphThread * thread = (GraphThread *) arg;
+  Graph * graph = thread->graph;
+
+  g_message (
+    "WORKER THREAD %d created (num threads %d)",
+    thread->id, graph->num_threads);
+
+  /* wait for all threads to get created */
+  if (thread->id < graph->num_threads - 1)
+    {
+      sched_yield ();
+    }
+
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_start (&thread->lsp_ctx);
+    }
+#endif
+
+  if (graph->scheduler ==
+        GRAPH_SCHEDULER_WORK_STEALING)
+    {
+      run_work_stealing (thread);
+    }
+  else
+    {
+      run_mpmc_queue (thread);
+    }
+
+  if (thread->id == -1)
+    {
+      g_message ("terminating main thread");
+    }
+  else
+    {
+      g_message (
+        "[%d]: terminating thread", thread->id);
+    }
 
 #ifdef HAVE_LSP_DSP
   if (ZRYTHM_USE_OPTIMIZED_DSP)
@@ -241,11 +426,9 @@ main_thread (void * arg)
   for (size_t i = 0;
        i < self->n_init_triggers; ++i)
     {
-      g_atomic_int_inc (&self->trigger_queue_size);
       /*g_message ("[main] pushing back node %d during bootstrap", i);*/
-      mpmc_queue_push_back_node (
-        self->trigger_queue,
-        self->init_trigger_list[i]);
+      graph_schedule_node (
+        self, thread, self->init_trigger_list[i]);
     }
 
   /* after setup, the main-thread just becomes
@@ -272,6 +455,9 @@ graph_thread_new (
 
   self->id = id;
   self->graph = graph;
+  self->deque = ws_deque_new ();
+  ws_deque_reserve (
+    self->deque, (size_t) graph->n_graph_nodes);
 
 #ifdef HAVE_JACK
   if (AUDIO_ENGINE->audio_backend ==
@@ -23,6 +23,7 @@
 #include "audio/group_target_track.h"
 #include "audio/router.h"
 #include "audio/track.h"
+#include "audio/tracklist.h"
 #include "utils/arrays.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -126,6 +127,8 @@ update_child_output (
       ch->output_pos = -1;
     }
 
+  tracklist_update_solo_state (TRACKLIST);
+
   if (recalc_graph)
     {
       router_recalc_graph (ROUTER, F_NOT_SOFT);
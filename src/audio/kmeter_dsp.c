@@ -41,6 +41,7 @@
 #include <math.h>
 
 #include "audio/kmeter_dsp.h"
+#include "utils/dsp.h"
 
 /**
  * Process.
@@ -64,7 +65,10 @@ kmeter_dsp_process (
       self->fpp = n;
     }
 
+  // Update digital peak.
   t = 0;
+  dsp_abs_max (p, &t, (size_t) n);
+
   // Get filter state.
   z1 =
     self->z1 > 50 ?
@@ -80,19 +84,15 @@ kmeter_dsp_process (
     {
       s = *p++;
       s *= s;
-      if (t < s) t = s;             // Update digital peak.
       z1 += self->omega * (s - z1);      // Update first filter.
       s = *p++;
       s *= s;
-      if (t < s) t = s;             // Update digital peak.
       z1 += self->omega * (s - z1);      // Update first filter.
       s = *p++;
       s *= s;
-      if (t < s) t = s;             // Update digital peak.
       z1 += self->omega * (s - z1);      // Update first filter.
       s = *p++;
       s *= s;
-      if (t < s) t = s;             // Update digital peak.
       z1 += self->omega * (s - z1);      // Update first filter.
             z2 += 4 * self->omega * (z1 - z2); // Update second filter.
     }
@@ -106,7 +106,6 @@ kmeter_dsp_process (
   self->z2 = z2 + 1e-20f;
 
   s = sqrtf (2.0f * z2);
-  t = sqrtf (t);
 
   if (self->flag) // Display thread has read the rms value.
     {
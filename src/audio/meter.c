@@ -27,8 +27,113 @@
 #include "audio/true_peak_dsp.h"
 #include "project.h"
 #include "utils/math.h"
+#include "utils/object_utils.h"
+#include "zrythm.h"
 #include "zrythm_app.h"
 
+/**
+ * Runs the meter DSP on the given range of the
+ * port buffer and publishes a new snapshot.
+ *
+ * To be called by the engine after the port is
+ * processed.
+ */
+void
+meter_process (
+  Meter *   self,
+  nframes_t local_offset,
+  nframes_t nframes)
+{
+  if (nframes == 0)
+    return;
+
+  Port * port = self->port;
+  float * buf = &port->buf[local_offset];
+
+  /* if the GUI read the last snapshot, make the
+   * processors start a new max */
+  bool reset =
+    g_atomic_int_compare_and_exchange (
+      &self->snapshot_read, 1, 0);
+
+  float amp = 0.f;
+  float max_amp = 0.f;
+  switch (self->algorithm)
+    {
+    case METER_ALGORITHM_RMS:
+      amp =
+        math_calculate_rms_amp (
+          buf, (size_t) nframes);
+      max_amp = amp;
+      break;
+    case METER_ALGORITHM_TRUE_PEAK:
+      if (reset)
+        self->true_peak_processor->res = true;
+      true_peak_dsp_process (
+        self->true_peak_processor, buf,
+        (int) nframes);
+      amp = self->true_peak_processor->m;
+      max_amp = amp;
+      break;
+    case METER_ALGORITHM_K:
+      if (reset)
+        self->kmeter_processor->flag = true;
+      kmeter_dsp_process (
+        self->kmeter_processor, buf,
+        (int) nframes);
+      amp = self->kmeter_processor->rms;
+      max_amp = self->kmeter_processor->peak;
+      break;
+    case METER_ALGORITHM_DIGITAL_PEAK:
+      if (reset)
+        self->peak_processor->flag = true;
+      peak_dsp_process (
+        self->peak_processor, buf,
+        (int) nframes);
+      amp = self->peak_processor->rms;
+      max_amp = self->peak_processor->peak;
+      break;
+    default:
+      break;
+    }
+
+  /* publish the snapshot */
+  g_atomic_int_inc (&self->snapshot_seq);
+  self->snapshot_amp = amp;
+  self->snapshot_max_amp = max_amp;
+  g_atomic_int_inc (&self->snapshot_seq);
+}
+
+/**
+ * Reads the last snapshot published by the
+ * engine.
+ *
+ * @return Whether a snapshot was available.
+ */
+static bool
+read_snapshot (
+  Meter * self,
+  float * amp,
+  float * max_amp)
+{
+  gint seq;
+  do
+    {
+      seq = g_atomic_int_get (&self->snapshot_seq);
+      *amp = self->snapshot_amp;
+      *max_amp = self->snapshot_max_amp;
+    } while (
+      seq % 2 != 0 ||
+      seq != g_atomic_int_get (&self->snapshot_seq));
+
+  if (seq == 0)
+    return false;
+
+  g_atomic_int_set (&self->snapshot_read, 1);
+
+  return true;
+}
+
 /**
  * Get the current meter value.
  *
@@ -42,7 +147,13 @@ meter_get_value (
   float *          val,
   float *          max)
 {
-  Port * port = self->port;
+  Port * port = g_atomic_pointer_get (&self->port);
+  if (!port)
+    {
+      * val = 1e-20f;
+      * max = 1e-20f;
+      return;
+    }
 
   /* get amplitude */
   float amp = -1.f;
@@ -50,85 +161,13 @@ meter_get_value (
   if (port->id.type == TYPE_AUDIO ||
       port->id.type == TYPE_CV)
     {
-      g_return_if_fail (port->audio_ring);
-      int num_cycles = 4;
-      size_t read_space_avail =
-        zix_ring_read_space (port->audio_ring);
-      size_t size =
-        sizeof (float) *
-        (size_t) AUDIO_ENGINE->block_length;
-      size_t blocks_to_read =
-        size == 0 ?
-          0 : read_space_avail / size;
-      /* if no blocks available, skip */
-      if (blocks_to_read == 0)
+      /* if nothing processed yet, skip */
+      if (!read_snapshot (self, &amp, &max_amp))
         {
           * val = 1e-20f;
           * max = 1e-20f;
           return;
         }
-
-      float buf[
-        AUDIO_ENGINE->block_length *
-          blocks_to_read];
-      size_t blocks_read =
-        zix_ring_peek (
-          port->audio_ring, &buf[0],
-          read_space_avail);
-      blocks_read /= size;
-      num_cycles = MIN (num_cycles, (int) blocks_read);
-      size_t start_index =
-        (blocks_read - (size_t) num_cycles) *
-          AUDIO_ENGINE->block_length;
-      if (blocks_read == 0)
-        {
-          g_message (
-            "%s: blocks read for port %s is 0",
-            __func__, port->id.label);
-          * val = 1e-20f;
-          * max = 1e-20f;
-          return;
-        }
-
-      switch (self->algorithm)
-        {
-        case METER_ALGORITHM_RMS:
-          /* not used */
-          g_warn_if_reached ();
-          amp =
-            math_calculate_rms_amp (
-              &buf[start_index],
-              (size_t) num_cycles *
-                AUDIO_ENGINE->block_length);
-          break;
-        case METER_ALGORITHM_TRUE_PEAK:
-          true_peak_dsp_process (
-            self->true_peak_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
-          amp =
-            true_peak_dsp_read_f (
-              self->true_peak_processor);
-          break;
-        case METER_ALGORITHM_K:
-          kmeter_dsp_process (
-            self->kmeter_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
-          kmeter_dsp_read (
-            self->kmeter_processor, &amp, &max_amp);
-          break;
-        case METER_ALGORITHM_DIGITAL_PEAK:
-          peak_dsp_process (
-            self->peak_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
-          peak_dsp_read (
-            self->peak_processor, &amp, &max_amp);
-          break;
-        default:
-          break;
-        }
     }
   else if (port->id.type == TYPE_EVENT)
     {
@@ -205,6 +244,8 @@ meter_get_value (
   switch (format)
     {
     case AUDIO_VALUE_AMPLITUDE:
+      *val = amp;
+      *max = max_amp;
       break;
     case AUDIO_VALUE_DBFS:
       *val = math_amp_to_dbfs (amp);
@@ -219,6 +260,56 @@ meter_get_value (
     }
 }
 
+/**
+ * Replaces the meters of the port with a copy
+ * that includes or excludes the given meter.
+ */
+static void
+update_port_meters (
+  Port *  port,
+  Meter * meter,
+  bool    add)
+{
+  Meter ** old_meters = port->meters;
+  int num_meters = 0;
+  if (old_meters)
+    {
+      while (old_meters[num_meters])
+        num_meters++;
+    }
+
+  Meter ** meters =
+    calloc (
+      (size_t) num_meters + 2, sizeof (Meter *));
+  int new_num_meters = 0;
+  for (int i = 0; i < num_meters; i++)
+    {
+      if (old_meters[i] != meter)
+        meters[new_num_meters++] = old_meters[i];
+    }
+  if (add)
+    meters[new_num_meters++] = meter;
+
+  if (new_num_meters == 0)
+    {
+      free (meters);
+      meters = NULL;
+    }
+  g_atomic_pointer_set (&port->meters, meters);
+
+  /* the engine may still be iterating the old
+   * array */
+  if (old_meters)
+    free_later (old_meters, free);
+}
+
+/**
+ * Creates a meter for the given port and
+ * registers it with the port so that it gets
+ * processed by the engine.
+ *
+ * Must be called from the GTK thread.
+ */
 Meter *
 meter_new_for_port (
   Port * port)
@@ -258,6 +349,8 @@ meter_new_for_port (
             self->peak_processor,
             AUDIO_ENGINE->sample_rate);
         }
+
+      update_port_meters (port, self, true);
     }
   else if (port->id.type == TYPE_EVENT)
     {
@@ -266,8 +359,8 @@ meter_new_for_port (
   return self;
 }
 
-void
-meter_free (
+static void
+free_meter (
   Meter * self)
 {
 #define FREE_DSP(x,name) \
@@ -285,3 +378,25 @@ meter_free (
 
   free (self);
 }
+
+/**
+ * Unregisters the meter from its port and frees
+ * it once the engine no longer uses it.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+meter_free (
+  Meter * self)
+{
+  Port * port = g_atomic_pointer_get (&self->port);
+  if (port && port->meters)
+    {
+      update_port_meters (port, self, false);
+      free_later (self, free_meter);
+    }
+  else
+    {
+      free_meter (self);
+    }
+}
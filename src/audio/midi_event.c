@@ -39,6 +39,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <string.h>
 
 #include "audio/channel.h"
 #include "audio/chord_descriptor.h"
@@ -48,6 +49,7 @@
 #include "audio/transport.h"
 #include "project.h"
 #include "utils/objects.h"
+#include "utils/rt_trace.h"
 
 static const char * midi_event_type_strings[] =
 {
@@ -112,11 +114,6 @@ midi_events_append_w_filter (
       if (src_ev->time < local_offset ||
           src_ev->time >= local_offset + nframes)
         {
-          g_debug (
-            "skipping event: time %" PRIu8
-            " (local offset %" PRIu32
-            " nframes %" PRIu32 ")",
-            src_ev->time, local_offset, nframes);
           continue;
         }
 
@@ -483,7 +480,7 @@ midi_events_copy_to_jack (
       midi_data[2] = ev->raw_buffer[2];
       jack_midi_event_write (
         buff, ev->time, midi_data, 3);
-      g_message (
+      rt_debug (
         "wrote MIDI event to JACK MIDI out at %d",
         ev->time);
     }
@@ -626,6 +623,8 @@ cmpfunc (
 
 /**
  * Sorts the MidiEvents by time.
+ *
+ * Does nothing if they are already sorted.
  */
 void
 midi_events_sort (
@@ -644,8 +643,195 @@ midi_events_sort (
       events = self->events;
       num_events = (size_t) self->num_events;
     }
-  qsort (events, num_events, sizeof (MidiEvent),
-         cmpfunc);
+
+  /* events are usually already sorted (eg, when
+   * merged with midi_events_merge()), so avoid
+   * sorting them again */
+  for (size_t i = 1; i < num_events; i++)
+    {
+      if (cmpfunc (&events[i - 1], &events[i]) > 0)
+        {
+          qsort (
+            events, num_events, sizeof (MidiEvent),
+            cmpfunc);
+          return;
+        }
+    }
+}
+
+/**
+ * Returns whether an event equal to @p ev exists
+ * among the last events in @p arr that have the
+ * same time as @p ev.
+ *
+ * @p arr must be sorted by time.
+ */
+static inline bool
+has_equal_event_at_same_time (
+  const MidiEvent * arr,
+  int               num_events,
+  const MidiEvent * ev)
+{
+  for (int i = num_events - 1;
+       i >= 0 && arr[i].time == ev->time; i--)
+    {
+      if (midi_events_are_equal (&arr[i], ev))
+        return true;
+    }
+
+  return false;
+}
+
+/**
+ * Returns the next event of @p src starting at
+ * @p idx that is inside the given range and
+ * allowed by @p channels, or NULL if there are
+ * no more events.
+ */
+static inline const MidiEvent *
+get_next_event_to_merge (
+  MidiEvents *    src,
+  int *           channels,
+  int *           idx,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  for (; *idx < src->num_events; (*idx)++)
+    {
+      const MidiEvent * ev = &src->events[*idx];
+      if (ev->time < local_offset ||
+          ev->time >= local_offset + nframes)
+        continue;
+      if (channels &&
+          !channels[ev->raw_buffer[0] & 0xf])
+        continue;
+
+      return ev;
+    }
+
+  return NULL;
+}
+
+/**
+ * Merges the events of the given sources into
+ * @p dest, keeping the events sorted by time and
+ * skipping duplicates.
+ *
+ * The events of each source and the existing
+ * events of @p dest must already be sorted, in
+ * which case the result is sorted too and this
+ * only takes linear time in the number of
+ * events.
+ *
+ * @param srcs Sources to merge the main events of.
+ * @param channels Allowed channels (array of 16
+ *   booleans) for each source, or NULL to allow
+ *   all channels. The array itself may be NULL.
+ * @param num_srcs Number of sources, up to
+ *   @ref MIDI_EVENTS_MAX_MERGE_SOURCES.
+ * @param local_offset The start frame offset from 0
+ *   in this cycle.
+ * @param nframes Number of frames to process.
+ */
+REALTIME
+void
+midi_events_merge (
+  MidiEvents *    dest,
+  MidiEvents **   srcs,
+  int **          channels,
+  const int       num_srcs,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  g_return_if_fail (
+    num_srcs <= MIDI_EVENTS_MAX_MERGE_SOURCES);
+
+  /* move the existing events to the end so that
+   * the merged events can be written from the
+   * start while the existing ones are read */
+  int num_dest_events = dest->num_events;
+  int dest_idx = MAX_MIDI_EVENTS - num_dest_events;
+  if (num_dest_events > 0 && dest_idx > 0)
+    {
+      memmove (
+        &dest->events[dest_idx], dest->events,
+        (size_t) num_dest_events *
+          sizeof (MidiEvent));
+    }
+
+  const MidiEvent * heads[
+    MIDI_EVENTS_MAX_MERGE_SOURCES];
+  int idxs[MIDI_EVENTS_MAX_MERGE_SOURCES];
+  for (int i = 0; i < num_srcs; i++)
+    {
+      idxs[i] = 0;
+      heads[i] =
+        get_next_event_to_merge (
+          srcs[i], channels ? channels[i] : NULL,
+          &idxs[i], local_offset, nframes);
+    }
+
+  int num_written = 0;
+  while (true)
+    {
+      /* find the earliest event among the heads
+       * of the sources, -1 means the existing
+       * events */
+      const MidiEvent * ev =
+        dest_idx < MAX_MIDI_EVENTS ?
+          &dest->events[dest_idx] : NULL;
+      int src_idx = -1;
+      for (int i = 0; i < num_srcs; i++)
+        {
+          if (heads[i] &&
+              (!ev || cmpfunc (heads[i], ev) < 0))
+            {
+              ev = heads[i];
+              src_idx = i;
+            }
+        }
+      if (!ev)
+        break;
+
+      /* writing would overwrite existing events
+       * that were not read yet, so there is no
+       * space left */
+      if (src_idx >= 0 &&
+          num_written >= dest_idx &&
+          dest_idx < MAX_MIDI_EVENTS)
+        break;
+      if (num_written == MAX_MIDI_EVENTS)
+        break;
+
+      if (!has_equal_event_at_same_time (
+             dest->events, num_written, ev))
+        {
+          if (&dest->events[num_written] != ev)
+            {
+              midi_event_copy (
+                &dest->events[num_written],
+                (MidiEvent *) ev);
+            }
+          num_written++;
+        }
+
+      if (src_idx >= 0)
+        {
+          idxs[src_idx]++;
+          heads[src_idx] =
+            get_next_event_to_merge (
+              srcs[src_idx],
+              channels ? channels[src_idx] : NULL,
+              &idxs[src_idx], local_offset,
+              nframes);
+        }
+      else
+        {
+          dest_idx++;
+        }
+    }
+
+  dest->num_events = num_written;
 }
 
 /**
@@ -752,25 +938,25 @@ print_unknown_event_message (
 {
   if (buf_size == 3)
     {
-      g_warning (
+      rt_warning (
         "Unknown MIDI event %#x %#x %#x"
         " received", buf[0], buf[1], buf[2]);
     }
   else if (buf_size == 2)
     {
-      g_warning (
+      rt_warning (
         "Unknown MIDI event %#x %#x"
         " received", buf[0], buf[1]);
     }
   else if (buf_size == 1)
     {
-      g_warning (
+      rt_warning (
         "Unknown MIDI event %#x"
         " received", buf[0]);
     }
   else
     {
-      g_warning (
+      rt_warning (
         "Unknown MIDI event of size %d"
         " received", buf_size);
     }
@@ -794,7 +980,7 @@ midi_events_add_event_from_buf (
 {
   if (buf_size != 3)
     {
-      g_debug (
+      rt_debug (
         "buf size of %d received (%"PRIu8" %"
         PRIu8" %"PRIu8"), expected 3, skipping...",
         buf_size > 0 ? buf[0] : 0,
@@ -945,9 +1131,14 @@ midi_events_print (
 /**
  * Clears duplicates.
  *
+ * The events must be sorted by time (see
+ * midi_events_sort()), so that only events at the
+ * same time need to be compared.
+ *
  * @param queued Clear duplicates from queued events
  * instead.
  */
+REALTIME
 void
 midi_events_clear_duplicates (
   MidiEvents * self,
@@ -957,37 +1148,29 @@ midi_events_clear_duplicates (
     queued ?
       self->queued_events :
       self->events;
-  MidiEvent * ev1, * ev2;
-#define NUM_EVENTS \
-  (queued ? self->num_queued_events : \
-   self->num_events)
+  int num_events =
+    queued ?
+      self->num_queued_events :
+      self->num_events;
 
-  int i, j, k;
-  for (i = 0; i < NUM_EVENTS; i++)
+  int num_kept = 0;
+  for (int i = 0; i < num_events; i++)
     {
-      ev1 = &arr[i];
+      if (has_equal_event_at_same_time (
+            arr, num_kept, &arr[i]))
+        continue;
 
-      for (j = i + 1; j < NUM_EVENTS; j++)
+      if (num_kept != i)
         {
-          ev2 = &arr[j];
-
-          if (midi_events_are_equal (ev1, ev2))
-            {
-              g_message (
-                "removing duplicate MIDI event");
-              for (k = j; k < NUM_EVENTS; k++)
-                {
-                  midi_event_copy (
-                    &arr[k], &arr[k + 1]);
-                }
-              if (queued)
-                self->num_queued_events--;
-              else
-                self->num_events--;
-              j--;
-            }
+          midi_event_copy (&arr[num_kept], &arr[i]);
         }
+      num_kept++;
     }
+
+  if (queued)
+    self->num_queued_events = num_kept;
+  else
+    self->num_events = num_kept;
 }
 
 /**
@@ -46,6 +46,7 @@
 #include "audio/region.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -65,6 +66,7 @@
 #include "utils/math.h"
 #include "utils/object_utils.h"
 #include "utils/objects.h"
+#include "utils/rt_trace.h"
 #include "utils/yaml.h"
 #include "zrythm_app.h"
 
@@ -192,6 +194,8 @@ midi_region_insert_midi_note (
   self->midi_notes[idx] = midi_note;
   midi_note_set_region_and_index (
     midi_note, self, idx);
+  midi_region_invalidate_note_index (self);
+  arranger_object_index_invalidate_all ();
 
   if (pub_events)
     {
@@ -364,6 +368,8 @@ midi_region_remove_midi_note (
   array_delete (
     region->midi_notes, region->num_midi_notes,
     midi_note);
+  midi_region_invalidate_note_index (region);
+  arranger_object_index_invalidate_all ();
 
   for (int i = 0; i < region->num_midi_notes; i++)
     {
@@ -1036,12 +1042,224 @@ send_notes_off_at (
       /* FIXME set channel */
     }
 
-  g_message ("all notes off at %d", time);
+  rt_debug ("all notes off at %d", time);
   midi_events_add_all_notes_off (
     midi_events, channel, time, F_QUEUED);
 
 }
 
+/**
+ * Returns the end position of the given MIDI note
+ * or chord object in frames, local to the region.
+ */
+static inline long
+get_note_end_frames (
+  ArrangerObject * obj)
+{
+  if (obj->type == ARRANGER_OBJECT_TYPE_CHORD_OBJECT)
+    {
+      return
+        math_round_double_to_type (
+          obj->pos.frames +
+            TRANSPORT->ticks_per_beat *
+            AUDIO_ENGINE->frames_per_tick,
+            long);
+    }
+
+  return obj->end_pos.frames;
+}
+
+/**
+ * Adds the note on event(s) for the given MIDI note
+ * or chord object.
+ */
+static inline void
+add_note_on (
+  ZRegion *        self,
+  ArrangerObject * obj,
+  midi_time_t      time,
+  MidiEvents *     midi_events)
+{
+  if (obj->type == ARRANGER_OBJECT_TYPE_CHORD_OBJECT)
+    {
+      ChordDescriptor * descr =
+        chord_object_get_chord_descriptor (
+          (ChordObject *) obj);
+      midi_events_add_note_ons_from_chord_descr (
+        midi_events, descr, 1,
+        VELOCITY_DEFAULT, time, F_QUEUED);
+    }
+  else
+    {
+      MidiNote * mn = (MidiNote *) obj;
+      midi_events_add_note_on (
+        midi_events,
+        midi_region_get_midi_ch (self),
+        mn->val, mn->vel->vel, time, F_QUEUED);
+    }
+}
+
+/**
+ * Adds the note off event(s) for the given MIDI
+ * note or chord object.
+ */
+static inline void
+add_note_off (
+  ZRegion *        self,
+  ArrangerObject * obj,
+  midi_time_t      time,
+  MidiEvents *     midi_events)
+{
+  if (obj->type == ARRANGER_OBJECT_TYPE_CHORD_OBJECT)
+    {
+      ChordDescriptor * descr =
+        chord_object_get_chord_descriptor (
+          (ChordObject *) obj);
+      for (int l = 0;
+           l < CHORD_DESCRIPTOR_MAX_NOTES; l++)
+        {
+          if (descr->notes[l])
+            {
+              midi_events_add_note_off (
+                midi_events, 1, l + 36,
+                time, F_QUEUED);
+            }
+        }
+    }
+  else
+    {
+      MidiNote * mn = (MidiNote *) obj;
+      midi_events_add_note_off (
+        midi_events,
+        midi_region_get_midi_ch (self),
+        mn->val, time, F_QUEUED);
+    }
+}
+
+/**
+ * Returns the time of the note off event for a
+ * note ending at the given local frames.
+ */
+static inline midi_time_t
+get_note_off_time (
+  long      end_frames,
+  long      r_local_pos,
+  nframes_t local_start_frame)
+{
+  midi_time_t time =
+    (midi_time_t)
+    (local_start_frame +
+      (end_frames - r_local_pos));
+
+  /* note actually ends 1 frame before the end
+   * point, not at the end point */
+  if (time > 0)
+    {
+      time--;
+    }
+
+  return time;
+}
+
+/**
+ * Returns the index of the first object in the
+ * sorted array that starts (or ends, if
+ * @p use_end is true) at or after the given
+ * local frames.
+ */
+static inline int
+find_first_note_at_or_after (
+  ArrangerObject ** objs,
+  int               num_objs,
+  bool              use_end,
+  long              frames)
+{
+  int low = 0;
+  int high = num_objs;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      long mid_frames =
+        use_end ?
+          get_note_end_frames (objs[mid]) :
+          objs[mid]->pos.frames;
+      if (mid_frames < frames)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+/**
+ * Fills the events by binary-searching the note
+ * index, so only the notes inside the cycle are
+ * visited.
+ */
+REALTIME
+static void
+fill_midi_events_from_index (
+  ZRegion *    self,
+  long         r_local_pos,
+  nframes_t    local_start_frame,
+  nframes_t    nframes,
+  MidiEvents * midi_events)
+{
+  int num_objs = self->num_indexed_notes;
+  long r_local_end = r_local_pos + (long) nframes;
+
+  /* chord objects all have the same length so
+   * they end in the same order they start */
+  ArrangerObject ** by_end =
+    self->notes_by_end ?
+      self->notes_by_end : self->notes_by_start;
+
+  /* note offs first, so that a note off is
+   * before a note on at the same time */
+  for (int i =
+         find_first_note_at_or_after (
+           by_end, num_objs, true, r_local_pos);
+       i < num_objs; i++)
+    {
+      ArrangerObject * obj = by_end[i];
+      long end_frames = get_note_end_frames (obj);
+      if (end_frames > r_local_end)
+        break;
+      if (arranger_object_get_muted (obj))
+        continue;
+
+      add_note_off (
+        self, obj,
+        get_note_off_time (
+          end_frames, r_local_pos,
+          local_start_frame),
+        midi_events);
+    }
+
+  /* note ons */
+  for (int i =
+         find_first_note_at_or_after (
+           self->notes_by_start, num_objs, false,
+           MAX (r_local_pos, 0));
+       i < num_objs; i++)
+    {
+      ArrangerObject * obj =
+        self->notes_by_start[i];
+      if (obj->pos.frames >= r_local_end)
+        break;
+      if (arranger_object_get_muted (obj))
+        continue;
+
+      add_note_on (
+        self, obj,
+        (midi_time_t)
+        (local_start_frame +
+          (obj->pos.frames - r_local_pos)),
+        midi_events);
+    }
+}
+
 /**
  * Fills MIDI event queue from the region.
  *
@@ -1093,29 +1311,27 @@ midi_region_fill_midi_events (
     region_timeline_frames_to_local (
       self, g_start_frames, F_NORMALIZE);
 
-  /* go through each note */
+  if (g_atomic_int_get (&self->note_index_valid))
+    {
+      fill_midi_events_from_index (
+        self, r_local_pos, local_start_frame,
+        nframes, midi_events);
+      return;
+    }
+
+  /* the index is outdated (eg, while notes are
+   * being moved), go through each note */
   int num_objs =
     track->type == TRACK_TYPE_CHORD ?
       self->num_chord_objects :
       self->num_midi_notes;
   for (int i = 0; i < num_objs; i++)
     {
-      ArrangerObject * mn_obj = NULL;
-      MidiNote * mn = NULL;
-      ChordObject * co = NULL;
-      ChordDescriptor * descr = NULL;
-      if (track->type == TRACK_TYPE_CHORD)
-        {
-          co = self->chord_objects[i];
-          descr =
-            chord_object_get_chord_descriptor (co);
-          mn_obj = (ArrangerObject *) co;
-        }
-      else
-        {
-          mn = self->midi_notes[i];
-          mn_obj = (ArrangerObject *) mn;
-        }
+      ArrangerObject * mn_obj =
+        track->type == TRACK_TYPE_CHORD ?
+          (ArrangerObject *)
+          self->chord_objects[i] :
+          (ArrangerObject *) self->midi_notes[i];
       if (arranger_object_get_muted (mn_obj))
         {
           continue;
@@ -1128,78 +1344,150 @@ midi_region_fill_midi_events (
           mn_obj->pos.frames <
             r_local_pos + (long) nframes)
         {
-          midi_time_t time =
+          add_note_on (
+            self, mn_obj,
             (midi_time_t)
             (local_start_frame +
-              (mn_obj->pos.frames - r_local_pos));
-          g_message ("normal note on at %u", time);
-          if (mn)
-            {
-              midi_events_add_note_on (
-                midi_events,
-                midi_region_get_midi_ch (self),
-                mn->val, mn->vel->vel,
-                time, F_QUEUED);
-            }
-          else if (co)
-            {
-              midi_events_add_note_ons_from_chord_descr (
-                midi_events, descr, 1,
-                VELOCITY_DEFAULT, time,
-                F_QUEUED);
-            }
+              (mn_obj->pos.frames - r_local_pos)),
+            midi_events);
         }
 
       long mn_obj_end_frames =
-        (track->type == TRACK_TYPE_CHORD ?
-          math_round_double_to_type (
-            mn_obj->pos.frames +
-              TRANSPORT->ticks_per_beat *
-              AUDIO_ENGINE->frames_per_tick,
-              long) :
-          mn_obj->end_pos.frames);
+        get_note_end_frames (mn_obj);
 
       /* if note ends within the cycle */
       if (mn_obj_end_frames >= r_local_pos &&
           (mn_obj_end_frames <=
             (r_local_pos + nframes)))
         {
-          midi_time_t time =
-            (midi_time_t)
-            (local_start_frame +
-              (mn_obj_end_frames - r_local_pos));
+          add_note_off (
+            self, mn_obj,
+            get_note_off_time (
+              mn_obj_end_frames, r_local_pos,
+              local_start_frame),
+            midi_events);
+        }
+    } /* foreach midi note */
+}
 
-          /* note actually ends 1 frame before
-           * the end point, not at the end
-           * point */
-          if (time > 0)
-            {
-              time--;
-            }
+static int
+cmp_note_start (
+  const void * a,
+  const void * b)
+{
+  const ArrangerObject * obj_a =
+    *(ArrangerObject * const *) a;
+  const ArrangerObject * obj_b =
+    *(ArrangerObject * const *) b;
+  return
+    (obj_a->pos.frames > obj_b->pos.frames) -
+    (obj_a->pos.frames < obj_b->pos.frames);
+}
 
-          if (mn)
-            {
-              midi_events_add_note_off (
-                midi_events,
-                midi_region_get_midi_ch (self),
-                mn->val, time, F_QUEUED);
-            }
-          else if (co)
-            {
-              for (int l = 0;
-                   l < CHORD_DESCRIPTOR_MAX_NOTES;
-                   l++)
-                {
-                  if (descr->notes[l])
-                    {
-                      midi_events_add_note_off (
-                        midi_events, 1, l + 36,
-                        time, F_QUEUED);
-                    }
-                }
-            }
+static int
+cmp_note_end (
+  const void * a,
+  const void * b)
+{
+  const ArrangerObject * obj_a =
+    *(ArrangerObject * const *) a;
+  const ArrangerObject * obj_b =
+    *(ArrangerObject * const *) b;
+  return
+    (obj_a->end_pos.frames >
+       obj_b->end_pos.frames) -
+    (obj_a->end_pos.frames <
+       obj_b->end_pos.frames);
+}
+
+/**
+ * Rebuilds the time-sorted note index of the
+ * given MIDI or chord region.
+ *
+ * Must not be called while the engine is
+ * processing the region.
+ *
+ * @see ZRegion.notes_by_start.
+ */
+void
+midi_region_update_note_index (
+  ZRegion * self)
+{
+  g_return_if_fail (
+    IS_REGION (self) &&
+    (self->id.type == REGION_TYPE_MIDI ||
+     self->id.type == REGION_TYPE_CHORD));
+
+  bool is_chord =
+    self->id.type == REGION_TYPE_CHORD;
+  int num_objs =
+    is_chord ?
+      self->num_chord_objects :
+      self->num_midi_notes;
+  ArrangerObject ** objs =
+    is_chord ?
+      (ArrangerObject **) self->chord_objects :
+      (ArrangerObject **) self->midi_notes;
+
+  if ((size_t) num_objs > self->indexed_notes_size)
+    {
+      size_t new_size =
+        MAX (
+          (size_t) num_objs,
+          self->indexed_notes_size * 2);
+      self->notes_by_start =
+        g_realloc_n (
+          self->notes_by_start, new_size,
+          sizeof (ArrangerObject *));
+      if (!is_chord)
+        {
+          self->notes_by_end =
+            g_realloc_n (
+              self->notes_by_end, new_size,
+              sizeof (ArrangerObject *));
         }
-    } /* foreach midi note */
+      self->indexed_notes_size = new_size;
+    }
+
+  if (num_objs > 0)
+    {
+      memcpy (
+        self->notes_by_start, objs,
+        (size_t) num_objs *
+          sizeof (ArrangerObject *));
+      qsort (
+        self->notes_by_start, (size_t) num_objs,
+        sizeof (ArrangerObject *),
+        cmp_note_start);
+      if (!is_chord)
+        {
+          memcpy (
+            self->notes_by_end, objs,
+            (size_t) num_objs *
+              sizeof (ArrangerObject *));
+          qsort (
+            self->notes_by_end, (size_t) num_objs,
+            sizeof (ArrangerObject *),
+            cmp_note_end);
+        }
+    }
+  self->num_indexed_notes = num_objs;
+
+  g_atomic_int_set (&self->note_index_valid, 1);
+}
+
+/**
+ * Marks the note index of the given MIDI or chord
+ * region as outdated.
+ *
+ * To be called when notes are added, removed or
+ * moved.
+ */
+void
+midi_region_invalidate_note_index (
+  ZRegion * self)
+{
+  g_atomic_int_set (&self->note_index_valid, 0);
 }
 
 /**
@@ -1218,4 +1506,7 @@ midi_region_free_members (ZRegion * self)
       arranger_object_free (
         (ArrangerObject *) self->midi_notes[i]);
     }
+
+  g_free (self->notes_by_start);
+  g_free (self->notes_by_end);
 }
@@ -62,6 +62,7 @@ modulator_macro_processor_process (
         &self->cv_out->buf[start_frame],
         &self->cv_in->buf[start_frame],
         0.f, self->macro->control, nframes);
+      self->cv_out->silent = false;
     }
   /* else if there are no inputs, set the knob value
    * as the output */
@@ -74,6 +75,7 @@ modulator_macro_processor_process (
           (cv_out->maxf - cv_out->minf) +
           cv_out->minf,
         nframes);
+      cv_out->silent = false;
     }
 }
 
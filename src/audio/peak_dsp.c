@@ -41,6 +41,7 @@
 #include <math.h>
 
 #include "audio/peak_dsp.h"
+#include "utils/dsp.h"
 
 /**
  * Process.
@@ -53,7 +54,7 @@ peak_dsp_process (
   PeakDsp * self,
   float * p, int n)
 {
-  float  s = 0.f, t;
+  float  t;
 
   if (self->fpp != n)
     {
@@ -64,21 +65,12 @@ peak_dsp_process (
       self->fpp = n;
     }
 
+  // Update digital peak.
   t = 0;
-
-  // Perform processing
-  float max = 0.f;
-  while (n--)
-    {
-      s = *p++;
-      if (fabsf (s) > max)
-        {
-          max = fabsf (s);
-        }
-      if (t < max) t = max;             // Update digital peak.
-    }
+  dsp_abs_max (p, &t, (size_t) n);
 
   if (!isfinite(t)) t = 0;
+  float max = t;
 
   if (self->flag) // Display thread has read the rms value.
     {
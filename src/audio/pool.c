@@ -20,28 +20,175 @@
 #include <stdlib.h>
 
 #include "audio/clip.h"
+#include "audio/clip_stream.h"
 #include "audio/pool.h"
 #include "audio/track.h"
 #include "utils/arrays.h"
+#include "utils/audio.h"
 #include "utils/io.h"
 #include "utils/objects.h"
 #include "utils/string.h"
+#include "zrythm.h"
+#include "zrythm_app.h"
 
 #include <gtk/gtk.h>
 
+#include <glib/gi18n.h>
+
+/**
+ * Max time to wait for a clip to finish loading
+ * before iterating the main context again, in
+ * microseconds.
+ */
+#define AUDIO_POOL_LOAD_UI_INTERVAL 16000
+
+/**
+ * Shared state of the clip loading workers.
+ */
+typedef struct LoadClipsData
+{
+  /** Number of clips loaded so far. */
+  int    num_loaded;
+
+  /** Lock for num_loaded. */
+  GMutex lock;
+
+  /** Signaled when a clip finished loading. */
+  GCond  cond;
+} LoadClipsData;
+
+/**
+ * Thread pool function that loads a clip.
+ */
+static void
+load_clip_func (
+  AudioClip *     clip,
+  LoadClipsData * data)
+{
+  gint64 start_time = g_get_monotonic_time ();
+  audio_clip_init_loaded (clip);
+  gint64 end_time = g_get_monotonic_time ();
+
+  g_message (
+    "loaded clip %s (%s, %ld frames) in %"
+    G_GINT64_FORMAT " ms",
+    clip->name,
+    clip->stream ?
+      "streamed" :
+      clip->mapped_file ? "cached" : "decoded",
+    clip->num_frames,
+    (end_time - start_time) / 1000);
+
+  g_mutex_lock (&data->lock);
+  data->num_loaded++;
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
 /**
  * Inits after loading a project.
+ *
+ * The clips are decoded in parallel on a thread
+ * pool with one thread per core.
  */
 void
 audio_pool_init_loaded (
   AudioPool * self)
 {
   self->clips_size = (size_t) self->num_clips;
-
-  for (int i = 0; i < self->num_clips; i++)
+  self->streamer = clip_streamer_new ();
+
+  if (self->num_clips == 0)
+    return;
+
+  gint64 start_time = g_get_monotonic_time ();
+
+  LoadClipsData data;
+  data.num_loaded = 0;
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+
+  int num_threads =
+    MIN (audio_get_num_cores (), self->num_clips);
+  GError * err = NULL;
+  GThreadPool * pool =
+    g_thread_pool_new (
+      (GFunc) load_clip_func, &data,
+      MAX (num_threads, 1), true, &err);
+  if (!pool)
+    {
+      g_warning (
+        "failed to create thread pool, loading "
+        "clips serially: %s", err->message);
+      g_error_free (err);
+      for (int i = 0; i < self->num_clips; i++)
+        {
+          load_clip_func (self->clips[i], &data);
+        }
+    }
+  else
     {
-      audio_clip_init_loaded (self->clips[i]);
+      for (int i = 0; i < self->num_clips; i++)
+        {
+          g_thread_pool_push (
+            pool, self->clips[i], NULL);
+        }
+
+      /* report progress until all clips are
+       * loaded, iterating the main context so
+       * that the splash screen gets redrawn */
+      bool pump_ui =
+        ZRYTHM_HAVE_UI &&
+        g_main_context_is_owner (NULL);
+      g_mutex_lock (&data.lock);
+      while (data.num_loaded < self->num_clips)
+        {
+          if (ZRYTHM_HAVE_UI)
+            {
+              char * status =
+                g_strdup_printf (
+                  _("Loading audio clips (%d/%d)"),
+                  data.num_loaded,
+                  self->num_clips);
+              zrythm_app_set_progress_status (
+                zrythm_app, status,
+                0.8 +
+                  0.15 * (double) data.num_loaded /
+                    (double) self->num_clips);
+              g_free (status);
+            }
+          if (pump_ui)
+            {
+              g_mutex_unlock (&data.lock);
+              while (g_main_context_iteration (
+                       NULL, false));
+              g_mutex_lock (&data.lock);
+              if (data.num_loaded >= self->num_clips)
+                break;
+
+              g_cond_wait_until (
+                &data.cond, &data.lock,
+                g_get_monotonic_time () +
+                  AUDIO_POOL_LOAD_UI_INTERVAL);
+            }
+          else
+            {
+              g_cond_wait (&data.cond, &data.lock);
+            }
+        }
+      g_mutex_unlock (&data.lock);
+
+      g_thread_pool_free (pool, false, true);
     }
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+
+  g_message (
+    "loaded %d clips on %d threads in %"
+    G_GINT64_FORMAT " ms",
+    self->num_clips, num_threads,
+    (g_get_monotonic_time () - start_time) / 1000);
 }
 
 /**
@@ -57,6 +204,7 @@ audio_pool_new ()
   self->clips =
     calloc (
       self->clips_size, sizeof (AudioClip *));
+  self->streamer = clip_streamer_new ();
 
   return self;
 }
@@ -211,10 +359,17 @@ audio_pool_duplicate_clip (
     audio_pool_get_clip (self, clip_id);
   g_return_val_if_fail (clip, -1);
 
+  float * frames =
+    malloc (
+      (size_t) MAX (clip->num_frames, 1) *
+      clip->channels * sizeof (float));
+  audio_clip_get_interleaved_frames (
+    clip, 0, (size_t) clip->num_frames, frames);
   AudioClip * new_clip =
     audio_clip_new_from_float_array (
-      clip->frames, clip->num_frames, clip->channels,
+      frames, clip->num_frames, clip->channels,
       clip->name);
+  free (frames);
   audio_pool_add_clip (self, new_clip);
 
   g_message (
@@ -301,8 +456,7 @@ audio_pool_reload_clip_frame_bufs (
         {
           /* unload frames */
           clip->num_frames = 0;
-          free (clip->frames);
-          clip->frames = NULL;
+          audio_clip_free_frames (clip);
         }
     }
 }
@@ -317,6 +471,8 @@ audio_pool_free (
         audio_clip_free, self->clips[i]);
     }
   object_zero_and_free (self->clips);
+  object_free_w_func_and_null (
+    clip_streamer_free, self->streamer);
 
   object_zero_and_free (self);
 }
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "audio/clip.h"
+#include "audio/engine.h"
+#include "audio/pool_cache.h"
+#include "project.h"
+#include "utils/file.h"
+#include "utils/io.h"
+#include "utils/string.h"
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#define POOL_CACHE_MAGIC "ZPOOLC1"
+
+/** Protects the index file. */
+static GMutex index_lock;
+
+static char *
+compute_file_hash (
+  const char * path)
+{
+  FILE * file = g_fopen (path, "rb");
+  if (!file)
+    return NULL;
+
+  GChecksum * checksum =
+    g_checksum_new (G_CHECKSUM_MD5);
+  guchar buf[65536];
+  size_t read;
+  while ((read = fread (buf, 1, sizeof (buf), file)))
+    {
+      g_checksum_update (
+        checksum, buf, (gssize) read);
+    }
+  fclose (file);
+
+  char * hash =
+    g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return hash;
+}
+
+/**
+ * Removes the cache files of the given hash if no
+ * other pool file in the index has it.
+ */
+static void
+remove_unused_cache_files (
+  GKeyFile *   index,
+  const char * cache_dir,
+  const char * hash)
+{
+  gsize num_groups;
+  char ** groups =
+    g_key_file_get_groups (index, &num_groups);
+  bool used = false;
+  for (gsize i = 0; i < num_groups; i++)
+    {
+      char * group_hash =
+        g_key_file_get_string (
+          index, groups[i], "hash", NULL);
+      used = g_strcmp0 (group_hash, hash) == 0;
+      g_free (group_hash);
+      if (used)
+        break;
+    }
+  g_strfreev (groups);
+  if (used)
+    return;
+
+  GDir * dir = g_dir_open (cache_dir, 0, NULL);
+  if (!dir)
+    return;
+  const char * filename;
+  while ((filename = g_dir_read_name (dir)))
+    {
+      if (g_str_has_prefix (filename, hash))
+        {
+          char * path =
+            g_build_filename (
+              cache_dir, filename, NULL);
+          io_remove (path);
+          g_free (path);
+        }
+    }
+  g_dir_close (dir);
+}
+
+/**
+ * Returns the hash of the contents of the given
+ * pool file.
+ *
+ * The hash stored in the index is reused if the
+ * file's size and modification time did not
+ * change.
+ */
+static char *
+get_file_hash (
+  const char * cache_dir,
+  const char * path)
+{
+  GStatBuf st;
+  if (g_stat (path, &st) != 0)
+    return NULL;
+
+  char * basename = g_path_get_basename (path);
+  char * index_path =
+    g_build_filename (
+      cache_dir, POOL_CACHE_INDEX_FILE, NULL);
+
+  g_mutex_lock (&index_lock);
+  GKeyFile * index = g_key_file_new ();
+  g_key_file_load_from_file (
+    index, index_path, G_KEY_FILE_NONE, NULL);
+  char * hash = NULL;
+  if (g_key_file_get_int64 (
+        index, basename, "size", NULL) ==
+          (gint64) st.st_size &&
+      g_key_file_get_int64 (
+        index, basename, "mtime", NULL) ==
+          (gint64) st.st_mtime)
+    {
+      hash =
+        g_key_file_get_string (
+          index, basename, "hash", NULL);
+    }
+  g_key_file_free (index);
+  g_mutex_unlock (&index_lock);
+
+  if (hash)
+    {
+      g_free (basename);
+      g_free (index_path);
+      return hash;
+    }
+
+  /* hash outside the lock, this reads the whole
+   * file */
+  hash = compute_file_hash (path);
+  if (!hash)
+    {
+      g_free (basename);
+      g_free (index_path);
+      return NULL;
+    }
+
+  g_mutex_lock (&index_lock);
+  index = g_key_file_new ();
+  g_key_file_load_from_file (
+    index, index_path, G_KEY_FILE_NONE, NULL);
+  char * prev_hash =
+    g_key_file_get_string (
+      index, basename, "hash", NULL);
+  g_key_file_set_int64 (
+    index, basename, "size", (gint64) st.st_size);
+  g_key_file_set_int64 (
+    index, basename, "mtime",
+    (gint64) st.st_mtime);
+  g_key_file_set_string (
+    index, basename, "hash", hash);
+  GError * err = NULL;
+  if (!g_key_file_save_to_file (
+         index, index_path, &err))
+    {
+      g_warning (
+        "failed to save pool cache index: %s",
+        err->message);
+      g_error_free (err);
+    }
+
+  /* the file changed, drop its stale cache */
+  if (prev_hash && !string_is_equal (prev_hash, hash))
+    {
+      remove_unused_cache_files (
+        index, cache_dir, prev_hash);
+    }
+  g_free (prev_hash);
+  g_key_file_free (index);
+  g_mutex_unlock (&index_lock);
+
+  g_free (basename);
+  g_free (index_path);
+
+  return hash;
+}
+
+static char *
+get_cache_file_path (
+  const char * cache_dir,
+  const char * hash,
+  int          samplerate)
+{
+  char * filename =
+    g_strdup_printf ("%s-%d.raw", hash, samplerate);
+  char * path =
+    g_build_filename (cache_dir, filename, NULL);
+  g_free (filename);
+
+  return path;
+}
+
+/**
+ * Maps the cached frames of the given pool file
+ * into the clip.
+ *
+ * The clip's frames are mapped copy-on-write, so
+ * editing them never modifies the cache.
+ *
+ * @return Whether a valid cache file was found
+ *   for the file's current contents and the
+ *   engine's sample rate.
+ */
+bool
+pool_cache_load_clip (
+  AudioClip *  clip,
+  const char * path)
+{
+  g_return_val_if_fail (
+    !clip->ch_frames[0] && !clip->stream, false);
+
+  int samplerate = (int) AUDIO_ENGINE->sample_rate;
+  char * cache_dir =
+    project_get_path (
+      PROJECT, PROJECT_PATH_POOL_CACHE, false);
+  if (!file_exists (cache_dir))
+    {
+      g_free (cache_dir);
+      return false;
+    }
+
+  char * hash = get_file_hash (cache_dir, path);
+  if (!hash)
+    {
+      g_free (cache_dir);
+      return false;
+    }
+  char * cache_path =
+    get_cache_file_path (
+      cache_dir, hash, samplerate);
+  g_free (cache_dir);
+  g_free (hash);
+
+  GMappedFile * mapped_file =
+    file_exists (cache_path) ?
+      g_mapped_file_new (cache_path, true, NULL) :
+      NULL;
+  if (!mapped_file)
+    {
+      g_free (cache_path);
+      return false;
+    }
+
+  /* validate */
+  gsize length =
+    g_mapped_file_get_length (mapped_file);
+  char * contents =
+    g_mapped_file_get_contents (mapped_file);
+  const PoolCacheHeader * header =
+    (const PoolCacheHeader *) contents;
+  if (length < POOL_CACHE_DATA_OFFSET ||
+      memcmp (
+        header->magic, POOL_CACHE_MAGIC,
+        sizeof (header->magic)) != 0 ||
+      header->version != POOL_CACHE_VERSION ||
+      header->samplerate != (guint32) samplerate ||
+      header->channels == 0 ||
+      header->channels > 16 ||
+      header->num_frames <= 0 ||
+      length !=
+        POOL_CACHE_DATA_OFFSET +
+          sizeof (float) * header->channels *
+            (gsize) header->num_frames)
+    {
+      g_message (
+        "ignoring invalid pool cache file %s",
+        cache_path);
+      g_mapped_file_unref (mapped_file);
+      g_free (cache_path);
+      return false;
+    }
+
+  clip->mapped_file = mapped_file;
+  clip->channels = header->channels;
+  clip->num_frames = (long) header->num_frames;
+  clip->ch_frames_size = (size_t) clip->num_frames;
+  clip->samplerate = samplerate;
+  float * frames =
+    (float *) &contents[POOL_CACHE_DATA_OFFSET];
+  for (unsigned int i = 0; i < clip->channels; i++)
+    {
+      clip->ch_frames[i] =
+        &frames[(size_t) i * clip->ch_frames_size];
+    }
+  g_free (clip->name);
+  clip->name = g_path_get_basename (path);
+
+  g_debug (
+    "loaded %s from pool cache %s",
+    path, cache_path);
+  g_free (cache_path);
+
+  return true;
+}
+
+/**
+ * Stores the decoded frames of the clip in the
+ * cache for the given pool file.
+ */
+void
+pool_cache_store_clip (
+  AudioClip *  clip,
+  const char * path)
+{
+  g_return_if_fail (
+    clip->ch_frames[0] && clip->num_frames > 0);
+
+  char * cache_dir =
+    project_get_path (
+      PROJECT, PROJECT_PATH_POOL_CACHE, false);
+  if (!file_exists (cache_dir))
+    {
+      io_mkdir (cache_dir);
+    }
+
+  char * hash = get_file_hash (cache_dir, path);
+  if (!hash)
+    {
+      g_free (cache_dir);
+      return;
+    }
+  char * cache_path =
+    get_cache_file_path (
+      cache_dir, hash, clip->samplerate);
+  /* clips with the same contents may be stored
+   * by different threads at the same time, so
+   * use a unique temporary file */
+  char * tmp_path =
+    g_strdup_printf ("%s.XXXXXX", cache_path);
+  g_free (cache_dir);
+  g_free (hash);
+
+  int fd = g_mkstemp (tmp_path);
+  FILE * file = fd >= 0 ? fdopen (fd, "wb") : NULL;
+  if (!file)
+    {
+      if (fd >= 0)
+        close (fd);
+      g_warning (
+        "failed to open %s for writing", tmp_path);
+      g_free (cache_path);
+      g_free (tmp_path);
+      return;
+    }
+
+  char header_buf[POOL_CACHE_DATA_OFFSET];
+  memset (header_buf, 0, sizeof (header_buf));
+  PoolCacheHeader * header =
+    (PoolCacheHeader *) header_buf;
+  memcpy (
+    header->magic, POOL_CACHE_MAGIC,
+    sizeof (header->magic));
+  header->version = POOL_CACHE_VERSION;
+  header->samplerate = (guint32) clip->samplerate;
+  header->channels = clip->channels;
+  header->num_frames = clip->num_frames;
+
+  bool success =
+    fwrite (
+      header_buf, sizeof (header_buf), 1, file) == 1;
+  for (unsigned int i = 0;
+       success && i < clip->channels; i++)
+    {
+      success =
+        fwrite (
+          clip->ch_frames[i], sizeof (float),
+          (size_t) clip->num_frames, file) ==
+        (size_t) clip->num_frames;
+    }
+  success = (fclose (file) == 0) && success;
+
+  if (success &&
+      g_rename (tmp_path, cache_path) == 0)
+    {
+      g_debug (
+        "stored %s in pool cache %s",
+        path, cache_path);
+    }
+  else
+    {
+      g_warning (
+        "failed to write pool cache file %s",
+        cache_path);
+      io_remove (tmp_path);
+    }
+
+  g_free (cache_path);
+  g_free (tmp_path);
+}
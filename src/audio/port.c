@@ -27,12 +27,14 @@
 #include "project.h"
 #include "audio/channel.h"
 #include "audio/clip.h"
+#include "audio/clip_stream.h"
 #include "audio/control_port.h"
 #ifdef HAVE_JACK
 #include "audio/engine_jack.h"
 #endif
 #include "audio/graph.h"
 #include "audio/hardware_processor.h"
+#include "audio/meter.h"
 #include "audio/midi_event.h"
 #include "audio/pan.h"
 #include "audio/port.h"
@@ -52,6 +54,7 @@
 #include "utils/math.h"
 #include "utils/object_utils.h"
 #include "utils/objects.h"
+#include "utils/rt_trace.h"
 #include "utils/string.h"
 #include "zix/ring.h"
 #include "zrythm_app.h"
@@ -668,34 +671,45 @@ stereo_ports_fill_from_clip (
   nframes_t     start_frame,
   nframes_t     nframes)
 {
-  channels_t max_channels = MAX (2, clip->channels);
-  for (nframes_t i = start_frame;
-       i < start_frame + nframes;
-       i++)
-    {
-      /* no more frames to read */
-      if (g_start_frames + i > clip->num_frames)
-        {
-          return;
-        }
+  /* frames in the clip to read */
+  long clip_start = g_start_frames + start_frame;
+  if (clip_start < 0 ||
+      clip_start >= clip->num_frames)
+    return;
+  size_t len =
+    (size_t)
+    MIN ((long) nframes, clip->num_frames - clip_start);
 
-      if (max_channels == 1)
+  float * lbuf = &self->l->buf[start_frame];
+  float * rbuf = &self->r->buf[start_frame];
+  self->l->silent = false;
+  self->r->silent = false;
+  ClipStream * stream =
+    g_atomic_pointer_get (&clip->stream);
+  if (stream)
+    {
+      clip_stream_read (
+        stream, 0, clip_start, len, lbuf);
+      if (clip->channels == 1)
         {
-          self->l->buf[i] =
-            clip->frames[g_start_frames + i];
-          self->r->buf[i] =
-            clip->frames[g_start_frames + i];
+          dsp_copy (rbuf, lbuf, len);
         }
-      else if (max_channels == 2)
+      else
         {
-          self->l->buf[i] =
-            clip->frames[
-              (g_start_frames + i) * 2];
-          self->r->buf[i] =
-            clip->frames[
-              (g_start_frames + i) * 2 + 1];
+          clip_stream_read (
+            stream, 1, clip_start, len, rbuf);
         }
     }
+  else
+    {
+      dsp_copy (
+        lbuf, &clip->ch_frames[0][clip_start], len);
+      dsp_copy (
+        rbuf,
+        &clip->ch_frames[
+          clip->channels == 1 ? 0 : 1][clip_start],
+        len);
+    }
 }
 
 void
@@ -812,6 +826,7 @@ port_receive_audio_data_from_jack (
   dsp_add2 (
     &self->buf[start_frames],
     &in[start_frames], nframes);
+  self->silent = false;
 }
 
 static void
@@ -1073,6 +1088,7 @@ sum_data_from_dummy (
           dsp_add2 (
             &self->buf[start_frame],
             &port->buf[start_frame], nframes);
+          self->silent = false;
         }
     }
 }
@@ -2270,6 +2286,7 @@ port_sum_data_from_rtaudio (
       dsp_add2 (
         &self->buf[start_frame],
         &dev->buf[start_frame], nframes);
+      self->silent = false;
     }
 }
 #endif // HAVE_RTAUDIO
@@ -2832,6 +2849,90 @@ stereo_ports_new_generic (
   return ports;
 }
 
+/**
+ * Renders the automation of the given control
+ * port into @p buf.
+ *
+ * The automation is evaluated every
+ * @ref PORT_AUTOMATION_RENDER_STEP frames and the
+ * values in between are interpolated linearly.
+ * Frames without automation keep the current
+ * value.
+ *
+ * @param buf Buffer to fill, starting at
+ *   @p g_start_frames.
+ *
+ * @return Whether the value changes within the
+ *   buffer.
+ */
+REALTIME
+static bool
+render_automation (
+  Port *            port,
+  AutomationTrack * at,
+  long              g_start_frames,
+  float *           buf,
+  nframes_t         nframes)
+{
+  float normalized_val;
+  float val = port->control;
+  bool has_automation =
+    automation_track_get_normalized_val_at_frames (
+      at, g_start_frames, &normalized_val);
+
+  /* the value at the start of the cycle is
+   * applied to the port (used by plugins) */
+  if (has_automation)
+    {
+      control_port_set_val_from_normalized (
+        port, normalized_val, true);
+      port->value_changed_from_reading = true;
+      val = port->control;
+    }
+
+  /* stepped values are not interpolated */
+  bool stepped =
+    port->id.flags &
+      (PORT_FLAG_TOGGLE | PORT_FLAG_INTEGER);
+
+  bool varies = false;
+  for (nframes_t i = 0; i < nframes;
+       i += PORT_AUTOMATION_RENDER_STEP)
+    {
+      nframes_t step =
+        MIN (
+          PORT_AUTOMATION_RENDER_STEP,
+          nframes - i);
+      float next_val = val;
+      if (automation_track_get_normalized_val_at_frames (
+            at, g_start_frames + (long) (i + step),
+            &normalized_val))
+        {
+          next_val =
+            control_port_get_snapped_val_from_val (
+              port,
+              control_port_normalized_val_to_real (
+                port, normalized_val));
+        }
+      if (stepped)
+        {
+          dsp_fill (&buf[i], val, step);
+        }
+      else
+        {
+          dsp_fill_ramp (
+            &buf[i], val, next_val, step);
+        }
+      if (!math_floats_equal (val, next_val))
+        {
+          varies = true;
+        }
+      val = next_val;
+    }
+
+  return varies;
+}
+
 /**
  * First sets port buf to 0, then sums the given
  * port signal from its inputs.
@@ -2933,6 +3034,13 @@ port_process (
             }
         }
 
+      /* merge the sources in batches, keeping the
+       * events sorted */
+      MidiEvents * merge_srcs[
+        MIDI_EVENTS_MAX_MERGE_SOURCES];
+      int * merge_channels[
+        MIDI_EVENTS_MAX_MERGE_SOURCES];
+      int num_merge_srcs = 0;
       for (k = 0; k < port->num_srcs; k++)
         {
           src_port = port->srcs[k];
@@ -2944,6 +3052,10 @@ port_process (
               g_return_if_fail (
                 src_port->id.type == TYPE_EVENT);
 
+              /* allowed channels, or NULL for all
+               * channels */
+              int * channels = NULL;
+
               /* if hardware device connected to
                * track processor input, only allow
                * signal to pass if armed and
@@ -2971,25 +3083,35 @@ port_process (
                        !track->channel->
                          all_midi_channels)
                     {
-                      midi_events_append_w_filter (
-                        src_port->midi_events,
-                        port->midi_events,
+                      channels =
                         track->channel->
-                          midi_channels,
-                        local_offset,
-                        nframes, F_NOT_QUEUED);
-                      continue;
+                          midi_channels;
                     }
-
-                  /* otherwise append normally */
                 }
 
-              midi_events_append (
-                src_port->midi_events,
-                port->midi_events, local_offset,
-                nframes, F_NOT_QUEUED);
+              merge_srcs[num_merge_srcs] =
+                src_port->midi_events;
+              merge_channels[num_merge_srcs] =
+                channels;
+              num_merge_srcs++;
+              if (num_merge_srcs ==
+                    MIDI_EVENTS_MAX_MERGE_SOURCES)
+                {
+                  midi_events_merge (
+                    port->midi_events, merge_srcs,
+                    merge_channels, num_merge_srcs,
+                    local_offset, nframes);
+                  num_merge_srcs = 0;
+                }
             }
         }
+      if (num_merge_srcs > 0)
+        {
+          midi_events_merge (
+            port->midi_events, merge_srcs,
+            merge_channels, num_merge_srcs,
+            local_offset, nframes);
+        }
 
       if (port->id.flow == FLOW_OUTPUT)
         {
@@ -3015,9 +3137,10 @@ port_process (
       /* send UI notification */
       if (port->midi_events->num_events > 0)
         {
-          g_message ("port %s has %d events",
-                     port->id.label,
-                     port->midi_events->num_events);
+          rt_debug (
+            "port %s has %d events",
+            port->id.label,
+            port->midi_events->num_events);
           /*if (port == AUDIO_ENGINE->midi_in)*/
             /*{*/
               /*AUDIO_ENGINE->trigger_midi_activity = 1;*/
@@ -3116,6 +3239,10 @@ port_process (
           if (!src_port->dest_enabled[dest_idx])
             continue;
 
+          /* nothing to add */
+          if (src_port->silent)
+            continue;
+
           float minf, maxf, depth_range;
           if (port->id.type == TYPE_AUDIO)
             {
@@ -3155,6 +3282,7 @@ port_process (
           dsp_limit1 (
             &port->buf[local_offset],
             minf, maxf, nframes);
+          port->silent = false;
         }
 
       if (port->id.flow == FLOW_OUTPUT)
@@ -3172,7 +3300,8 @@ port_process (
             }
         }
 
-      if (local_offset + nframes ==
+      if (port->write_ring_buffers &&
+          local_offset + nframes ==
             AUDIO_ENGINE->block_length)
         {
           size_t size =
@@ -3195,6 +3324,20 @@ port_process (
             size);
         }
 
+      /* update the meters */
+      Meter ** meters =
+        (Meter **)
+        g_atomic_pointer_get (&port->meters);
+      if (meters)
+        {
+          for (Meter ** meter = meters; *meter;
+               meter++)
+            {
+              meter_process (
+                *meter, local_offset, nframes);
+            }
+        }
+
       /* if track output (to be shown on mixer) */
       if (port->id.owner_type ==
             PORT_OWNER_TYPE_TRACK &&
@@ -3218,11 +3361,19 @@ port_process (
                   TIME_TO_RESET_PEAK)
                 port->peak = -1.f;
 
-              bool changed =
-                dsp_abs_max (
-                  &port->buf[local_offset],
-                  &port->peak,
-                  nframes);
+              bool changed = false;
+              if (port->silent)
+                {
+                  port->peak = MAX (port->peak, 0.f);
+                }
+              else
+                {
+                  changed =
+                    dsp_abs_max (
+                      &port->buf[local_offset],
+                      &port->peak,
+                      nframes);
+                }
               if (changed)
                 {
                   port->peak_timestamp =
@@ -3263,35 +3414,25 @@ port_process (
             g_return_if_fail (
               at == found_at);
           }
+        float * buf = &port->buf[local_offset];
         if (at &&
             port->id.flags &
               PORT_FLAG_AUTOMATABLE &&
             automation_track_should_read_automation (
               at, AUDIO_ENGINE->timestamp_start))
           {
-            Position pos;
-            position_from_frames (
-              &pos, g_start_frames);
-
-            /* if there was an automation event
-             * at the playhead position, set val
-             * and flag */
-            AutomationPoint * ap =
-              automation_track_get_ap_before_pos (
-                at, &pos);
-            if (ap)
-              {
-                float val =
-                  automation_track_get_val_at_pos (
-                    at, &pos, true);
-                control_port_set_val_from_normalized (
-                  port, val, true);
-                port->value_changed_from_reading =
-                  true;
-              }
+            port->buf_varies =
+              render_automation (
+                port, at, g_start_frames, buf,
+                nframes);
+          }
+        else
+          {
+            dsp_fill (buf, port->control, nframes);
+            port->buf_varies = false;
           }
 
-        float maxf, minf, depth_range, val_to_use;
+        float maxf, minf, depth_range;
         /* whether this is the first CV processed
          * on this control port */
         bool first_cv = true;
@@ -3320,27 +3461,30 @@ port_process (
                   (maxf - minf) / 2.f;
 
                 /* figure out whether to use base
-                 * value or the current value */
+                 * value or the current value (the
+                 * buffer already contains the
+                 * current values) */
                 if (first_cv)
                   {
-                    val_to_use = port->base_value;
+                    dsp_fill (
+                      buf, port->base_value,
+                      nframes);
                     first_cv = false;
                   }
-                else
-                  {
-                    val_to_use = port->control;
-                  }
 
-                float result =
-                  CLAMP (
-                    val_to_use +
-                      depth_range *
-                        src_port->buf[0] *
-                        src_port->multipliers[
-                          port_get_dest_index (
-                            src_port, port)],
-                    minf, maxf);
-                port->control = result;
+                /* modulate each frame */
+                dsp_mix2 (
+                  buf,
+                  &src_port->buf[local_offset],
+                  1.f,
+                  depth_range *
+                    src_port->multipliers[dest_idx],
+                  nframes);
+                dsp_limit1 (
+                  buf, minf, maxf, nframes);
+                port->buf_varies = true;
+
+                port->control = buf[0];
                 port_forward_control_change_event (
                   port);
               }
@@ -3581,6 +3725,7 @@ port_clear_buffer (Port * port)
       dsp_fill (
         port->buf, DENORMAL_PREVENTION_VAL,
         AUDIO_ENGINE->block_length);
+      port->silent = true;
 
       return;
     }
@@ -3841,6 +3986,19 @@ port_free (Port * self)
     self->num_dests == 0 ||
     self->dests[0] == 0);
 
+  /* detach any meters still using the port */
+  if (self->meters)
+    {
+      for (Meter ** meter = self->meters; *meter;
+           meter++)
+        {
+          g_atomic_pointer_set (
+            &(*meter)->port, NULL);
+        }
+      free (self->meters);
+      self->meters = NULL;
+    }
+
   object_zero_and_free (self->buf);
   if (self->audio_ring)
     {
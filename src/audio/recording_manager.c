@@ -21,6 +21,7 @@
 #include "audio/audio_region.h"
 #include "audio/automation_region.h"
 #include "audio/clip.h"
+#include "audio/clip_peaks.h"
 #include "audio/control_port.h"
 #include "audio/engine.h"
 #include "audio/recording_event.h"
@@ -30,6 +31,7 @@
 #include "gui/backend/arranger_object.h"
 #include "project.h"
 #include "utils/arrays.h"
+#include "utils/audio.h"
 #include "utils/dsp.h"
 #include "utils/flags.h"
 #include "utils/math.h"
@@ -55,6 +57,183 @@ static int returned = 0;
   /*recording_event_print (x)*/
 #endif
 
+/**
+ * Returns the track the event is for.
+ */
+static Track *
+get_track (
+  RecordingEvent * ev)
+{
+  g_return_val_if_fail (
+    ev->track_pos >= 0 &&
+    ev->track_pos < TRACKLIST->num_tracks, NULL);
+
+  return TRACKLIST->tracks[ev->track_pos];
+}
+
+/**
+ * Writes the completed chunks of recorded frames
+ * of the clip to the pool.
+ *
+ * Must be called from the flusher thread with
+ * @ref RecordingManager.flush_lock held. The lock
+ * is released while writing.
+ */
+static void
+flush_clip (
+  RecordingManager *   self,
+  RecordingFlushClip * flush,
+  float **             buf,
+  size_t *             buf_size)
+{
+  AudioClip * clip = flush->clip;
+  char * path = flush->path;
+  long start_frame = clip->frames_written;
+  long nframes =
+    clip->num_frames - start_frame;
+  nframes -=
+    nframes % RECORDING_MANAGER_FLUSH_CHUNK_FRAMES;
+  if (nframes <= 0)
+    return;
+
+  size_t size =
+    (size_t) nframes * clip->channels;
+  if (size > *buf_size)
+    {
+      *buf = g_realloc_n (*buf, size, sizeof (float));
+      *buf_size = size;
+    }
+  audio_clip_get_interleaved_frames (
+    clip, start_frame, (size_t) nframes, *buf);
+
+  /* write without holding the lock so that
+   * recording can go on */
+  self->flushing = true;
+  g_mutex_unlock (&self->flush_lock);
+  int ret =
+    audio_write_raw_file (
+      *buf, start_frame, nframes,
+      (uint32_t) clip->samplerate, clip->channels,
+      path);
+  g_mutex_lock (&self->flush_lock);
+  self->flushing = false;
+  g_cond_broadcast (&self->flush_done_cond);
+
+  if (ret == 0)
+    {
+      clip->frames_written = start_frame + nframes;
+      clip->last_write = g_get_monotonic_time ();
+    }
+  else
+    {
+      g_warning (
+        "failed to write recorded frames to %s",
+        path);
+    }
+}
+
+static void *
+flush_thread_func (
+  void * data)
+{
+  RecordingManager * self =
+    (RecordingManager *) data;
+  float * buf = NULL;
+  size_t buf_size = 0;
+
+  g_mutex_lock (&self->flush_lock);
+  while (!self->stop_flushing)
+    {
+      /* only wake up periodically while
+       * recording */
+      if (self->num_flush_clips == 0)
+        {
+          g_cond_wait (
+            &self->flush_cond, &self->flush_lock);
+        }
+      else
+        {
+          g_cond_wait_until (
+            &self->flush_cond, &self->flush_lock,
+            g_get_monotonic_time () +
+              RECORDING_MANAGER_FLUSH_INTERVAL);
+        }
+
+      for (int i = 0;
+           i < self->num_flush_clips &&
+           !self->stop_flushing; i++)
+        {
+          /* copy since the array may be resized
+           * while writing */
+          RecordingFlushClip flush =
+            self->flush_clips[i];
+          flush_clip (
+            self, &flush, &buf,
+            &buf_size);
+        }
+    }
+  g_mutex_unlock (&self->flush_lock);
+
+  g_free (buf);
+
+  return NULL;
+}
+
+/**
+ * Starts flushing the recorded frames of the clip
+ * to the pool in the background, if not already
+ * started.
+ *
+ * Must be called with
+ * @ref RecordingManager.flush_lock held.
+ */
+static void
+add_flush_clip (
+  RecordingManager * self,
+  AudioClip *        clip)
+{
+  for (int i = 0; i < self->num_flush_clips; i++)
+    {
+      if (self->flush_clips[i].clip == clip)
+        return;
+    }
+
+  array_double_size_if_full (
+    self->flush_clips, self->num_flush_clips,
+    self->flush_clips_size, RecordingFlushClip);
+  RecordingFlushClip * flush =
+    &self->flush_clips[self->num_flush_clips++];
+  flush->clip = clip;
+  flush->path =
+    audio_clip_get_path_in_pool (clip);
+}
+
+/**
+ * Stops flushing recorded frames, waiting for any
+ * write in progress to finish.
+ *
+ * The remaining frames are written with
+ * audio_clip_write_to_pool() when recording
+ * stops.
+ */
+static void
+clear_flush_clips (
+  RecordingManager * self)
+{
+  g_mutex_lock (&self->flush_lock);
+  while (self->flushing)
+    {
+      g_cond_wait (
+        &self->flush_done_cond, &self->flush_lock);
+    }
+  for (int i = 0; i < self->num_flush_clips; i++)
+    {
+      g_free (self->flush_clips[i].path);
+    }
+  self->num_flush_clips = 0;
+  g_mutex_unlock (&self->flush_lock);
+}
+
 /**
  * Adds the region's identifier to the recorded
  * identifiers (to be used for creating the undoable
@@ -103,6 +282,9 @@ handle_stop_recording (
     "%s%s", "----- stopped recording",
     is_automation ? " (automation)" : "");
 
+  /* the rest of the frames are written below */
+  clear_flush_clips (self);
+
   /* cache the current selections */
   ArrangerSelections * prev_selections =
     arranger_selections_clone (
@@ -172,6 +354,10 @@ handle_stop_recording (
           AudioClip * clip =
             audio_region_get_clip (r);
           audio_clip_write_to_pool (clip, true);
+
+          /* save the peaks updated while
+           * recording for the final file */
+          audio_clip_generate_peaks (clip, true);
         }
     }
 
@@ -294,7 +480,7 @@ recording_manager_handle_recording (
           re->g_start_frames = g_start_frames;
           re->local_offset = local_offset;
           re->nframes = nframes;
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -319,7 +505,7 @@ recording_manager_handle_recording (
           re->g_start_frames = g_start_frames;
           re->local_offset = local_offset;
           re->nframes = nframes;
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -348,7 +534,7 @@ recording_manager_handle_recording (
           re->g_start_frames = g_start_frames;
           re->local_offset = local_offset;
           re->nframes = nframes;
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -382,7 +568,7 @@ recording_manager_handle_recording (
           re->nframes = nframes;
           port_identifier_copy (
             &re->port_id, &at->port_id);
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -409,7 +595,7 @@ recording_manager_handle_recording (
           re->nframes = nframes;
           port_identifier_copy (
             &re->port_id, &at->port_id);
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -441,7 +627,7 @@ recording_manager_handle_recording (
               re->nframes = nframes;
               port_identifier_copy (
                 &re->port_id, &at->port_id);
-              strcpy (re->track_name, tr->name);
+              re->track_pos = tr->pos;
               /*UP_RECEIVED (re);*/
               recording_event_queue_push_back_event (
                 self->event_queue, re);
@@ -481,7 +667,7 @@ recording_manager_handle_recording (
           re->nframes = nframes;
           re->has_midi_event = 1;
           midi_event_copy (&re->midi_event, me);
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -499,7 +685,7 @@ recording_manager_handle_recording (
           re->local_offset = local_offset;
           re->nframes = nframes;
           re->has_midi_event = 0;
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -525,7 +711,7 @@ recording_manager_handle_recording (
         &track_processor->stereo_out->r->buf[
           local_offset],
         nframes);
-      strcpy (re->track_name, tr->name);
+      re->track_pos = tr->pos;
       /*UP_RECEIVED (re);*/
       recording_event_queue_push_back_event (
         self->event_queue, re);
@@ -560,7 +746,7 @@ add_automation_events:
           re->nframes = nframes;
           port_identifier_copy (
             &re->port_id, &at->port_id);
-          strcpy (re->track_name, tr->name);
+          re->track_pos = tr->pos;
           /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (
             self->event_queue, re);
@@ -679,7 +865,7 @@ handle_pause_event (
   RecordingManager * self,
   RecordingEvent * ev)
 {
-  Track * tr = track_get_from_name (ev->track_name);
+  Track * tr = get_track (ev);
 
   /* pausition to pause at */
   Position pause_pos;
@@ -744,7 +930,7 @@ handle_resume_event (
   RecordingManager * self,
   RecordingEvent * ev)
 {
-  Track * tr = track_get_from_name (ev->track_name);
+  Track * tr = get_track (ev);
   gint64 cur_time = g_get_monotonic_time ();
 
   /* position to resume from */
@@ -930,7 +1116,7 @@ handle_audio_event (
   long g_start_frames = ev->g_start_frames;
   nframes_t nframes = ev->nframes;
   nframes_t local_offset = ev->local_offset;
-  Track * tr = track_get_from_name (ev->track_name);
+  Track * tr = get_track (ev);
 
   /* get end position */
   long start_frames =
@@ -960,17 +1146,25 @@ handle_audio_event (
     r_obj, &end_pos);
   /*r_obj->end_pos.frames = end_pos.frames;*/
 
-  clip->num_frames =
-    r_obj->end_pos.frames - r_obj->pos.frames;
-  g_return_if_fail (clip->num_frames >= 0);
-  clip->frames =
-    (sample_t *)
-    realloc (
-      clip->frames,
-      (size_t)
-      (clip->num_frames *
-         (long) clip->channels) *
-      sizeof (sample_t));
+  long clip_start_frames =
+    start_frames - r_obj->pos.frames;
+  long clip_end_frames =
+    end_frames - r_obj->pos.frames;
+  g_return_if_fail (
+    clip_start_frames >= 0 &&
+    clip_end_frames >= clip_start_frames &&
+    local_offset + nframes <=
+      G_N_ELEMENTS (ev->lbuf));
+
+  /* make sure the peaks are not being generated
+   * while the frames are written */
+  audio_clip_wait_for_peaks (clip);
+
+  /* the flusher thread reads the frames */
+  g_mutex_lock (&self->flush_lock);
+
+  clip->num_frames = clip_end_frames;
+  audio_clip_update_channel_caches (clip);
 #if 0
   region->frames =
     (sample_t *) realloc (
@@ -985,49 +1179,30 @@ handle_audio_event (
     (size_t) clip->num_frames * clip->channels);
 #endif
 
+  /* set clip frames */
+  dsp_copy (
+    &clip->ch_frames[0][clip_start_frames],
+    &ev->lbuf[local_offset], nframes);
+  dsp_copy (
+    &clip->ch_frames[1][clip_start_frames],
+    &ev->rbuf[local_offset], nframes);
+
+  add_flush_clip (self, clip);
+  if (clip->num_frames - clip->frames_written >=
+        RECORDING_MANAGER_FLUSH_CHUNK_FRAMES)
+    {
+      g_cond_signal (&self->flush_cond);
+    }
+  g_mutex_unlock (&self->flush_lock);
+
   position_from_frames (
     &r_obj->loop_end_pos,
     r_obj->end_pos.frames - r_obj->pos.frames);
 
   r_obj->fade_out_pos = r_obj->loop_end_pos;
 
-  /* handle the samples normally */
-  nframes_t cur_local_offset = 0;
-  for (long i = start_frames - r_obj->pos.frames;
-       i < end_frames - r_obj->pos.frames;
-       i++)
-    {
-      g_return_if_fail (
-        i >= 0 && i < clip->num_frames);
-      g_warn_if_fail (
-        cur_local_offset >= local_offset &&
-        cur_local_offset < local_offset + nframes);
-
-      /* set clip frames */
-      clip->frames[i * clip->channels] =
-        ev->lbuf[cur_local_offset];
-      clip->frames[i * clip->channels + 1] =
-        ev->rbuf[cur_local_offset];
-#if 0
-      region->frames[i * clip->channels] =
-        ev->lbuf[cur_local_offset];
-      region->frames[i * clip->channels + 1] =
-        ev->rbuf[cur_local_offset];
-#endif
-
-      cur_local_offset++;
-    }
-
-  audio_clip_update_channel_caches (
-    clip, (size_t) clip->frames_written);
-
-  /* write to pool if 2 seconds passed since last
-   * write */
-  gint64 cur_time = g_get_monotonic_time ();
-  if ((cur_time - clip->last_write) > 2000000)
-    {
-      audio_clip_write_to_pool (clip, true);
-    }
+  clip_peaks_update_clip (
+    clip, clip_start_frames, clip_end_frames);
 
 #if 0
   g_message (
@@ -1045,7 +1220,7 @@ handle_midi_event (
 
   long g_start_frames = ev->g_start_frames;
   nframes_t nframes = ev->nframes;
-  Track * tr = track_get_from_name (ev->track_name);
+  Track * tr = get_track (ev);
 
   g_return_if_fail (tr->recording_region);
 
@@ -1176,7 +1351,7 @@ handle_automation_event (
   long g_start_frames = ev->g_start_frames;
   nframes_t nframes = ev->nframes;
   /*nframes_t local_offset = ev->local_offset;*/
-  Track * tr = track_get_from_name (ev->track_name);
+  Track * tr = get_track (ev);
   AutomationTrack * at =
     automation_track_find_from_port_id (
       &ev->port_id, false);
@@ -1306,7 +1481,7 @@ handle_start_recording (
   RecordingEvent *   ev,
   bool               is_automation)
 {
-  Track * tr = track_get_from_name (ev->track_name);
+  Track * tr = get_track (ev);
   gint64 cur_time = g_get_monotonic_time ();
   AutomationTrack * at = NULL;
   if (is_automation)
@@ -1501,11 +1676,11 @@ recording_manager_process_events (
           break;
         case RECORDING_EVENT_TYPE_STOP_TRACK_RECORDING:
           g_message (
-            "-------- STOP TRACK RECORDING (%s)",
-            ev->track_name);
+            "-------- STOP TRACK RECORDING (%d)",
+            ev->track_pos);
           {
             Track * track =
-              track_get_from_name (ev->track_name);
+              get_track (ev);
             g_warn_if_fail (track);
             handle_stop_recording (self, false);
             track->recording_region = NULL;
@@ -1537,8 +1712,8 @@ recording_manager_process_events (
           break;
         case RECORDING_EVENT_TYPE_START_TRACK_RECORDING:
           g_message (
-            "-------- START TRACK RECORDING (%s)",
-            ev->track_name);
+            "-------- START TRACK RECORDING (%d)",
+            ev->track_pos);
           handle_start_recording (self, ev, false);
           g_message (
             "num active recordings: %d",
@@ -1606,6 +1781,13 @@ recording_manager_new (void)
       (GSourceFunc)
       recording_manager_process_events, self);
 
+  g_mutex_init (&self->flush_lock);
+  g_cond_init (&self->flush_cond);
+  g_cond_init (&self->flush_done_cond);
+  self->flush_thread =
+    g_thread_new (
+      "recording_flusher", flush_thread_func, self);
+
   return self;
 }
 
@@ -1621,6 +1803,18 @@ recording_manager_free (
   /* process pending events */
   recording_manager_process_events (self);
 
+  /* stop the flusher thread */
+  clear_flush_clips (self);
+  g_mutex_lock (&self->flush_lock);
+  self->stop_flushing = true;
+  g_cond_signal (&self->flush_cond);
+  g_mutex_unlock (&self->flush_lock);
+  g_thread_join (self->flush_thread);
+  g_free (self->flush_clips);
+  g_mutex_clear (&self->flush_lock);
+  g_cond_clear (&self->flush_cond);
+  g_cond_clear (&self->flush_done_cond);
+
   /* free objects */
   object_free_w_func_and_null (
     mpmc_queue_free, self->event_queue);
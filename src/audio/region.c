@@ -273,13 +273,25 @@ region_stretch (
           stretcher_new_rubberband (
             AUDIO_ENGINE->sample_rate,
             new_clip->channels, ratio, 1.0, false);
+        float * frames =
+          malloc (
+            (size_t) new_clip->num_frames *
+            new_clip->channels * sizeof (float));
+        audio_clip_get_interleaved_frames (
+          new_clip, 0,
+          (size_t) new_clip->num_frames, frames);
         ssize_t returned_frames =
           stretcher_stretch_interleaved (
-            stretcher, new_clip->frames,
+            stretcher, frames,
             (size_t) new_clip->num_frames,
-            &new_clip->frames);
+            &frames);
         g_warn_if_fail (returned_frames > 0);
         new_clip->num_frames = returned_frames;
+        audio_clip_update_channel_caches (new_clip);
+        audio_clip_set_interleaved_frames (
+          new_clip, frames, 0,
+          (size_t) returned_frames);
+        free (frames);
         audio_clip_write_to_pool (
           new_clip, F_NO_PARTS);
         (void) obj;
@@ -117,8 +117,31 @@ router_start_cycle (
     self->max_route_playback_latency -
     AUDIO_ENGINE->remaining_latency_preroll;
   self->local_offset = local_offset;
-  zix_sem_post (&self->graph->callback_start);
-  zix_sem_wait (&self->graph->callback_done);
+
+  /* small graphs are cheaper to run directly than
+   * to hand over to the graph threads */
+  if (self->graph->process_serially)
+    {
+#ifdef HAVE_LSP_DSP
+      lsp_dsp_context_t ctx;
+      if (ZRYTHM_USE_OPTIMIZED_DSP)
+        {
+          lsp_dsp_start (&ctx);
+        }
+#endif
+      graph_process_serially (self->graph);
+#ifdef HAVE_LSP_DSP
+      if (ZRYTHM_USE_OPTIMIZED_DSP)
+        {
+          lsp_dsp_finish (&ctx);
+        }
+#endif
+    }
+  else
+    {
+      zix_sem_post (&self->graph->callback_start);
+      zix_sem_wait (&self->graph->callback_done);
+    }
 
   zix_sem_post (&self->graph_access);
 }
@@ -154,8 +177,12 @@ router_recalc_graph (
     }
   else
     {
+      /* set up the new graph while the current
+       * one keeps processing and only block
+       * processing while swapping it in */
+      graph_setup_next (self->graph);
       zix_sem_wait (&self->graph_access);
-      graph_setup (self->graph, 1, 1);
+      graph_apply_setup (self->graph);
       zix_sem_post (&self->graph_access);
     }
 
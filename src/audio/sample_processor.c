@@ -124,6 +124,11 @@ sample_processor_process (
     self->stereo_out->r->buf);
   float * l = self->stereo_out->l->buf,
         * r = self->stereo_out->r->buf;
+  if (self->num_current_samples > 0)
+    {
+      self->stereo_out->l->silent = false;
+      self->stereo_out->r->silent = false;
+    }
   for (int i = self->num_current_samples - 1;
        i >= 0; i--)
     {
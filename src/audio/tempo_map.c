@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "audio/automation_region.h"
+#include "audio/automation_track.h"
+#include "audio/engine.h"
+#include "audio/port.h"
+#include "audio/position.h"
+#include "audio/tempo_map.h"
+#include "audio/track.h"
+#include "project.h"
+#include "utils/objects.h"
+
+#include <gtk/gtk.h>
+
+/** Number of intervals used to integrate the
+ * frames over an automated segment. */
+#define INTEGRATION_STEPS 16
+
+/** Number of iterations used to find the ticks at
+ * given frames inside an automated segment. */
+#define BISECTION_STEPS 32
+
+static int
+cmp_ticks (
+  const void * a,
+  const void * b)
+{
+  double diff =
+    *(const double *) a - *(const double *) b;
+  return diff < 0.0 ? -1 : (diff > 0.0 ? 1 : 0);
+}
+
+/**
+ * Returns the local position in ticks inside the
+ * region at the given timeline ticks, taking
+ * loops into account.
+ */
+static double
+get_local_ticks (
+  ArrangerObject * r_obj,
+  double           ticks)
+{
+  double local =
+    (ticks - r_obj->pos.total_ticks) +
+    r_obj->clip_start_pos.total_ticks;
+  double loop_end = r_obj->loop_end_pos.total_ticks;
+  double loop_len =
+    loop_end - r_obj->loop_start_pos.total_ticks;
+  if (local >= loop_end && loop_len > 0.0)
+    {
+      local -=
+        loop_len *
+        (floor ((local - loop_end) / loop_len) + 1);
+    }
+  return local;
+}
+
+/**
+ * Appends the positions on the timeline where the
+ * tempo curve of the region changes shape (region
+ * bounds, loop points and automation points).
+ */
+static void
+add_region_breakpoints (
+  ZRegion * region,
+  GArray *  breakpoints)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) region;
+  double start = r_obj->pos.total_ticks;
+  double end = r_obj->end_pos.total_ticks;
+  double loop_start =
+    r_obj->loop_start_pos.total_ticks;
+  double loop_end = r_obj->loop_end_pos.total_ticks;
+
+  g_array_append_val (breakpoints, start);
+  g_array_append_val (breakpoints, end);
+
+  /* go through each loop iteration */
+  double t = start;
+  double local = r_obj->clip_start_pos.total_ticks;
+  while (t < end)
+    {
+      double piece_len = loop_end - local;
+      if (piece_len <= 0.0)
+        break;
+      double piece_end = MIN (t + piece_len, end);
+      g_array_append_val (breakpoints, t);
+
+      for (int i = 0; i < region->num_aps; i++)
+        {
+          ArrangerObject * ap_obj =
+            (ArrangerObject *) region->aps[i];
+          double ap_local = ap_obj->pos.total_ticks;
+          if (ap_local >= local &&
+              ap_local < local + (piece_end - t))
+            {
+              double ap_ticks = t + (ap_local - local);
+              g_array_append_val (
+                breakpoints, ap_ticks);
+            }
+        }
+
+      t = piece_end;
+      local = loop_start;
+    }
+}
+
+/**
+ * Returns the normalized value of the segment at
+ * the given ticks.
+ */
+static float
+get_normalized_val (
+  const TempoMapSegment * seg,
+  double                  ticks)
+{
+  if (!seg->has_next)
+    return seg->normalized_val;
+
+  double ratio =
+    seg->start_ratio +
+    (ticks - seg->start_ticks) * seg->ratio_per_tick;
+  ratio = CLAMP (ratio, 0.0, 1.0);
+  bool start_higher =
+    seg->next_normalized_val < seg->normalized_val;
+  float diff =
+    fabsf (
+      seg->normalized_val -
+      seg->next_normalized_val);
+  CurveOptions opts = seg->curve_opts;
+  return
+    (float)
+    curve_get_normalized_y (
+      ratio, &opts, start_higher) *
+    diff +
+    MIN (seg->normalized_val,
+         seg->next_normalized_val);
+}
+
+/**
+ * Returns the BPM used for frame calculations at
+ * the given ticks in the segment.
+ */
+static double
+get_bpm_for_frames (
+  const TempoMap *        self,
+  const TempoMapSegment * seg,
+  double                  ticks)
+{
+  if (!seg->automated)
+    return (double) self->default_bpm;
+
+  return
+    (double) self->min_bpm +
+    (double) get_normalized_val (seg, ticks) *
+      (double) self->bpm_range;
+}
+
+/**
+ * Returns the number of frames from the start of
+ * the segment to the given ticks.
+ */
+static double
+integrate_frames (
+  const TempoMap *        self,
+  const TempoMapSegment * seg,
+  double                  ticks,
+  int                     num_steps)
+{
+  double len = ticks - seg->start_ticks;
+  if (!seg->automated || !seg->has_next)
+    {
+      return
+        len * self->frames_per_tick_bpm /
+        get_bpm_for_frames (
+          self, seg, seg->start_ticks);
+    }
+
+  /* Simpson's rule on frames per tick, which is
+   * inversely proportional to the BPM */
+  double h = len / num_steps;
+  double sum = 0.0;
+  for (int i = 0; i <= num_steps; i++)
+    {
+      double w =
+        (i == 0 || i == num_steps) ?
+          1.0 : (i % 2 ? 4.0 : 2.0);
+      sum +=
+        w /
+        get_bpm_for_frames (
+          self, seg, seg->start_ticks + h * i);
+    }
+  return self->frames_per_tick_bpm * sum * h / 3.0;
+}
+
+/**
+ * Fills in the automation of the segment
+ * starting at @p start and ending at @p end.
+ */
+static void
+fill_segment (
+  TempoMapSegment * seg,
+  AutomationTrack * at,
+  double            start,
+  double            end)
+{
+  seg->start_ticks = start;
+
+  /* find the automation in the middle of the
+   * segment, where nothing changes shape */
+  double mid = start + (end - start) / 2.0;
+  Position pos;
+  position_from_ticks (&pos, mid);
+  ZRegion * region =
+    automation_track_get_region_before_pos (
+      at, &pos);
+  AutomationPoint * ap =
+    automation_track_get_ap_before_pos (at, &pos);
+  if (!region || !ap)
+    return;
+
+  ArrangerObject * ap_obj = (ArrangerObject *) ap;
+  AutomationPoint * next_ap =
+    automation_region_get_next_ap (
+      region, ap, false, false);
+  seg->automated = true;
+  seg->normalized_val = ap->normalized_val;
+  seg->next_normalized_val = ap->normalized_val;
+  seg->curve_opts = ap->curve_opts;
+  if (!next_ap)
+    return;
+
+  ArrangerObject * next_ap_obj =
+    (ArrangerObject *) next_ap;
+  double curve_len =
+    next_ap_obj->pos.total_ticks -
+    ap_obj->pos.total_ticks;
+  if (curve_len <= 0.0)
+    return;
+
+  double local_mid =
+    get_local_ticks (
+      (ArrangerObject *) region, mid);
+  double local_start = local_mid - (mid - start);
+  seg->has_next = true;
+  seg->next_normalized_val = next_ap->normalized_val;
+  seg->ratio_per_tick = 1.0 / curve_len;
+  seg->start_ratio =
+    (local_start - ap_obj->pos.total_ticks) /
+    curve_len;
+}
+
+/**
+ * Creates a tempo map from the BPM automation of
+ * the given tempo track.
+ *
+ * Must not be called from a realtime thread.
+ */
+TempoMap *
+tempo_map_new (
+  Track * tempo_track)
+{
+  TempoMap * self = object_new (TempoMap);
+
+  Port * port = tempo_track->bpm_port;
+  self->default_bpm =
+    port_get_control_value (port, false);
+  self->min_bpm = port->minf;
+  self->bpm_range = port->maxf - port->minf;
+  self->frames_per_tick_bpm =
+    AUDIO_ENGINE->frames_per_tick *
+    (double) self->default_bpm;
+
+  AutomationTrack * at =
+    automation_track_find_from_port (
+      port, tempo_track, true);
+
+  GArray * breakpoints =
+    g_array_new (false, false, sizeof (double));
+  double zero = 0.0;
+  g_array_append_val (breakpoints, zero);
+  for (int i = 0; at && i < at->num_regions; i++)
+    {
+      add_region_breakpoints (
+        at->regions[i], breakpoints);
+    }
+  g_array_sort (breakpoints, cmp_ticks);
+
+  self->segments =
+    calloc (
+      breakpoints->len, sizeof (TempoMapSegment));
+  double * ticks = (double *) breakpoints->data;
+  for (guint i = 0; i < breakpoints->len; i++)
+    {
+      /* skip duplicates and negative positions */
+      if (ticks[i] < 0.0 ||
+          (self->num_segments > 0 &&
+           ticks[i] <=
+             self->segments[
+               self->num_segments - 1].start_ticks))
+        continue;
+
+      TempoMapSegment * seg =
+        &self->segments[self->num_segments];
+      if (at && i < breakpoints->len - 1)
+        {
+          fill_segment (
+            seg, at, ticks[i], ticks[i + 1]);
+        }
+      else
+        {
+          seg->start_ticks = ticks[i];
+        }
+
+      if (self->num_segments > 0)
+        {
+          TempoMapSegment * prev =
+            &self->segments[self->num_segments - 1];
+          seg->start_frames =
+            prev->start_frames +
+            integrate_frames (
+              self, prev, seg->start_ticks,
+              INTEGRATION_STEPS);
+        }
+      self->num_segments++;
+    }
+  g_array_free (breakpoints, true);
+
+  return self;
+}
+
+/**
+ * Returns the index of the last segment starting
+ * before or at the given ticks.
+ */
+static size_t
+find_segment_at_ticks (
+  const TempoMap * self,
+  double           ticks)
+{
+  size_t lo = 0;
+  size_t hi = self->num_segments;
+  while (hi - lo > 1)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (self->segments[mid].start_ticks <= ticks)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+/**
+ * Returns the index of the last segment starting
+ * before or at the given frames.
+ */
+static size_t
+find_segment_at_frames (
+  const TempoMap * self,
+  double           frames)
+{
+  size_t lo = 0;
+  size_t hi = self->num_segments;
+  while (hi - lo > 1)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (self->segments[mid].start_frames <= frames)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+/**
+ * Returns the BPM at the given position.
+ *
+ * @param cur_bpm BPM to return if there is no
+ *   automation at the position.
+ */
+bpm_t
+tempo_map_get_bpm_at_ticks (
+  const TempoMap * self,
+  double           ticks,
+  bpm_t            cur_bpm)
+{
+  const TempoMapSegment * seg =
+    &self->segments[
+      find_segment_at_ticks (self, ticks)];
+  if (!seg->automated)
+    return cur_bpm;
+
+  return
+    self->min_bpm +
+    get_normalized_val (seg, ticks) *
+      self->bpm_range;
+}
+
+/**
+ * Returns the frames from the start of the
+ * timeline to the given position, following the
+ * tempo changes.
+ */
+double
+tempo_map_get_frames_at_ticks (
+  const TempoMap * self,
+  double           ticks)
+{
+  const TempoMapSegment * seg =
+    &self->segments[
+      find_segment_at_ticks (self, ticks)];
+  return
+    seg->start_frames +
+    integrate_frames (
+      self, seg, ticks, INTEGRATION_STEPS / 2);
+}
+
+/**
+ * Returns the position in ticks that is the given
+ * number of frames from the start of the
+ * timeline, following the tempo changes.
+ */
+double
+tempo_map_get_ticks_at_frames (
+  const TempoMap * self,
+  double           frames)
+{
+  size_t idx = find_segment_at_frames (self, frames);
+  const TempoMapSegment * seg =
+    &self->segments[idx];
+  double frames_in_seg = frames - seg->start_frames;
+  if (!seg->automated || !seg->has_next ||
+      idx == self->num_segments - 1)
+    {
+      return
+        seg->start_ticks +
+        frames_in_seg *
+          get_bpm_for_frames (
+            self, seg, seg->start_ticks) /
+          self->frames_per_tick_bpm;
+    }
+
+  /* the frames increase monotonically with the
+   * ticks, so bisect */
+  double lo = seg->start_ticks;
+  double hi = self->segments[idx + 1].start_ticks;
+  for (int i = 0; i < BISECTION_STEPS; i++)
+    {
+      double mid = lo + (hi - lo) / 2.0;
+      if (integrate_frames (
+            self, seg, mid,
+            INTEGRATION_STEPS / 2) < frames_in_seg)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  return lo + (hi - lo) / 2.0;
+}
+
+void
+tempo_map_free (
+  TempoMap * self)
+{
+  free (self->segments);
+
+  object_zero_and_free (self);
+}
@@ -20,7 +20,9 @@
 #include <stdlib.h>
 
 #include "audio/automation_track.h"
+#include "audio/engine.h"
 #include "audio/port.h"
+#include "audio/tempo_map.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
@@ -28,6 +30,7 @@
 #include "project.h"
 #include "utils/arrays.h"
 #include "utils/flags.h"
+#include "utils/object_utils.h"
 #include "utils/objects.h"
 #include "zrythm_app.h"
 
@@ -94,20 +97,113 @@ tempo_track_default (
   return self;
 }
 
+/**
+ * Marks the tempo map as outdated.
+ *
+ * To be called when the BPM automation changes.
+ */
+void
+tempo_track_invalidate_tempo_map (
+  Track * self)
+{
+  g_atomic_int_set (&self->tempo_map_outdated, 1);
+}
+
+/**
+ * Rebuilds the tempo map if it is outdated.
+ *
+ * The new map replaces the old one atomically and
+ * the old one is free'd later, so this can be
+ * called while the engine is running.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+tempo_track_update_tempo_map (
+  Track * self)
+{
+  if (self->tempo_map &&
+      !g_atomic_int_get (&self->tempo_map_outdated))
+    return;
+
+  /* clear the flag first so that changes made
+   * while rebuilding are not lost */
+  g_atomic_int_set (&self->tempo_map_outdated, 0);
+
+  TempoMap * old_map = self->tempo_map;
+  TempoMap * new_map = tempo_map_new (self);
+  g_atomic_pointer_set (&self->tempo_map, new_map);
+  if (old_map)
+    {
+      free_later (old_map, tempo_map_free);
+    }
+}
+
 /**
  * Returns the BPM at the given pos.
+ *
+ * This does not look up any ports or automation
+ * and is safe to call from realtime threads.
  */
 bpm_t
 tempo_track_get_bpm_at_pos (
   Track *    self,
   Position * pos)
 {
-  AutomationTrack * at =
-    automation_track_find_from_port_id (
-      &self->bpm_port->id, false);
+  if (ZRYTHM_APP_IS_GTK_THREAD)
+    {
+      tempo_track_update_tempo_map (self);
+    }
+
+  bpm_t cur_bpm =
+    port_get_control_value (self->bpm_port, false);
+  TempoMap * map =
+    (TempoMap *)
+    g_atomic_pointer_get (&self->tempo_map);
+  if (!map)
+    return cur_bpm;
+
   return
-    automation_track_get_val_at_pos (
-      at, pos, false);
+    tempo_map_get_bpm_at_ticks (
+      map, pos->total_ticks, cur_bpm);
+}
+
+/**
+ * Returns the frames from the start of the
+ * timeline to the given position, following the
+ * tempo automation.
+ */
+double
+tempo_track_get_frames_at_ticks (
+  Track * self,
+  double  ticks)
+{
+  TempoMap * map =
+    (TempoMap *)
+    g_atomic_pointer_get (&self->tempo_map);
+  if (!map)
+    return ticks * AUDIO_ENGINE->frames_per_tick;
+
+  return tempo_map_get_frames_at_ticks (map, ticks);
+}
+
+/**
+ * Returns the position in ticks that is the given
+ * number of frames from the start of the
+ * timeline, following the tempo automation.
+ */
+double
+tempo_track_get_ticks_at_frames (
+  Track * self,
+  double  frames)
+{
+  TempoMap * map =
+    (TempoMap *)
+    g_atomic_pointer_get (&self->tempo_map);
+  if (!map)
+    return frames / AUDIO_ENGINE->frames_per_tick;
+
+  return tempo_map_get_ticks_at_frames (map, frames);
 }
 
 /**
@@ -156,6 +252,7 @@ tempo_track_set_bpm (
 
   port_set_control_value (
     self->bpm_port, bpm, false, false);
+  tempo_track_invalidate_tempo_map (self);
 
   if (!temporary)
     {
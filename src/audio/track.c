@@ -29,6 +29,7 @@
 #include "audio/audio_bus_track.h"
 #include "audio/channel.h"
 #include "audio/chord_track.h"
+#include "audio/clip_stream.h"
 #include "audio/control_port.h"
 #include "audio/exporter.h"
 #include "audio/group_target_track.h"
@@ -40,9 +41,11 @@
 #include "audio/midi_group_track.h"
 #include "audio/midi_track.h"
 #include "audio/modulator_track.h"
+#include "audio/pool.h"
 #include "audio/instrument_track.h"
 #include "audio/router.h"
 #include "audio/stretcher.h"
+#include "audio/tempo_map.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
@@ -141,6 +144,13 @@ track_init_loaded (
         stretcher_new_rubberband (
           AUDIO_ENGINE->sample_rate, 2, 1.0,
           1.0, true);
+      for (int i = 0; i < 2; i++)
+        {
+          self->rt_stretch_bufs[i] =
+            calloc (
+              TRACK_MAX_STREAMED_STRETCH_FRAMES,
+              sizeof (float));
+        }
     }
 
   /** set magic to all track ports */
@@ -2132,6 +2142,85 @@ track_update_frames (
 
   automation_tracklist_update_frames (
     &self->automation_tracklist);
+
+  if (self->type == TRACK_TYPE_TEMPO)
+    {
+      tempo_track_invalidate_tempo_map (self);
+    }
+}
+
+/**
+ * Lets the clip streamer read ahead the streamed
+ * clips of the audio regions in the track.
+ */
+static void
+prefetch_streamed_clips (
+  Track *    track,
+  const long g_start_frames)
+{
+  /* nothing to do if no clip is streamed */
+  ClipStreamer * streamer = AUDIO_POOL->streamer;
+  if (!streamer ||
+      g_atomic_int_get (&streamer->num_streams) == 0)
+    return;
+
+  /* get the read-ahead window, split at the
+   * transport loop end */
+  long g_end_frames =
+    g_start_frames + CLIP_STREAM_READ_AHEAD_FRAMES;
+  long window_starts[2] = { g_start_frames, 0 };
+  long window_ends[2] = { g_end_frames, 0 };
+  int num_windows = 1;
+  long loop_start_frames =
+    TRANSPORT->loop_start_pos.frames;
+  long loop_end_frames =
+    TRANSPORT->loop_end_pos.frames;
+  if (TRANSPORT_IS_LOOPING &&
+      g_start_frames < loop_end_frames &&
+      g_end_frames > loop_end_frames)
+    {
+      window_ends[0] = loop_end_frames;
+      window_starts[1] = loop_start_frames;
+      window_ends[1] =
+        loop_start_frames +
+        (g_end_frames - loop_end_frames);
+      num_windows = 2;
+    }
+
+  for (int i = 0; i < track->num_lanes; i++)
+    {
+      TrackLane * lane = track->lanes[i];
+      for (int j = 0; j < num_windows; j++)
+        {
+          /* go through each region that may be
+           * hit, or each region if the lane's
+           * index is outdated */
+          int first_region = 0;
+          int last_region = lane->num_regions;
+          bool use_index =
+            track_lane_get_indexed_regions_in_range (
+              lane, window_starts[j],
+              window_ends[j], &first_region,
+              &last_region);
+          for (int k = first_region; k < last_region;
+               k++)
+            {
+              ZRegion * r =
+                use_index ?
+                  lane->regions_by_start[k] :
+                  lane->regions[k];
+              if (arranger_object_get_muted (
+                    (ArrangerObject *) r) ||
+                  !region_is_hit_by_range (
+                    r, window_starts[j],
+                    window_ends[j], F_INCLUSIVE))
+                continue;
+
+              audio_region_prefetch (
+                r, g_start_frames);
+            }
+        }
+    }
 }
 
 /**
@@ -2160,6 +2249,12 @@ track_fill_events (
   MidiEvents *    midi_events,
   StereoPorts *   stereo_ports)
 {
+  if (stereo_ports)
+    {
+      prefetch_streamed_clips (
+        track, g_start_frames);
+    }
+
   if (!TRANSPORT_IS_ROLLING)
     return;
 
@@ -2191,17 +2286,28 @@ track_fill_events (
           lane = track->lanes[j];
         }
 
-      /* go through each region */
-      const int num_regions =
+      /* go through each region that may be
+       * hit, or each region if the lane's index
+       * is outdated */
+      int first_region = 0;
+      int last_region =
         (track->type == TRACK_TYPE_CHORD ?
          track->num_chord_regions :
          lane->num_regions);
-      for (int i = 0; i < num_regions; i++)
+      bool use_index =
+        lane &&
+        track_lane_get_indexed_regions_in_range (
+          lane, g_start_frames, g_end_frames,
+          &first_region, &last_region);
+      for (int i = first_region; i < last_region;
+           i++)
         {
           ZRegion * r =
             track->type == TRACK_TYPE_CHORD ?
             track->chord_regions[i] :
-            lane->regions[i];
+            (use_index ?
+               lane->regions_by_start[i] :
+               lane->regions[i]);
           ArrangerObject * r_obj =
             (ArrangerObject *) r;
           g_return_if_fail (IS_REGION (r));
@@ -2313,12 +2419,12 @@ track_fill_events (
 
   if (midi_events)
     {
+      /* sort events and remove duplicates, which
+       * are next to each other after sorting */
+      midi_events_sort (midi_events, F_QUEUED);
       midi_events_clear_duplicates (
         midi_events, F_QUEUED);
 
-      /* sort events */
-      midi_events_sort (midi_events, F_QUEUED);
-
       zix_sem_post (&midi_events->access_sem);
     }
 }
@@ -3003,6 +3109,13 @@ track_free (Track * self)
       object_free_w_func_and_null (
         port_free, self->time_sig_port);
     }
+  object_free_w_func_and_null (
+    tempo_map_free, self->tempo_map);
+  for (int i = 0; i < 2; i++)
+    {
+      object_free_w_func_and_null (
+        free, self->rt_stretch_bufs[i]);
+    }
 
 #undef _FREE_TRACK
 
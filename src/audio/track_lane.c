@@ -17,12 +17,15 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "audio/audio_region.h"
 #include "audio/track.h"
 #include "audio/track_lane.h"
 #include "audio/tracklist.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/widgets/arranger.h"
 #include "midilib/src/midifile.h"
 #include "midilib/src/midiinfo.h"
@@ -144,6 +147,8 @@ track_lane_insert_region (
   region->id.lane_pos = self->pos;
   region->id.idx = idx;
   region_update_identifier (region);
+  track_lane_invalidate_region_index (self);
+  arranger_object_index_invalidate_all ();
 
   if (region->id.type == REGION_TYPE_AUDIO)
     {
@@ -283,6 +288,8 @@ track_lane_remove_region (
 
   array_delete (
     self->regions, self->num_regions, region);
+  track_lane_invalidate_region_index (self);
+  arranger_object_index_invalidate_all ();
 
   for (int i = region->id.idx; i < self->num_regions;
        i++)
@@ -293,6 +300,160 @@ track_lane_remove_region (
     }
 }
 
+static int
+cmp_region_start (
+  const void * a,
+  const void * b)
+{
+  const ArrangerObject * obj_a =
+    *(ArrangerObject * const *) a;
+  const ArrangerObject * obj_b =
+    *(ArrangerObject * const *) b;
+  return
+    (obj_a->pos.frames > obj_b->pos.frames) -
+    (obj_a->pos.frames < obj_b->pos.frames);
+}
+
+/**
+ * Rebuilds the time-sorted region index.
+ *
+ * Must not be called while the engine is
+ * processing the lane.
+ *
+ * @see TrackLane.regions_by_start.
+ */
+void
+track_lane_update_region_index (
+  TrackLane * self)
+{
+  if ((size_t) self->num_regions >
+        self->indexed_regions_size)
+    {
+      size_t new_size =
+        MAX (
+          (size_t) self->num_regions,
+          self->indexed_regions_size * 2);
+      self->regions_by_start =
+        g_realloc_n (
+          self->regions_by_start, new_size,
+          sizeof (ZRegion *));
+      self->max_end_indices =
+        g_realloc_n (
+          self->max_end_indices, new_size,
+          sizeof (int));
+      self->indexed_regions_size = new_size;
+    }
+
+  if (self->num_regions > 0)
+    {
+      memcpy (
+        self->regions_by_start, self->regions,
+        (size_t) self->num_regions *
+          sizeof (ZRegion *));
+      qsort (
+        self->regions_by_start,
+        (size_t) self->num_regions,
+        sizeof (ZRegion *), cmp_region_start);
+    }
+
+  long max_end = LONG_MIN;
+  int max_end_idx = 0;
+  for (int i = 0; i < self->num_regions; i++)
+    {
+      ArrangerObject * r_obj =
+        (ArrangerObject *) self->regions_by_start[i];
+      if (r_obj->end_pos.frames > max_end)
+        {
+          max_end = r_obj->end_pos.frames;
+          max_end_idx = i;
+        }
+      self->max_end_indices[i] = max_end_idx;
+    }
+  self->num_indexed_regions = self->num_regions;
+
+  g_atomic_int_set (&self->region_index_valid, 1);
+}
+
+/**
+ * Marks the region index as outdated.
+ *
+ * To be called when regions are added, removed
+ * or moved.
+ */
+void
+track_lane_invalidate_region_index (
+  TrackLane * self)
+{
+  g_atomic_int_set (&self->region_index_valid, 0);
+}
+
+/**
+ * Gets the range of regions in
+ * @ref TrackLane.regions_by_start that may be hit
+ * by the given global frame range (inclusive).
+ *
+ * The regions in the range still need to be
+ * checked with region_is_hit_by_range().
+ *
+ * @param[out] first First index.
+ * @param[out] last Index after the last region.
+ *
+ * @return False if the index is outdated, in which
+ *   case all regions must be checked.
+ */
+REALTIME
+bool
+track_lane_get_indexed_regions_in_range (
+  TrackLane * self,
+  long        g_start_frames,
+  long        g_end_frames,
+  int *       first,
+  int *       last)
+{
+  if (!g_atomic_int_get (&self->region_index_valid))
+    return false;
+
+  int num_regions = self->num_indexed_regions;
+
+  /* the max ends are sorted, so find the first
+   * region that could still be playing at the
+   * range start */
+  int low = 0;
+  int high = num_regions;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      ArrangerObject * max_end_obj =
+        (ArrangerObject *)
+        self->regions_by_start[
+          self->max_end_indices[mid]];
+      if (max_end_obj->end_pos.frames <
+            g_start_frames)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+  *first = low;
+
+  /* find the first region starting after the
+   * range end */
+  high = num_regions;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      ArrangerObject * r_obj =
+        (ArrangerObject *)
+        self->regions_by_start[mid];
+      if (r_obj->pos.frames <= g_end_frames)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+  *last = low;
+
+  return true;
+}
+
 Track *
 track_lane_get_track (
   TrackLane * self)
@@ -363,5 +524,8 @@ track_lane_free (
     arranger_object_free (
       (ArrangerObject *) self->regions[i]);
 
+  g_free (self->regions_by_start);
+  g_free (self->max_end_indices);
+
   free (self);
 }
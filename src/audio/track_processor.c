@@ -835,6 +835,13 @@ track_processor_process (
   switch (tr->in_signal_type)
     {
     case TYPE_AUDIO:
+      /* nothing to add if the input is silent */
+      if (self->stereo_in->l->silent &&
+          self->stereo_in->r->silent)
+        break;
+
+      self->stereo_out->l->silent = false;
+      self->stereo_out->r->silent = false;
       for (nframes_t l = local_offset;
            l < nframes; l++)
         {
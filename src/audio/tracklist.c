@@ -22,9 +22,12 @@
 #include "audio/channel.h"
 #include "audio/chord_track.h"
 #include "audio/midi_file.h"
+#include "audio/midi_region.h"
 #include "audio/router.h"
+#include "audio/tempo_track.h"
 #include "audio/tracklist.h"
 #include "audio/track.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/arranger.h"
@@ -70,6 +73,67 @@ tracklist_init_loaded (
 
       track_init_loaded (track, true);
     }
+
+  tracklist_update_playback_indices (self);
+  tracklist_update_solo_state (self);
+}
+
+/**
+ * Rebuilds the outdated region indices of all
+ * lanes, note indices of all MIDI and chord
+ * regions and the tempo map.
+ *
+ * Must not be called while the engine is
+ * processing (eg, call it while the engine is
+ * paused during undoable actions).
+ *
+ * @see track_lane_update_region_index().
+ * @see midi_region_update_note_index().
+ * @see tempo_track_update_tempo_map().
+ */
+void
+tracklist_update_playback_indices (
+  Tracklist * self)
+{
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      Track * track = self->tracks[i];
+      for (int j = 0; j < track->num_lanes; j++)
+        {
+          TrackLane * lane = track->lanes[j];
+          if (!g_atomic_int_get (
+                &lane->region_index_valid))
+            {
+              track_lane_update_region_index (lane);
+            }
+          for (int k = 0; k < lane->num_regions; k++)
+            {
+              ZRegion * r = lane->regions[k];
+              if (r->id.type == REGION_TYPE_MIDI &&
+                  !g_atomic_int_get (
+                    &r->note_index_valid))
+                {
+                  midi_region_update_note_index (r);
+                }
+            }
+        }
+      for (int j = 0; j < track->num_chord_regions;
+           j++)
+        {
+          ZRegion * r = track->chord_regions[j];
+          if (!g_atomic_int_get (
+                &r->note_index_valid))
+            {
+              midi_region_update_note_index (r);
+            }
+        }
+    }
+
+  if (self->tempo_track)
+    {
+      tempo_track_update_tempo_map (
+        self->tempo_track);
+    }
 }
 
 /**
@@ -221,6 +285,8 @@ tracklist_insert_track (
     "inserting %s at %d...",
     track->name, pos);
 
+  arranger_object_index_invalidate_all ();
+
   /* set to -1 so other logic knows it is a new
    * track */
   track->pos = -1;
@@ -289,6 +355,8 @@ tracklist_insert_track (
       track->widget = track_widget_new (track);
     }
 
+  tracklist_update_solo_state (self);
+
   if (recalc_graph)
     {
       router_recalc_graph (ROUTER, F_NOT_SOFT);
@@ -623,6 +691,8 @@ tracklist_remove_track (
   g_message (
     "%s: removing %s...", __func__, track->name);
 
+  arranger_object_index_invalidate_all ();
+
   Track * prev_visible =
     tracklist_get_prev_visible_track (
       TRACKLIST, track);
@@ -675,6 +745,8 @@ tracklist_remove_track (
 
   track_set_is_project (track, false);
 
+  tracklist_update_solo_state (self);
+
   if (free_track)
     {
       object_free_w_func_and_null (
@@ -716,6 +788,8 @@ tracklist_move_track (
   /*int prev_pos = track->pos;*/
   bool move_higher = pos < track->pos;
 
+  arranger_object_index_invalidate_all ();
+
   Track * prev_visible =
     tracklist_get_prev_visible_track (
       TRACKLIST, track);
@@ -830,6 +904,31 @@ tracklist_has_soloed (
   return 0;
 }
 
+/**
+ * Updates the cached solo state of the tracklist
+ * and of each channel fader.
+ *
+ * To be called when a track is soloed/unsoloed or
+ * when the routing changes.
+ */
+void
+tracklist_update_solo_state (
+  Tracklist * self)
+{
+  self->has_soloed_tracks =
+    tracklist_has_soloed (self);
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      Track * track = self->tracks[i];
+      if (!track->channel)
+        continue;
+
+      Fader * fader = track->channel->fader;
+      fader->implied_soloed =
+        fader_get_implied_soloed (fader);
+    }
+}
+
 /**
  * Activate or deactivate all plugins.
  *
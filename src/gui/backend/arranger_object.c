@@ -25,7 +25,9 @@
 #include "audio/marker_track.h"
 #include "audio/midi_region.h"
 #include "audio/stretcher.h"
+#include "audio/tempo_track.h"
 #include "gui/backend/arranger_object.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/automation_selections.h"
 #include "gui/backend/chord_selections.h"
 #include "gui/backend/event.h"
@@ -260,6 +262,105 @@ arranger_object_get_muted (
   return self->muted;
 }
 
+/**
+ * Returns the track at the given position without
+ * warning if it does not exist.
+ */
+static Track *
+get_track_if_exists (
+  int track_pos)
+{
+  if (!TRACKLIST || track_pos < 0 ||
+      track_pos >= TRACKLIST->num_tracks)
+    return NULL;
+
+  return TRACKLIST->tracks[track_pos];
+}
+
+/**
+ * Invalidates the playback index the given
+ * object's position is part of, if any.
+ *
+ * This is the region index of the lane for
+ * regions, the note index of the owner region
+ * for MIDI notes and chord objects, and the tempo
+ * map for objects in the tempo track.
+ *
+ * The lane/region is looked up directly instead
+ * of with region_find() since objects that are
+ * not part of the project (eg, clones) may point
+ * to ones that do not exist.
+ */
+static void
+invalidate_playback_index (
+  ArrangerObject * self)
+{
+  if (self->type == TYPE (REGION) ||
+      self->type == TYPE (AUTOMATION_POINT))
+    {
+      int track_pos =
+        self->type == TYPE (REGION) ?
+          ((ZRegion *) self)->id.track_pos :
+          self->region_id.track_pos;
+      Track * track = get_track_if_exists (track_pos);
+      if (track && track->type == TRACK_TYPE_TEMPO)
+        {
+          tempo_track_invalidate_tempo_map (track);
+        }
+    }
+
+  if (self->type == TYPE (REGION))
+    {
+      RegionIdentifier * id =
+        &((ZRegion *) self)->id;
+      Track * track =
+        get_track_if_exists (id->track_pos);
+      if (!track ||
+          !region_type_has_lane (id->type) ||
+          id->lane_pos < 0 ||
+          id->lane_pos >= track->num_lanes)
+        return;
+
+      track_lane_invalidate_region_index (
+        track->lanes[id->lane_pos]);
+      return;
+    }
+
+  if (self->type != TYPE (MIDI_NOTE) &&
+      self->type != TYPE (CHORD_OBJECT))
+    return;
+
+  RegionIdentifier * id = &self->region_id;
+  Track * track =
+    get_track_if_exists (id->track_pos);
+  if (!track)
+    return;
+
+  ZRegion * region = NULL;
+  if (id->type == REGION_TYPE_MIDI)
+    {
+      if (id->lane_pos < 0 ||
+          id->lane_pos >= track->num_lanes)
+        return;
+      TrackLane * lane = track->lanes[id->lane_pos];
+      if (id->idx < 0 || id->idx >= lane->num_regions)
+        return;
+      region = lane->regions[id->idx];
+    }
+  else if (id->type == REGION_TYPE_CHORD)
+    {
+      if (id->idx < 0 ||
+          id->idx >= track->num_chord_regions)
+        return;
+      region = track->chord_regions[id->idx];
+    }
+
+  if (region)
+    {
+      midi_region_invalidate_note_index (region);
+    }
+}
+
 /**
  * Sets the dest object's values to the main
  * src object's values.
@@ -288,6 +389,8 @@ arranger_object_set_to_object (
       dest->fade_in_pos = src->fade_in_pos;
       dest->fade_out_pos = src->fade_out_pos;
     }
+  invalidate_playback_index (dest);
+  arranger_object_index_invalidate_all ();
 
   /* reset other members */
   switch (src->type)
@@ -643,6 +746,9 @@ arranger_object_set_position (
   pos_ptr = get_position_ptr (self, pos_type);
   g_return_if_fail (pos_ptr);
   position_set_to_pos (pos_ptr, pos);
+
+  invalidate_playback_index (self);
+  arranger_object_index_invalidate_all ();
 }
 
 /**
@@ -2015,8 +2121,10 @@ clone_region (
             region->id.lane_pos,
             region->id.idx);
         ZRegion * mr_orig = region;
-        for (i = 0;
-             i < mr_orig->num_midi_notes; i++)
+        int num_midi_notes =
+          flag == ARRANGER_OBJECT_CLONE_COPY_SHALLOW ?
+            0 : mr_orig->num_midi_notes;
+        for (i = 0; i < num_midi_notes; i++)
           {
             MidiNote * orig_mn =
               mr_orig->midi_notes[i];
@@ -2087,7 +2195,10 @@ clone_region (
 
         /* add automation points */
         AutomationPoint * src_ap, * dest_ap;
-        for (j = 0; j < ar_orig->num_aps; j++)
+        int num_aps =
+          flag == ARRANGER_OBJECT_CLONE_COPY_SHALLOW ?
+            0 : ar_orig->num_aps;
+        for (j = 0; j < num_aps; j++)
           {
             src_ap = ar_orig->aps[j];
             ArrangerObject * src_ap_obj =
@@ -2115,9 +2226,10 @@ clone_region (
             region->id.idx);
         ZRegion * cr_orig = region;
         ChordObject * src_co, * dest_co;
-        for (i = 0;
-             i < cr_orig->num_chord_objects;
-             i++)
+        int num_chord_objects =
+          flag == ARRANGER_OBJECT_CLONE_COPY_SHALLOW ?
+            0 : cr_orig->num_chord_objects;
+        for (i = 0; i < num_chord_objects; i++)
           {
             src_co = cr_orig->chord_objects[i];
 
@@ -2262,6 +2374,73 @@ clone_automation_point (
   return ap_obj;
 }
 
+/**
+ * Returns the approximate amount of memory used
+ * by the object and its children, in bytes.
+ *
+ * Used for keeping track of the memory used by
+ * the undo history.
+ */
+size_t
+arranger_object_get_mem_usage (
+  ArrangerObject * self)
+{
+  g_return_val_if_fail (self, 0);
+
+  switch (self->type)
+    {
+    case TYPE (REGION):
+      {
+        ZRegion * r = (ZRegion *) self;
+        size_t size = sizeof (ZRegion);
+        if (r->name)
+          size += strlen (r->name) + 1;
+        for (int i = 0; i < r->num_midi_notes; i++)
+          {
+            size +=
+              arranger_object_get_mem_usage (
+                (ArrangerObject *)
+                r->midi_notes[i]);
+          }
+        size +=
+          (size_t) r->num_aps *
+            sizeof (AutomationPoint) +
+          (size_t) r->num_chord_objects *
+            sizeof (ChordObject);
+        size +=
+          (r->midi_notes_size + r->aps_size +
+             r->chord_objects_size) *
+          sizeof (void *);
+
+        /* audio frames live in the pool's clip and
+         * are not copied by clones */
+        return size;
+      }
+    case TYPE (MIDI_NOTE):
+      return sizeof (MidiNote) + sizeof (Velocity);
+    case TYPE (CHORD_OBJECT):
+      return sizeof (ChordObject);
+    case TYPE (SCALE_OBJECT):
+      return
+        sizeof (ScaleObject) + sizeof (MusicalScale);
+    case TYPE (AUTOMATION_POINT):
+      return sizeof (AutomationPoint);
+    case TYPE (MARKER):
+      {
+        Marker * m = (Marker *) self;
+        return
+          sizeof (Marker) +
+          (m->name ? strlen (m->name) + 1 : 0);
+      }
+    case TYPE (VELOCITY):
+      return sizeof (Velocity);
+    default:
+      g_return_val_if_reached (0);
+    }
+
+  g_return_val_if_reached (0);
+}
+
 /**
  * Clone the ArrangerObject.
  *
@@ -3249,6 +3428,9 @@ arranger_object_free (
 {
   g_return_if_fail (IS_ARRANGER_OBJECT (self));
 
+  /* make sure freed objects are not hit */
+  arranger_object_index_invalidate_all ();
+
   switch (self->type)
     {
     case TYPE (REGION):
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "gui/backend/arranger_object_index.h"
+#include "utils/objects.h"
+
+#include <gtk/gtk.h>
+
+/**
+ * Incremented every time arranger objects change,
+ * so that indices built before the change are
+ * not used.
+ */
+static volatile gint change_counter = 0;
+
+/**
+ * Creates a new empty index.
+ */
+ArrangerObjectIndex *
+arranger_object_index_new (void)
+{
+  ArrangerObjectIndex * self =
+    object_new (ArrangerObjectIndex);
+
+  self->generation = -1;
+
+  return self;
+}
+
+/**
+ * Marks all indices as outdated.
+ *
+ * To be called when arranger objects are added,
+ * moved or removed, or when tracks are added,
+ * moved or removed.
+ */
+void
+arranger_object_index_invalidate_all (void)
+{
+  g_atomic_int_inc (&change_counter);
+}
+
+/**
+ * Returns whether the index is up to date and
+ * was built for the given owner.
+ */
+bool
+arranger_object_index_is_valid (
+  ArrangerObjectIndex * self,
+  void *                owner)
+{
+  return
+    self->generation ==
+      g_atomic_int_get (&change_counter) &&
+    self->owner == owner;
+}
+
+/**
+ * Removes all the objects from the index to start
+ * building it again.
+ */
+void
+arranger_object_index_clear (
+  ArrangerObjectIndex * self,
+  void *                owner)
+{
+  self->num_entries = 0;
+  self->owner = owner;
+  self->generation = -1;
+}
+
+/**
+ * Adds an object to the index.
+ *
+ * Objects are returned by queries in the order
+ * they were added.
+ */
+void
+arranger_object_index_add (
+  ArrangerObjectIndex * self,
+  ArrangerObject *      obj,
+  double                start_ticks,
+  double                end_ticks)
+{
+  if ((size_t) self->num_entries ==
+        self->entries_size)
+    {
+      size_t new_size =
+        MAX (self->entries_size * 2, 64);
+      self->entries =
+        g_realloc_n (
+          self->entries, new_size,
+          sizeof (ArrangerObjectIndexEntry));
+      self->max_end_ticks =
+        g_realloc_n (
+          self->max_end_ticks, new_size,
+          sizeof (double));
+      self->results =
+        g_realloc_n (
+          self->results, new_size,
+          sizeof (ArrangerObjectIndexEntry *));
+      self->result_objs =
+        g_realloc_n (
+          self->result_objs, new_size,
+          sizeof (ArrangerObject *));
+      self->entries_size = new_size;
+    }
+
+  ArrangerObjectIndexEntry * entry =
+    &self->entries[self->num_entries];
+  entry->obj = obj;
+  entry->start_ticks = start_ticks;
+  entry->end_ticks = MAX (start_ticks, end_ticks);
+  entry->order = self->num_entries;
+  self->num_entries++;
+}
+
+static int
+cmp_entry_start (
+  const void * a,
+  const void * b)
+{
+  const ArrangerObjectIndexEntry * ea =
+    (const ArrangerObjectIndexEntry *) a;
+  const ArrangerObjectIndexEntry * eb =
+    (const ArrangerObjectIndexEntry *) b;
+  if (ea->start_ticks < eb->start_ticks)
+    return -1;
+  if (ea->start_ticks > eb->start_ticks)
+    return 1;
+  return ea->order - eb->order;
+}
+
+static int
+cmp_result_order (
+  const void * a,
+  const void * b)
+{
+  const ArrangerObjectIndexEntry * ea =
+    * (ArrangerObjectIndexEntry * const *) a;
+  const ArrangerObjectIndexEntry * eb =
+    * (ArrangerObjectIndexEntry * const *) b;
+  return ea->order - eb->order;
+}
+
+/**
+ * Sorts the added objects and marks the index as
+ * up to date.
+ */
+void
+arranger_object_index_finish (
+  ArrangerObjectIndex * self)
+{
+  qsort (
+    self->entries, (size_t) self->num_entries,
+    sizeof (ArrangerObjectIndexEntry),
+    cmp_entry_start);
+
+  for (int i = 0; i < self->num_entries; i++)
+    {
+      double end_ticks = self->entries[i].end_ticks;
+      self->max_end_ticks[i] =
+        i > 0 ?
+          MAX (self->max_end_ticks[i - 1], end_ticks) :
+          end_ticks;
+    }
+
+  self->generation =
+    g_atomic_int_get (&change_counter);
+}
+
+/**
+ * Returns the objects that overlap the given
+ * range, in the order they were added.
+ *
+ * The returned array is owned by the index and
+ * is valid until the next call.
+ *
+ * @param[out] num_objs Number of objects returned.
+ */
+ArrangerObject **
+arranger_object_index_query (
+  ArrangerObjectIndex * self,
+  double                start_ticks,
+  double                end_ticks,
+  int *                 num_objs)
+{
+  *num_objs = 0;
+
+  /* find the first entry starting after the
+   * range */
+  int lo = 0;
+  int hi = self->num_entries;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (self->entries[mid].start_ticks <=
+            end_ticks)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  /* go back until no earlier entry can reach the
+   * range */
+  int num_results = 0;
+  for (int i = lo - 1;
+       i >= 0 &&
+       self->max_end_ticks[i] >= start_ticks;
+       i--)
+    {
+      ArrangerObjectIndexEntry * entry =
+        &self->entries[i];
+      if (entry->end_ticks >= start_ticks)
+        {
+          self->results[num_results++] = entry;
+        }
+    }
+
+  if (num_results > 1)
+    {
+      qsort (
+        self->results, (size_t) num_results,
+        sizeof (ArrangerObjectIndexEntry *),
+        cmp_result_order);
+    }
+  for (int i = 0; i < num_results; i++)
+    {
+      self->result_objs[i] = self->results[i]->obj;
+    }
+  *num_objs = num_results;
+
+  return self->result_objs;
+}
+
+void
+arranger_object_index_free (
+  ArrangerObjectIndex * self)
+{
+  g_free (self->entries);
+  g_free (self->max_end_ticks);
+  g_free (self->results);
+  g_free (self->result_objs);
+
+  object_zero_and_free (self);
+}
@@ -381,12 +381,10 @@ arranger_selections_set_from_selections (
 #undef RESET_COUNTERPART
 }
 
-/**
- * Clone the struct for copying, undoing, etc.
- */
-ArrangerSelections *
-arranger_selections_clone (
-  ArrangerSelections * self)
+static ArrangerSelections *
+clone_selections (
+  ArrangerSelections *    self,
+  ArrangerObjectCloneFlag flag)
 {
   g_return_val_if_fail (self, NULL);
 
@@ -406,8 +404,7 @@ arranger_selections_clone (
       new_##sc = \
         (cc *) \
         arranger_object_clone ( \
-          (ArrangerObject *) sc, \
-          ARRANGER_OBJECT_CLONE_COPY); \
+          (ArrangerObject *) sc, flag); \
       ArrangerObject * new_sc_obj = \
         (ArrangerObject *) new_##sc; \
       sc_obj->transient = new_sc_obj; \
@@ -490,6 +487,33 @@ arranger_selections_clone (
 #undef CLONE_OBJS
 }
 
+/**
+ * Clone the struct for copying, undoing, etc.
+ */
+ArrangerSelections *
+arranger_selections_clone (
+  ArrangerSelections * self)
+{
+  return
+    clone_selections (
+      self, ARRANGER_OBJECT_CLONE_COPY);
+}
+
+/**
+ * Clones the struct without the children of the
+ * objects.
+ *
+ * @see ARRANGER_OBJECT_CLONE_COPY_SHALLOW.
+ */
+ArrangerSelections *
+arranger_selections_clone_shallow (
+  ArrangerSelections * self)
+{
+  return
+    clone_selections (
+      self, ARRANGER_OBJECT_CLONE_COPY_SHALLOW);
+}
+
 static int
 sort_midi_notes_func (
   const void * _a,
@@ -2102,6 +2126,7 @@ arranger_selections_merge (
             /* add all audio data */
             AudioClip * clip =
               audio_region_get_clip (r);
+            audio_clip_ensure_loaded (clip);
             dsp_add2 (
               &lframes[frames_diff],
               clip->ch_frames[0],
@@ -2346,6 +2371,51 @@ arranger_selections_paste_to_pos (
     }
 }
 
+/**
+ * Returns the approximate amount of memory used
+ * by the selections and their objects, in bytes.
+ */
+size_t
+arranger_selections_get_mem_usage (
+  ArrangerSelections * self)
+{
+  size_t mem_usage = 0;
+  switch (self->type)
+    {
+    case TYPE (TIMELINE):
+      mem_usage += sizeof (TimelineSelections);
+      break;
+    case TYPE (MIDI):
+      mem_usage += sizeof (MidiArrangerSelections);
+      break;
+    case TYPE (AUTOMATION):
+      mem_usage += sizeof (AutomationSelections);
+      break;
+    case TYPE (CHORD):
+      mem_usage += sizeof (ChordSelections);
+      break;
+    case TYPE (AUDIO):
+      mem_usage += sizeof (AudioSelections);
+      break;
+    default:
+      break;
+    }
+
+  int size;
+  ArrangerObject ** objs =
+    arranger_selections_get_all_objects (
+      self, &size);
+  for (int i = 0; i < size; i++)
+    {
+      mem_usage +=
+        arranger_object_get_mem_usage (objs[i]) +
+        sizeof (ArrangerObject *);
+    }
+  free (objs);
+
+  return mem_usage;
+}
+
 /**
  * Returns all objects in the selections in a
  * newly allocated array that should be free'd.
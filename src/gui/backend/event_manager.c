@@ -31,6 +31,7 @@
 #include "audio/pool.h"
 #include "audio/router.h"
 #include "audio/stretcher.h"
+#include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -1841,6 +1842,13 @@ return_to_pool:
     g_message ("More than 6 events processed. "
                "Optimization needed.");
 
+  /* pick up tempo automation changes made outside
+   * undoable actions (eg, while dragging) */
+  if (PROJECT && TRACKLIST && P_TEMPO_TRACK)
+    {
+      tempo_track_update_tempo_map (P_TEMPO_TRACK);
+    }
+
   /*g_usleep (8000);*/
   /*project_sanity_check (PROJECT);*/
 
@@ -31,6 +31,7 @@
 #include "audio/midi_region.h"
 #include "audio/track.h"
 #include "audio/transport.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/arranger.h"
@@ -69,6 +70,7 @@
 #include "gui/widgets/timeline_ruler.h"
 #include "gui/widgets/track.h"
 #include "gui/widgets/tracklist.h"
+#include "gui/widgets/velocity.h"
 #include "project.h"
 #include "settings/settings.h"
 #include "utils/arrays.h"
@@ -475,12 +477,306 @@ add_object_if_overlap (
   return add;
 }
 
+/**
+ * Adds the region to the array if it is hit,
+ * checking the visibility of automation regions
+ * and the lanes of lane regions.
+ */
+static void
+add_region_if_overlap (
+  ArrangerWidget *   self,
+  GdkRectangle *     rect,
+  double             x,
+  double             y,
+  ArrangerObject **  array,
+  int *              array_size,
+  ZRegion *          r)
+{
+  g_warn_if_fail (IS_REGION (r));
+  ArrangerObject * obj = (ArrangerObject *) r;
+
+  switch (r->id.type)
+    {
+    case REGION_TYPE_AUTOMATION:
+      {
+        Track * track =
+          arranger_object_get_track (obj);
+        AutomationTrack * at =
+          region_get_automation_track (r);
+        if (!track->automation_visible ||
+            !at || !at->visible)
+          return;
+
+        add_object_if_overlap (
+          self, rect, x, y, array, array_size,
+          obj);
+      }
+      break;
+    case REGION_TYPE_CHORD:
+      add_object_if_overlap (
+        self, rect, x, y, array, array_size, obj);
+      break;
+    default:
+      {
+        bool ret =
+          add_object_if_overlap (
+            self, rect, x, y, array, array_size,
+            obj);
+        if (ret)
+          return;
+
+        /* check lanes */
+        Track * track =
+          arranger_object_get_track (obj);
+        if (!track->lanes_visible)
+          return;
+        GdkRectangle lane_rect;
+        region_get_lane_full_rect (r, &lane_rect);
+        if (((rect &&
+              ui_rectangle_overlap (
+                &lane_rect, rect)) ||
+             (!rect &&
+              ui_is_point_in_rect_hit (
+                &lane_rect, true, true, x, y,
+                0, 0))) &&
+            arranger_object_get_arranger (obj) ==
+              self &&
+            !obj->deleted_temporarily)
+          {
+            array[*array_size] = obj;
+            (*array_size)++;
+          }
+      }
+      break;
+    }
+}
+
+/**
+ * Rebuilds the object index of the arranger with
+ * the objects that can have many instances.
+ *
+ * @param region The clip editor region, if the
+ *   arranger is an editor.
+ */
+static void
+build_object_index (
+  ArrangerWidget * self,
+  ZRegion *        region)
+{
+  ArrangerObjectIndex * index = self->object_index;
+  arranger_object_index_clear (index, region);
+
+  switch (self->type)
+    {
+    case TYPE (TIMELINE):
+      for (int i = 0; i < TRACKLIST->num_tracks; i++)
+        {
+          Track * track = TRACKLIST->tracks[i];
+          for (int j = 0; j < track->num_lanes; j++)
+            {
+              TrackLane * lane = track->lanes[j];
+              for (int k = 0; k < lane->num_regions;
+                   k++)
+                {
+                  ArrangerObject * obj =
+                    (ArrangerObject *)
+                    lane->regions[k];
+                  arranger_object_index_add (
+                    index, obj,
+                    obj->pos.total_ticks,
+                    obj->end_pos.total_ticks);
+                }
+            }
+
+          for (int j = 0;
+               j < track->num_chord_regions; j++)
+            {
+              ArrangerObject * obj =
+                (ArrangerObject *)
+                track->chord_regions[j];
+              arranger_object_index_add (
+                index, obj, obj->pos.total_ticks,
+                obj->end_pos.total_ticks);
+            }
+
+          AutomationTracklist * atl =
+            track_get_automation_tracklist (track);
+          if (!atl)
+            continue;
+          for (int j = 0; j < atl->num_ats; j++)
+            {
+              AutomationTrack * at = atl->ats[j];
+              for (int k = 0; k < at->num_regions;
+                   k++)
+                {
+                  ArrangerObject * obj =
+                    (ArrangerObject *)
+                    at->regions[k];
+                  arranger_object_index_add (
+                    index, obj,
+                    obj->pos.total_ticks,
+                    obj->end_pos.total_ticks);
+                }
+            }
+        }
+      break;
+    case TYPE (MIDI):
+    case TYPE (MIDI_MODIFIER):
+      for (int i = 0; i < region->num_midi_notes;
+           i++)
+        {
+          MidiNote * mn = region->midi_notes[i];
+          ArrangerObject * mn_obj =
+            (ArrangerObject *) mn;
+          if (self->type == TYPE (MIDI))
+            {
+              arranger_object_index_add (
+                index, mn_obj,
+                mn_obj->pos.total_ticks,
+                mn_obj->end_pos.total_ticks);
+            }
+          else
+            {
+              arranger_object_index_add (
+                index, (ArrangerObject *) mn->vel,
+                mn_obj->pos.total_ticks,
+                mn_obj->pos.total_ticks);
+            }
+        }
+      break;
+    case TYPE (AUTOMATION):
+      for (int i = 0; i < region->num_aps; i++)
+        {
+          AutomationPoint * ap = region->aps[i];
+          ArrangerObject * obj =
+            (ArrangerObject *) ap;
+
+          /* the curve to the next point is part
+           * of the point */
+          AutomationPoint * next_ap =
+            automation_region_get_next_ap (
+              region, ap, false, false);
+          arranger_object_index_add (
+            index, obj, obj->pos.total_ticks,
+            next_ap ?
+              ((ArrangerObject *) next_ap)->
+                pos.total_ticks :
+              obj->pos.total_ticks);
+        }
+      break;
+    default:
+      g_warn_if_reached ();
+      break;
+    }
+
+  arranger_object_index_finish (index);
+}
+
+/**
+ * Returns the indexed objects around the given
+ * rect or point, to be checked for hits, or NULL
+ * if all the objects need to be checked.
+ *
+ * @param region The clip editor region, if the
+ *   arranger is an editor.
+ */
+static ArrangerObject **
+get_indexed_objects_to_check (
+  ArrangerWidget *   self,
+  ZRegion *          region,
+  GdkRectangle *     rect,
+  double             x,
+  int *              num_objs)
+{
+  /* the original objects are also drawn and hit
+   * while moving, and the index is outdated on
+   * every step anyway */
+  if (arranger_widget_is_in_moving_operation (self))
+    return NULL;
+
+  double start_px, end_px;
+  if (rect)
+    {
+      start_px = (double) rect->x;
+      end_px = (double) (rect->x + rect->width);
+    }
+  else if (x >= 0.0)
+    {
+      start_px = x;
+      end_px = x;
+    }
+  else
+    return NULL;
+
+  RulerWidget * ruler;
+  double region_start_ticks = 0.0;
+  /* extra pixels to look at around the range,
+   * for objects drawn outside their positions */
+  double margin_px = 2.0;
+  switch (self->type)
+    {
+    case TYPE (TIMELINE):
+      ruler = MW_RULER;
+      break;
+    case TYPE (MIDI):
+      ruler = (RulerWidget *) EDITOR_RULER;
+      region_start_ticks =
+        ((ArrangerObject *) region)->pos.total_ticks;
+      if (PIANO_ROLL->drum_mode)
+        {
+          margin_px +=
+            MW_PIANO_ROLL_KEYS->px_per_key + 1.0;
+        }
+      break;
+    case TYPE (MIDI_MODIFIER):
+      ruler = (RulerWidget *) EDITOR_RULER;
+      region_start_ticks =
+        ((ArrangerObject *) region)->pos.total_ticks;
+      margin_px += VELOCITY_WIDTH;
+      break;
+    case TYPE (AUTOMATION):
+      ruler = (RulerWidget *) EDITOR_RULER;
+      region_start_ticks =
+        ((ArrangerObject *) region)->pos.total_ticks;
+      margin_px += AP_WIDGET_POINT_SIZE;
+      break;
+    default:
+      return NULL;
+    }
+  if (!ruler || ruler->px_per_tick <= 0.0)
+    return NULL;
+
+  if (!arranger_object_index_is_valid (
+         self->object_index, region))
+    {
+      build_object_index (self, region);
+    }
+
+  double start_ticks =
+    (start_px - margin_px - SPACE_BEFORE_START_D) /
+      ruler->px_per_tick -
+    region_start_ticks;
+  double end_ticks =
+    (end_px + margin_px - SPACE_BEFORE_START_D) /
+      ruler->px_per_tick -
+    region_start_ticks;
+
+  return
+    arranger_object_index_query (
+      self->object_index, start_ticks, end_ticks,
+      num_objs);
+}
+
 /**
  * Fills in the given array with the
  * ArrangerObject's of the given type that appear
  * in the given rect, or at the given coords if
  * \ref rect is NULL.
  *
+ * Regions, MIDI notes, velocities and automation
+ * points are looked up in the arranger's
+ * @ref ArrangerWidget.object_index.
+ *
  * @param rect The rectangle to search in.
  * @param type The type of arranger objects to find,
  *   or -1 to look for all objects.
@@ -503,6 +799,8 @@ get_hit_objects (
 
   *array_size = 0;
   ArrangerObject * obj = NULL;
+  ArrangerObject ** objs_to_check = NULL;
+  int num_objs_to_check = 0;
 
   /* skip if haven't drawn yet */
   if (self->first_draw)
@@ -519,125 +817,81 @@ get_hit_objects (
           type != ARRANGER_OBJECT_TYPE_SCALE_OBJECT)
         break;
 
-      /* add overlapping scales */
-      if (type == ARRANGER_OBJECT_TYPE_ALL ||
-          type ==
-            ARRANGER_OBJECT_TYPE_SCALE_OBJECT)
-        {
-          for (int i = 0;
-               i < P_CHORD_TRACK->num_scales; i++)
-            {
-              obj =
-                (ArrangerObject *)
-                P_CHORD_TRACK->scales[i];
-              add_object_if_overlap (
-                self, rect, x, y, array,
-                array_size, obj);
-            }
-        }
-
       /* add overlapping regions */
       if (type == ARRANGER_OBJECT_TYPE_ALL ||
           type == ARRANGER_OBJECT_TYPE_REGION)
         {
-          /* midi and audio regions */
-          for (int i = 0;
-               i < TRACKLIST->num_tracks;
-               i++)
+          objs_to_check =
+            get_indexed_objects_to_check (
+              self, NULL, rect, x,
+              &num_objs_to_check);
+          if (objs_to_check)
             {
-              Track * track =
-                TRACKLIST->tracks[i];
-
-              for (int j = 0;
-                   j < track->num_lanes; j++)
+              for (int i = 0;
+                   i < num_objs_to_check; i++)
+                {
+                  add_region_if_overlap (
+                    self, rect, x, y, array,
+                    array_size,
+                    (ZRegion *) objs_to_check[i]);
+                }
+            }
+          else
+            {
+              for (int i = 0;
+                   i < TRACKLIST->num_tracks;
+                   i++)
                 {
-                  TrackLane * lane =
-                    track->lanes[j];
-                  for (int k = 0;
-                       k < lane->num_regions;
-                       k++)
+                  Track * track =
+                    TRACKLIST->tracks[i];
+
+                  /* midi and audio regions */
+                  for (int j = 0;
+                       j < track->num_lanes; j++)
                     {
-                      ZRegion *r =
-                        lane->regions[k];
-                      g_warn_if_fail (
-                        IS_REGION (r));
-                      obj =
-                        (ArrangerObject *) r;
-                      bool ret =
-                        add_object_if_overlap (
-                          self, rect, x, y, array,
-                          array_size, obj);
-                      if (!ret)
+                      TrackLane * lane =
+                        track->lanes[j];
+                      for (int k = 0;
+                           k < lane->num_regions;
+                           k++)
                         {
-                          /* check lanes */
-                          if (!track->
-                                lanes_visible)
-                            continue;
-                          GdkRectangle lane_rect;
-                          region_get_lane_full_rect (
-                            lane->regions[k],
-                            &lane_rect);
-                          if (((rect &&
-                               ui_rectangle_overlap (
-                                &lane_rect,
-                                rect)) ||
-                               (!rect &&
-                                ui_is_point_in_rect_hit (
-                                  &lane_rect,
-                                  true, true, x, y,
-                                  0, 0))) &&
-                              arranger_object_get_arranger (obj) ==  self &&
-                              !obj->deleted_temporarily)
-                            {
-                              array[*array_size] =
-                                obj;
-                              (*array_size)++;
-                            }
+                          add_region_if_overlap (
+                            self, rect, x, y,
+                            array, array_size,
+                            lane->regions[k]);
                         }
                     }
-                }
-
-              /* chord regions */
-              for (int j = 0;
-                   j < P_CHORD_TRACK->num_chord_regions;
-                   j++)
-                {
-                  ZRegion * cr =
-                    P_CHORD_TRACK->chord_regions[j];
-                  obj =
-                    (ArrangerObject *) cr;
-                  add_object_if_overlap (
-                    self, rect, x, y, array,
-                    array_size, obj);
-                }
 
-              /* automation regions */
-              AutomationTracklist * atl =
-                track_get_automation_tracklist (
-                  track);
-              if (atl &&
-                  track->automation_visible)
-                {
+                  /* chord regions */
                   for (int j = 0;
-                       j < atl->num_ats;
+                       j < track->num_chord_regions;
                        j++)
+                    {
+                      add_region_if_overlap (
+                        self, rect, x, y, array,
+                        array_size,
+                        track->chord_regions[j]);
+                    }
+
+                  /* automation regions */
+                  AutomationTracklist * atl =
+                    track_get_automation_tracklist (
+                      track);
+                  if (!atl)
+                    continue;
+                  for (int j = 0;
+                       j < atl->num_ats; j++)
                     {
                       AutomationTrack * at =
                         atl->ats[j];
-
-                      if (!at->visible)
-                        continue;
-
                       for (int k = 0;
                            k < at->num_regions;
                            k++)
                         {
-                          obj =
-                            (ArrangerObject *)
-                            at->regions[k];
-                          add_object_if_overlap (
-                            self, rect, x, y, array,
-                            array_size, obj);
+                          add_region_if_overlap (
+                            self, rect, x, y,
+                            array, array_size,
+                            at->regions[k]);
                         }
                     }
                 }
@@ -690,16 +944,23 @@ get_hit_objects (
           if (!r)
             break;
 
-          for (int i = 0; i < r->num_midi_notes;
+          objs_to_check =
+            get_indexed_objects_to_check (
+              self, r, rect, x,
+              &num_objs_to_check);
+          if (!objs_to_check)
+            {
+              objs_to_check =
+                (ArrangerObject **) r->midi_notes;
+              num_objs_to_check = r->num_midi_notes;
+            }
+
+          for (int i = 0; i < num_objs_to_check;
                i++)
             {
-              MidiNote * mn = r->midi_notes[i];
-              obj =
-                (ArrangerObject *)
-                mn;
               add_object_if_overlap (
                 self, rect, x, y, array,
-                array_size, obj);
+                array_size, objs_to_check[i]);
             }
         }
       break;
@@ -713,6 +974,22 @@ get_hit_objects (
           if (!r)
             break;
 
+          objs_to_check =
+            get_indexed_objects_to_check (
+              self, r, rect, x,
+              &num_objs_to_check);
+          if (objs_to_check)
+            {
+              for (int i = 0;
+                   i < num_objs_to_check; i++)
+                {
+                  add_object_if_overlap (
+                    self, rect, x, y, array,
+                    array_size, objs_to_check[i]);
+                }
+              break;
+            }
+
           for (int i = 0; i < r->num_midi_notes;
                i++)
             {
@@ -765,13 +1042,23 @@ get_hit_objects (
           if (!r)
             break;
 
-          for (int i = 0; i < r->num_aps; i++)
+          objs_to_check =
+            get_indexed_objects_to_check (
+              self, r, rect, x,
+              &num_objs_to_check);
+          if (!objs_to_check)
+            {
+              objs_to_check =
+                (ArrangerObject **) r->aps;
+              num_objs_to_check = r->num_aps;
+            }
+
+          for (int i = 0; i < num_objs_to_check;
+               i++)
             {
-              AutomationPoint * ap =  r->aps[i];
-              obj = (ArrangerObject *) ap;
               add_object_if_overlap (
                 self, rect, x, y, array,
-                array_size, obj);
+                array_size, objs_to_check[i]);
             }
         }
       break;
@@ -5942,10 +6229,29 @@ arranger_widget_setup (
   g_debug ("done");
 }
 
+static void
+finalize (
+  ArrangerWidget * self)
+{
+  if (self->object_index)
+    {
+      arranger_object_index_free (
+        self->object_index);
+    }
+
+  G_OBJECT_CLASS (
+    arranger_widget_parent_class)->
+      finalize (G_OBJECT (self));
+}
+
 static void
 arranger_widget_class_init (
   ArrangerWidgetClass * _klass)
 {
+  GObjectClass * oklass =
+    G_OBJECT_CLASS (_klass);
+  oklass->finalize =
+    (GObjectFinalizeFunc) finalize;
 }
 
 static void
@@ -5953,6 +6259,8 @@ arranger_widget_init (
   ArrangerWidget *self)
 {
   self->first_draw = true;
+  self->object_index =
+    arranger_object_index_new ();
 
   /* make widget able to notify */
   gtk_widget_add_events (
@@ -522,34 +522,10 @@ draw_audio_bg (
       if (curr_frames < 0)
         continue;
 
-      float min = 0.f, max = 0.f;
-      for (long j = prev_frames;
-           j < curr_frames; j++)
-        {
-          if (j >= (long) clip->num_frames)
-            break;
-          for (unsigned int k = 0;
-               k < clip->channels; k++)
-            {
-              long index =
-                j * (long) clip->channels + (long) k;
-              g_return_if_fail (
-                index >= 0 &&
-                index <
-                  (long)
-                  (clip->num_frames *
-                     clip->channels));
-              float val = clip->frames[index];
-              if (val > max)
-                {
-                  max = val;
-                }
-              if (val < min)
-                {
-                  min = val;
-                }
-            }
-        }
+      float min, max;
+      audio_clip_get_min_max (
+        clip, prev_frames, curr_frames,
+        &min, &max);
 #define DRAW_VLINE(cr,x,from_y,_height) \
   switch (detail) \
     { \
@@ -23,8 +23,11 @@
 #include "actions/tracklist_selections.h"
 #include "actions/undoable_action.h"
 #include "actions/undo_manager.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
 #include "audio/master_track.h"
 #include "audio/meter.h"
+#include "audio/router.h"
 #include "audio/track.h"
 #include "gui/widgets/balance_control.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -135,6 +138,50 @@ channel_widget_update_meter_reading (
   return G_SOURCE_CONTINUE;
 }
 
+/**
+ * Shows the processing time of the track as the
+ * tooltip of the meter reading.
+ */
+static gboolean
+on_meter_reading_query_tooltip (
+  GtkWidget *     widget,
+  gint            x,
+  gint            y,
+  gboolean        keyboard_mode,
+  GtkTooltip *    tooltip,
+  ChannelWidget * self)
+{
+  if (!AUDIO_ENGINE || !ROUTER || !ROUTER->graph)
+    return false;
+
+  Track * track =
+    channel_get_track (self->channel);
+  GraphNodeDspLoad load;
+  graph_get_track_dsp_load (
+    ROUTER->graph, track, &load);
+  if (load.num_cycles == 0)
+    return false;
+
+  /* in nanoseconds */
+  gint64 block_latency =
+    ((gint64) AUDIO_ENGINE->block_length *
+       1000000000) /
+    AUDIO_ENGINE->sample_rate;
+  char str[200];
+  sprintf (
+    str,
+    _("DSP load: %.1f µs (%.1f%% of the cycle)\n"
+    "Average: %.1f µs, min: %.1f µs, max: %.1f µs"),
+    load.last / 1000.0,
+    (double) load.last * 100.0 /
+      (double) MAX (block_latency, 1),
+    load.avg / 1000.0, load.min / 1000.0,
+    load.max / 1000.0);
+  gtk_tooltip_set_text (tooltip, str);
+
+  return true;
+}
+
 static void
 on_drag_data_received (
   GtkWidget        *widget,
@@ -690,6 +737,13 @@ channel_widget_new (Channel * channel)
       channel_widget_update_meter_reading,
     self, NULL);
 
+  gtk_widget_set_has_tooltip (
+    GTK_WIDGET (self->meter_reading), true);
+  g_signal_connect (
+    G_OBJECT (self->meter_reading), "query-tooltip",
+    G_CALLBACK (on_meter_reading_query_tooltip),
+    self);
+
   g_signal_connect (
     self, "destroy",
     G_CALLBACK (on_destroy), NULL);
@@ -545,6 +545,9 @@ make_control (
           SET_STRV_IF_MATCH (
             "UI", "General", "graphic-detail",
             ui_detail_str);
+          SET_STRV_IF_MATCH (
+            "Projects", "General", "file-format",
+            project_file_format_str);
           SET_STRV_IF_MATCH (
             "DSP", "Pan", "pan-algorithm",
             pan_algorithm_str);
@@ -25,6 +25,7 @@
 #include "audio/audio_region.h"
 #include "audio/automation_region.h"
 #include "audio/channel.h"
+#include "audio/clip_peaks.h"
 #include "audio/fade.h"
 #include "audio/instrument_track.h"
 #include "audio/tempo_track.h"
@@ -1132,6 +1133,15 @@ draw_audio_part (
   /*position_from_frames (&tmp, curr_frames);*/
   /*position_print (&tmp);*/
 
+  /* use the coarsest peaks that are still finer
+   * than each drawn line, or read the frames
+   * directly when zoomed in enough */
+  ClipPeaks * peaks = clip_peaks_acquire (clip);
+  int peaks_level =
+    peaks ?
+      clip_peaks_get_level (
+        peaks, multiplier * increment) : -1;
+
   for (double i = local_start_x;
        i < (double) local_end_x; i += increment)
     {
@@ -1142,38 +1152,18 @@ draw_audio_part (
         {
           curr_frames -= loop_frames;
         }
-      float min = 0.f, max = 0.f;
-      for (long j = prev_frames;
-           j < curr_frames; j++)
+      float min, max;
+      if (peaks_level >= 0)
         {
-          for (unsigned int k = 0;
-               k < clip->channels; k++)
-            {
-              long index =
-                j * (long) clip->channels +
-                (long) k;
-
-              /* if outside bounds */
-              if (
-                index < 0 ||
-                index >=
-                (long)
-                  clip->num_frames *
-                  (long) clip->channels)
-                {
-                  /* skip */
-                  continue;
-                }
-              float val = clip->frames[index];
-              if (val > max)
-                {
-                  max = val;
-                }
-              if (val < min)
-                {
-                  min = val;
-                }
-            }
+          clip_peaks_get_min_max (
+            peaks, peaks_level, prev_frames,
+            curr_frames, &min, &max, NULL);
+        }
+      else
+        {
+          audio_clip_get_min_max (
+            clip, prev_frames, curr_frames,
+            &min, &max);
         }
 #define DRAW_VLINE(cr,x,from_y,_height) \
   switch (detail) \
@@ -1224,6 +1214,11 @@ draw_audio_part (
       prev_frames = curr_frames;
     }
 
+  if (peaks)
+    {
+      clip_peaks_release ();
+    }
+
   cairo_stroke (cr);
 }
 
@@ -19,11 +19,13 @@
 
 #include "plugins/cached_plugin_descriptors.h"
 #include "utils/file.h"
+#include "utils/flags.h"
+#include "utils/io.h"
 #include "utils/objects.h"
 #include "utils/string.h"
 #include "zrythm.h"
 
-#define CACHED_PLUGIN_DESCRIPTORS_VERSION 9
+#define CACHED_PLUGIN_DESCRIPTORS_VERSION 10
 
 static char *
 get_cached_plugin_descriptors_file_path (void)
@@ -38,6 +40,118 @@ get_cached_plugin_descriptors_file_path (void)
       "cached_plugin_descriptors.yaml", NULL);
 }
 
+/**
+ * Returns the key of the descriptor in
+ * @ref CachedPluginDescriptors.index.
+ */
+static const char *
+get_index_key (
+  const PluginDescriptor * descr)
+{
+  if (descr->protocol == PROT_LV2)
+    return descr->uri;
+  else
+    return descr->path;
+}
+
+static void
+add_to_index (
+  CachedPluginDescriptors * self,
+  PluginDescriptor *        descr)
+{
+  const char * key = get_index_key (descr);
+  if (!key)
+    return;
+
+  GPtrArray * arr =
+    g_hash_table_lookup (self->index, key);
+  if (!arr)
+    {
+      arr = g_ptr_array_new ();
+      g_hash_table_insert (
+        self->index, g_strdup (key), arr);
+    }
+  g_ptr_array_add (arr, descr);
+}
+
+static void
+add_to_blacklisted_index (
+  CachedPluginDescriptors * self,
+  PluginDescriptor *        descr)
+{
+  if (!descr->path)
+    return;
+
+  g_hash_table_insert (
+    self->blacklisted_index, g_strdup (descr->path),
+    descr);
+}
+
+/**
+ * Makes the lookup tables point to @p new_descr
+ * instead of @p old_descr.
+ */
+static void
+replace_in_index (
+  CachedPluginDescriptors * self,
+  const PluginDescriptor *  old_descr,
+  PluginDescriptor *        new_descr)
+{
+  GPtrArray * arr =
+    g_hash_table_lookup (
+      self->index, get_index_key (new_descr));
+  for (guint i = 0; arr && i < arr->len; i++)
+    {
+      if (g_ptr_array_index (arr, i) == old_descr)
+        {
+          arr->pdata[i] = new_descr;
+        }
+    }
+  if (new_descr->path &&
+      g_hash_table_lookup (
+        self->blacklisted_index,
+        new_descr->path) == old_descr)
+    {
+      add_to_blacklisted_index (self, new_descr);
+    }
+}
+
+/**
+ * Rebuilds the lookup tables from the descriptor
+ * arrays.
+ */
+static void
+rebuild_index (
+  CachedPluginDescriptors * self)
+{
+  if (self->index)
+    {
+      g_hash_table_destroy (self->index);
+    }
+  if (self->blacklisted_index)
+    {
+      g_hash_table_destroy (
+        self->blacklisted_index);
+    }
+  self->index =
+    g_hash_table_new_full (
+      g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) g_ptr_array_unref);
+  self->blacklisted_index =
+    g_hash_table_new_full (
+      g_str_hash, g_str_equal, g_free, NULL);
+
+  for (int i = 0; i < self->num_descriptors; i++)
+    {
+      add_to_index (self, self->descriptors[i]);
+    }
+  for (int i = 0; i < self->num_blacklisted; i++)
+    {
+      add_to_blacklisted_index (
+        self, self->blacklisted[i]);
+    }
+}
+
 void
 cached_plugin_descriptors_serialize_to_file (
   CachedPluginDescriptors * self)
@@ -78,6 +192,7 @@ cached_plugin_descriptors_serialize_to_file (
 CachedPluginDescriptors *
 cached_plugin_descriptors_new (void)
 {
+  CachedPluginDescriptors * self = NULL;
   GError *err = NULL;
   char * path =
     get_cached_plugin_descriptors_file_path ();
@@ -87,8 +202,11 @@ cached_plugin_descriptors_new (void)
         "Cached plugin descriptors file at %s does "
         "not exist", path);
 return_new_instance:
-      return
+      self =
         calloc (1, sizeof (CachedPluginDescriptors));
+      rebuild_index (self);
+      g_free (path);
+      return self;
     }
   char * yaml = NULL;
   g_file_get_contents (path, &yaml, NULL, &err);
@@ -118,10 +236,11 @@ return_new_instance:
         g_file_new_for_path (path);
       g_file_delete (file, NULL, NULL);
       g_object_unref (file);
+      g_free (yaml);
       goto return_new_instance;
     }
 
-  CachedPluginDescriptors * self =
+  self =
     cached_plugin_descriptors_deserialize (yaml);
   if (!self)
     {
@@ -143,6 +262,8 @@ return_new_instance:
           self->descriptors[i]->category_str);
     }
 
+  rebuild_index (self);
+
   return self;
 }
 
@@ -172,21 +293,22 @@ cached_plugin_descriptors_is_blacklisted (
   CachedPluginDescriptors * self,
   const char *           abs_path)
 {
-  for (int i = 0; i < self->num_blacklisted; i++)
-    {
-      PluginDescriptor * descr =
-        self->blacklisted[i];
-      GFile * file =
-        g_file_new_for_path (descr->path);
-      if (string_is_equal (descr->path, abs_path) &&
-          descr->ghash == g_file_hash (file))
-        {
-          g_object_unref (file);
-          return 1;
-        }
-      g_object_unref (file);
-    }
-  return 0;
+  PluginDescriptor * descr =
+    g_hash_table_lookup (
+      self->blacklisted_index, abs_path);
+  if (!descr)
+    return 0;
+
+  /* retry plugins that changed since they were
+   * blacklisted */
+  GFile * file = g_file_new_for_path (abs_path);
+  bool same_file =
+    descr->ghash == g_file_hash (file) &&
+    descr->mtime ==
+      io_file_get_last_modified_time (abs_path);
+  g_object_unref (file);
+
+  return same_file;
 }
 
 /**
@@ -207,12 +329,15 @@ cached_plugin_descriptors_find (
   bool                      check_valid,
   bool                      check_blacklisted)
 {
-  if (check_valid)
+  const char * key = get_index_key (descr);
+  if (check_valid && key)
     {
-      for (int i = 0; i < self->num_descriptors; i++)
+      GPtrArray * arr =
+        g_hash_table_lookup (self->index, key);
+      for (guint i = 0; arr && i < arr->len; i++)
         {
           PluginDescriptor * cur_descr =
-            self->descriptors[i];
+            g_ptr_array_index (arr, i);
           if (plugin_descriptor_is_same_plugin (
                 cur_descr, descr))
             {
@@ -220,17 +345,46 @@ cached_plugin_descriptors_find (
             }
         }
     }
-  if (check_blacklisted)
+  if (check_blacklisted && descr->path)
     {
-      for (int i = 0; i < self->num_blacklisted; i++)
+      PluginDescriptor * cur_descr =
+        g_hash_table_lookup (
+          self->blacklisted_index, descr->path);
+      if (cur_descr &&
+          plugin_descriptor_is_same_plugin (
+            cur_descr, descr))
         {
-          PluginDescriptor * cur_descr =
-            self->blacklisted[i];
-          if (plugin_descriptor_is_same_plugin (
-                cur_descr, descr))
-            {
-              return cur_descr;
-            }
+          return cur_descr;
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * Returns the cached descriptor of the LV2 plugin
+ * with the given URI, if its bundle was not
+ * modified since it was cached.
+ *
+ * @param mtime The current modification time of
+ *   the plugin's bundle.
+ */
+const PluginDescriptor *
+cached_plugin_descriptors_get_lv2 (
+  CachedPluginDescriptors * self,
+  const char *              uri,
+  int64_t                   mtime)
+{
+  GPtrArray * arr =
+    g_hash_table_lookup (self->index, uri);
+  for (guint i = 0; arr && i < arr->len; i++)
+    {
+      PluginDescriptor * descr =
+        g_ptr_array_index (arr, i);
+      if (descr->protocol == PROT_LV2 &&
+          descr->mtime == mtime)
+        {
+          return descr;
         }
     }
 
@@ -252,36 +406,39 @@ cached_plugin_descriptors_get (
   CachedPluginDescriptors * self,
   const char *              abs_path)
 {
+  g_debug ("Getting cached descriptors for %s",
+    abs_path);
+
+  GPtrArray * arr =
+    g_hash_table_lookup (self->index, abs_path);
+  if (!arr)
+    return NULL;
+
   PluginDescriptor ** descriptors =
-    calloc (1, sizeof (PluginDescriptor *));
+    calloc (
+      arr->len + 1, sizeof (PluginDescriptor *));
   int num_descriptors = 0;
 
-  g_debug ("Getting cached descriptors for %s",
-    abs_path);
+  GFile * file = g_file_new_for_path (abs_path);
+  unsigned int ghash = g_file_hash (file);
+  g_object_unref (file);
+  int64_t mtime =
+    io_file_get_last_modified_time (abs_path);
 
-  for (int i = 0; i < self->num_descriptors; i++)
+  for (guint i = 0; i < arr->len; i++)
     {
       PluginDescriptor * descr =
-        self->descriptors[i];
+        g_ptr_array_index (arr, i);
 
       /* skip LV2 since they don't have paths */
       if (descr->protocol == PROT_LV2)
         continue;
 
-      GFile * file =
-        g_file_new_for_path (descr->path);
-      if (string_is_equal (descr->path, abs_path) &&
-          descr->ghash == g_file_hash (file))
+      if (descr->ghash == ghash &&
+          descr->mtime == mtime)
         {
-          num_descriptors++;
-          descriptors =
-            realloc (
-              descriptors,
-              (size_t) (num_descriptors + 1) *
-                sizeof (PluginDescriptor *));
-          descriptors[num_descriptors - 1] = descr;
+          descriptors[num_descriptors++] = descr;
         }
-      g_object_unref (file);
     }
 
   if (num_descriptors == 0)
@@ -316,8 +473,11 @@ cached_plugin_descriptors_blacklist (
   GFile * file = g_file_new_for_path (abs_path);
   new_descr->ghash = g_file_hash (file);
   g_object_unref (file);
+  new_descr->mtime =
+    io_file_get_last_modified_time (abs_path);
   self->blacklisted[self->num_blacklisted++] =
     new_descr;
+  add_to_blacklisted_index (self, new_descr);
   if (_serialize)
     {
       cached_plugin_descriptors_serialize_to_file (
@@ -340,40 +500,42 @@ cached_plugin_descriptors_replace (
   const PluginDescriptor *  _new_descr,
   bool                      _serialize)
 {
+  const PluginDescriptor * found_descr =
+    cached_plugin_descriptors_find (
+      self, _new_descr, F_CHECK_VALID,
+      F_CHECK_BLACKLISTED);
+  if (!found_descr)
+    {
+      /* plugin not found, add instead */
+      cached_plugin_descriptors_add (
+        self, _new_descr, _serialize);
+      return;
+    }
+
   PluginDescriptor * new_descr =
     plugin_descriptor_clone (_new_descr);
-
   for (int i = 0; i < self->num_descriptors; i++)
     {
-      PluginDescriptor * cur_descr =
-        self->descriptors[i];
-      if (plugin_descriptor_is_same_plugin (
-            cur_descr, new_descr))
+      if (self->descriptors[i] == found_descr)
         {
           self->descriptors[i] = new_descr;
-          plugin_descriptor_free (cur_descr);
-          goto check_serialize;
+          goto replaced;
         }
     }
   for (int i = 0; i < self->num_blacklisted; i++)
     {
-      PluginDescriptor * cur_descr =
-        self->blacklisted[i];
-      if (plugin_descriptor_is_same_plugin (
-            cur_descr, new_descr))
+      if (self->blacklisted[i] == found_descr)
         {
-          self->descriptors[i] = new_descr;
-          plugin_descriptor_free (cur_descr);
-          goto check_serialize;
+          self->blacklisted[i] = new_descr;
+          goto replaced;
         }
     }
-  /* plugin not found, add instead */
-  cached_plugin_descriptors_add (
-    self, _new_descr, _serialize);
-  plugin_descriptor_free (new_descr);
-  return;
 
-check_serialize:
+replaced:
+  replace_in_index (self, found_descr, new_descr);
+  plugin_descriptor_free (
+    (PluginDescriptor *) found_descr);
+
   if (_serialize)
     {
       cached_plugin_descriptors_serialize_to_file (
@@ -404,6 +566,7 @@ cached_plugin_descriptors_add (
     }
   self->descriptors[self->num_descriptors++] =
     new_descr;
+  add_to_index (self, new_descr);
 
   if (_serialize)
     {
@@ -424,6 +587,7 @@ cached_plugin_descriptors_clear (
       plugin_descriptor_free (self->descriptors[i]);
     }
   self->num_descriptors = 0;
+  rebuild_index (self);
 
   delete_file ();
 }
@@ -444,6 +608,10 @@ cached_plugin_descriptors_free (
         plugin_descriptor_free,
         self->blacklisted[i]);
     }
+  object_free_w_func_and_null (
+    g_hash_table_destroy, self->index);
+  object_free_w_func_and_null (
+    g_hash_table_destroy, self->blacklisted_index);
 }
 
 SERIALIZE_SRC (
@@ -28,6 +28,7 @@
 #include "plugins/plugin_manager.h"
 #include "plugins/carla/carla_discovery.h"
 #include "utils/file.h"
+#include "utils/io.h"
 #include "utils/string.h"
 #include "utils/system.h"
 #include "zrythm.h"
@@ -393,6 +394,8 @@ z_carla_discovery_create_descriptors_from_file (
         g_file_new_for_path (descr->path);
       descr->ghash = g_file_hash (file);
       g_object_unref (file);
+      descr->mtime =
+        io_file_get_last_modified_time (path);
 
       /* open all VSTs with carla */
       descr->open_with_carla = true;
@@ -22,6 +22,7 @@
 #ifdef HAVE_CARLA
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "audio/engine.h"
 #include "audio/midi_event.h"
@@ -1395,6 +1396,8 @@ carla_native_plugin_save_state (
   GError * err = NULL;
   g_file_set_contents (
     state_file_abs_path, state, -1, &err);
+  self->plugin->state_size =
+    err ? 0 : strlen (state);
   g_free (abs_state_dir);
   g_free (state_file_abs_path);
   g_free (state);
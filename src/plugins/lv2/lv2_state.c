@@ -28,6 +28,7 @@
 #include "plugins/lv2_plugin.h"
 #include "plugins/lv2/lv2_state.h"
 #include "plugins/lv2/lv2_ui.h"
+#include "plugins/plugin.h"
 #include "plugins/plugin_manager.h"
 #include "project.h"
 #include "utils/datetime.h"
@@ -149,6 +150,9 @@ lv2_state_save_to_file (
       return NULL;
     }
 
+  plugin_update_state_size (
+    pl->plugin, abs_state_dir);
+
   g_message (
     "Lilv state saved to %s", pl->plugin->state_dir);
 
@@ -37,6 +37,7 @@
 #include "plugins/lv2/lv2_ui.h"
 #include "plugins/plugin.h"
 #include "plugins/plugin_manager.h"
+#include "utils/rt_trace.h"
 #include "zrythm.h"
 #include "zrythm_app.h"
 
@@ -136,7 +137,7 @@ lv2_ui_read_and_apply_events (
             ev.size) !=
           ev.size)
         {
-          g_warning (
+          rt_warning (
             "Error reading from UI ring buffer");
           break;
         }
@@ -157,9 +158,7 @@ lv2_ui_read_and_apply_events (
             port->port, * (float *) body, 0, 0);
           port->received_ui_event = 1;
 
-          /* note: should not be printing in the
-           * realtime thread */
-          g_debug (
+          rt_debug (
             "plugin %s float control '%s' change: "
             "%f - has custom UI %d",
             plugin->plugin->descr->name,
@@ -179,9 +178,7 @@ lv2_ui_read_and_apply_events (
             (const uint8_t*)
               LV2_ATOM_BODY_CONST(atom));
 
-          /* note: should not be printing in the
-           * realtime thread */
-          g_debug (
+          rt_debug (
             "%s: plugin %s event transfer "
             "event for %s - has custom UI %d",
             __func__, plugin->plugin->descr->name,
@@ -190,7 +187,7 @@ lv2_ui_read_and_apply_events (
         }
       else
         {
-          g_warning (
+          rt_warning (
             "Unknown control change protocol %d",
             ev.protocol);
         }
@@ -294,7 +291,7 @@ lv2_ui_send_event_from_plugin_to_ui (
     {
       PluginDescriptor * descr =
         ((Plugin *)plugin)->descr;
-      g_warning (
+      rt_warning (
         "Buffer overflow when sending plugin %s "
         "(%s) event to its UI",
         descr->name, descr->uri);
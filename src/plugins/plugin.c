@@ -66,6 +66,7 @@
 
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 void
 plugin_init_loaded (
@@ -1667,6 +1668,11 @@ plugin_process (
     }
 #endif
 
+  for (int i = 0; i < plugin->num_out_ports; i++)
+    {
+      plugin->out_ports[i]->silent = false;
+    }
+
   /* turn off any trigger input controls */
   for (int i = 0; i < plugin->num_in_ports; i++)
     {
@@ -2230,11 +2236,16 @@ plugin_process_passthrough (
               Port * out_port = self->out_ports[j];
               if (out_port->id.type == TYPE_AUDIO)
                 {
-                  /* copy */
-                  dsp_copy (
-                    &out_port->buf[local_offset],
-                    &in_port->buf[local_offset],
-                    nframes);
+                  /* copy (the output is already
+                   * silent if the input is) */
+                  if (!in_port->silent)
+                    {
+                      dsp_copy (
+                        &out_port->buf[local_offset],
+                        &in_port->buf[local_offset],
+                        nframes);
+                      out_port->silent = false;
+                    }
 
                   last_audio_idx = j + 1;
                   goto_next = true;
@@ -2977,6 +2988,128 @@ plugin_get_port_by_symbol (
   return port;
 }
 
+/**
+ * Updates \ref Plugin.state_size from the files
+ * in the given state directory.
+ *
+ * To be called after saving the state.
+ */
+void
+plugin_update_state_size (
+  Plugin *     self,
+  const char * abs_state_dir)
+{
+  self->state_size = 0;
+  if (!g_file_test (
+         abs_state_dir, G_FILE_TEST_IS_DIR))
+    return;
+
+  char ** files =
+    io_get_files_in_dir_ending_in (
+      abs_state_dir, 1, NULL);
+  for (int i = 0; files && files[i]; i++)
+    {
+      GStatBuf st;
+      if (g_stat (files[i], &st) == 0)
+        {
+          self->state_size += (size_t) st.st_size;
+        }
+    }
+  g_strfreev (files);
+}
+
+static size_t
+get_ports_mem_usage (
+  Port ** ports,
+  int     num_ports)
+{
+  size_t mem_usage =
+    (size_t) num_ports * sizeof (Port *);
+  for (int i = 0; i < num_ports; i++)
+    {
+      Port * port = ports[i];
+      mem_usage += sizeof (Port);
+      if (port->id.label)
+        {
+          mem_usage += strlen (port->id.label) + 1;
+        }
+      if (port->buf)
+        {
+          mem_usage +=
+            AUDIO_ENGINE->block_length *
+              sizeof (float);
+        }
+      if (port->midi_events)
+        {
+          mem_usage += sizeof (MidiEvents);
+        }
+      if (port->audio_ring)
+        {
+          mem_usage +=
+            zix_ring_capacity (port->audio_ring);
+        }
+      if (port->midi_ring)
+        {
+          mem_usage +=
+            zix_ring_capacity (port->midi_ring);
+        }
+    }
+
+  return mem_usage;
+}
+
+/**
+ * Returns the approximate amount of memory used
+ * by the plugin, its ports and its saved state,
+ * in bytes.
+ *
+ * Used for keeping track of the memory used by
+ * the undo history.
+ */
+size_t
+plugin_get_mem_usage (
+  Plugin * self)
+{
+  g_return_val_if_fail (IS_PLUGIN (self), 0);
+
+  size_t mem_usage = sizeof (Plugin);
+  if (self->descr)
+    {
+      mem_usage += sizeof (PluginDescriptor);
+    }
+  mem_usage +=
+    get_ports_mem_usage (
+      self->in_ports, self->num_in_ports);
+  mem_usage +=
+    get_ports_mem_usage (
+      self->out_ports, self->num_out_ports);
+  for (int i = 0; i < self->num_banks; i++)
+    {
+      mem_usage +=
+        sizeof (PluginBank) +
+        (size_t) self->banks[i]->num_presets *
+          sizeof (PluginPreset);
+    }
+  if (self->lv2)
+    {
+      mem_usage +=
+        sizeof (Lv2Plugin) +
+        (size_t) self->lv2->num_ports *
+          sizeof (Lv2Port);
+    }
+  if (self->carla)
+    {
+      mem_usage += sizeof (CarlaNativePlugin);
+    }
+
+  /* the plugin's state lives in the plugin
+   * instance, so use the size of its last saved
+   * state as an estimate */
+  mem_usage += self->state_size;
+
+  return mem_usage;
+}
+
 /**
  * Frees given plugin, frees its ports
  * and other internal pointers
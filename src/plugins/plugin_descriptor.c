@@ -74,6 +74,7 @@ plugin_descriptor_copy (
   dest->open_with_carla = src->open_with_carla;
   dest->bridge_mode = src->bridge_mode;
   dest->ghash = src->ghash;
+  dest->mtime = src->mtime;
 }
 
 /**
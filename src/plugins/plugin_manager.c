@@ -50,6 +50,7 @@
 #include "plugins/lv2_plugin.h"
 #include "settings/settings.h"
 #include "utils/arrays.h"
+#include "utils/audio.h"
 #include "utils/flags.h"
 #include "utils/io.h"
 #include "utils/objects.h"
@@ -798,7 +799,261 @@ plugin_manager_supports_protocol (
   return false;
 }
 
+/**
+ * Returns the latest modification time of the
+ * files of the LV2 plugin's bundle, so that
+ * updated bundles are scanned again.
+ */
+static int64_t
+get_lv2_bundle_mtime (
+  const LilvPlugin * p)
+{
+  int64_t mtime = -1;
+
+  const LilvNodes * data_uris =
+    lilv_plugin_get_data_uris (p);
+  LILV_FOREACH (nodes, i, data_uris)
+    {
+      const LilvNode * node =
+        lilv_nodes_get (data_uris, i);
+      char * path =
+        lilv_file_uri_parse (
+          lilv_node_as_uri (node), NULL);
+      if (path)
+        {
+          mtime =
+            MAX (
+              mtime,
+              io_file_get_last_modified_time (path));
+          lilv_free (path);
+        }
+    }
+
+  /* if the library is missing, treat the bundle
+   * as changed so that it gets validated again */
+  const LilvNode * lib_uri =
+    lilv_plugin_get_library_uri (p);
+  if (!lib_uri)
+    return -1;
+  char * path =
+    lilv_file_uri_parse (
+      lilv_node_as_uri (lib_uri), NULL);
+  if (!path)
+    return -1;
+  int64_t lib_mtime =
+    io_file_get_last_modified_time (path);
+  lilv_free (path);
+  if (lib_mtime < 0)
+    return -1;
+
+  return MAX (mtime, lib_mtime);
+}
+
 #ifdef HAVE_CARLA
+/**
+ * A plugin file to be scanned with carla
+ * discovery.
+ */
+typedef struct CarlaDiscoveryJob
+{
+  char *              path;
+  PluginProtocol      protocol;
+
+  /** Result (NULL-terminated array). */
+  PluginDescriptor ** descriptors;
+} CarlaDiscoveryJob;
+
+/**
+ * Runs carla discovery for the job.
+ *
+ * Called by the worker threads in
+ * scan_carla_descriptors_from_paths(). Each
+ * discovery runs in a separate process.
+ */
+static void
+run_carla_discovery_job (
+  CarlaDiscoveryJob * job,
+  GAsyncQueue *       finished_jobs)
+{
+  job->descriptors =
+    z_carla_discovery_create_descriptors_from_file (
+      job->path, ARCH_64, job->protocol);
+
+  /* try 32-bit if above failed */
+  if (!job->descriptors)
+    {
+      g_debug (
+        "no descriptors for %s, trying 32bit...",
+        job->path);
+      job->descriptors =
+        z_carla_discovery_create_descriptors_from_file (
+          job->path, ARCH_32, job->protocol);
+    }
+
+  g_async_queue_push (finished_jobs, job);
+}
+
+/**
+ * Creates a descriptor for the given SFZ/SF2 file.
+ *
+ * @return A NULL-terminated array with the
+ *   descriptor, or NULL if failed.
+ */
+static PluginDescriptor **
+create_sf_descriptors (
+  const char *   plugin_path,
+  PluginProtocol protocol)
+{
+  char * parent_path =
+    io_path_get_parent_dir (plugin_path);
+  if (!parent_path)
+    {
+      g_warning (
+        "Failed to get parent dir of %s",
+        plugin_path);
+      return NULL;
+    }
+
+  PluginDescriptor ** descriptors =
+    calloc (2, sizeof (PluginDescriptor *));
+  descriptors[0] =
+    calloc (1, sizeof (PluginDescriptor));
+  PluginDescriptor * descr = descriptors[0];
+  descr->path = g_strdup (plugin_path);
+  GFile * file =
+    g_file_new_for_path (descr->path);
+  descr->ghash = g_file_hash (file);
+  g_object_unref (file);
+  descr->mtime =
+    io_file_get_last_modified_time (plugin_path);
+  descr->category = PC_INSTRUMENT;
+  descr->category_str =
+    plugin_descriptor_category_to_string (
+      descr->category);
+  descr->name =
+    io_path_get_basename_without_ext (
+      plugin_path);
+  descr->author =
+    g_path_get_basename (parent_path);
+  g_free (parent_path);
+  descr->num_audio_outs = 2;
+  descr->num_midi_ins = 1;
+  descr->arch = ARCH_64;
+  descr->protocol = protocol;
+  descr->open_with_carla = true;
+  descr->bridge_mode =
+    z_carla_discovery_get_bridge_mode (descr);
+
+  return descriptors;
+}
+
+static void
+update_carla_scan_progress (
+  PluginProtocol            protocol,
+  const char *              plugin_path,
+  PluginDescriptor * const * descriptors,
+  unsigned int *            count,
+  const double              size,
+  double *                  progress,
+  const double              start_progress,
+  const double              max_progress)
+{
+  (*count)++;
+
+  if (!progress)
+    return;
+
+  *progress =
+    start_progress +
+    ((double) *count / size) *
+      (max_progress - start_progress);
+  const char * protocol_str =
+    plugin_protocol_to_str (protocol);
+  char prog_str[800];
+  if (descriptors && descriptors[0])
+    {
+      sprintf (
+        prog_str,
+        _("Scanned %s plugin: %s"),
+        protocol_str,
+        descriptors[0]->name);
+    }
+  else
+    {
+      sprintf (
+        prog_str,
+        /* TRANSLATORS: first argument
+         * is plugin protocol, 2nd
+         * argument is path */
+        _("Skipped %1$s plugin at "
+        "%2$s"),
+        protocol_str,
+        plugin_path);
+    }
+  zrythm_app_set_progress_status (
+    zrythm_app, prog_str, *progress);
+}
+
+/**
+ * Adds the newly scanned descriptors to the
+ * plugin list and the cache, or blacklists the
+ * plugin if none were found.
+ */
+static void
+add_scanned_carla_descriptors (
+  PluginManager *     self,
+  PluginProtocol      protocol,
+  const char *        plugin_path,
+  PluginDescriptor ** descriptors)
+{
+  const char * protocol_str =
+    plugin_protocol_to_str (protocol);
+
+  g_debug (
+    "descriptors for %s: %p",
+    plugin_path, descriptors);
+
+  if (!descriptors)
+    {
+      g_message (
+        "Blacklisting %s %s",
+        protocol_str, plugin_path);
+      cached_plugin_descriptors_blacklist (
+        self->cached_plugin_descriptors,
+        plugin_path, 0);
+      return;
+    }
+
+  PluginDescriptor * descriptor = NULL;
+  int i = 0;
+  while ((descriptor = descriptors[i++]))
+    {
+      array_append (
+        self->plugin_descriptors,
+        self->num_plugins, descriptor);
+      add_category (
+        self, descriptor->category_str);
+      g_message (
+        "Caching %s %s",
+        protocol_str, descriptor->name);
+
+      cached_plugin_descriptors_replace (
+        self->cached_plugin_descriptors,
+        descriptor, F_NO_SERIALIZE);
+    }
+  g_debug (
+    "%d descriptors cached for %s",
+    i - 1, plugin_path);
+}
+
+/**
+ * Scans the plugins of the given protocol.
+ *
+ * Plugins that are cached and did not change since
+ * they were cached are not scanned again. The rest
+ * are scanned with carla discovery in parallel,
+ * using one worker thread per CPU core.
+ */
 static void
 scan_carla_descriptors_from_paths (
   PluginManager * self,
@@ -862,6 +1117,10 @@ scan_carla_descriptors_from_paths (
     }
   g_return_if_fail (paths && suffix);
 
+  /* plugins that need to be scanned with carla
+   * discovery */
+  GPtrArray * jobs = g_ptr_array_new ();
+
   int path_idx = 0;
   char * path;
   while ((path = paths[path_idx++]) != NULL)
@@ -913,177 +1172,120 @@ scan_carla_descriptors_from_paths (
                 }
             }
           /* if no cached descriptors found */
+          else if (
+            cached_plugin_descriptors_is_blacklisted (
+              self->cached_plugin_descriptors,
+              plugin_path))
+            {
+              g_message (
+                "Ignoring blacklisted %s "
+                "plugin: %s",
+                protocol_str, plugin_path);
+            }
+          else if (protocol == PROT_SFZ ||
+                   protocol == PROT_SF2)
+            {
+              descriptors =
+                create_sf_descriptors (
+                  plugin_path, protocol);
+              add_scanned_carla_descriptors (
+                self, protocol, plugin_path,
+                descriptors);
+            }
           else
             {
-              if (
-                cached_plugin_descriptors_is_blacklisted (
-                  self->cached_plugin_descriptors,
-                  plugin_path))
-                {
-                  g_message (
-                    "Ignoring blacklisted %s "
-                    "plugin: %s",
-                    protocol_str, plugin_path);
-                }
-              else
-                {
-                  if (protocol == PROT_SFZ ||
-                      protocol == PROT_SF2)
-                    {
-                      descriptors =
-                        calloc (
-                          2, sizeof (PluginDescriptor *));
-                      descriptors[0] =
-                        calloc (
-                          1, sizeof (PluginDescriptor));
-                      PluginDescriptor * descr =
-                        descriptors[0];
-                      descr->path = g_strdup (plugin_path);
-                      GFile * file =
-                        g_file_new_for_path (descr->path);
-                      descr->ghash = g_file_hash (file);
-                      g_object_unref (file);
-                      descr->category = PC_INSTRUMENT;
-                      descr->category_str =
-                        plugin_descriptor_category_to_string (
-                          descr->category);
-                      descr->name =
-                        io_path_get_basename_without_ext (
-                          plugin_path);
-                      char * parent_path =
-                        io_path_get_parent_dir (plugin_path);
-                      if (!parent_path)
-                        {
-                          g_warning (
-                            "Failed to get parent dir of "
-                            "%s", plugin_path);
-                          plugin_descriptor_free (descr);
-                          descriptors[0] = NULL;
-                          continue;
-                        }
-                      descr->author =
-                        g_path_get_basename (parent_path);
-                      g_free (parent_path);
-                      descr->num_audio_outs = 2;
-                      descr->num_midi_ins = 1;
-                      descr->arch = ARCH_64;
-                      descr->protocol = protocol;
-                      descr->open_with_carla = true;
-                      descr->bridge_mode =
-                        z_carla_discovery_get_bridge_mode (
-                          descr);
-                    }
-                  else
-                    {
-                      descriptors =
-                        z_carla_discovery_create_descriptors_from_file (
-                          plugin_path, ARCH_64,
-                          protocol);
-
-                      /* try 32-bit if above failed */
-                      if (!descriptors)
-                        {
-                          g_debug (
-                            "no descriptors for %s, "
-                            "trying 32bit...",
-                            plugin_path);
-                          descriptors =
-                            z_carla_discovery_create_descriptors_from_file (
-                              plugin_path, ARCH_32,
-                              protocol);
-                        }
-                    }
-
-                  g_debug (
-                    "descriptors for %s: %p",
-                    plugin_path, descriptors);
-
-                  if (descriptors)
-                    {
-                      PluginDescriptor * descriptor = NULL;
-                      int i = 0;
-                      while ((descriptor = descriptors[i++]))
-                        {
-                          array_append (
-                            self->plugin_descriptors,
-                            self->num_plugins,
-                            descriptor);
-                          add_category (
-                            self, descriptor->category_str);
-                          g_message (
-                            "Caching %s %s",
-                            protocol_str,
-                            descriptor->name);
-
-                          PluginDescriptor * clone =
-                            plugin_descriptor_clone (
-                              descriptor);
-                          cached_plugin_descriptors_add (
-                            self->cached_plugin_descriptors,
-                            clone, 0);
-                        }
-                      g_debug (
-                        "%d descriptors cached for "
-                        "%s",
-                        i - 1, plugin_path);
-                    }
-                  else
-                    {
-                      g_message (
-                        "Blacklisting %s %s",
-                        protocol_str,
-                        plugin_path);
-                      cached_plugin_descriptors_blacklist (
-                        self->cached_plugin_descriptors,
-                        plugin_path, 0);
-                    }
-                }
+              /* scan later */
+              CarlaDiscoveryJob * job =
+                object_new (CarlaDiscoveryJob);
+              job->path = g_strdup (plugin_path);
+              job->protocol = protocol;
+              g_ptr_array_add (jobs, job);
+              continue;
             }
-          (*count)++;
 
-          if (progress)
-            {
-              *progress =
-                start_progress +
-                ((double) *count / size) *
-                  (max_progress - start_progress);
-              char prog_str[800];
-              if (descriptors)
-                {
-                  sprintf (
-                    prog_str,
-                    _("Scanned %s plugin: %s"),
-                    protocol_str,
-                    descriptors[0]->name);
+          update_carla_scan_progress (
+            protocol, plugin_path, descriptors,
+            count, size, progress, start_progress,
+            max_progress);
+          free (descriptors);
+        }
+      g_strfreev (plugins);
+    }
+  g_strfreev (paths);
 
-                  free (descriptors);
-                  descriptors = NULL;
-                }
-              else
-                {
-                  sprintf (
-                    prog_str,
-                    /* TRANSLATORS: first argument
-                     * is plugin protocol, 2nd
-                     * argument is path */
-                    _("Skipped %1$s plugin at "
-                    "%2$s"),
-                    protocol_str,
-                    plugin_path);
-                }
-              zrythm_app_set_progress_status (
-                zrythm_app, prog_str, *progress);
+  if (jobs->len > 0)
+    {
+      g_message (
+        "Scanning %u new or changed %s plugins...",
+        jobs->len, protocol_str);
+
+      GAsyncQueue * finished_jobs =
+        g_async_queue_new ();
+      GError * err = NULL;
+      GThreadPool * pool =
+        g_thread_pool_new (
+          (GFunc) run_carla_discovery_job,
+          finished_jobs,
+          MAX (audio_get_num_cores (), 1),
+          F_EXCLUSIVE, &err);
+      if (!pool)
+        {
+          g_warning (
+            "Failed to create thread pool: %s",
+            err->message);
+          g_error_free (err);
+        }
+      for (guint i = 0; i < jobs->len; i++)
+        {
+          CarlaDiscoveryJob * job =
+            g_ptr_array_index (jobs, i);
+          if (pool)
+            {
+              g_thread_pool_push (pool, job, NULL);
+            }
+          else
+            {
+              run_carla_discovery_job (
+                job, finished_jobs);
             }
         }
-      if (plugin_idx > 0 &&
-          !ZRYTHM_TESTING)
+
+      /* update the progress as the jobs finish */
+      for (guint i = 0; i < jobs->len; i++)
         {
-          cached_plugin_descriptors_serialize_to_file (
-            self->cached_plugin_descriptors);
+          CarlaDiscoveryJob * job =
+            g_async_queue_pop (finished_jobs);
+          update_carla_scan_progress (
+            protocol, job->path, job->descriptors,
+            count, size, progress, start_progress,
+            max_progress);
+        }
+      if (pool)
+        {
+          g_thread_pool_free (pool, false, true);
+        }
+      g_async_queue_unref (finished_jobs);
+
+      /* add the results in scan order */
+      for (guint i = 0; i < jobs->len; i++)
+        {
+          CarlaDiscoveryJob * job =
+            g_ptr_array_index (jobs, i);
+          add_scanned_carla_descriptors (
+            self, protocol, job->path,
+            job->descriptors);
+          free (job->descriptors);
+          g_free (job->path);
+          free (job);
         }
-      g_strfreev (plugins);
     }
-  g_strfreev (paths);
+  g_ptr_array_free (jobs, true);
+
+  if (!ZRYTHM_TESTING)
+    {
+      cached_plugin_descriptors_serialize_to_file (
+        self->cached_plugin_descriptors);
+    }
 }
 #endif
 
@@ -1139,45 +1341,46 @@ plugin_manager_scan_plugins (
     {
       const LilvPlugin* p =
         lilv_plugins_get (lilv_plugins, i);
+      const char * uri_str =
+        lilv_node_as_string (
+          lilv_plugin_get_uri (p));
+      int64_t mtime = get_lv2_bundle_mtime (p);
 
-      PluginDescriptor * descriptor =
-        lv2_plugin_create_descriptor_from_lilv (p);
-
-      if (descriptor)
-        {
+      const PluginDescriptor * found_descr =
+        cached_plugin_descriptors_get_lv2 (
+          self->cached_plugin_descriptors,
+          uri_str, mtime);
 
-          const PluginDescriptor * found_descr =
-            cached_plugin_descriptors_find (
-              self->cached_plugin_descriptors,
-              descriptor, F_CHECK_VALID,
-              F_CHECK_BLACKLISTED);
+      PluginDescriptor * descriptor = NULL;
 
-          /* if cached descriptor found, use it */
-          if (found_descr)
+      /* if cached descriptor found, use it */
+      if (found_descr)
+        {
+          descriptor =
+            plugin_descriptor_clone (found_descr);
+          self->plugin_descriptors[
+            self->num_plugins++] = descriptor;
+          add_category (
+            self, descriptor->category_str);
+        }
+      else
+        {
+          descriptor =
+            lv2_plugin_create_descriptor_from_lilv (
+              p);
+          if (descriptor)
             {
-              self->plugin_descriptors[
-                self->num_plugins++] =
-                  plugin_descriptor_clone (
-                    found_descr);;
-              add_category (
-                self, found_descr->category_str);
+              descriptor->mtime = mtime;
 
-              plugin_descriptor_free (
-                descriptor);
-              descriptor =
-                self->plugin_descriptors[
-                  self->num_plugins - 1];
-            }
-          else
-            {
               /* add descriptor to list */
               self->plugin_descriptors[
                 self->num_plugins++] = descriptor;
               add_category (
                 self, descriptor->category_str);
 
-              /* add descriptor to cached */
-              cached_plugin_descriptors_add (
+              /* add descriptor to cached, replacing
+               * any outdated descriptor */
+              cached_plugin_descriptors_replace (
                 self->cached_plugin_descriptors,
                 descriptor, F_NO_SERIALIZE);
             }
@@ -1201,10 +1404,6 @@ plugin_manager_scan_plugins (
             }
           else
             {
-              const LilvNode*  lv2_uri =
-                lilv_plugin_get_uri (p);
-              const char * uri_str =
-                lilv_node_as_string (lv2_uri);
               sprintf (
                 prog_str,
                 _("Skipped LV2 plugin at %s"),
@@ -73,6 +73,7 @@
 #include "plugins/lv2/lv2_state.h"
 #include "settings/settings.h"
 #include "utils/arrays.h"
+#include "utils/binary.h"
 #include "utils/datetime.h"
 #include "utils/general.h"
 #include "utils/file.h"
@@ -970,6 +971,33 @@ load (
   g_message (
     "%s: loading project file %s",
     __func__, project_file_path);
+
+  Project * self = NULL;
+  if (binary_file_is_binary (project_file_path))
+    {
+      gint64 time_before = g_get_monotonic_time ();
+      char * error_msg =
+        binary_load_from_file (
+          project_file_path, &project_schema,
+          (void **) &self);
+      g_message (
+        "time to deserialize: %ldms",
+        (long)
+        (g_get_monotonic_time () - time_before) /
+          1000);
+      if (error_msg)
+        {
+          g_warning (
+            "Failed to load project file: %s",
+            error_msg);
+          ui_show_error_message (
+            MAIN_WINDOW, error_msg);
+          g_free (error_msg);
+          return -1;
+        }
+      goto deserialized;
+    }
+
   g_file_get_contents (
     project_file_path, &compressed_pj,
     &compressed_pj_size, &err);
@@ -1015,13 +1043,15 @@ load (
       yaml_size + sizeof (char));
   yaml[yaml_size] = '\0';
 
-  Project * self = project_deserialize (yaml);
+  self = project_deserialize (yaml);
   free (yaml);
   if (!self)
     {
       g_warning ("Failed to load project");
       return -1;
     }
+
+deserialized:
   self->backup_dir =
     g_strdup (PROJECT->backup_dir);
 
@@ -1411,6 +1441,10 @@ project_get_path (
       return
         g_build_filename (
           self->dir, PROJECT_POOL_DIR, NULL);
+    case PROJECT_PATH_POOL_CACHE:
+      return
+        g_build_filename (
+          self->dir, PROJECT_POOL_CACHE_DIR, NULL);
     case PROJECT_PATH_PROJECT_FILE:
       if (backup)
         {
@@ -1471,6 +1505,9 @@ typedef struct ProjectSaveData
 
   bool      is_backup;
 
+  /** Format to save in. */
+  ProjectFileFormat format;
+
   /** To be set to true when the thread finishes. */
   bool      finished;
 
@@ -1502,11 +1539,42 @@ serialize_project_thread (
   char * compressed_yaml;
   char * error_msg;
   size_t compressed_size;
+  GError *err = NULL;
+  gint64 time_before = g_get_monotonic_time ();
+
+  if (data->format == PROJECT_FILE_FORMAT_BINARY)
+    {
+      g_message (
+        "%s: saving binary project file at %s...",
+        __func__, data->project_file_path);
+      error_msg =
+        binary_save_to_file (
+          data->project_file_path,
+          &project_schema, &data->project);
+      g_message (
+        "time to serialize: %ldms",
+        (long)
+        (g_get_monotonic_time () - time_before) /
+          1000);
+      if (error_msg)
+        {
+          g_critical (
+            "Failed to save project file: %s",
+            error_msg);
+          ui_show_error_message (
+            MAIN_WINDOW, error_msg);
+          g_free (error_msg);
+          data->has_error = true;
+          goto serialize_end;
+        }
+
+      g_message (
+        "%s: successfully saved project", __func__);
+      goto serialize_end;
+    }
 
   /* generate yaml */
   g_message ("serializing project to yaml...");
-  GError *err = NULL;
-  gint64 time_before = g_get_monotonic_time ();
   char * yaml = project_serialize (&data->project);
   gint64 time_after = g_get_monotonic_time ();
   g_message (
@@ -1819,6 +1887,12 @@ project_save (
       self, PROJECT_PATH_PROJECT_FILE, is_backup);
   data->show_notification = show_notification;
   data->is_backup = is_backup;
+  data->format =
+    ZRYTHM_TESTING ?
+      PROJECT_FILE_FORMAT_BINARY :
+      (ProjectFileFormat)
+      g_settings_get_enum (
+        S_P_PROJECTS_GENERAL, "file-format");
   memcpy (
     &data->project, PROJECT, sizeof (Project));
   if (async)
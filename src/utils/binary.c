@@ -0,0 +1,1190 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * File layout:
+ *
+ * - @ref BINARY_MAGIC (4 bytes)
+ * - @ref BINARY_FORMAT_VERSION (4 bytes, little
+ *   endian)
+ * - zstd stream with the root value
+ *
+ * Values are encoded as a @ref BinaryTag byte
+ * followed by:
+ *
+ * - INT: zigzag LEB128 varint
+ * - UINT: LEB128 varint
+ * - BOOL: 1 byte
+ * - FLOAT/DOUBLE: 4/8 bytes, little endian
+ * - STRING: varint length + bytes
+ * - ENUM: symbol
+ * - MAPPING: varint count + (symbol key, value)
+ *   pairs
+ * - SEQUENCE: varint count + values
+ *
+ * Symbols are encoded as a varint index into the
+ * symbols seen so far. The first occurrence of a
+ * symbol has the next free index and is followed by
+ * its length and bytes.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/binary.h"
+#include "utils/io.h"
+
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include <zstd.h>
+
+typedef struct BinaryWriter
+{
+  FILE *         file;
+  ZSTD_CStream * cstream;
+
+  /** Uncompressed chunk. */
+  uint8_t *      buf;
+  size_t         len;
+
+  /** Compressed output. */
+  uint8_t *      out_buf;
+  size_t         out_size;
+
+  /** Symbol string -> index + 1. */
+  GHashTable *   syms;
+  unsigned int   num_syms;
+
+  char *         error;
+} BinaryWriter;
+
+typedef struct BinaryReader
+{
+  FILE *         file;
+  ZSTD_DStream * dstream;
+
+  /** Compressed input. */
+  uint8_t *      in_buf;
+  size_t         in_size;
+  size_t         in_len;
+  size_t         in_pos;
+
+  /** Decompressed chunk. */
+  uint8_t *      buf;
+  size_t         len;
+  size_t         pos;
+
+  /** Symbols seen so far. */
+  GPtrArray *    syms;
+
+  /**
+   * Mapping fields -> GArray of field indices by
+   * symbol index (-1 if the symbol is not a field,
+   * -2 if not looked up yet).
+   */
+  GHashTable *   field_maps;
+
+  char *         error;
+} BinaryReader;
+
+#define SET_ERROR(x,...) \
+  if (!(x)->error) \
+    { \
+      (x)->error = g_strdup_printf (__VA_ARGS__); \
+    }
+
+/* ---- writer ---- */
+
+static void
+writer_flush (
+  BinaryWriter * w,
+  bool           end)
+{
+  ZSTD_inBuffer input = { w->buf, w->len, 0 };
+  bool finished = false;
+  while (!w->error &&
+         (input.pos < input.size ||
+          (end && !finished)))
+    {
+      ZSTD_outBuffer output = {
+        w->out_buf, w->out_size, 0 };
+      size_t ret;
+      if (input.pos < input.size)
+        {
+          ret =
+            ZSTD_compressStream (
+              w->cstream, &output, &input);
+        }
+      else
+        {
+          ret =
+            ZSTD_endStream (w->cstream, &output);
+          finished = ret == 0;
+        }
+      if (ZSTD_isError (ret))
+        {
+          SET_ERROR (
+            w, "Failed to compress: %s",
+            ZSTD_getErrorName (ret));
+          break;
+        }
+      if (output.pos > 0 &&
+          fwrite (
+            w->out_buf, 1, output.pos, w->file) !=
+              output.pos)
+        {
+          SET_ERROR (w, "%s", _("Failed to write file"));
+        }
+    }
+  w->len = 0;
+}
+
+static inline void
+write_bytes (
+  BinaryWriter * w,
+  const void *   src,
+  size_t         size)
+{
+  const uint8_t * bytes = (const uint8_t *) src;
+  while (size > 0)
+    {
+      size_t len =
+        MIN (size, BINARY_CHUNK_SIZE - w->len);
+      memcpy (&w->buf[w->len], bytes, len);
+      w->len += len;
+      bytes += len;
+      size -= len;
+      if (w->len == BINARY_CHUNK_SIZE)
+        writer_flush (w, false);
+    }
+}
+
+static inline void
+write_byte (
+  BinaryWriter * w,
+  uint8_t        byte)
+{
+  if (w->len == BINARY_CHUNK_SIZE)
+    writer_flush (w, false);
+  w->buf[w->len++] = byte;
+}
+
+static inline void
+write_varint (
+  BinaryWriter * w,
+  uint64_t       val)
+{
+  while (val >= 0x80)
+    {
+      write_byte (w, (uint8_t) (val | 0x80));
+      val >>= 7;
+    }
+  write_byte (w, (uint8_t) val);
+}
+
+static void
+write_sym (
+  BinaryWriter * w,
+  const char *   str)
+{
+  unsigned int idx =
+    GPOINTER_TO_UINT (
+      g_hash_table_lookup (w->syms, str));
+  if (idx > 0)
+    {
+      write_varint (w, idx - 1);
+      return;
+    }
+
+  g_hash_table_insert (
+    w->syms, (char *) str,
+    GUINT_TO_POINTER (++w->num_syms));
+  size_t len = strlen (str);
+  write_varint (w, w->num_syms - 1);
+  write_varint (w, len);
+  write_bytes (w, str, len);
+}
+
+static int64_t
+get_int (
+  const void * data,
+  uint32_t     size)
+{
+  switch (size)
+    {
+    case 1: return *(const int8_t *) data;
+    case 2: return *(const int16_t *) data;
+    case 4: return *(const int32_t *) data;
+    case 8: return *(const int64_t *) data;
+    default: g_return_val_if_reached (0);
+    }
+}
+
+static uint64_t
+get_uint (
+  const void * data,
+  uint32_t     size)
+{
+  switch (size)
+    {
+    case 1: return *(const uint8_t *) data;
+    case 2: return *(const uint16_t *) data;
+    case 4: return *(const uint32_t *) data;
+    case 8: return *(const uint64_t *) data;
+    default: g_return_val_if_reached (0);
+    }
+}
+
+static void
+set_uint (
+  void *   data,
+  uint32_t size,
+  uint64_t val)
+{
+  switch (size)
+    {
+    case 1: *(uint8_t *) data = (uint8_t) val; break;
+    case 2: *(uint16_t *) data = (uint16_t) val; break;
+    case 4: *(uint32_t *) data = (uint32_t) val; break;
+    case 8: *(uint64_t *) data = val; break;
+    default: g_return_if_reached ();
+    }
+}
+
+/**
+ * Returns the size of each element in a sequence.
+ */
+static inline size_t
+get_entry_stride (
+  const cyaml_schema_value_t * entry)
+{
+  return
+    entry->flags & CYAML_FLAG_POINTER ?
+      sizeof (void *) : entry->data_size;
+}
+
+static void
+write_value (
+  BinaryWriter *               w,
+  const cyaml_schema_value_t * schema,
+  const void *                 storage);
+
+static void
+write_field (
+  BinaryWriter *               w,
+  const cyaml_schema_field_t * field,
+  const uint8_t *              base)
+{
+  const cyaml_schema_value_t * value =
+    &field->value;
+  if (value->type != CYAML_SEQUENCE &&
+      value->type != CYAML_SEQUENCE_FIXED)
+    {
+      write_value (
+        w, value, base + field->data_offset);
+      return;
+    }
+
+  const uint8_t * arr = base + field->data_offset;
+  if (value->flags & CYAML_FLAG_POINTER)
+    {
+      arr = *(const uint8_t * const *) arr;
+    }
+  uint64_t count =
+    value->type == CYAML_SEQUENCE_FIXED ?
+      value->sequence.max :
+      get_uint (
+        base + field->count_offset,
+        field->count_size);
+  if (!arr)
+    {
+      write_byte (w, BINARY_TAG_NULL);
+      return;
+    }
+
+  const cyaml_schema_value_t * entry =
+    value->sequence.entry;
+  size_t stride = get_entry_stride (entry);
+  write_byte (w, BINARY_TAG_SEQUENCE);
+  write_varint (w, count);
+  for (uint64_t i = 0; i < count; i++)
+    {
+      write_value (w, entry, arr + i * stride);
+    }
+}
+
+/**
+ * Writes the value at the given storage location.
+ *
+ * For pointer values, @p storage is the location of
+ * the pointer.
+ */
+static void
+write_value (
+  BinaryWriter *               w,
+  const cyaml_schema_value_t * schema,
+  const void *                 storage)
+{
+  const uint8_t * data = storage;
+  if (schema->flags & CYAML_FLAG_POINTER)
+    {
+      data = *(const uint8_t * const *) storage;
+      if (!data)
+        {
+          write_byte (w, BINARY_TAG_NULL);
+          return;
+        }
+    }
+
+  switch (schema->type)
+    {
+    case CYAML_INT:
+      {
+        int64_t val =
+          get_int (data, schema->data_size);
+        write_byte (w, BINARY_TAG_INT);
+        write_varint (
+          w,
+          ((uint64_t) val << 1) ^
+            (uint64_t) (val >> 63));
+      }
+      break;
+    case CYAML_UINT:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+      write_byte (w, BINARY_TAG_UINT);
+      write_varint (
+        w, get_uint (data, schema->data_size));
+      break;
+    case CYAML_BOOL:
+      write_byte (w, BINARY_TAG_BOOL);
+      write_byte (
+        w,
+        get_uint (data, schema->data_size) != 0);
+      break;
+    case CYAML_ENUM:
+      {
+        int64_t val =
+          get_int (data, schema->data_size);
+        for (uint32_t i = 0;
+             i < schema->enumeration.count; i++)
+          {
+            if (schema->enumeration.strings[i].val ==
+                  val)
+              {
+                write_byte (w, BINARY_TAG_ENUM);
+                write_sym (
+                  w,
+                  schema->enumeration.strings[i].str);
+                return;
+              }
+          }
+        /* not a named value, store the number */
+        write_byte (w, BINARY_TAG_INT);
+        write_varint (
+          w,
+          ((uint64_t) val << 1) ^
+            (uint64_t) (val >> 63));
+      }
+      break;
+    case CYAML_FLOAT:
+      if (schema->data_size == sizeof (float))
+        {
+          write_byte (w, BINARY_TAG_FLOAT);
+          guint32 val;
+          memcpy (&val, data, sizeof (val));
+          val = GUINT32_TO_LE (val);
+          write_bytes (w, &val, sizeof (val));
+        }
+      else
+        {
+          write_byte (w, BINARY_TAG_DOUBLE);
+          guint64 val;
+          memcpy (&val, data, sizeof (val));
+          val = GUINT64_TO_LE (val);
+          write_bytes (w, &val, sizeof (val));
+        }
+      break;
+    case CYAML_STRING:
+      {
+        const char * str = (const char *) data;
+        size_t len = strlen (str);
+        write_byte (w, BINARY_TAG_STRING);
+        write_varint (w, len);
+        write_bytes (w, str, len);
+      }
+      break;
+    case CYAML_MAPPING:
+      {
+        const cyaml_schema_field_t * fields =
+          schema->mapping.fields;
+        uint64_t count = 0;
+        for (const cyaml_schema_field_t * field =
+               fields;
+             field->key; field++)
+          {
+            if (field->value.type != CYAML_IGNORE)
+              count++;
+          }
+        write_byte (w, BINARY_TAG_MAPPING);
+        write_varint (w, count);
+        for (const cyaml_schema_field_t * field =
+               fields;
+             field->key; field++)
+          {
+            if (field->value.type == CYAML_IGNORE)
+              continue;
+            write_sym (w, field->key);
+            write_field (w, field, data);
+          }
+      }
+      break;
+    default:
+      g_warning (
+        "unsupported schema type %d",
+        schema->type);
+      write_byte (w, BINARY_TAG_NULL);
+      break;
+    }
+}
+
+/**
+ * Serializes the given data using its cyaml
+ * schema and writes it to a zstd-compressed file
+ * in chunks of @ref BINARY_CHUNK_SIZE.
+ *
+ * Mappings are written with their field keys, so
+ * files stay loadable when fields are added or
+ * removed. Keys and enum strings are only written
+ * in full the first time they appear and are
+ * referenced by index afterwards.
+ *
+ * @param data Pointer to the data, as would be
+ *   passed to cyaml_save_data().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+binary_save_to_file (
+  const char *                 filepath,
+  const cyaml_schema_value_t * schema,
+  const void *                 data)
+{
+  /* write to a temporary file first so that the
+   * previous file stays intact on failure */
+  char * tmp_path =
+    g_strdup_printf ("%s.tmp", filepath);
+  FILE * file = g_fopen (tmp_path, "wb");
+  if (!file)
+    {
+      char * err =
+        g_strdup_printf (
+          _("Failed to open file: %s"), tmp_path);
+      g_free (tmp_path);
+      return err;
+    }
+
+  BinaryWriter w;
+  memset (&w, 0, sizeof (w));
+  w.file = file;
+  w.cstream = ZSTD_createCStream ();
+  ZSTD_initCStream (w.cstream, 1);
+  w.buf = malloc (BINARY_CHUNK_SIZE);
+  w.out_size = ZSTD_CStreamOutSize ();
+  w.out_buf = malloc (w.out_size);
+  w.syms = g_hash_table_new (g_str_hash, g_str_equal);
+
+  /* header */
+  guint32 version =
+    GUINT32_TO_LE (BINARY_FORMAT_VERSION);
+  if (fwrite (BINARY_MAGIC, 1, 4, file) != 4 ||
+      fwrite (&version, 1, 4, file) != 4)
+    {
+      SET_ERROR (&w, "%s", _("Failed to write file"));
+    }
+
+  write_value (&w, schema, &data);
+  writer_flush (&w, true);
+
+  if (fclose (file) != 0)
+    {
+      SET_ERROR (&w, "%s", _("Failed to write file"));
+    }
+  if (!w.error &&
+      g_rename (tmp_path, filepath) != 0)
+    {
+      /* renaming over an existing file fails on
+       * some platforms */
+      io_remove (filepath);
+      if (g_rename (tmp_path, filepath) != 0)
+        {
+          SET_ERROR (
+            &w, _("Failed to move %s to %s"),
+            tmp_path, filepath);
+        }
+    }
+  if (w.error)
+    {
+      io_remove (tmp_path);
+    }
+
+  ZSTD_freeCStream (w.cstream);
+  free (w.buf);
+  free (w.out_buf);
+  g_hash_table_destroy (w.syms);
+  g_free (tmp_path);
+
+  return w.error;
+}
+
+/* ---- reader ---- */
+
+static bool
+reader_refill (
+  BinaryReader * r)
+{
+  r->len = 0;
+  r->pos = 0;
+  while (!r->error && r->len == 0)
+    {
+      if (r->in_pos == r->in_len)
+        {
+          r->in_len =
+            fread (r->in_buf, 1, r->in_size, r->file);
+          r->in_pos = 0;
+          if (r->in_len == 0)
+            {
+              SET_ERROR (
+                r, "%s", _("Unexpected end of file"));
+              return false;
+            }
+        }
+      ZSTD_inBuffer input = {
+        r->in_buf, r->in_len, r->in_pos };
+      ZSTD_outBuffer output = {
+        r->buf, BINARY_CHUNK_SIZE, 0 };
+      size_t ret =
+        ZSTD_decompressStream (
+          r->dstream, &output, &input);
+      if (ZSTD_isError (ret))
+        {
+          SET_ERROR (
+            r, _("Failed to decompress: %s"),
+            ZSTD_getErrorName (ret));
+          return false;
+        }
+      r->in_pos = input.pos;
+      r->len = output.pos;
+    }
+
+  return !r->error;
+}
+
+static inline bool
+read_bytes (
+  BinaryReader * r,
+  void *         dest,
+  size_t         size)
+{
+  uint8_t * bytes = (uint8_t *) dest;
+  while (size > 0)
+    {
+      if (r->pos == r->len && !reader_refill (r))
+        return false;
+      size_t len = MIN (size, r->len - r->pos);
+      if (bytes)
+        {
+          memcpy (bytes, &r->buf[r->pos], len);
+          bytes += len;
+        }
+      r->pos += len;
+      size -= len;
+    }
+
+  return true;
+}
+
+static inline uint8_t
+read_byte (
+  BinaryReader * r)
+{
+  if (r->pos == r->len && !reader_refill (r))
+    return 0;
+  return r->buf[r->pos++];
+}
+
+static inline uint64_t
+read_varint (
+  BinaryReader * r)
+{
+  uint64_t val = 0;
+  for (unsigned int shift = 0; shift < 64;
+       shift += 7)
+    {
+      uint8_t byte = read_byte (r);
+      val |= (uint64_t) (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return val;
+    }
+  SET_ERROR (r, "%s", _("Invalid varint"));
+  return 0;
+}
+
+static inline int64_t
+read_zigzag (
+  BinaryReader * r)
+{
+  uint64_t val = read_varint (r);
+  return (int64_t) (val >> 1) ^ -(int64_t) (val & 1);
+}
+
+/**
+ * Reads a symbol and returns its index, or -1 on
+ * error.
+ */
+static int
+read_sym (
+  BinaryReader * r)
+{
+  uint64_t idx = read_varint (r);
+  if (idx < r->syms->len)
+    return (int) idx;
+  if (idx > r->syms->len || r->error)
+    {
+      SET_ERROR (r, "%s", _("Invalid symbol"));
+      return -1;
+    }
+
+  uint64_t len = read_varint (r);
+  char * str = g_malloc (len + 1);
+  read_bytes (r, str, len);
+  str[len] = '\0';
+  g_ptr_array_add (r->syms, str);
+
+  return (int) idx;
+}
+
+static void
+skip_value (
+  BinaryReader * r,
+  uint8_t        tag)
+{
+  switch (tag)
+    {
+    case BINARY_TAG_NULL:
+      break;
+    case BINARY_TAG_INT:
+    case BINARY_TAG_UINT:
+      read_varint (r);
+      break;
+    case BINARY_TAG_BOOL:
+      read_byte (r);
+      break;
+    case BINARY_TAG_FLOAT:
+      read_bytes (r, NULL, 4);
+      break;
+    case BINARY_TAG_DOUBLE:
+      read_bytes (r, NULL, 8);
+      break;
+    case BINARY_TAG_STRING:
+      read_bytes (r, NULL, read_varint (r));
+      break;
+    case BINARY_TAG_ENUM:
+      read_sym (r);
+      break;
+    case BINARY_TAG_MAPPING:
+      {
+        uint64_t count = read_varint (r);
+        for (uint64_t i = 0;
+             i < count && !r->error; i++)
+          {
+            read_sym (r);
+            skip_value (r, read_byte (r));
+          }
+      }
+      break;
+    case BINARY_TAG_SEQUENCE:
+      {
+        uint64_t count = read_varint (r);
+        for (uint64_t i = 0;
+             i < count && !r->error; i++)
+          {
+            skip_value (r, read_byte (r));
+          }
+      }
+      break;
+    default:
+      SET_ERROR (
+        r, _("Invalid value tag %u"), tag);
+      break;
+    }
+}
+
+/**
+ * Returns the field of the mapping with the key
+ * of the given symbol, or NULL if not found.
+ */
+static const cyaml_schema_field_t *
+get_field (
+  BinaryReader *               r,
+  const cyaml_schema_field_t * fields,
+  int                          sym)
+{
+  GArray * map =
+    g_hash_table_lookup (r->field_maps, fields);
+  if (!map)
+    {
+      map =
+        g_array_new (false, false, sizeof (int));
+      g_hash_table_insert (
+        r->field_maps, (gpointer) fields, map);
+    }
+  while (map->len <= (guint) sym)
+    {
+      int not_looked_up = -2;
+      g_array_append_val (map, not_looked_up);
+    }
+
+  int * idx = &g_array_index (map, int, sym);
+  if (*idx == -2)
+    {
+      const char * key =
+        g_ptr_array_index (r->syms, sym);
+      *idx = -1;
+      for (int i = 0; fields[i].key; i++)
+        {
+          if (strcmp (fields[i].key, key) == 0)
+            {
+              *idx = i;
+              break;
+            }
+        }
+    }
+
+  return *idx >= 0 ? &fields[*idx] : NULL;
+}
+
+static void
+read_value (
+  BinaryReader *               r,
+  const cyaml_schema_value_t * schema,
+  void *                       storage);
+
+static void
+read_field (
+  BinaryReader *               r,
+  const cyaml_schema_field_t * field,
+  uint8_t *                    base)
+{
+  const cyaml_schema_value_t * value =
+    &field->value;
+  if (value->type != CYAML_SEQUENCE &&
+      value->type != CYAML_SEQUENCE_FIXED)
+    {
+      read_value (
+        r, value, base + field->data_offset);
+      return;
+    }
+
+  uint8_t tag = read_byte (r);
+  if (tag != BINARY_TAG_SEQUENCE)
+    {
+      skip_value (r, tag);
+      return;
+    }
+
+  uint64_t count = read_varint (r);
+  const cyaml_schema_value_t * entry =
+    value->sequence.entry;
+  size_t stride = get_entry_stride (entry);
+  uint8_t * arr = base + field->data_offset;
+  uint64_t num_to_read = count;
+  if (value->flags & CYAML_FLAG_POINTER)
+    {
+      if (value->type == CYAML_SEQUENCE_FIXED)
+        {
+          num_to_read =
+            MIN (count, value->sequence.max);
+        }
+      uint8_t * alloc =
+        num_to_read > 0 ?
+          calloc (
+            value->type == CYAML_SEQUENCE_FIXED ?
+              value->sequence.max : num_to_read,
+            stride) :
+          NULL;
+      *(uint8_t **) arr = alloc;
+      arr = alloc;
+    }
+  else
+    {
+      /* array embedded in the struct */
+      num_to_read =
+        MIN (count, value->sequence.max);
+    }
+  if (value->type == CYAML_SEQUENCE)
+    {
+      set_uint (
+        base + field->count_offset,
+        field->count_size, num_to_read);
+    }
+
+  for (uint64_t i = 0; i < count && !r->error; i++)
+    {
+      if (i < num_to_read)
+        {
+          read_value (r, entry, arr + i * stride);
+        }
+      else
+        {
+          skip_value (r, read_byte (r));
+        }
+    }
+}
+
+/**
+ * Reads a value into the given storage location.
+ *
+ * For pointer values, @p storage is the location of
+ * the pointer, which is allocated here.
+ */
+static void
+read_value (
+  BinaryReader *               r,
+  const cyaml_schema_value_t * schema,
+  void *                       storage)
+{
+  uint8_t tag = read_byte (r);
+  if (r->error || tag == BINARY_TAG_NULL)
+    return;
+
+  /* check that the tag matches the type, otherwise
+   * the schema changed and the value is skipped */
+  bool matches = false;
+  switch (schema->type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+    case CYAML_BOOL:
+      matches =
+        tag == BINARY_TAG_INT ||
+        tag == BINARY_TAG_UINT ||
+        tag == BINARY_TAG_BOOL;
+      break;
+    case CYAML_ENUM:
+      matches =
+        tag == BINARY_TAG_ENUM ||
+        tag == BINARY_TAG_INT;
+      break;
+    case CYAML_FLOAT:
+      matches =
+        tag == BINARY_TAG_FLOAT ||
+        tag == BINARY_TAG_DOUBLE;
+      break;
+    case CYAML_STRING:
+      matches = tag == BINARY_TAG_STRING;
+      break;
+    case CYAML_MAPPING:
+      matches = tag == BINARY_TAG_MAPPING;
+      break;
+    default:
+      break;
+    }
+  if (!matches)
+    {
+      g_message (
+        "skipping value with tag %u for schema "
+        "type %d", tag, schema->type);
+      skip_value (r, tag);
+      return;
+    }
+
+  uint8_t * data = storage;
+  if ((schema->flags & CYAML_FLAG_POINTER) &&
+      schema->type != CYAML_STRING)
+    {
+      data = calloc (1, schema->data_size);
+      *(uint8_t **) storage = data;
+    }
+
+  switch (schema->type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+    case CYAML_BOOL:
+    case CYAML_ENUM:
+      {
+        uint64_t val = 0;
+        switch (tag)
+          {
+          case BINARY_TAG_INT:
+            val = (uint64_t) read_zigzag (r);
+            break;
+          case BINARY_TAG_UINT:
+            val = read_varint (r);
+            break;
+          case BINARY_TAG_BOOL:
+            val = read_byte (r);
+            break;
+          case BINARY_TAG_ENUM:
+            {
+              int sym = read_sym (r);
+              if (sym < 0)
+                return;
+              const char * str =
+                g_ptr_array_index (r->syms, sym);
+              bool found = false;
+              for (uint32_t i = 0;
+                   i < schema->enumeration.count;
+                   i++)
+                {
+                  if (strcmp (
+                        schema->enumeration.
+                          strings[i].str,
+                        str) == 0)
+                    {
+                      val =
+                        (uint64_t)
+                        schema->enumeration.
+                          strings[i].val;
+                      found = true;
+                      break;
+                    }
+                }
+              if (!found)
+                {
+                  g_message (
+                    "unknown enum value %s", str);
+                  return;
+                }
+            }
+            break;
+          }
+        set_uint (data, schema->data_size, val);
+      }
+      break;
+    case CYAML_FLOAT:
+      {
+        double val;
+        if (tag == BINARY_TAG_FLOAT)
+          {
+            guint32 bits;
+            read_bytes (r, &bits, sizeof (bits));
+            bits = GUINT32_FROM_LE (bits);
+            float fval;
+            memcpy (&fval, &bits, sizeof (fval));
+            val = fval;
+          }
+        else
+          {
+            guint64 bits;
+            read_bytes (r, &bits, sizeof (bits));
+            bits = GUINT64_FROM_LE (bits);
+            memcpy (&val, &bits, sizeof (val));
+          }
+        if (schema->data_size == sizeof (float))
+          {
+            float fval = (float) val;
+            memcpy (data, &fval, sizeof (fval));
+          }
+        else
+          {
+            memcpy (data, &val, sizeof (val));
+          }
+      }
+      break;
+    case CYAML_STRING:
+      {
+        uint64_t len = read_varint (r);
+        if (schema->flags & CYAML_FLAG_POINTER)
+          {
+            char * str = malloc (len + 1);
+            read_bytes (r, str, len);
+            str[len] = '\0';
+            *(char **) storage = str;
+          }
+        else
+          {
+            /* fixed size array */
+            uint64_t max =
+              MIN (len, schema->string.max);
+            read_bytes (r, data, max);
+            read_bytes (r, NULL, len - max);
+            data[max] = '\0';
+          }
+      }
+      break;
+    case CYAML_MAPPING:
+      {
+        uint64_t count = read_varint (r);
+        for (uint64_t i = 0;
+             i < count && !r->error; i++)
+          {
+            int sym = read_sym (r);
+            if (sym < 0)
+              return;
+            const cyaml_schema_field_t * field =
+              get_field (
+                r, schema->mapping.fields, sym);
+            if (field &&
+                field->value.type != CYAML_IGNORE)
+              {
+                read_field (r, field, data);
+              }
+            else
+              {
+                skip_value (r, read_byte (r));
+              }
+          }
+      }
+      break;
+    default:
+      g_warn_if_reached ();
+      break;
+    }
+}
+
+static void
+free_field_map (
+  gpointer data)
+{
+  g_array_free ((GArray *) data, true);
+}
+
+/**
+ * Loads data saved with binary_save_to_file().
+ *
+ * Fields that are not in the schema are skipped
+ * and fields that are not in the file are left
+ * zeroed. Memory is allocated the same way as
+ * cyaml_load_data() so the result can be freed
+ * with cyaml_free().
+ *
+ * @param[out] data Pointer to store the loaded
+ *   data in.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+binary_load_from_file (
+  const char *                 filepath,
+  const cyaml_schema_value_t * schema,
+  void **                      data)
+{
+  *data = NULL;
+
+  FILE * file = g_fopen (filepath, "rb");
+  if (!file)
+    {
+      return
+        g_strdup_printf (
+          _("Failed to open file: %s"), filepath);
+    }
+
+  char magic[4];
+  guint32 version;
+  if (fread (magic, 1, 4, file) != 4 ||
+      memcmp (magic, BINARY_MAGIC, 4) != 0 ||
+      fread (&version, 1, 4, file) != 4)
+    {
+      fclose (file);
+      return
+        g_strdup_printf (
+          _("Not a binary file: %s"), filepath);
+    }
+  version = GUINT32_FROM_LE (version);
+  if (version > BINARY_FORMAT_VERSION)
+    {
+      fclose (file);
+      return
+        g_strdup_printf (
+          _("Unsupported binary format version %u"),
+          version);
+    }
+
+  BinaryReader r;
+  memset (&r, 0, sizeof (r));
+  r.file = file;
+  r.dstream = ZSTD_createDStream ();
+  ZSTD_initDStream (r.dstream);
+  r.in_size = ZSTD_DStreamInSize ();
+  r.in_buf = malloc (r.in_size);
+  r.buf = malloc (BINARY_CHUNK_SIZE);
+  r.syms = g_ptr_array_new_with_free_func (g_free);
+  r.field_maps =
+    g_hash_table_new_full (
+      g_direct_hash, g_direct_equal, NULL,
+      free_field_map);
+
+  void * result = NULL;
+  read_value (&r, schema, &result);
+
+  fclose (file);
+  ZSTD_freeDStream (r.dstream);
+  free (r.in_buf);
+  free (r.buf);
+  g_ptr_array_unref (r.syms);
+  g_hash_table_destroy (r.field_maps);
+
+  if (r.error)
+    {
+      if (result)
+        {
+          cyaml_config_t cyaml_config;
+          yaml_get_cyaml_config (&cyaml_config);
+          cyaml_free (
+            &cyaml_config, schema, result, 0);
+        }
+      return r.error;
+    }
+
+  *data = result;
+
+  return NULL;
+}
+
+/**
+ * Returns whether the given file was saved with
+ * binary_save_to_file().
+ */
+bool
+binary_file_is_binary (
+  const char * filepath)
+{
+  FILE * file = g_fopen (filepath, "rb");
+  if (!file)
+    return false;
+
+  char magic[4];
+  bool is_binary =
+    fread (magic, 1, 4, file) == 4 &&
+    memcmp (magic, BINARY_MAGIC, 4) == 0;
+  fclose (file);
+
+  return is_binary;
+}
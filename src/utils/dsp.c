@@ -57,6 +57,27 @@ dsp_fill (
 #endif
 }
 
+/**
+ * Fill the buffer with a linear ramp from @p start
+ * (inclusive) to @p end (exclusive).
+ */
+void
+dsp_fill_ramp (
+  float * buf,
+  float   start,
+  float   end,
+  size_t  size)
+{
+  /* each value is calculated from the index
+   * instead of accumulating the step so that the
+   * loop can be vectorized */
+  float step = (end - start) / (float) size;
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = start + step * (float) i;
+    }
+}
+
 /**
  * Clamp the buffer to min/max.
  */
@@ -327,6 +348,74 @@ dsp_mix_add2 (
 #endif
 }
 
+/**
+ * Calculate
+ * dest[i] = dest[i] + src[i] * k1[i] * k2.
+ */
+void
+dsp_mix_add_mul (
+  float *       dest,
+  const float * src,
+  const float * k1,
+  float         k2,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i] * k1[i] * k2;
+    }
+}
+
+/**
+ * Calculate
+ * dest[i] = dest[i] + src[i] * k[i], where k
+ * ramps linearly from @p k_start (inclusive) to
+ * @p k_end (exclusive).
+ */
+void
+dsp_mix_add_ramp (
+  float *       dest,
+  const float * src,
+  float         k_start,
+  float         k_end,
+  size_t        size)
+{
+  /* see dsp_fill_ramp() */
+  float step = (k_end - k_start) / (float) size;
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] =
+        dest[i] +
+        src[i] * (k_start + step * (float) i);
+    }
+}
+
+/**
+ * Calculate
+ * dest[i] = dest[i] + src[i] * k1[i] * k2[i],
+ * where k2 ramps linearly from @p k2_start
+ * (inclusive) to @p k2_end (exclusive).
+ */
+void
+dsp_mix_add_mul_ramp (
+  float *       dest,
+  const float * src,
+  const float * k1,
+  float         k2_start,
+  float         k2_end,
+  size_t        size)
+{
+  /* see dsp_fill_ramp() */
+  float step = (k2_end - k2_start) / (float) size;
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] =
+        dest[i] +
+        src[i] * k1[i] *
+          (k2_start + step * (float) i);
+    }
+}
+
 /**
  * Makes the two signals mono.
  *
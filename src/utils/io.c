@@ -231,6 +231,23 @@ io_file_get_last_modified_datetime (
   return NULL;
 }
 
+/**
+ * Returns the last modification time of the given
+ * file or directory in seconds since the epoch,
+ * or -1 if it could not be obtained.
+ */
+int64_t
+io_file_get_last_modified_time (
+  const char * filename)
+{
+  struct stat result;
+  if (stat (filename, &result) == 0)
+    {
+      return (int64_t) result.st_mtime;
+    }
+  return -1;
+}
+
 /**
  * Removes the given file.
  */
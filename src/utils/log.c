@@ -57,6 +57,7 @@
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
 #include "utils/objects.h"
+#include "utils/rt_trace.h"
 #include "utils/string.h"
 #include "zrythm.h"
 #include "zrythm_app.h"
@@ -676,6 +677,12 @@ log_idle_cb (
   if (!self || !self->mqueue)
     return G_SOURCE_CONTINUE;
 
+  /* queue messages from realtime threads */
+  if (self->rt_trace)
+    {
+      rt_trace_drain (self->rt_trace);
+    }
+
   /* write queued messages */
   LogEvent * ev;
   while (
@@ -1153,6 +1160,8 @@ log_new (void)
   self->min_log_level_for_test_console =
     G_LOG_LEVEL_MESSAGE;
 
+  self->rt_trace = rt_trace_new ();
+
   g_log_set_writer_func (
     (GLogWriterFunc) log_writer, self, NULL);
 
@@ -1182,6 +1191,15 @@ log_free (
       g_source_remove (self->writer_source_id);
     }
 
+  /* stop accepting realtime messages and write
+   * the pending ones */
+  RtTrace * rt_trace = self->rt_trace;
+  self->rt_trace = NULL;
+  if (rt_trace)
+    {
+      rt_trace_free (rt_trace);
+    }
+
   /* clear the queue */
   log_idle_cb (self);
 
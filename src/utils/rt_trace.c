@@ -0,0 +1,691 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "utils/log.h"
+#include "utils/objects.h"
+#include "utils/rt_trace.h"
+
+/** Number of bits of the thread ring value used
+ * for the ring index. */
+#define RING_IDX_BITS 8
+
+/** Used to give each instance a unique number. */
+static volatile gint next_generation = 1;
+
+static void
+release_thread_ring (
+  gpointer data);
+
+/**
+ * Ring claimed by the calling thread, stored as
+ * the generation of the instance followed by the
+ * ring index + 1, or 0 if no ring was claimed.
+ *
+ * The ring is released when the thread exits.
+ */
+static GPrivate thread_ring =
+  G_PRIVATE_INIT (release_thread_ring);
+
+/**
+ * Length modifier of a conversion specification.
+ */
+typedef enum SpecLength
+{
+  SPEC_LENGTH_NONE,
+  SPEC_LENGTH_HH,
+  SPEC_LENGTH_H,
+  SPEC_LENGTH_L,
+  SPEC_LENGTH_LL,
+  SPEC_LENGTH_Z,
+  SPEC_LENGTH_J,
+  SPEC_LENGTH_T,
+  SPEC_LENGTH_BIG_L,
+} SpecLength;
+
+/**
+ * A parsed printf conversion specification.
+ */
+typedef struct Spec
+{
+  /** Start of the specification (the '%'). */
+  const char * str;
+
+  /** Length of the specification. */
+  size_t       len;
+
+  /** Number of `*` width and precision
+   * arguments. */
+  int          num_stars;
+
+  SpecLength   length;
+
+  /** Conversion character, or '\0' if the
+   * format ended. */
+  char         conv;
+} Spec;
+
+/**
+ * Parses the conversion specification starting at
+ * @p str (a '%').
+ *
+ * @return The character after the specification.
+ */
+static const char *
+parse_spec (
+  const char * str,
+  Spec *       spec)
+{
+  const char * p = str + 1;
+  spec->str = str;
+  spec->num_stars = 0;
+  spec->length = SPEC_LENGTH_NONE;
+
+  /* flags */
+  while (*p && strchr ("-+ #0'", *p))
+    p++;
+
+  /* width */
+  if (*p == '*')
+    {
+      spec->num_stars++;
+      p++;
+    }
+  else
+    {
+      while (g_ascii_isdigit (*p))
+        p++;
+    }
+
+  /* precision */
+  if (*p == '.')
+    {
+      p++;
+      if (*p == '*')
+        {
+          spec->num_stars++;
+          p++;
+        }
+      else
+        {
+          while (g_ascii_isdigit (*p))
+            p++;
+        }
+    }
+
+  /* length modifier */
+  switch (*p)
+    {
+    case 'h':
+      p++;
+      spec->length = SPEC_LENGTH_H;
+      if (*p == 'h')
+        {
+          p++;
+          spec->length = SPEC_LENGTH_HH;
+        }
+      break;
+    case 'l':
+      p++;
+      spec->length = SPEC_LENGTH_L;
+      if (*p == 'l')
+        {
+          p++;
+          spec->length = SPEC_LENGTH_LL;
+        }
+      break;
+    case 'z':
+      p++;
+      spec->length = SPEC_LENGTH_Z;
+      break;
+    case 'j':
+      p++;
+      spec->length = SPEC_LENGTH_J;
+      break;
+    case 't':
+      p++;
+      spec->length = SPEC_LENGTH_T;
+      break;
+    case 'L':
+      p++;
+      spec->length = SPEC_LENGTH_BIG_L;
+      break;
+    default:
+      break;
+    }
+
+  spec->conv = *p;
+  if (*p)
+    p++;
+  spec->len = (size_t) (p - str);
+
+  return p;
+}
+
+/**
+ * Returns whether the conversion takes an
+ * argument that can be stored.
+ */
+static bool
+is_supported_conv (
+  char conv)
+{
+  return conv != '\0' && strchr ("diouxXceEfFgGaAps", conv);
+}
+
+/**
+ * Stores the format and the raw arguments in the
+ * record without formatting them.
+ *
+ * This never allocates or blocks. The `%n`
+ * conversion is not supported.
+ */
+void
+rt_trace_record_set_args (
+  RtTraceRecord * self,
+  const char *    format,
+  va_list         args)
+{
+  self->format = format;
+  self->num_args = 0;
+  self->truncated = false;
+  int strs_used = 0;
+
+  const char * p = format;
+  while ((p = strchr (p, '%')))
+    {
+      Spec spec;
+      p = parse_spec (p, &spec);
+      if (spec.conv == '%')
+        continue;
+
+      if (!is_supported_conv (spec.conv) ||
+          self->num_args + spec.num_stars + 1 >
+            RT_TRACE_MAX_ARGS)
+        {
+          self->truncated = true;
+          return;
+        }
+
+      for (int i = 0; i < spec.num_stars; i++)
+        {
+          self->args[self->num_args++].i =
+            va_arg (args, int);
+        }
+
+      RtTraceArg * arg =
+        &self->args[self->num_args++];
+      switch (spec.conv)
+        {
+        case 's':
+          {
+            const char * str =
+              va_arg (args, const char *);
+            if (!str)
+              {
+                arg->str_offset = -1;
+                break;
+              }
+
+            /* copy as much as fits */
+            arg->str_offset = strs_used;
+            while (*str &&
+                   strs_used < RT_TRACE_STR_SIZE - 1)
+              {
+                self->strs[strs_used++] = *str++;
+              }
+            self->strs[strs_used] = '\0';
+            if (strs_used < RT_TRACE_STR_SIZE - 1)
+              strs_used++;
+          }
+          break;
+        case 'p':
+          arg->p = va_arg (args, const void *);
+          break;
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+          if (spec.length == SPEC_LENGTH_BIG_L)
+            arg->ld = va_arg (args, long double);
+          else
+            arg->d = va_arg (args, double);
+          break;
+        default:
+          switch (spec.length)
+            {
+            case SPEC_LENGTH_L:
+              arg->l = va_arg (args, long);
+              break;
+            case SPEC_LENGTH_LL:
+              arg->ll = va_arg (args, long long);
+              break;
+            case SPEC_LENGTH_Z:
+              arg->z = va_arg (args, size_t);
+              break;
+            case SPEC_LENGTH_J:
+              arg->j = va_arg (args, intmax_t);
+              break;
+            case SPEC_LENGTH_T:
+              arg->t = va_arg (args, ptrdiff_t);
+              break;
+            default:
+              /* char and short are promoted */
+              arg->i = va_arg (args, int);
+              break;
+            }
+          break;
+        }
+    }
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+
+/**
+ * Formats a single argument with the given
+ * specification (without `*`).
+ *
+ * @return The number of characters written,
+ *   excluding the terminating null byte.
+ */
+static size_t
+format_arg (
+  const RtTraceRecord * self,
+  const Spec *          spec,
+  const char *          spec_str,
+  const RtTraceArg *    arg,
+  char *                buf,
+  size_t                size)
+{
+  int ret = 0;
+  switch (spec->conv)
+    {
+    case 's':
+      ret =
+        snprintf (
+          buf, size, spec_str,
+          arg->str_offset < 0 ?
+            "(null)" : &self->strs[arg->str_offset]);
+      break;
+    case 'p':
+      ret = snprintf (buf, size, spec_str, arg->p);
+      break;
+    case 'e': case 'E': case 'f': case 'F':
+    case 'g': case 'G': case 'a': case 'A':
+      if (spec->length == SPEC_LENGTH_BIG_L)
+        ret =
+          snprintf (buf, size, spec_str, arg->ld);
+      else
+        ret =
+          snprintf (buf, size, spec_str, arg->d);
+      break;
+    default:
+      switch (spec->length)
+        {
+        case SPEC_LENGTH_L:
+          ret =
+            snprintf (buf, size, spec_str, arg->l);
+          break;
+        case SPEC_LENGTH_LL:
+          ret =
+            snprintf (buf, size, spec_str, arg->ll);
+          break;
+        case SPEC_LENGTH_Z:
+          ret =
+            snprintf (buf, size, spec_str, arg->z);
+          break;
+        case SPEC_LENGTH_J:
+          ret =
+            snprintf (buf, size, spec_str, arg->j);
+          break;
+        case SPEC_LENGTH_T:
+          ret =
+            snprintf (buf, size, spec_str, arg->t);
+          break;
+        default:
+          ret =
+            snprintf (buf, size, spec_str, arg->i);
+          break;
+        }
+      break;
+    }
+
+  if (ret < 0)
+    return 0;
+
+  return MIN ((size_t) ret, size - 1);
+}
+
+#pragma GCC diagnostic pop
+
+/**
+ * Formats the message of the record into @p buf.
+ */
+void
+rt_trace_record_format (
+  const RtTraceRecord * self,
+  char *                buf,
+  size_t                size)
+{
+  g_return_if_fail (size > 0);
+
+  size_t pos = 0;
+  int arg_idx = 0;
+  const char * p = self->format;
+  while (*p && pos < size - 1)
+    {
+      if (*p != '%')
+        {
+          buf[pos++] = *p++;
+          continue;
+        }
+
+      Spec spec;
+      p = parse_spec (p, &spec);
+      if (spec.conv == '%')
+        {
+          buf[pos++] = '%';
+          continue;
+        }
+
+      /* stop at the first argument that was not
+       * stored */
+      if (!is_supported_conv (spec.conv) ||
+          arg_idx + spec.num_stars + 1 >
+            self->num_args)
+        {
+          pos +=
+            (size_t)
+            MAX (
+              snprintf (
+                &buf[pos], size - pos, "..."),
+              0);
+          pos = MIN (pos, size - 1);
+          break;
+        }
+
+      /* copy the specification, replacing `*` with
+       * the stored values */
+      char spec_str[64];
+      size_t spec_pos = 0;
+      for (size_t i = 0;
+           i < spec.len &&
+             spec_pos < sizeof (spec_str) - 12;
+           i++)
+        {
+          if (spec.str[i] == '*')
+            {
+              spec_pos +=
+                (size_t)
+                sprintf (
+                  &spec_str[spec_pos], "%d",
+                  self->args[arg_idx++].i);
+            }
+          else
+            {
+              spec_str[spec_pos++] = spec.str[i];
+            }
+        }
+      spec_str[spec_pos] = '\0';
+
+      pos +=
+        format_arg (
+          self, &spec, spec_str,
+          &self->args[arg_idx++], &buf[pos],
+          size - pos);
+    }
+  buf[pos] = '\0';
+}
+
+/**
+ * Creates the trace rings.
+ */
+RtTrace *
+rt_trace_new (void)
+{
+  RtTrace * self = object_new (RtTrace);
+
+  self->rings =
+    calloc (
+      RT_TRACE_MAX_THREADS, sizeof (RtTraceRing));
+  self->generation =
+    g_atomic_int_add (&next_generation, 1);
+  g_mutex_init (&self->drain_lock);
+
+  return self;
+}
+
+/**
+ * Releases the ring claimed by an exiting thread
+ * so that other threads can claim it.
+ */
+static void
+release_thread_ring (
+  gpointer data)
+{
+  gint val = GPOINTER_TO_INT (data);
+  RtTrace * self = LOG ? LOG->rt_trace : NULL;
+  if (!self ||
+      (val >> RING_IDX_BITS) != self->generation)
+    return;
+
+  int idx = (val & ((1 << RING_IDX_BITS) - 1)) - 1;
+  g_atomic_int_set (&self->rings[idx].claimed, 0);
+}
+
+/**
+ * Returns the ring of the calling thread, claiming
+ * a free one if necessary, or NULL if all rings
+ * are claimed.
+ */
+static RtTraceRing *
+get_thread_ring (
+  RtTrace * self)
+{
+  gint val =
+    GPOINTER_TO_INT (g_private_get (&thread_ring));
+  if (val != 0 &&
+      (val >> RING_IDX_BITS) == self->generation)
+    {
+      return
+        &self->rings[
+          (val & ((1 << RING_IDX_BITS) - 1)) - 1];
+    }
+
+  for (int i = 0; i < RT_TRACE_MAX_THREADS; i++)
+    {
+      if (g_atomic_int_compare_and_exchange (
+            &self->rings[i].claimed, 0, 1))
+        {
+          g_private_set (
+            &thread_ring,
+            GINT_TO_POINTER (
+              (self->generation << RING_IDX_BITS) |
+              (i + 1)));
+          return &self->rings[i];
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * Stores a message into the ring of the calling
+ * thread.
+ *
+ * This never allocates or blocks. If the ring is
+ * full, the message is dropped and counted.
+ *
+ * @param format A printf-style format string
+ *   literal.
+ */
+void
+rt_trace_log (
+  GLogLevelFlags log_level,
+  const char *   format,
+  ...)
+{
+  if (!LOG || !LOG->rt_trace)
+    return;
+
+  RtTrace * self = LOG->rt_trace;
+  RtTraceRing * ring = get_thread_ring (self);
+  if (!ring)
+    {
+      g_atomic_int_inc (&self->num_dropped);
+      return;
+    }
+
+  /* only this thread writes write_idx */
+  gint write_idx = ring->write_idx;
+  gint read_idx = g_atomic_int_get (&ring->read_idx);
+  if ((guint) (write_idx - read_idx) >=
+        RT_TRACE_RING_SIZE)
+    {
+      g_atomic_int_inc (&ring->num_dropped);
+      return;
+    }
+
+  RtTraceRecord * rec =
+    &ring->records[
+      (guint) write_idx & (RT_TRACE_RING_SIZE - 1)];
+  rec->time = g_get_monotonic_time ();
+  rec->log_level = log_level;
+
+  va_list args;
+  va_start (args, format);
+  rt_trace_record_set_args (rec, format, args);
+  va_end (args);
+
+  /* publish the record */
+  g_atomic_int_set (&ring->write_idx, write_idx + 1);
+}
+
+/**
+ * Writes all pending records to the log.
+ *
+ * Records from different threads are written in
+ * the order they were created.
+ *
+ * Must not be called from a realtime thread.
+ *
+ * @return The number of records written.
+ */
+int
+rt_trace_drain (
+  RtTrace * self)
+{
+  g_mutex_lock (&self->drain_lock);
+
+  /* only drain records written so far */
+  gint write_idxs[RT_TRACE_MAX_THREADS];
+  for (int i = 0; i < RT_TRACE_MAX_THREADS; i++)
+    {
+      write_idxs[i] =
+        g_atomic_int_get (&self->rings[i].write_idx);
+    }
+
+  int num_drained = 0;
+  while (true)
+    {
+      /* find the oldest pending record */
+      RtTraceRing * oldest_ring = NULL;
+      RtTraceRecord * oldest = NULL;
+      for (int i = 0; i < RT_TRACE_MAX_THREADS; i++)
+        {
+          RtTraceRing * ring = &self->rings[i];
+          if (ring->read_idx == write_idxs[i])
+            continue;
+
+          RtTraceRecord * rec =
+            &ring->records[
+              (guint) ring->read_idx &
+              (RT_TRACE_RING_SIZE - 1)];
+          if (!oldest || rec->time < oldest->time)
+            {
+              oldest_ring = ring;
+              oldest = rec;
+            }
+        }
+      if (!oldest)
+        break;
+
+      char msg[RT_TRACE_MSG_SIZE];
+      rt_trace_record_format (
+        oldest, msg, sizeof (msg));
+      g_log (
+        G_LOG_DOMAIN, oldest->log_level, "%s",
+        msg);
+
+      /* release the record */
+      g_atomic_int_set (
+        &oldest_ring->read_idx,
+        oldest_ring->read_idx + 1);
+      num_drained++;
+    }
+
+  /* report dropped records */
+  for (int i = 0; i < RT_TRACE_MAX_THREADS; i++)
+    {
+      RtTraceRing * ring = &self->rings[i];
+      gint num_dropped =
+        g_atomic_int_get (&ring->num_dropped);
+      if (num_dropped > 0)
+        {
+          g_atomic_int_add (
+            &ring->num_dropped, - num_dropped);
+          g_message (
+            "%d realtime log records dropped "
+            "(ring %d full)",
+            num_dropped, i);
+        }
+    }
+  gint num_dropped =
+    g_atomic_int_get (&self->num_dropped);
+  if (num_dropped > 0)
+    {
+      g_atomic_int_add (
+        &self->num_dropped, - num_dropped);
+      g_message (
+        "%d realtime log records dropped "
+        "(no free rings)",
+        num_dropped);
+    }
+
+  g_mutex_unlock (&self->drain_lock);
+
+  return num_drained;
+}
+
+/**
+ * Drains and frees the trace rings.
+ */
+void
+rt_trace_free (
+  RtTrace * self)
+{
+  rt_trace_drain (self);
+
+  g_mutex_clear (&self->drain_lock);
+  free (self->rings);
+
+  object_zero_and_free (self);
+}
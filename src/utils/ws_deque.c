@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "utils/ws_deque.h"
+
+/* glib atomics imply a full memory barrier, which
+ * is what the Chase-Lev algorithm needs between
+ * publishing bottom and reading top */
+
+static size_t
+power_of_two_size (
+  size_t sz)
+{
+  size_t size = 2;
+  while (size < sz)
+    size <<= 1;
+  return size;
+}
+
+WsDeque *
+ws_deque_new (void)
+{
+  WsDeque * self =
+    calloc (1, sizeof (WsDeque));
+
+  ws_deque_reserve (self, 8);
+
+  return self;
+}
+
+void
+ws_deque_reserve (
+  WsDeque * self,
+  size_t    buffer_size)
+{
+  buffer_size = power_of_two_size (buffer_size);
+
+  if (self->buffer &&
+      self->buffer_mask >= buffer_size - 1)
+    return;
+
+  if (self->buffer)
+    free (self->buffer);
+
+  self->buffer =
+    calloc (buffer_size, sizeof (void *));
+  self->buffer_mask = buffer_size - 1;
+
+  ws_deque_clear (self);
+}
+
+void
+ws_deque_clear (
+  WsDeque * self)
+{
+  g_atomic_int_set (&self->top, 0);
+  g_atomic_int_set (&self->bottom, 0);
+}
+
+int
+ws_deque_size (
+  WsDeque * self)
+{
+  guint b = (guint) g_atomic_int_get (&self->bottom);
+  guint t = (guint) g_atomic_int_get (&self->top);
+  gint size = (gint) (b - t);
+  return MAX (size, 0);
+}
+
+int
+ws_deque_push_bottom (
+  WsDeque *    self,
+  void * const data)
+{
+  guint b = (guint) g_atomic_int_get (&self->bottom);
+  guint t = (guint) g_atomic_int_get (&self->top);
+  /* full, let the caller decide where to put the
+   * element instead of logging from the RT
+   * thread */
+  if ((size_t) (gint) (b - t) > self->buffer_mask)
+    {
+      return 0;
+    }
+
+  g_atomic_pointer_set (
+    &self->buffer[b & self->buffer_mask], data);
+  g_atomic_int_set (&self->bottom, b + 1);
+
+  return 1;
+}
+
+int
+ws_deque_pop_bottom (
+  WsDeque * self,
+  void **   data)
+{
+  guint b =
+    (guint) g_atomic_int_get (&self->bottom) - 1;
+  g_atomic_int_set (&self->bottom, b);
+  guint t = (guint) g_atomic_int_get (&self->top);
+
+  gint size = (gint) (b - t);
+  if (size < 0)
+    {
+      /* empty */
+      g_atomic_int_set (&self->bottom, t);
+      return 0;
+    }
+
+  *data =
+    g_atomic_pointer_get (
+      &self->buffer[b & self->buffer_mask]);
+  if (size > 0)
+    return 1;
+
+  /* last element - race against thieves */
+  int ret = 1;
+  if (!g_atomic_int_compare_and_exchange (
+         &self->top, (gint) t, (gint) (t + 1)))
+    {
+      ret = 0;
+    }
+  g_atomic_int_set (&self->bottom, t + 1);
+
+  return ret;
+}
+
+int
+ws_deque_steal (
+  WsDeque * self,
+  void **   data)
+{
+  guint t = (guint) g_atomic_int_get (&self->top);
+  guint b = (guint) g_atomic_int_get (&self->bottom);
+
+  if ((gint) (b - t) <= 0)
+    return 0;
+
+  void * elem =
+    g_atomic_pointer_get (
+      &self->buffer[t & self->buffer_mask]);
+  if (!g_atomic_int_compare_and_exchange (
+         &self->top, (gint) t, (gint) (t + 1)))
+    {
+      return 0;
+    }
+
+  *data = elem;
+  return 1;
+}
+
+void
+ws_deque_free (
+  WsDeque * self)
+{
+  free (self->buffer);
+
+  free (self);
+}
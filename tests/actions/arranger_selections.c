@@ -1297,8 +1297,8 @@ test_split ()
     r_obj, F_SELECT, F_NO_APPEND, F_NO_PUBLISH_EVENTS);
   AudioClip * clip =
     audio_region_get_clip (region);
-  float first_frame = clip->frames[0];
-  g_assert_true (clip->frames[0] > 0.000001f);
+  float first_frame = clip->ch_frames[0][0];
+  g_assert_true (clip->ch_frames[0][0] > 0.000001f);
 
   position_set_to_bar (&pos, 2);
   ua =
@@ -1318,7 +1318,7 @@ test_split ()
   r_obj = (ArrangerObject *) region;
   clip = audio_region_get_clip (region);
   g_assert_cmpfloat_with_epsilon (
-    first_frame, clip->frames[0], 0.000001f);
+    first_frame, clip->ch_frames[0][0], 0.000001f);
 
   undo_manager_undo (UNDO_MANAGER);
 
@@ -1374,7 +1374,7 @@ verify_audio_function (
         {
           g_assert_cmpfloat_with_epsilon (
             frames[clip->channels * i + j],
-            clip->frames[clip->channels * i + j],
+            clip->ch_frames[j][i],
             0.0001f);
         }
     }
@@ -1411,12 +1411,10 @@ test_audio_functions ()
     (size_t) orig_clip->num_frames * channels;
   float orig_frames[total_frames];
   float inverted_frames[total_frames];
+  audio_clip_get_interleaved_frames (
+    orig_clip, 0, frames_per_channel, orig_frames);
   dsp_copy (
-    orig_frames, orig_clip->frames,
-    total_frames);
-  dsp_copy (
-    inverted_frames, orig_clip->frames,
-    total_frames);
+    inverted_frames, orig_frames, total_frames);
   dsp_mul_k2 (
     inverted_frames, -1.f, total_frames);
 
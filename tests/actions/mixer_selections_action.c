@@ -209,8 +209,17 @@ test_midi_fx_slot_deletion (void)
   ua =
     mixer_selections_action_new_delete (
       MIXER_SELECTIONS);
+  size_t num_in_ports = (size_t) pl->num_in_ports;
   undo_manager_perform (UNDO_MANAGER, ua);
 
+  /* the deleted plugin clone and its ports are
+   * accounted for */
+  g_assert_cmpuint (
+    ua->mem_usage, >,
+    sizeof (MixerSelectionsAction) +
+      sizeof (Plugin) +
+      num_in_ports * sizeof (Port));
+
   /* undo and check port value is restored */
   undo_manager_undo (UNDO_MANAGER);
   pl = track->channel->midi_fx[slot];
@@ -440,7 +440,28 @@ test_insert_silence (void)
   RangeAction * ra = (RangeAction *) ua;
   g_assert_cmpint (
     arranger_selections_get_num_objects (
-      (ArrangerSelections *) ra->sel_before), ==, 7);
+      (ArrangerSelections *) ra->sel_before) +
+    arranger_selections_get_num_objects (
+      (ArrangerSelections *) ra->sel_moved), ==, 7);
+
+  /* objects that are only moved don't need their
+   * children */
+  int num_moved_objs;
+  ArrangerObject ** moved_objs =
+    arranger_selections_get_all_objects (
+      (ArrangerSelections *) ra->sel_moved,
+      &num_moved_objs);
+  g_assert_cmpint (num_moved_objs, >, 0);
+  for (int i = 0; i < num_moved_objs; i++)
+    {
+      if (moved_objs[i]->type !=
+            ARRANGER_OBJECT_TYPE_REGION)
+        continue;
+
+      ZRegion * r = (ZRegion *) moved_objs[i];
+      g_assert_cmpint (r->num_midi_notes, ==, 0);
+    }
+  free (moved_objs);
 
   check_before_insert ();
 
@@ -618,6 +639,129 @@ test_remove_range (void)
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Appends @p yaml to @p str, without the document
+ * markers and the top-level keys in @p skip_keys,
+ * indenting each line by @p indent spaces.
+ */
+static void
+append_yaml (
+  GString *    str,
+  const char * yaml,
+  const char * skip_keys[],
+  int          indent)
+{
+  char ** lines = g_strsplit (yaml, "\n", -1);
+  bool skipping = false;
+  for (int i = 0; lines[i]; i++)
+    {
+      const char * line = lines[i];
+      if (strlen (line) == 0 ||
+          g_str_equal (line, "---") ||
+          g_str_equal (line, "..."))
+        continue;
+
+      /* skip the children of a skipped key */
+      if (skipping && line[0] == ' ')
+        continue;
+      skipping = false;
+      for (int j = 0; skip_keys[j]; j++)
+        {
+          char * key =
+            g_strdup_printf ("%s:", skip_keys[j]);
+          if (g_str_has_prefix (line, key))
+            skipping = true;
+          g_free (key);
+        }
+      if (skipping)
+        continue;
+
+      g_string_append_printf (
+        str, "%*s%s\n", indent, "", line);
+    }
+  g_strfreev (lines);
+}
+
+static void
+test_load_legacy_transport (void)
+{
+  test_prepare_common ();
+
+  Position start, end, playhead;
+  position_set_to_bar (&start, RANGE_START_BAR);
+  position_set_to_bar (&end, RANGE_END_BAR);
+  position_set_to_bar (&playhead, 3);
+  transport_set_playhead_pos (TRANSPORT, &playhead);
+  RangeAction * ra =
+    (RangeAction *)
+    range_action_new_insert_silence (&start, &end);
+
+  cyaml_config_t cyaml_config;
+  yaml_get_cyaml_config (&cyaml_config);
+  char * ra_yaml;
+  size_t ra_yaml_len;
+  cyaml_err_t err =
+    cyaml_save_data (
+      &ra_yaml, &ra_yaml_len, &cyaml_config,
+      &range_action_schema, ra, 0);
+  g_assert_cmpint (err, ==, CYAML_OK);
+  char * transport_yaml;
+  size_t transport_yaml_len;
+  err =
+    cyaml_save_data (
+      &transport_yaml, &transport_yaml_len,
+      &cyaml_config, &transport_schema,
+      TRANSPORT, 0);
+  g_assert_cmpint (err, ==, CYAML_OK);
+
+  /* recreate the format that stored a copy of
+   * the transport instead of the positions */
+  GString * legacy = g_string_new (NULL);
+  char * tmp = g_strndup (ra_yaml, ra_yaml_len);
+  const char * ra_skip_keys[] = {
+    "playhead_pos_before", "cue_pos_before",
+    "loop_start_pos_before",
+    "loop_end_pos_before", "transport", NULL };
+  append_yaml (legacy, tmp, ra_skip_keys, 0);
+  g_free (tmp);
+  g_string_append (legacy, "transport:\n");
+  tmp =
+    g_strndup (transport_yaml, transport_yaml_len);
+  const char * no_skip_keys[] = { NULL };
+  append_yaml (legacy, tmp, no_skip_keys, 2);
+  g_free (tmp);
+  cyaml_config.mem_fn (
+    cyaml_config.mem_ctx, ra_yaml, 0);
+  cyaml_config.mem_fn (
+    cyaml_config.mem_ctx, transport_yaml, 0);
+
+  RangeAction * loaded = NULL;
+  err =
+    cyaml_load_data (
+      (const unsigned char *) legacy->str,
+      legacy->len, &cyaml_config,
+      &range_action_schema,
+      (cyaml_data_t **) &loaded, NULL);
+  g_assert_cmpint (err, ==, CYAML_OK);
+  g_assert_nonnull (loaded);
+  g_assert_nonnull (loaded->transport);
+  range_action_init_loaded (loaded);
+  g_assert_null (loaded->transport);
+  g_assert_true (
+    position_is_equal (
+      &loaded->playhead_pos_before, &playhead));
+  g_assert_true (
+    position_is_equal (
+      &loaded->loop_end_pos_before,
+      &TRANSPORT->loop_end_pos));
+
+  range_action_free (loaded);
+  range_action_free (ra);
+  g_string_free (legacy, true);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -631,6 +775,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test remove range",
     (GTestFunc) test_remove_range);
+  g_test_add_func (
+    TEST_PREFIX "test load legacy transport",
+    (GTestFunc) test_load_legacy_transport);
 
   return g_test_run ();
 }
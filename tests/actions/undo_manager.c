@@ -22,6 +22,8 @@
 #include <math.h>
 
 #include "actions/undo_manager.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm.h"
@@ -123,6 +125,109 @@ test_perform_many_actions ()
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_mem_limit ()
+{
+  test_helper_zrythm_init ();
+
+  UndoableAction * track_ua =
+    tracklist_selections_action_new_create_midi (
+      TRACKLIST->num_tracks, 1);
+  undo_manager_perform (UNDO_MANAGER, track_ua);
+  undo_manager_clear_stacks (UNDO_MANAGER, F_FREE);
+
+  UndoStack * undo_stack = UNDO_MANAGER->undo_stack;
+  g_assert_cmpuint (undo_stack->mem_usage, ==, 0);
+
+  perform_create_region_action ();
+  UndoableAction * ua =
+    (UndoableAction *) undo_stack_peek (undo_stack);
+  g_assert_cmpuint (ua->mem_usage, >, 0);
+  g_assert_cmpuint (
+    undo_stack->mem_usage, ==, ua->mem_usage);
+
+  /* allow about 3 actions */
+  undo_stack->max_mem_usage =
+    ua->mem_usage * 3 + ua->mem_usage / 2;
+  for (int i = 0; i < 10; i++)
+    {
+      perform_create_region_action ();
+      g_assert_false (
+        undo_stack_is_over_mem_limit (undo_stack));
+    }
+  g_assert_cmpint (
+    undo_stack_size (undo_stack), ==, 3);
+
+  /* memory is accounted for when moving between
+   * the stacks */
+  undo_manager_undo (UNDO_MANAGER);
+  g_assert_cmpint (
+    undo_stack_size (undo_stack), ==, 2);
+  g_assert_cmpuint (
+    UNDO_MANAGER->redo_stack->mem_usage, >, 0);
+  undo_manager_redo (UNDO_MANAGER);
+  g_assert_cmpuint (
+    UNDO_MANAGER->redo_stack->mem_usage, ==, 0);
+
+  /* the last action is always kept */
+  undo_stack->max_mem_usage = 1;
+  perform_create_region_action ();
+  g_assert_cmpint (
+    undo_stack_size (undo_stack), ==, 1);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_move_uses_shallow_clones ()
+{
+  test_helper_zrythm_init ();
+
+  UndoableAction * track_ua =
+    tracklist_selections_action_new_create_midi (
+      TRACKLIST->num_tracks, 1);
+  undo_manager_perform (UNDO_MANAGER, track_ua);
+
+  /* create a region with notes */
+  perform_create_region_action ();
+  ZRegion * r = TL_SELECTIONS->regions[0];
+  Position p1, p2;
+  for (int i = 0; i < 4; i++)
+    {
+      position_init (&p1);
+      position_add_ticks (&p1, i * 120);
+      p2 = p1;
+      position_add_ticks (&p2, 60);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &p1, &p2, (uint8_t) (60 + i), 90);
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+
+  UndoableAction * ua =
+    arranger_selections_action_new_move_timeline (
+      TL_SELECTIONS, 960.0, 0, 0,
+      F_NOT_ALREADY_MOVED);
+  undo_manager_perform (UNDO_MANAGER, ua);
+
+  ArrangerSelectionsAction * action =
+    (ArrangerSelectionsAction *) ua;
+  g_assert_true (action->shallow);
+  ZRegion * clone =
+    ((TimelineSelections *) action->sel)->regions[0];
+  g_assert_cmpint (clone->num_midi_notes, ==, 0);
+  g_assert_cmpint (r->num_midi_notes, ==, 4);
+
+  /* undo/redo still find the region */
+  undo_manager_undo (UNDO_MANAGER);
+  g_assert_cmpint (r->num_midi_notes, ==, 4);
+  undo_manager_redo (UNDO_MANAGER);
+  g_assert_cmpint (r->num_midi_notes, ==, 4);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -133,6 +238,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test perform many actions",
     (GTestFunc) test_perform_many_actions);
+  g_test_add_func (
+    TEST_PREFIX "test mem limit",
+    (GTestFunc) test_mem_limit);
+  g_test_add_func (
+    TEST_PREFIX "test move uses shallow clones",
+    (GTestFunc) test_move_uses_shallow_clones);
 
   return g_test_run ();
 }
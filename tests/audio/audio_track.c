@@ -23,7 +23,9 @@
 
 #include "audio/engine_dummy.h"
 #include "audio/audio_track.h"
+#include "audio/track_processor.h"
 #include "project.h"
+#include "utils/dsp.h"
 #include "utils/flags.h"
 #include "zrythm.h"
 
@@ -115,6 +117,69 @@ test_fill_when_region_starts_on_loop_end ()
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_process_hw_input ()
+{
+  test_helper_zrythm_init ();
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  /* create dummy input (the hardware input of the
+   * dummy backend) */
+  nframes_t nframes = AUDIO_ENGINE->block_length;
+  AUDIO_ENGINE->dummy_input =
+    stereo_ports_new_generic (
+      true, "Dummy input", PORT_OWNER_TYPE_BACKEND,
+      AUDIO_ENGINE);
+  dsp_fill (
+    AUDIO_ENGINE->dummy_input->l->buf, 0.5f,
+    nframes);
+  dsp_fill (
+    AUDIO_ENGINE->dummy_input->r->buf, 0.5f,
+    nframes);
+
+  Track * track =
+    track_new (
+      TRACK_TYPE_AUDIO, TRACKLIST->num_tracks,
+      "Audio Track", F_WITH_LANE);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+  track_set_recording (track, true, false);
+
+  /* the cleared input receives the hardware
+   * data */
+  TrackProcessor * processor = track->processor;
+  track_processor_clear_buffers (processor);
+  g_assert_true (processor->stereo_in->l->silent);
+  port_process (
+    processor->stereo_in->l, 0, 0, nframes, false);
+  port_process (
+    processor->stereo_in->r, 0, 0, nframes, false);
+  g_assert_false (processor->stereo_in->l->silent);
+  g_assert_false (processor->stereo_in->r->silent);
+
+  /* and passes it on */
+  track_processor_process (
+    processor, 0, 0, nframes);
+  g_assert_false (processor->stereo_out->l->silent);
+  g_assert_false (processor->stereo_out->r->silent);
+  for (nframes_t i = 0; i < nframes; i++)
+    {
+      g_assert_true (
+        fabsf (processor->stereo_out->l->buf[i]) >
+          0.1f);
+      g_assert_true (
+        fabsf (processor->stereo_out->r->buf[i]) >
+          0.1f);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -125,6 +190,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test fill when region starts on loop end",
     (GTestFunc) test_fill_when_region_starts_on_loop_end);
+  g_test_add_func (
+    TEST_PREFIX "test process hw input",
+    (GTestFunc) test_process_hw_input);
 
   return g_test_run ();
 }
@@ -26,6 +26,7 @@
 #include "audio/master_track.h"
 #include "project.h"
 #include "utils/arrays.h"
+#include "utils/flags.h"
 #include "zrythm.h"
 
 #include "tests/helpers/zrythm.h"
@@ -86,6 +87,86 @@ test_set_at_index ()
   test_helper_zrythm_cleanup ();
 }
 
+static void
+check_val_at_frames (
+  AutomationTrack * at,
+  long              frames)
+{
+  Position pos;
+  position_from_frames (&pos, frames);
+  float val;
+  bool has_automation =
+    automation_track_get_normalized_val_at_frames (
+      at, frames, &val);
+  AutomationPoint * ap =
+    automation_track_get_ap_before_pos (at, &pos);
+  g_assert_true (has_automation == (ap != NULL));
+  if (has_automation)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        val,
+        automation_track_get_val_at_pos (
+          at, &pos, true),
+        0.0001f);
+    }
+}
+
+static void
+test_get_normalized_val_at_frames ()
+{
+  test_helper_zrythm_init ();
+
+  AutomationTrack * at =
+    channel_get_automation_track (
+      P_MASTER_TRACK->channel,
+      PORT_FLAG_STEREO_BALANCE);
+  Position start, end;
+  position_set_to_bar (&start, 2);
+  position_set_to_bar (&end, 6);
+  ZRegion * r =
+    automation_region_new (
+      &start, &end, P_MASTER_TRACK->pos,
+      at->index, 0);
+  track_add_region (
+    P_MASTER_TRACK, r, at, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  Position pos;
+  for (int i = 0; i < 8; i++)
+    {
+      position_set_to_bar (&pos, 1 + i / 2);
+      position_add_beats (&pos, i % 2);
+      float val = (float) ((i * 3) % 5) / 4.f;
+      AutomationPoint * ap =
+        automation_point_new_float (val, val, &pos);
+      automation_region_add_ap (
+        r, ap, F_NO_PUBLISH_EVENTS);
+    }
+
+  long end_frames = end.frames + 4800;
+  long step = 997;
+
+  /* forward, like the engine reads */
+  for (long i = 0; i < end_frames; i += step)
+    {
+      check_val_at_frames (at, i);
+    }
+
+  /* backward, with the cursor at the end */
+  for (long i = end_frames; i >= 0; i -= step)
+    {
+      check_val_at_frames (at, i);
+    }
+
+  /* jumping around */
+  for (long i = 0; i < end_frames; i += step)
+    {
+      check_val_at_frames (at, end_frames - i);
+      check_val_at_frames (at, i);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -96,6 +177,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test set at index",
     (GTestFunc) test_set_at_index);
+  g_test_add_func (
+    TEST_PREFIX "test get normalized val at frames",
+    (GTestFunc) test_get_normalized_val_at_frames);
 
   return g_test_run ();
 }
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "audio/clip.h"
+#include "audio/clip_peaks.h"
+#include "helpers/project.h"
+#include "helpers/zrythm.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include <glib/gstdio.h>
+
+#define NUM_FRAMES 100000
+
+static AudioClip *
+create_clip (void)
+{
+  float * frames =
+    malloc (NUM_FRAMES * 2 * sizeof (float));
+  for (long i = 0; i < NUM_FRAMES; i++)
+    {
+      frames[i * 2] =
+        0.8f * sinf ((float) i * 0.001f);
+      frames[i * 2 + 1] =
+        0.5f * cosf ((float) i * 0.013f);
+    }
+  AudioClip * clip =
+    audio_clip_new_from_float_array (
+      frames, NUM_FRAMES, 2, "test clip");
+  free (frames);
+
+  return clip;
+}
+
+static void
+assert_peaks_equal (
+  ClipPeaks * a,
+  ClipPeaks * b)
+{
+  g_assert_cmpint (a->num_levels, ==, b->num_levels);
+  g_assert_cmpint (a->num_frames, ==, b->num_frames);
+  for (int i = 0; i < a->num_levels; i++)
+    {
+      g_assert_cmpuint (
+        a->num_peaks[i], ==, b->num_peaks[i]);
+      for (size_t j = 0; j < a->num_peaks[i]; j++)
+        {
+          ClipPeak * pa = &a->levels[i][j];
+          ClipPeak * pb = &b->levels[i][j];
+          g_assert_cmpfloat_with_epsilon (
+            pa->min, pb->min, 0.00001f);
+          g_assert_cmpfloat_with_epsilon (
+            pa->max, pb->max, 0.00001f);
+          g_assert_cmpfloat_with_epsilon (
+            pa->rms, pb->rms, 0.00001f);
+        }
+    }
+}
+
+static void
+test_min_max ()
+{
+  AudioClip * clip = create_clip ();
+  ClipPeaks * peaks =
+    clip_peaks_new_from_clip (clip);
+
+  g_assert_cmpint (peaks->num_levels, >, 1);
+  g_assert_cmpuint (
+    peaks->num_peaks[peaks->num_levels - 1], ==, 1);
+
+  g_assert_cmpint (
+    clip_peaks_get_level (peaks, 100), ==, -1);
+  g_assert_cmpint (
+    clip_peaks_get_level (
+      peaks, CLIP_PEAKS_BASE_FRAMES), ==, 0);
+  g_assert_cmpint (
+    clip_peaks_get_level (
+      peaks,
+      CLIP_PEAKS_BASE_FRAMES *
+        CLIP_PEAKS_LEVEL_FACTOR + 1), ==, 1);
+
+  /* ranges aligned to the peaks must give the
+   * same results as reading the frames */
+  for (int level = 0; level < peaks->num_levels;
+       level++)
+    {
+      long level_frames = CLIP_PEAKS_BASE_FRAMES;
+      for (int i = 0; i < level; i++)
+        level_frames *= CLIP_PEAKS_LEVEL_FACTOR;
+      for (long start = 0; start < NUM_FRAMES;
+           start += level_frames * 3)
+        {
+          long end = start + level_frames * 2;
+          float min, max, peaks_min, peaks_max;
+          audio_clip_get_min_max (
+            clip, start, end, &min, &max);
+          clip_peaks_get_min_max (
+            peaks, level, start, end,
+            &peaks_min, &peaks_max, NULL);
+          g_assert_cmpfloat_with_epsilon (
+            min, peaks_min, 0.00001f);
+          g_assert_cmpfloat_with_epsilon (
+            max, peaks_max, 0.00001f);
+        }
+    }
+
+  /* empty range */
+  float min, max, rms;
+  clip_peaks_get_min_max (
+    peaks, 0, 500, 500, &min, &max, &rms);
+  g_assert_cmpfloat (min, ==, 0.f);
+  g_assert_cmpfloat (max, ==, 0.f);
+  g_assert_cmpfloat (rms, ==, 0.f);
+
+  clip_peaks_free (peaks);
+  audio_clip_free (clip);
+}
+
+static void
+test_incremental_update ()
+{
+  AudioClip * clip = create_clip ();
+  ClipPeaks * full_peaks =
+    clip_peaks_new_from_clip (clip);
+
+  /* simulate recording by revealing the frames
+   * in uneven chunks */
+  ClipPeaks * peaks = clip_peaks_new ();
+  long total_frames = clip->num_frames;
+  long start = 0;
+  while (start < total_frames)
+    {
+      long end =
+        MIN (start + 1000 + start % 777, total_frames);
+      clip->num_frames = end;
+      clip_peaks_update (peaks, clip, start, end);
+      start = end;
+    }
+
+  assert_peaks_equal (peaks, full_peaks);
+
+  clip_peaks_free (peaks);
+  clip_peaks_free (full_peaks);
+  audio_clip_free (clip);
+}
+
+static void
+test_save_load ()
+{
+  AudioClip * clip = create_clip ();
+  ClipPeaks * peaks =
+    clip_peaks_new_from_clip (clip);
+
+  char * dir =
+    g_dir_make_tmp ("zrythm_peaks_XXXXXX", NULL);
+  char * pool_path =
+    g_build_filename (dir, "test.wav", NULL);
+  g_assert_true (
+    g_file_set_contents (
+      pool_path, "data", -1, NULL));
+
+  clip_peaks_save (peaks, clip, pool_path);
+  ClipPeaks * loaded_peaks =
+    clip_peaks_load (clip, pool_path);
+  g_assert_nonnull (loaded_peaks);
+  assert_peaks_equal (loaded_peaks, peaks);
+  clip_peaks_free (loaded_peaks);
+
+  /* peaks of a different file are not used */
+  g_assert_true (
+    g_file_set_contents (
+      pool_path, "other data", -1, NULL));
+  g_assert_null (
+    clip_peaks_load (clip, pool_path));
+
+  /* the clip's own peaks are saved for the new
+   * file */
+  g_assert_false (
+    clip_peaks_save_clip (clip, pool_path));
+  clip_peaks_set (
+    clip, clip_peaks_new_from_clip (clip));
+  g_assert_true (
+    clip_peaks_save_clip (clip, pool_path));
+  loaded_peaks =
+    clip_peaks_load (clip, pool_path);
+  g_assert_nonnull (loaded_peaks);
+  assert_peaks_equal (loaded_peaks, peaks);
+  clip_peaks_free (loaded_peaks);
+
+  char * peaks_path =
+    clip_peaks_get_path (pool_path);
+  io_remove (peaks_path);
+  io_remove (pool_path);
+  io_rmdir (dir, false);
+  g_free (peaks_path);
+  g_free (pool_path);
+  g_free (dir);
+
+  clip_peaks_free (peaks);
+  audio_clip_free (clip);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  test_helper_zrythm_init ();
+
+#define TEST_PREFIX "/audio/clip_peaks/"
+
+  g_test_add_func (
+    TEST_PREFIX "test min max",
+    (GTestFunc) test_min_max);
+  g_test_add_func (
+    TEST_PREFIX "test incremental update",
+    (GTestFunc) test_incremental_update);
+  g_test_add_func (
+    TEST_PREFIX "test save load",
+    (GTestFunc) test_save_load);
+
+  return g_test_run ();
+}
@@ -23,6 +23,7 @@
 #include "audio/fader.h"
 #include "audio/midi_event.h"
 #include "audio/router.h"
+#include "utils/dsp.h"
 #include "utils/math.h"
 
 #include "tests/helpers/plugin_manager.h"
@@ -95,6 +96,146 @@ test_fader_process ()
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_gain_ramp ()
+{
+  test_helper_zrythm_init ();
+
+  Fader * fader =
+    fader_new (FADER_TYPE_MONITOR, NULL, false);
+  nframes_t nframes = AUDIO_ENGINE->block_length;
+  dsp_fill (
+    fader->stereo_in->l->buf, 1.f, nframes);
+  dsp_fill (
+    fader->stereo_in->r->buf, 1.f, nframes);
+
+  /* first cycle is not ramped */
+  fader_set_amp (fader, 1.f);
+  dsp_fill (
+    fader->stereo_out->l->buf, 0.f, nframes);
+  fader_process (fader, 0, 0, nframes);
+  float full = fader->stereo_out->l->buf[0];
+  g_assert_cmpfloat (full, >, 0.f);
+  g_assert_cmpfloat_with_epsilon (
+    fader->stereo_out->l->buf[nframes - 1], full,
+    0.0001f);
+
+  /* the gain ramps down to the new amplitude */
+  fader_set_amp (fader, 0.5f);
+  dsp_fill (
+    fader->stereo_out->l->buf, 0.f, nframes);
+  fader_process (fader, 0, 0, nframes);
+  float * buf = fader->stereo_out->l->buf;
+  g_assert_cmpfloat_with_epsilon (
+    buf[0], full, 0.0001f);
+  for (nframes_t i = 1; i < nframes; i++)
+    {
+      g_assert_cmpfloat (buf[i], <, buf[i - 1]);
+    }
+  g_assert_cmpfloat (
+    buf[nframes - 1], >, full * 0.5f);
+
+  /* and stays there */
+  dsp_fill (
+    fader->stereo_out->l->buf, 0.f, nframes);
+  fader_process (fader, 0, 0, nframes);
+  g_assert_cmpfloat_with_epsilon (
+    buf[0], full * 0.5f, 0.0001f);
+  g_assert_cmpfloat_with_epsilon (
+    buf[nframes - 1], full * 0.5f, 0.0001f);
+
+  fader_free (fader);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_amp_automation ()
+{
+  test_helper_zrythm_init ();
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  Fader * fader =
+    P_MASTER_TRACK->channel->fader;
+  nframes_t nframes = AUDIO_ENGINE->block_length;
+  fader_set_amp (fader, 1.f);
+
+  /* dip in the middle of the block with equal
+   * amplitudes at both ends */
+  dsp_fill (fader->amp->buf, 1.f, nframes);
+  dsp_fill (
+    &fader->amp->buf[nframes / 4], 0.25f,
+    nframes / 2);
+  fader->amp->buf_varies = true;
+
+  fader_clear_buffers (fader);
+  dsp_fill (
+    fader->stereo_in->l->buf, 0.5f, nframes);
+  fader->stereo_in->l->silent = false;
+  fader_process (fader, 0, 0, nframes);
+  float * buf = fader->stereo_out->l->buf;
+  g_assert_cmpfloat (buf[0], >, 0.f);
+  g_assert_cmpfloat_with_epsilon (
+    buf[nframes / 2], buf[0] * 0.25f, 0.0001f);
+  g_assert_cmpfloat_with_epsilon (
+    buf[nframes - 1], buf[0], 0.0001f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_silence_propagation ()
+{
+  test_helper_zrythm_init ();
+
+  Fader * fader =
+    fader_new (FADER_TYPE_MONITOR, NULL, false);
+  nframes_t nframes = AUDIO_ENGINE->block_length;
+
+  /* silent input stays silent */
+  fader_clear_buffers (fader);
+  g_assert_true (fader->stereo_in->l->silent);
+  fader_process (fader, 0, 0, nframes);
+  g_assert_true (fader->stereo_out->l->silent);
+  g_assert_true (fader->stereo_out->r->silent);
+  g_assert_cmpfloat_with_epsilon (
+    fader->stereo_out->l->buf[0], 0.f, 0.0001f);
+
+  /* signal is passed on */
+  fader_clear_buffers (fader);
+  dsp_fill (
+    fader->stereo_in->l->buf, 0.5f, nframes);
+  fader->stereo_in->l->silent = false;
+  fader_process (fader, 0, 0, nframes);
+  g_assert_false (fader->stereo_out->l->silent);
+  g_assert_cmpfloat (
+    fader->stereo_out->l->buf[0], >, 0.1f);
+
+  /* muted fader ramps down, then goes silent */
+  port_set_control_value (
+    fader->mute, 1.f, false, false);
+  fader_clear_buffers (fader);
+  dsp_fill (
+    fader->stereo_in->l->buf, 0.5f, nframes);
+  fader->stereo_in->l->silent = false;
+  fader_process (fader, 0, 0, nframes);
+  g_assert_false (fader->stereo_out->l->silent);
+  fader_clear_buffers (fader);
+  dsp_fill (
+    fader->stereo_in->l->buf, 0.5f, nframes);
+  fader->stereo_in->l->silent = false;
+  fader_process (fader, 0, 0, nframes);
+  g_assert_true (fader->stereo_out->l->silent);
+
+  fader_free (fader);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -105,6 +246,15 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test fader process",
     (GTestFunc) test_fader_process);
+  g_test_add_func (
+    TEST_PREFIX "test gain ramp",
+    (GTestFunc) test_gain_ramp);
+  g_test_add_func (
+    TEST_PREFIX "test amp automation",
+    (GTestFunc) test_amp_automation);
+  g_test_add_func (
+    TEST_PREFIX "test silence propagation",
+    (GTestFunc) test_silence_propagation);
 
   return g_test_run ();
 }
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "actions/tracklist_selections.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/graph_export.h"
+#include "audio/graph_node.h"
+#include "audio/router.h"
+#include "audio/tracklist.h"
+#include "project.h"
+#include "utils/io.h"
+
+#include "tests/helpers/zrythm.h"
+
+static void
+test_dsp_load ()
+{
+  test_helper_zrythm_init ();
+
+  /* create an audio track */
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  Graph * graph = ROUTER->graph;
+  graph_reset_dsp_load (graph);
+  GraphNodeDspLoad load;
+  graph_get_track_dsp_load (graph, track, &load);
+  g_assert_cmpint (load.num_cycles, ==, 0);
+
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+
+  for (int i = 0; i < graph->n_graph_nodes; i++)
+    {
+      graph_node_get_dsp_load (
+        graph->graph_nodes[i], &load);
+      g_assert_cmpint (load.num_cycles, ==, 2);
+      g_assert_cmpint (load.min, <=, load.avg);
+      g_assert_cmpint (load.avg, <=, load.max);
+      g_assert_cmpint (load.last, <=, load.max);
+    }
+
+  graph_get_track_dsp_load (graph, track, &load);
+  g_assert_cmpint (load.num_cycles, ==, 2);
+
+  /* short nodes are still measured */
+  g_assert_cmpint (load.last, >, 0);
+
+  /* the critical path must follow the edges from
+   * an initial node to a terminal node */
+  GraphNode ** path;
+  size_t path_len =
+    graph_get_critical_path (graph, &path);
+  g_assert_cmpuint (path_len, >, 0);
+  g_assert_cmpint (path[0]->init_refcount, ==, 0);
+  g_assert_cmpint (
+    path[path_len - 1]->n_childnodes, ==, 0);
+  for (size_t i = 1; i < path_len; i++)
+    {
+      bool is_parent = false;
+      for (int j = 0;
+           j < path[i]->init_refcount; j++)
+        {
+          if (path[i]->parentnodes[j] ==
+                path[i - 1])
+            {
+              is_parent = true;
+              break;
+            }
+        }
+      g_assert_true (is_parent);
+    }
+  free (path);
+
+  /* export a report */
+  char * dir =
+    g_dir_make_tmp ("zrythm_dsp_load_XXXXXX", NULL);
+  char * report_path =
+    g_build_filename (dir, "dsp_load.txt", NULL);
+  graph_export_dsp_load (graph, report_path);
+  g_assert_true (
+    g_file_test (
+      report_path, G_FILE_TEST_EXISTS));
+  io_remove (report_path);
+  io_rmdir (dir, false);
+  g_free (report_path);
+  g_free (dir);
+
+  graph_reset_dsp_load (graph);
+  graph_get_track_dsp_load (graph, track, &load);
+  g_assert_cmpint (load.num_cycles, ==, 0);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/graph/"
+
+  g_test_add_func (
+    TEST_PREFIX "test DSP load",
+    (GTestFunc) test_dsp_load);
+
+  return g_test_run ();
+}
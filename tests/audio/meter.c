@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/fader.h"
+#include "audio/meter.h"
+#include "audio/port.h"
+#include "utils/dsp.h"
+
+#include "tests/helpers/zrythm.h"
+
+static void
+test_meter_snapshot ()
+{
+  test_helper_zrythm_init ();
+
+  Fader * fader =
+    fader_new (FADER_TYPE_MONITOR, NULL, false);
+  Port * port = fader->stereo_out->l;
+  nframes_t nframes = AUDIO_ENGINE->block_length;
+
+  /* the meter is registered with the port */
+  Meter * meter = meter_new_for_port (port);
+  g_assert_nonnull (port->meters);
+  g_assert_true (port->meters[0] == meter);
+  g_assert_null (port->meters[1]);
+
+  /* nothing published yet */
+  float val, max;
+  meter_get_value (
+    meter, AUDIO_VALUE_AMPLITUDE, &val, &max);
+  g_assert_cmpfloat_with_epsilon (
+    val, 1e-20f, 1e-21f);
+
+  /* the engine publishes the peak */
+  dsp_fill (port->buf, 0.5f, nframes);
+  port->buf[nframes / 2] = -0.8f;
+  meter_process (meter, 0, nframes);
+  meter_get_value (
+    meter, AUDIO_VALUE_AMPLITUDE, &val, &max);
+  g_assert_cmpfloat_with_epsilon (
+    val, 0.8f, 0.0001f);
+  g_assert_cmpfloat_with_epsilon (
+    max, 0.8f, 0.0001f);
+
+  /* a new max is started after reading, and the
+   * held peak is kept */
+  dsp_fill (port->buf, 0.25f, nframes);
+  meter_process (meter, 0, nframes);
+  g_assert_cmpfloat_with_epsilon (
+    meter->snapshot_amp, 0.25f, 0.0001f);
+  g_assert_cmpfloat_with_epsilon (
+    meter->snapshot_max_amp, 0.8f, 0.0001f);
+
+  /* the meter is unregistered when freed */
+  meter_free (meter);
+  g_assert_null (port->meters);
+
+  fader_free (fader);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/meter/"
+
+  g_test_add_func (
+    TEST_PREFIX "test meter snapshot",
+    (GTestFunc) test_meter_snapshot);
+
+  return g_test_run ();
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/midi_event.h"
+#include "helpers/project.h"
+#include "helpers/zrythm.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+static void
+assert_events_sorted (
+  MidiEvents * events)
+{
+  for (int i = 1; i < events->num_events; i++)
+    {
+      MidiEvent * prev = &events->events[i - 1];
+      MidiEvent * ev = &events->events[i];
+      g_assert_true (
+        prev->time < ev->time ||
+        (prev->time == ev->time &&
+         prev->type <= ev->type));
+    }
+}
+
+static void
+test_merge ()
+{
+  MidiEvents * src1 = midi_events_new (NULL);
+  MidiEvents * src2 = midi_events_new (NULL);
+  MidiEvents * src3 = midi_events_new (NULL);
+  MidiEvents * dest = midi_events_new (NULL);
+
+  /* existing event in dest */
+  midi_events_add_control_change (
+    dest, 1, 7, 100, 5, F_NOT_QUEUED);
+
+  for (midi_time_t i = 0; i < 20; i += 2)
+    {
+      midi_events_add_note_on (
+        src1, 1, 60, 90, i, F_NOT_QUEUED);
+    }
+  for (midi_time_t i = 0; i < 20; i += 3)
+    {
+      midi_events_add_note_off (
+        src2, 1, 62, i, F_NOT_QUEUED);
+    }
+  /* duplicates of src1 events and an event on
+   * channel 2 */
+  midi_events_add_note_on (
+    src3, 1, 60, 90, 4, F_NOT_QUEUED);
+  midi_events_add_note_on (
+    src3, 2, 64, 90, 6, F_NOT_QUEUED);
+  midi_events_add_note_on (
+    src3, 1, 60, 90, 8, F_NOT_QUEUED);
+
+  /* only allow channel 1 from src3 */
+  int src3_channels[16] = { 1 };
+
+  MidiEvents * srcs[] = { src1, src2, src3 };
+  int * channels[] = { NULL, NULL, src3_channels };
+
+  /* merge frames 2 to 17 */
+  midi_events_merge (
+    dest, srcs, channels, 3, 2, 16);
+
+  /* 1 existing + 8 note ons (2 ~ 16) + 5 note offs
+   * (3 ~ 15) */
+  g_assert_cmpint (dest->num_events, ==, 14);
+  assert_events_sorted (dest);
+  g_assert_cmpint (
+    dest->events[0].type, ==,
+    MIDI_EVENT_TYPE_NOTE_ON);
+  g_assert_cmpuint (dest->events[0].time, ==, 2);
+  for (int i = 0; i < dest->num_events; i++)
+    {
+      g_assert_cmpuint (
+        dest->events[i].channel, ==, 1);
+    }
+
+  /* merging again only adds duplicates */
+  midi_events_merge (
+    dest, srcs, channels, 3, 2, 16);
+  g_assert_cmpint (dest->num_events, ==, 14);
+  assert_events_sorted (dest);
+
+  midi_events_free (src1);
+  midi_events_free (src2);
+  midi_events_free (src3);
+  midi_events_free (dest);
+}
+
+static void
+test_sort_and_clear_duplicates ()
+{
+  MidiEvents * events = midi_events_new (NULL);
+
+  midi_events_add_note_on (
+    events, 1, 60, 90, 10, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 60, 4, F_QUEUED);
+  midi_events_add_note_on (
+    events, 1, 60, 90, 10, F_QUEUED);
+  midi_events_add_note_on (
+    events, 1, 61, 90, 10, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 60, 10, F_QUEUED);
+  midi_events_add_note_off (
+    events, 1, 60, 4, F_QUEUED);
+
+  midi_events_sort (events, F_QUEUED);
+  midi_events_clear_duplicates (events, F_QUEUED);
+
+  g_assert_cmpint (events->num_queued_events, ==, 4);
+  g_assert_cmpuint (
+    events->queued_events[0].time, ==, 4);
+  g_assert_cmpint (
+    events->queued_events[1].type, ==,
+    MIDI_EVENT_TYPE_NOTE_OFF);
+  g_assert_cmpuint (
+    events->queued_events[1].time, ==, 10);
+  g_assert_cmpint (
+    events->queued_events[2].type, ==,
+    MIDI_EVENT_TYPE_NOTE_ON);
+  g_assert_cmpint (
+    events->queued_events[3].type, ==,
+    MIDI_EVENT_TYPE_NOTE_ON);
+
+  midi_events_free (events);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  test_helper_zrythm_init ();
+
+#define TEST_PREFIX "/audio/midi_event/"
+
+  g_test_add_func (
+    TEST_PREFIX "test merge",
+    (GTestFunc) test_merge);
+  g_test_add_func (
+    TEST_PREFIX "test sort and clear duplicates",
+    (GTestFunc) test_sort_and_clear_duplicates);
+
+  return g_test_run ();
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/automation_region.h"
+#include "audio/automation_track.h"
+#include "audio/engine.h"
+#include "audio/tempo_track.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+#include <locale.h>
+
+/**
+ * Adds a looped BPM automation region from bar 3
+ * to bar 11 with a 2-bar loop.
+ */
+static AutomationTrack *
+add_bpm_automation (void)
+{
+  Port * port = P_TEMPO_TRACK->bpm_port;
+  AutomationTrack * at =
+    automation_track_find_from_port (
+      port, P_TEMPO_TRACK, true);
+  g_assert_nonnull (at);
+
+  Position start, end;
+  position_set_to_bar (&start, 3);
+  position_set_to_bar (&end, 11);
+  ZRegion * r =
+    automation_region_new (
+      &start, &end, P_TEMPO_TRACK->pos,
+      at->index, 0);
+  track_add_region (
+    P_TEMPO_TRACK, r, at, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  Position pos;
+  position_set_to_bar (&pos, 3);
+  arranger_object_set_position (
+    (ArrangerObject *) r, &pos,
+    ARRANGER_OBJECT_POSITION_TYPE_LOOP_END,
+    F_NO_VALIDATE);
+
+  for (int i = 0; i < 4; i++)
+    {
+      position_set_to_bar (&pos, 1);
+      position_add_beats (&pos, i * 2);
+      float val = (float) ((i * 3) % 5) / 4.f;
+      AutomationPoint * ap =
+        automation_point_new_float (
+          port->minf + val * (port->maxf - port->minf),
+          val, &pos);
+      automation_region_add_ap (
+        r, ap, F_NO_PUBLISH_EVENTS);
+      automation_point_set_curviness (
+        ap, i % 2 ? 0.6 : -0.3);
+    }
+
+  return at;
+}
+
+static void
+test_bpm_at_pos ()
+{
+  test_helper_zrythm_init ();
+
+  AutomationTrack * at = add_bpm_automation ();
+  tempo_track_update_tempo_map (P_TEMPO_TRACK);
+
+  Position pos;
+  for (int i = 0; i < 13 * 16; i++)
+    {
+      position_set_to_bar (&pos, 1);
+      position_add_sixteenths (&pos, i);
+      position_add_ticks (&pos, 7);
+      g_assert_cmpfloat_with_epsilon (
+        tempo_track_get_bpm_at_pos (
+          P_TEMPO_TRACK, &pos),
+        automation_track_get_val_at_pos (
+          at, &pos, false),
+        0.01f);
+    }
+
+  /* check that the map is rebuilt after edits */
+  ZRegion * r = at->regions[0];
+  automation_point_set_fvalue (
+    r->aps[0], 0.5f, true, F_NO_PUBLISH_EVENTS);
+  g_assert_true (
+    g_atomic_int_get (
+      &P_TEMPO_TRACK->tempo_map_outdated));
+  tempo_track_update_tempo_map (P_TEMPO_TRACK);
+  position_set_to_bar (&pos, 3);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_track_get_bpm_at_pos (
+      P_TEMPO_TRACK, &pos),
+    automation_track_get_val_at_pos (
+      at, &pos, false),
+    0.01f);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_ticks_frames_conversion ()
+{
+  test_helper_zrythm_init ();
+
+  add_bpm_automation ();
+  tempo_track_update_tempo_map (P_TEMPO_TRACK);
+
+  /* no automation before bar 3 */
+  Position pos;
+  position_set_to_bar (&pos, 3);
+  for (double ticks = 0.0; ticks <= pos.total_ticks;
+       ticks += 100.0)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        tempo_track_get_frames_at_ticks (
+          P_TEMPO_TRACK, ticks),
+        ticks * AUDIO_ENGINE->frames_per_tick,
+        0.001);
+    }
+
+  /* frames increase with the ticks and convert
+   * back */
+  double prev_frames = -1.0;
+  position_set_to_bar (&pos, 13);
+  for (double ticks = 0.0; ticks <= pos.total_ticks;
+       ticks += 37.0)
+    {
+      double frames =
+        tempo_track_get_frames_at_ticks (
+          P_TEMPO_TRACK, ticks);
+      g_assert_cmpfloat (frames, >, prev_frames);
+      prev_frames = frames;
+      g_assert_cmpfloat_with_epsilon (
+        tempo_track_get_ticks_at_frames (
+          P_TEMPO_TRACK, frames),
+        ticks, 0.01);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/tempo_track/"
+
+  g_test_add_func (
+    TEST_PREFIX "test bpm at pos",
+    (GTestFunc) test_bpm_at_pos);
+  g_test_add_func (
+    TEST_PREFIX "test ticks frames conversion",
+    (GTestFunc) test_ticks_frames_conversion);
+
+  return g_test_run ();
+}
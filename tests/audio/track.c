@@ -19,7 +19,9 @@
 
 #include "zrythm-test-config.h"
 
+#include "audio/midi_region.h"
 #include "audio/track.h"
+#include "audio/tracklist.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm.h"
@@ -42,6 +44,93 @@ test_new_track ()
   g_assert_nonnull (track->name);
 }
 
+static void
+test_lane_region_index ()
+{
+  Track * track =
+    track_new (
+      TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+      "Test MIDI Track 1", F_WITH_LANE);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+  TrackLane * lane = track->lanes[0];
+
+  /* add regions in reverse order, with a long
+   * region at the start overlapping the rest */
+  Position p1, p2;
+  for (int i = 9; i >= 0; i--)
+    {
+      position_set_to_bar (&p1, 1 + i * 2);
+      position_set_to_bar (
+        &p2, i == 0 ? 12 : 2 + i * 2);
+      ZRegion * r =
+        midi_region_new (
+          &p1, &p2, track->pos, 0,
+          lane->num_regions);
+      track_add_region (
+        track, r, NULL, 0, F_GEN_NAME,
+        F_NO_PUBLISH_EVENTS);
+    }
+  g_assert_false (lane->region_index_valid);
+
+  int first, last;
+  g_assert_false (
+    track_lane_get_indexed_regions_in_range (
+      lane, 0, 1, &first, &last));
+
+  tracklist_update_playback_indices (TRACKLIST);
+  g_assert_true (lane->region_index_valid);
+
+  /* check that all regions hit by each range are
+   * in the returned range */
+  for (int bar = 1; bar < 24; bar++)
+    {
+      position_set_to_bar (&p1, bar);
+      long start = p1.frames + 100;
+      long end = start + 256;
+      g_assert_true (
+        track_lane_get_indexed_regions_in_range (
+          lane, start, end, &first, &last));
+      int num_hit = 0;
+      for (int i = 0; i < lane->num_regions; i++)
+        {
+          if (region_is_hit_by_range (
+                lane->regions[i], start, end,
+                F_INCLUSIVE))
+            num_hit++;
+        }
+      int num_hit_in_range = 0;
+      for (int i = first; i < last; i++)
+        {
+          if (region_is_hit_by_range (
+                lane->regions_by_start[i], start,
+                end, F_INCLUSIVE))
+            num_hit_in_range++;
+        }
+      g_assert_cmpint (
+        num_hit_in_range, ==, num_hit);
+    }
+
+  /* moving a region invalidates the index */
+  ArrangerObject * r_obj =
+    (ArrangerObject *) lane->regions[3];
+  position_set_to_bar (&p1, 40);
+  position_set_to_bar (&p2, 41);
+  arranger_object_end_pos_setter (r_obj, &p2);
+  arranger_object_pos_setter (r_obj, &p1);
+  g_assert_false (lane->region_index_valid);
+  tracklist_update_playback_indices (TRACKLIST);
+  g_assert_true (
+    track_lane_get_indexed_regions_in_range (
+      lane, p1.frames, p1.frames + 256,
+      &first, &last));
+  g_assert_cmpint (last - first, ==, 1);
+  g_assert_true (
+    lane->regions_by_start[first] ==
+      (ZRegion *) r_obj);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -54,6 +143,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test new track",
     (GTestFunc) test_new_track);
+  g_test_add_func (
+    TEST_PREFIX "test lane region index",
+    (GTestFunc) test_lane_region_index);
 
   return g_test_run ();
 }
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/router.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_ITERATIONS 4
+
+static void
+append_tracks_until (
+  int num_tracks)
+{
+  while (TRACKLIST->num_tracks < num_tracks)
+    {
+      Track * track =
+        track_new (
+          TRACK_TYPE_AUDIO, TRACKLIST->num_tracks,
+          "Benchmark Audio Track", F_WITH_LANE);
+      tracklist_append_track (
+        TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+        F_NO_RECALC_GRAPH);
+    }
+}
+
+static void
+time_graph_setup (
+  int num_tracks)
+{
+  append_tracks_until (num_tracks);
+
+  gint64 total = 0;
+  size_t num_nodes = 0;
+  for (int i = 0; i < NUM_ITERATIONS; i++)
+    {
+      Graph * graph = graph_new (ROUTER);
+
+      gint64 start = g_get_monotonic_time ();
+      graph_setup (graph, 1, 0);
+      total += g_get_monotonic_time () - start;
+
+      num_nodes = graph->num_setup_graph_nodes;
+      g_assert_nonnull (
+        graph_find_node_from_track (
+          graph,
+          TRACKLIST->tracks[
+            TRACKLIST->num_tracks - 1],
+          true));
+
+      graph_free (graph);
+    }
+
+  fprintf (
+    stderr,
+    "---- graph setup ----\n"
+    "tracks: %d\n"
+    "nodes: %zu\n"
+    "average time: %ldus\n",
+    num_tracks, num_nodes,
+    (long) (total / NUM_ITERATIONS));
+}
+
+static void
+test_graph_setup ()
+{
+  test_helper_zrythm_init ();
+
+  engine_activate (AUDIO_ENGINE, false);
+
+  time_graph_setup (10);
+  time_graph_setup (100);
+  time_graph_setup (1000);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/graph_setup/"
+
+  g_test_add_func (
+    TEST_PREFIX "test graph setup",
+    (GTestFunc) test_graph_setup);
+
+  return g_test_run ();
+}
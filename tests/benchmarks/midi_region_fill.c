@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/midi_event.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_NOTES 100000
+#define BUFFER_SIZE 256
+
+/** Number of cycles to compare against the
+ * linear scan, which is too slow to run over the
+ * whole region. */
+#define NUM_LINEAR_CYCLES 2000
+
+/**
+ * Returns a checksum of the queued events that
+ * does not depend on their order.
+ */
+static long
+get_events_checksum (
+  MidiEvents * events)
+{
+  long sum = 0;
+  for (int i = 0; i < events->num_queued_events;
+       i++)
+    {
+      MidiEvent * ev = &events->queued_events[i];
+      sum +=
+        ((long) ev->time << 16) +
+        ((long) ev->type << 8) + ev->note_pitch;
+    }
+  return sum;
+}
+
+/**
+ * Fills events for @p num_cycles cycles starting
+ * at the region start.
+ *
+ * @param[out] num_events Total number of events.
+ * @param[out] checksums Per-cycle checksums, or
+ *   NULL.
+ *
+ * @return The time taken in microseconds.
+ */
+static gint64
+fill_cycles (
+  ZRegion *    r,
+  MidiEvents * events,
+  long         num_cycles,
+  long *       num_events,
+  long *       checksums)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  *num_events = 0;
+  gint64 total = 0;
+  for (long i = 0; i < num_cycles; i++)
+    {
+      gint64 start = g_get_monotonic_time ();
+      midi_region_fill_midi_events (
+        r, r_obj->pos.frames + i * BUFFER_SIZE,
+        0, BUFFER_SIZE, false, events);
+      total += g_get_monotonic_time () - start;
+
+      *num_events += events->num_queued_events;
+      if (checksums)
+        {
+          checksums[i] =
+            get_events_checksum (events);
+        }
+      midi_events_clear (events, F_QUEUED);
+    }
+
+  return total;
+}
+
+static void
+test_midi_region_fill ()
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_new (
+      TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+      "Benchmark MIDI Track", F_WITH_LANE);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  Position p1, p2;
+  position_set_to_bar (&p1, 1);
+  position_set_to_bar (&p2, 2 + NUM_NOTES / 320);
+  ZRegion * r =
+    midi_region_new (&p1, &p2, track->pos, 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  /* add the notes in reverse so that the index
+   * has to sort them */
+  for (int i = NUM_NOTES - 1; i >= 0; i--)
+    {
+      position_init (&p1);
+      position_add_ticks (&p1, i * 12);
+      p2 = p1;
+      position_add_ticks (&p2, 10 + (i % 3) * 12);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &p1, &p2,
+          (uint8_t) (36 + i % 48),
+          (uint8_t) (1 + i % 127));
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+
+  Port * port =
+    port_new_with_type (
+      TYPE_EVENT, FLOW_INPUT, "Benchmark Port");
+  MidiEvents * events = midi_events_new (port);
+
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  long num_cycles =
+    (r_obj->end_pos.frames - r_obj->pos.frames) /
+      BUFFER_SIZE;
+  g_assert_cmpint (num_cycles, >, NUM_LINEAR_CYCLES);
+
+  /* linear scan */
+  g_assert_false (r->note_index_valid);
+  long linear_events;
+  long * linear_checksums =
+    calloc (NUM_LINEAR_CYCLES, sizeof (long));
+  gint64 linear_time =
+    fill_cycles (
+      r, events, NUM_LINEAR_CYCLES,
+      &linear_events, linear_checksums);
+
+  /* indexed */
+  gint64 start = g_get_monotonic_time ();
+  midi_region_update_note_index (r);
+  gint64 index_time =
+    g_get_monotonic_time () - start;
+  g_assert_true (r->note_index_valid);
+  long indexed_events;
+  long * indexed_checksums =
+    calloc (NUM_LINEAR_CYCLES, sizeof (long));
+  fill_cycles (
+    r, events, NUM_LINEAR_CYCLES,
+    &indexed_events, indexed_checksums);
+
+  /* verify that the same events are produced */
+  g_assert_cmpint (linear_events, >, 0);
+  g_assert_cmpint (linear_events, ==, indexed_events);
+  for (int i = 0; i < NUM_LINEAR_CYCLES; i++)
+    {
+      g_assert_cmpint (
+        linear_checksums[i], ==,
+        indexed_checksums[i]);
+    }
+
+  /* whole region */
+  long total_events;
+  gint64 indexed_time =
+    fill_cycles (
+      r, events, num_cycles, &total_events, NULL);
+  g_assert_cmpint (total_events, >=, NUM_NOTES * 2);
+
+  /* moving a note invalidates the index */
+  ArrangerObject * mn_obj =
+    (ArrangerObject *) r->midi_notes[0];
+  p1 = mn_obj->pos;
+  position_add_ticks (&p1, 1);
+  arranger_object_set_position (
+    mn_obj, &p1, ARRANGER_OBJECT_POSITION_TYPE_START,
+    F_NO_VALIDATE);
+  g_assert_false (r->note_index_valid);
+  tracklist_update_playback_indices (TRACKLIST);
+  g_assert_true (r->note_index_valid);
+
+  fprintf (
+    stderr,
+    "---- MIDI region fill ----\n"
+    "notes: %d\n"
+    "cycles: %ld (%d frames)\n"
+    "index build: %ldus\n"
+    "linear: %.3fus per cycle\n"
+    "indexed: %.3fus per cycle\n",
+    NUM_NOTES, num_cycles, BUFFER_SIZE,
+    (long) index_time,
+    (double) linear_time / NUM_LINEAR_CYCLES,
+    (double) indexed_time / (double) num_cycles);
+
+  free (linear_checksums);
+  free (indexed_checksums);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/midi_region_fill/"
+
+  g_test_add_func (
+    TEST_PREFIX "test midi region fill",
+    (GTestFunc) test_midi_region_fill);
+
+  return g_test_run ();
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/automation_region.h"
+#include "audio/channel.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "project.h"
+#include "utils/binary.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib/gstdio.h>
+
+#define NUM_MIDI_TRACKS 8
+#define NUM_REGIONS_PER_TRACK 4
+#define NUM_AUTOMATION_POINTS 20000
+
+/**
+ * Adds MIDI tracks with regions until there are
+ * about @p num_notes notes in the project, and an
+ * automation region with
+ * @ref NUM_AUTOMATION_POINTS points.
+ */
+static void
+create_large_project (
+  int num_notes)
+{
+  int notes_per_region =
+    num_notes /
+      (NUM_MIDI_TRACKS * NUM_REGIONS_PER_TRACK);
+  Position p1, p2;
+  for (int i = 0; i < NUM_MIDI_TRACKS; i++)
+    {
+      Track * track =
+        track_new (
+          TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+          "Benchmark MIDI Track", F_WITH_LANE);
+      tracklist_append_track (
+        TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+        F_NO_RECALC_GRAPH);
+
+      for (int j = 0; j < NUM_REGIONS_PER_TRACK; j++)
+        {
+          position_set_to_bar (&p1, 1 + j * 64);
+          position_set_to_bar (&p2, 1 + (j + 1) * 64);
+          ZRegion * r =
+            midi_region_new (
+              &p1, &p2, track->pos, 0, j);
+          track_add_region (
+            track, r, NULL, 0, F_GEN_NAME,
+            F_NO_PUBLISH_EVENTS);
+
+          for (int k = 0; k < notes_per_region; k++)
+            {
+              position_init (&p1);
+              position_add_ticks (&p1, k * 12);
+              p2 = p1;
+              position_add_ticks (&p2, 10);
+              MidiNote * mn =
+                midi_note_new (
+                  &r->id, &p1, &p2,
+                  (uint8_t) (36 + k % 48),
+                  (uint8_t) (1 + k % 127));
+              midi_region_add_midi_note (
+                r, mn, F_NO_PUBLISH_EVENTS);
+            }
+        }
+    }
+
+  AutomationTrack * at =
+    channel_get_automation_track (
+      P_MASTER_TRACK->channel,
+      PORT_FLAG_STEREO_BALANCE);
+  position_set_to_bar (&p1, 1);
+  position_set_to_bar (&p2, 257);
+  ZRegion * r =
+    automation_region_new (
+      &p1, &p2, P_MASTER_TRACK->pos, at->index, 0);
+  track_add_region (
+    P_MASTER_TRACK, r, at, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  for (int i = 0; i < NUM_AUTOMATION_POINTS; i++)
+    {
+      position_init (&p1);
+      position_add_ticks (&p1, i * 3);
+      float val = (float) (i % 100) / 100.f;
+      AutomationPoint * ap =
+        automation_point_new_float (val, val, &p1);
+      automation_region_add_ap (
+        r, ap, F_NO_PUBLISH_EVENTS);
+    }
+}
+
+static void
+free_loaded_project (
+  Project * prj)
+{
+  cyaml_config_t cyaml_config;
+  yaml_get_cyaml_config (&cyaml_config);
+  cyaml_free (
+    &cyaml_config, &project_schema, prj, 0);
+}
+
+static void
+time_save_and_load (
+  int num_notes)
+{
+  create_large_project (num_notes);
+
+  char * dir =
+    g_dir_make_tmp ("zrythm_bench_XXXXXX", NULL);
+  char * yaml_path =
+    g_build_filename (dir, "project.yaml.zpj", NULL);
+  char * bin_path =
+    g_build_filename (dir, "project.bin.zpj", NULL);
+
+  /* YAML */
+  gint64 start = g_get_monotonic_time ();
+  char * yaml = project_serialize (PROJECT);
+  g_assert_nonnull (yaml);
+  char * compressed;
+  size_t compressed_size;
+  char * err =
+    project_compress (
+      &compressed, &compressed_size,
+      PROJECT_COMPRESS_DATA,
+      yaml, strlen (yaml), PROJECT_COMPRESS_DATA);
+  g_assert_null (err);
+  g_assert_true (
+    g_file_set_contents (
+      yaml_path, compressed,
+      (gssize) compressed_size, NULL));
+  free (compressed);
+  gint64 yaml_save_time =
+    g_get_monotonic_time () - start;
+
+  start = g_get_monotonic_time ();
+  char * decompressed;
+  size_t decompressed_size;
+  err =
+    project_decompress (
+      &decompressed, &decompressed_size,
+      PROJECT_DECOMPRESS_DATA,
+      yaml_path, 0, PROJECT_DECOMPRESS_FILE);
+  g_assert_null (err);
+  decompressed =
+    realloc (decompressed, decompressed_size + 1);
+  decompressed[decompressed_size] = '\0';
+  Project * yaml_prj =
+    project_deserialize (decompressed);
+  free (decompressed);
+  g_assert_nonnull (yaml_prj);
+  gint64 yaml_load_time =
+    g_get_monotonic_time () - start;
+  free_loaded_project (yaml_prj);
+
+  /* binary */
+  start = g_get_monotonic_time ();
+  err =
+    binary_save_to_file (
+      bin_path, &project_schema, PROJECT);
+  g_assert_null (err);
+  gint64 bin_save_time =
+    g_get_monotonic_time () - start;
+
+  start = g_get_monotonic_time ();
+  Project * bin_prj = NULL;
+  err =
+    binary_load_from_file (
+      bin_path, &project_schema,
+      (void **) &bin_prj);
+  g_assert_null (err);
+  g_assert_nonnull (bin_prj);
+  gint64 bin_load_time =
+    g_get_monotonic_time () - start;
+
+  /* verify that nothing was lost */
+  char * bin_yaml = project_serialize (bin_prj);
+  g_assert_cmpstr (bin_yaml, ==, yaml);
+  g_free (bin_yaml);
+  free_loaded_project (bin_prj);
+
+  GStatBuf yaml_st, bin_st;
+  g_stat (yaml_path, &yaml_st);
+  g_stat (bin_path, &bin_st);
+
+  fprintf (
+    stderr,
+    "---- project save/load ----\n"
+    "notes: %d\n"
+    "automation points: %d\n"
+    "yaml: save %ldms, load %ldms, %ld bytes\n"
+    "binary: save %ldms, load %ldms, %ld bytes\n",
+    num_notes, NUM_AUTOMATION_POINTS,
+    (long) (yaml_save_time / 1000),
+    (long) (yaml_load_time / 1000),
+    (long) yaml_st.st_size,
+    (long) (bin_save_time / 1000),
+    (long) (bin_load_time / 1000),
+    (long) bin_st.st_size);
+
+  g_free (yaml);
+  io_remove (yaml_path);
+  io_remove (bin_path);
+  io_rmdir (dir, false);
+  g_free (yaml_path);
+  g_free (bin_path);
+  g_free (dir);
+}
+
+static void
+test_project_save_load ()
+{
+  test_helper_zrythm_init ();
+
+  time_save_and_load (10000);
+  time_save_and_load (100000);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/project_save_load/"
+
+  g_test_add_func (
+    TEST_PREFIX "test project save load",
+    (GTestFunc) test_project_save_load);
+
+  return g_test_run ();
+}
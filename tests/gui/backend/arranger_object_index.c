@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "gui/backend/arranger_object_index.h"
+
+#include <glib.h>
+
+#define NUM_OBJS 1000
+
+/**
+ * Fake objects. The index does not look inside
+ * them.
+ */
+static char objs[NUM_OBJS];
+
+static double
+get_start (
+  int i)
+{
+  return (double) ((i * 37) % NUM_OBJS) * 10.0;
+}
+
+static double
+get_end (
+  int i)
+{
+  return get_start (i) + (double) (i % 7) * 25.0;
+}
+
+static void
+test_query ()
+{
+  ArrangerObjectIndex * index =
+    arranger_object_index_new ();
+  g_assert_false (
+    arranger_object_index_is_valid (index, NULL));
+
+  arranger_object_index_clear (index, NULL);
+  for (int i = 0; i < NUM_OBJS; i++)
+    {
+      arranger_object_index_add (
+        index, (ArrangerObject *) &objs[i],
+        get_start (i), get_end (i));
+    }
+  arranger_object_index_finish (index);
+  g_assert_true (
+    arranger_object_index_is_valid (index, NULL));
+  g_assert_false (
+    arranger_object_index_is_valid (
+      index, &objs[0]));
+
+  /* compare with a linear search */
+  for (double start = -100.0; start < 10100.0;
+       start += 333.0)
+    {
+      double end = start + 120.0;
+      int num_results;
+      ArrangerObject ** results =
+        arranger_object_index_query (
+          index, start, end, &num_results);
+
+      int num_expected = 0;
+      for (int i = 0; i < NUM_OBJS; i++)
+        {
+          if (get_start (i) > end ||
+              get_end (i) < start)
+            continue;
+
+          /* results are in the order the objects
+           * were added */
+          g_assert_cmpint (
+            num_results, >, num_expected);
+          g_assert_true (
+            results[num_expected] ==
+              (ArrangerObject *) &objs[i]);
+          num_expected++;
+        }
+      g_assert_cmpint (
+        num_results, ==, num_expected);
+    }
+
+  /* point query */
+  int num_results;
+  ArrangerObject ** results =
+    arranger_object_index_query (
+      index, get_start (5), get_start (5),
+      &num_results);
+  g_assert_cmpint (num_results, >=, 1);
+  bool found = false;
+  for (int i = 0; i < num_results; i++)
+    {
+      if (results[i] == (ArrangerObject *) &objs[5])
+        found = true;
+    }
+  g_assert_true (found);
+
+  /* changes make the index outdated */
+  arranger_object_index_invalidate_all ();
+  g_assert_false (
+    arranger_object_index_is_valid (index, NULL));
+
+  arranger_object_index_free (index);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/gui/backend/arranger_object_index/"
+
+  g_test_add_func (
+    TEST_PREFIX "test query",
+    (GTestFunc) test_query);
+
+  return g_test_run ();
+}
@@ -1014,6 +1014,107 @@ test_mono_recording (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_flush_while_recording (void)
+{
+  test_helper_zrythm_init ();
+
+  /* create an audio track */
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  Track * audio_track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+
+  prepare ();
+  TRANSPORT->recording = true;
+  transport_request_roll (TRANSPORT);
+  transport_set_loop (TRANSPORT, false);
+  transport_set_punch_mode_enabled (
+    TRANSPORT, false);
+  Position pos;
+  position_set_to_bar (&pos, PLAYHEAD_START_BAR);
+  transport_set_playhead_pos (TRANSPORT, &pos);
+  track_set_recording (audio_track, true, false);
+
+  for (nframes_t i = 0; i < CYCLE_SIZE; i++)
+    {
+      AUDIO_ENGINE->dummy_input->l->buf[i] =
+        AUDIO_VAL;
+      AUDIO_ENGINE->dummy_input->r->buf[i] =
+        AUDIO_VAL;
+    }
+
+  /* record more than a chunk */
+  long total_frames = 0;
+  while (total_frames <=
+           RECORDING_MANAGER_FLUSH_CHUNK_FRAMES)
+    {
+      engine_process (AUDIO_ENGINE, CYCLE_SIZE);
+      recording_manager_process_events (
+        RECORDING_MANAGER);
+      total_frames += CYCLE_SIZE;
+    }
+
+  g_assert_cmpint (
+    audio_track->lanes[0]->num_regions, ==, 1);
+  AudioClip * clip =
+    audio_region_get_clip (
+      audio_track->lanes[0]->regions[0]);
+  g_assert_cmpint (
+    clip->num_frames, ==, total_frames);
+
+  /* wait for the flusher thread to write the
+   * first chunk */
+  long frames_written = 0;
+  for (int i = 0; i < 500; i++)
+    {
+      g_mutex_lock (&RECORDING_MANAGER->flush_lock);
+      frames_written = clip->frames_written;
+      g_mutex_unlock (
+        &RECORDING_MANAGER->flush_lock);
+      if (frames_written > 0)
+        break;
+      g_usleep (10000);
+    }
+  g_assert_cmpint (
+    frames_written, ==,
+    RECORDING_MANAGER_FLUSH_CHUNK_FRAMES);
+
+  /* check the written frames while still
+   * recording */
+  char * path = audio_clip_get_path_in_pool (clip);
+  AudioClip * written_clip =
+    audio_clip_new_from_file (path);
+  g_assert_nonnull (written_clip);
+  g_assert_cmpint (
+    written_clip->num_frames, ==, frames_written);
+  g_assert_cmpuint (written_clip->channels, ==, 2);
+  for (long i = 0; i < frames_written;
+       i += CYCLE_SIZE)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        written_clip->ch_frames[0][i], AUDIO_VAL,
+        0.0001f);
+      g_assert_cmpfloat_with_epsilon (
+        written_clip->ch_frames[1][i], AUDIO_VAL,
+        0.0001f);
+    }
+  audio_clip_free (written_clip);
+  g_free (path);
+
+  /* stop recording */
+  track_set_recording (audio_track, false, false);
+  engine_process (AUDIO_ENGINE, CYCLE_SIZE);
+  transport_request_pause (TRANSPORT);
+  recording_manager_process_events (
+    RECORDING_MANAGER);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1032,6 +1133,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test mono recording",
     (GTestFunc) test_mono_recording);
+  g_test_add_func (
+    TEST_PREFIX "test flush while recording",
+    (GTestFunc) test_flush_while_recording);
 
   return g_test_run ();
 }
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2020 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "plugins/cached_plugin_descriptors.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+
+#include "helpers/zrythm.h"
+
+#include <glib/gstdio.h>
+
+#include <utime.h>
+
+static void
+test_lookup ()
+{
+  test_helper_zrythm_init ();
+
+  CachedPluginDescriptors * self =
+    cached_plugin_descriptors_new ();
+  g_assert_nonnull (self);
+
+  /* create a fake plugin file */
+  char * dir =
+    g_dir_make_tmp ("zrythm_cached_XXXXXX", NULL);
+  char * path =
+    g_build_filename (dir, "plugin.so", NULL);
+  g_assert_true (
+    g_file_set_contents (path, "abc", -1, NULL));
+
+  PluginDescriptor descr;
+  memset (&descr, 0, sizeof (PluginDescriptor));
+  descr.name = "Test";
+  descr.protocol = PROT_VST;
+  descr.arch = ARCH_64;
+  descr.path = path;
+  descr.unique_id = 1;
+  GFile * file = g_file_new_for_path (path);
+  descr.ghash = g_file_hash (file);
+  g_object_unref (file);
+  descr.mtime =
+    io_file_get_last_modified_time (path);
+  cached_plugin_descriptors_add (
+    self, &descr, F_NO_SERIALIZE);
+
+  PluginDescriptor ** descriptors =
+    cached_plugin_descriptors_get (self, path);
+  g_assert_nonnull (descriptors);
+  g_assert_cmpstr (descriptors[0]->name, ==, "Test");
+  g_assert_null (descriptors[1]);
+  free (descriptors);
+  g_assert_nonnull (
+    cached_plugin_descriptors_find (
+      self, &descr, F_CHECK_VALID,
+      F_NO_CHECK_BLACKLISTED));
+
+  /* replace with a different name */
+  descr.name = "Test 2";
+  cached_plugin_descriptors_replace (
+    self, &descr, F_NO_SERIALIZE);
+  g_assert_cmpint (self->num_descriptors, ==, 1);
+  descriptors =
+    cached_plugin_descriptors_get (self, path);
+  g_assert_nonnull (descriptors);
+  g_assert_cmpstr (
+    descriptors[0]->name, ==, "Test 2");
+  free (descriptors);
+
+  /* changed files are not returned */
+  struct utimbuf times = {
+    .actime = 1000, .modtime = 1000 };
+  g_assert_cmpint (g_utime (path, &times), ==, 0);
+  g_assert_null (
+    cached_plugin_descriptors_get (self, path));
+
+  /* LV2 lookup by URI */
+  PluginDescriptor lv2_descr;
+  memset (&lv2_descr, 0, sizeof (PluginDescriptor));
+  lv2_descr.name = "LV2 Test";
+  lv2_descr.protocol = PROT_LV2;
+  lv2_descr.uri = "http://example.org/test";
+  lv2_descr.mtime = 1234;
+  cached_plugin_descriptors_add (
+    self, &lv2_descr, F_NO_SERIALIZE);
+  g_assert_nonnull (
+    cached_plugin_descriptors_get_lv2 (
+      self, lv2_descr.uri, 1234));
+  g_assert_null (
+    cached_plugin_descriptors_get_lv2 (
+      self, lv2_descr.uri, 1235));
+  g_assert_null (
+    cached_plugin_descriptors_get_lv2 (
+      self, "http://example.org/other", 1234));
+
+  /* blacklisting */
+  char * bl_path =
+    g_build_filename (dir, "broken.so", NULL);
+  g_assert_true (
+    g_file_set_contents (bl_path, "abc", -1, NULL));
+  g_assert_false (
+    cached_plugin_descriptors_is_blacklisted (
+      self, bl_path));
+  cached_plugin_descriptors_blacklist (
+    self, bl_path, F_NO_SERIALIZE);
+  g_assert_true (
+    cached_plugin_descriptors_is_blacklisted (
+      self, bl_path));
+  g_assert_cmpint (g_utime (bl_path, &times), ==, 0);
+  g_assert_false (
+    cached_plugin_descriptors_is_blacklisted (
+      self, bl_path));
+
+  cached_plugin_descriptors_clear (self);
+  g_assert_null (
+    cached_plugin_descriptors_get_lv2 (
+      self, lv2_descr.uri, 1234));
+  cached_plugin_descriptors_free (self);
+
+  io_remove (path);
+  io_remove (bl_path);
+  io_rmdir (dir, false);
+  g_free (path);
+  g_free (bl_path);
+  g_free (dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/plugins/cached_plugin_descriptors/"
+
+  g_test_add_func (
+    TEST_PREFIX "test lookup",
+    (GTestFunc) test_lookup);
+
+  return g_test_run ();
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <string.h>
+
+#include "utils/log.h"
+#include "utils/rt_trace.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define NUM_THREADS 4
+#define MSGS_PER_THREAD 64
+
+static gpointer
+log_from_thread (
+  gpointer data)
+{
+  int idx = GPOINTER_TO_INT (data);
+  for (int i = 0; i < MSGS_PER_THREAD; i++)
+    {
+      rt_message ("thread %d message %d", idx, i);
+    }
+
+  return NULL;
+}
+
+static void
+test_drain ()
+{
+  test_helper_zrythm_init ();
+
+  /* write any pending messages first */
+  rt_trace_drain (LOG->rt_trace);
+
+  GThread * threads[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; i++)
+    {
+      threads[i] =
+        g_thread_new (
+          "rt_trace", log_from_thread,
+          GINT_TO_POINTER (i));
+    }
+  for (int i = 0; i < NUM_THREADS; i++)
+    {
+      g_thread_join (threads[i]);
+    }
+
+  /* the engine may also log in the meantime */
+  g_assert_cmpint (
+    rt_trace_drain (LOG->rt_trace), >=,
+    NUM_THREADS * MSGS_PER_THREAD);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_full_ring ()
+{
+  test_helper_zrythm_init ();
+
+  rt_trace_drain (LOG->rt_trace);
+
+  /* messages are dropped instead of blocking when
+   * the ring is full */
+  for (int i = 0; i < RT_TRACE_RING_SIZE + 10; i++)
+    {
+      rt_message ("message %d", i);
+    }
+  g_assert_cmpint (
+    rt_trace_drain (LOG->rt_trace), >=,
+    RT_TRACE_RING_SIZE);
+  g_assert_cmpint (
+    rt_trace_drain (LOG->rt_trace), <,
+    RT_TRACE_RING_SIZE);
+
+  /* the ring is usable again after draining */
+  rt_message ("message after drain");
+  g_assert_cmpint (
+    rt_trace_drain (LOG->rt_trace), >=, 1);
+
+  /* long messages are truncated */
+  char long_str[RT_TRACE_MSG_SIZE * 2];
+  memset (long_str, 'a', sizeof (long_str) - 1);
+  long_str[sizeof (long_str) - 1] = '\0';
+  rt_message ("%s", long_str);
+  g_assert_cmpint (
+    rt_trace_drain (LOG->rt_trace), >=, 1);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_thread_exit ()
+{
+  test_helper_zrythm_init ();
+
+  rt_trace_drain (LOG->rt_trace);
+
+  /* rings are released when the threads exit, so
+   * more threads than rings can log one after the
+   * other */
+  int num_threads = RT_TRACE_MAX_THREADS * 2;
+  for (int i = 0; i < num_threads; i++)
+    {
+      GThread * thread =
+        g_thread_new (
+          "rt_trace", log_from_thread,
+          GINT_TO_POINTER (i));
+      g_thread_join (thread);
+    }
+  g_assert_cmpint (
+    g_atomic_int_get (&LOG->rt_trace->num_dropped),
+    ==, 0);
+  g_assert_cmpint (
+    rt_trace_drain (LOG->rt_trace), >=,
+    num_threads * MSGS_PER_THREAD);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+set_args (
+  RtTraceRecord * rec,
+  const char *    format,
+  ...)
+{
+  va_list args;
+  va_start (args, format);
+  rt_trace_record_set_args (rec, format, args);
+  va_end (args);
+}
+
+static void
+check_format (
+  const char * expected,
+  const char * format,
+  ...)
+{
+  RtTraceRecord rec;
+  va_list args;
+  va_start (args, format);
+  rt_trace_record_set_args (&rec, format, args);
+  va_end (args);
+
+  char buf[RT_TRACE_MSG_SIZE];
+  rt_trace_record_format (&rec, buf, sizeof (buf));
+  g_assert_cmpstr (buf, ==, expected);
+}
+
+static void
+test_format ()
+{
+  check_format ("plain", "plain");
+  check_format ("100%", "100%%");
+  check_format (
+    "1 -2 3 0x1f 4.50", "%d %ld %zu %#x %.2f",
+    1, -2l, (size_t) 3, 31u, 4.5);
+  check_format (
+    "[  ab] [ 1.5]", "[%4s] [%*.*f]", "ab", 4, 1,
+    1.5);
+  check_format (
+    "(null) x", "%s %c", (char *) NULL, 'x');
+
+  /* arguments that do not fit are not stored */
+  check_format (
+    "1 2 3 4 5 6 7 8 ...",
+    "%d %d %d %d %d %d %d %d %d",
+    1, 2, 3, 4, 5, 6, 7, 8, 9);
+
+  /* strings are copied when logging */
+  char str[] = "before";
+  RtTraceRecord rec;
+  set_args (&rec, "%s", str);
+  strcpy (str, "after");
+  char buf[RT_TRACE_MSG_SIZE];
+  rt_trace_record_format (&rec, buf, sizeof (buf));
+  g_assert_cmpstr (buf, ==, "before");
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/rt_trace/"
+
+  g_test_add_func (
+    TEST_PREFIX "test drain",
+    (GTestFunc) test_drain);
+  g_test_add_func (
+    TEST_PREFIX "test full ring",
+    (GTestFunc) test_full_ring);
+  g_test_add_func (
+    TEST_PREFIX "test thread exit",
+    (GTestFunc) test_thread_exit);
+  g_test_add_func (
+    TEST_PREFIX "test format",
+    (GTestFunc) test_format);
+
+  return g_test_run ();
+}